@@ -0,0 +1,211 @@
+﻿/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+using UnityEngine;
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Index of the targets of a device database shipped in StreamingAssets/QCAR.
+///
+/// The native plugin parses the database descriptor once into a compact
+/// table, cached in Application.temporaryCachePath, so that the database
+/// holding a target can be found without loading any database.
+/// The index is not available in the Editor.
+/// </summary>
+public class DataSetIndex : IDisposable
+{
+    #region NESTED
+
+    public enum TargetType
+    {
+        IMAGE_TARGET,
+        MULTI_TARGET,
+        CYLINDER_TARGET,
+        OBJECT_TARGET,
+        VUMARK
+    }
+
+    public struct TargetInfo
+    {
+        public string Name;
+        public TargetType Type;
+        public Vector3 Size;        // see the native DataSetTarget structure
+        public int MemorySize;      // bytes of the target data once loaded
+    }
+
+    /// <summary>
+    /// The layout matches the native DataSetTarget structure.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    private struct NativeTarget
+    {
+        public IntPtr Name;
+        public int Type;
+        public float Width;
+        public float Height;
+        public float Depth;
+        public uint DataOffset;
+        public uint DataSize;
+        public uint MemorySize;
+    }
+
+    #endregion // NESTED
+
+
+
+    #region PRIVATE_MEMBER_VARIABLES
+
+    private IntPtr mIndexPtr = IntPtr.Zero;
+    private string mDataSetName;
+
+    #endregion // PRIVATE_MEMBER_VARIABLES
+
+
+
+    #region PUBLIC_METHODS
+
+    private DataSetIndex(IntPtr indexPtr, string dataSetName)
+    {
+        mIndexPtr = indexPtr;
+        mDataSetName = dataSetName;
+    }
+
+    /// <summary>
+    /// Opens the index of StreamingAssets/QCAR/dataSetName.xml, building it on first use.
+    /// Returns null if it cannot be built, or on platforms without the native plugin.
+    /// </summary>
+    public static DataSetIndex Open(string dataSetName)
+    {
+#if !UNITY_EDITOR
+        string basePath = Application.streamingAssetsPath + "/QCAR/" + dataSetName;
+        IntPtr indexPtr = dataSetIndexOpen(basePath + ".xml", basePath + ".dat",
+                                           Application.temporaryCachePath + "/DataSetIndex");
+        if (indexPtr != IntPtr.Zero)
+        {
+            return new DataSetIndex(indexPtr, dataSetName);
+        }
+        Debug.LogWarning("Could not index the database " + dataSetName);
+#endif
+        return null;
+    }
+
+    public string DataSetName
+    {
+        get { return mDataSetName; }
+    }
+
+    public int TargetCount
+    {
+        get
+        {
+#if !UNITY_EDITOR
+            return dataSetIndexGetTargetCount(mIndexPtr);
+#else
+            return 0;
+#endif
+        }
+    }
+
+    /// <summary>
+    /// Looks up a target by name, without loading the database
+    /// </summary>
+    public bool FindTarget(string targetName, out TargetInfo info)
+    {
+        info = new TargetInfo();
+#if !UNITY_EDITOR
+        NativeTarget target;
+        if (mIndexPtr != IntPtr.Zero && dataSetIndexFindTarget(mIndexPtr, targetName, out target))
+        {
+            info = ToTargetInfo(target);
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    /// <summary>
+    /// Returns the targets of the database, sorted by name
+    /// </summary>
+    public TargetInfo[] GetTargets()
+    {
+        TargetInfo[] targets = new TargetInfo[TargetCount];
+#if !UNITY_EDITOR
+        for (int i = 0; i < targets.Length; ++i)
+        {
+            NativeTarget target;
+            if (dataSetIndexGetTarget(mIndexPtr, i, out target))
+            {
+                targets[i] = ToTargetInfo(target);
+            }
+        }
+#endif
+        return targets;
+    }
+
+    public void Dispose()
+    {
+#if !UNITY_EDITOR
+        if (mIndexPtr != IntPtr.Zero)
+        {
+            dataSetIndexClose(mIndexPtr);
+        }
+#endif
+        mIndexPtr = IntPtr.Zero;
+    }
+
+    #endregion // PUBLIC_METHODS
+
+
+
+    #region PRIVATE_METHODS
+
+    private static TargetInfo ToTargetInfo(NativeTarget target)
+    {
+        TargetInfo info = new TargetInfo();
+        info.Name = Marshal.PtrToStringAnsi(target.Name);
+        info.Type = (TargetType)target.Type;
+        info.Size = new Vector3(target.Width, target.Height, target.Depth);
+        info.MemorySize = (int)target.MemorySize;
+        return info;
+    }
+
+    #endregion // PRIVATE_METHODS
+
+
+
+    #region NATIVE_FUNCTIONS
+
+#if !UNITY_EDITOR
+
+#if UNITY_IPHONE || UNITY_IOS
+    private const string PLUGIN_NAME = "__Internal";
+#else
+    private const string PLUGIN_NAME = "VuforiaMedia";
+#endif
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern IntPtr dataSetIndexOpen([MarshalAs(UnmanagedType.LPStr)] string xmlPath,
+                                                  [MarshalAs(UnmanagedType.LPStr)] string datPath,
+                                                  [MarshalAs(UnmanagedType.LPStr)] string cacheDirectory);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern void dataSetIndexClose(IntPtr index);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern int dataSetIndexGetTargetCount(IntPtr index);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern bool dataSetIndexGetTarget(IntPtr index, int targetIndex, out NativeTarget target);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern bool dataSetIndexFindTarget(IntPtr index, [MarshalAs(UnmanagedType.LPStr)] string name,
+                                                      out NativeTarget target);
+
+#endif // !UNITY_EDITOR
+
+    #endregion // NATIVE_FUNCTIONS
+}
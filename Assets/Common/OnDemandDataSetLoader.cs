@@ -0,0 +1,199 @@
+﻿/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+using UnityEngine;
+using System.Collections.Generic;
+using System.Linq;
+using Vuforia;
+
+/// <summary>
+/// Loads and activates device databases only when one of their targets is
+/// needed, instead of loading every database at startup.
+///
+/// The databases listed here should not be loaded by the Vuforia configuration.
+/// Their targets are looked up in a DataSetIndex; where no index is available
+/// (in the Editor), the databases are loaded in turn until the target is found.
+/// </summary>
+public class OnDemandDataSetLoader : MonoBehaviour
+{
+    #region PUBLIC_MEMBER_VARIABLES
+
+    // Names of the databases in StreamingAssets/QCAR, without extension
+    public string[] DataSetNames = new string[0];
+
+    #endregion // PUBLIC_MEMBER_VARIABLES
+
+
+
+    #region PRIVATE_MEMBER_VARIABLES
+
+    private Dictionary<string, DataSetIndex> mIndices = new Dictionary<string, DataSetIndex>();
+    private Dictionary<string, DataSet> mLoadedDataSets = new Dictionary<string, DataSet>();
+
+    #endregion // PRIVATE_MEMBER_VARIABLES
+
+
+
+    #region MONOBEHAVIOUR_METHODS
+
+    void Start()
+    {
+        foreach (string dataSetName in DataSetNames)
+        {
+            DataSetIndex index = DataSetIndex.Open(dataSetName);
+            if (index != null)
+            {
+                mIndices[dataSetName] = index;
+            }
+        }
+    }
+
+    void OnDestroy()
+    {
+        foreach (DataSetIndex index in mIndices.Values)
+        {
+            index.Dispose();
+        }
+        mIndices.Clear();
+    }
+
+    #endregion // MONOBEHAVIOUR_METHODS
+
+
+
+    #region PUBLIC_METHODS
+
+    /// <summary>
+    /// Returns the name of the database holding the target, or null.
+    /// Only indexed databases are searched; nothing is loaded.
+    /// </summary>
+    public string FindDataSet(string targetName)
+    {
+        foreach (DataSetIndex index in mIndices.Values)
+        {
+            DataSetIndex.TargetInfo info;
+            if (index.FindTarget(targetName, out info))
+            {
+                return index.DataSetName;
+            }
+        }
+        return null;
+    }
+
+    /// <summary>
+    /// Loads and activates the database holding the target, if it is not already active
+    /// </summary>
+    public bool ActivateTarget(string targetName)
+    {
+        string dataSetName = FindDataSet(targetName);
+        if (dataSetName != null)
+        {
+            return ActivateDataSet(dataSetName);
+        }
+
+        // Databases without index: load them until one holds the target
+        foreach (string name in DataSetNames)
+        {
+            if (mIndices.ContainsKey(name))
+            {
+                continue;
+            }
+
+            DataSet dataSet = LoadDataSet(name);
+            if (dataSet != null && dataSet.GetTrackables().Any(trackable => trackable.Name == targetName))
+            {
+                return ActivateDataSet(name);
+            }
+        }
+
+        Debug.LogError("No database holds the target " + targetName);
+        return false;
+    }
+
+    public bool ActivateDataSet(string dataSetName)
+    {
+        DataSet dataSet = LoadDataSet(dataSetName);
+        if (dataSet == null)
+        {
+            return false;
+        }
+
+        ObjectTracker objectTracker = TrackerManager.Instance.GetTracker<ObjectTracker>();
+        if (objectTracker.GetActiveDataSets().Contains(dataSet))
+        {
+            return true;
+        }
+
+        // Datasets should not be activated while the ObjectTracker is running
+        bool wasActive = objectTracker.IsActive;
+        objectTracker.Stop();
+        bool activated = objectTracker.ActivateDataSet(dataSet);
+        if (wasActive)
+        {
+            objectTracker.Start();
+        }
+        return activated;
+    }
+
+    /// <summary>
+    /// Deactivates the database and releases the memory of its targets
+    /// </summary>
+    public void UnloadDataSet(string dataSetName)
+    {
+        DataSet dataSet;
+        if (!mLoadedDataSets.TryGetValue(dataSetName, out dataSet))
+        {
+            return;
+        }
+
+        ObjectTracker objectTracker = TrackerManager.Instance.GetTracker<ObjectTracker>();
+        bool wasActive = objectTracker.IsActive;
+        objectTracker.Stop();
+        objectTracker.DeactivateDataSet(dataSet);
+        objectTracker.DestroyDataSet(dataSet, true);
+        if (wasActive)
+        {
+            objectTracker.Start();
+        }
+
+        mLoadedDataSets.Remove(dataSetName);
+    }
+
+    #endregion // PUBLIC_METHODS
+
+
+
+    #region PRIVATE_METHODS
+
+    private DataSet LoadDataSet(string dataSetName)
+    {
+        DataSet dataSet;
+        if (mLoadedDataSets.TryGetValue(dataSetName, out dataSet))
+        {
+            return dataSet;
+        }
+
+        ObjectTracker objectTracker = TrackerManager.Instance.GetTracker<ObjectTracker>();
+        if (objectTracker == null || !DataSet.Exists(dataSetName))
+        {
+            Debug.LogError("Cannot load the database " + dataSetName);
+            return null;
+        }
+
+        dataSet = objectTracker.CreateDataSet();
+        if (!dataSet.Load(dataSetName))
+        {
+            Debug.LogError("Failed to load the database " + dataSetName);
+            objectTracker.DestroyDataSet(dataSet, false);
+            return null;
+        }
+
+        mLoadedDataSets[dataSetName] = dataSet;
+        return dataSet;
+    }
+
+    #endregion // PRIVATE_METHODS
+}
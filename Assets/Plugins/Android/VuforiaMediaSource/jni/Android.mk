@@ -9,7 +9,25 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE    := libVuforiaMedia
 LOCAL_ARM_MODE  := arm
-LOCAL_SRC_FILES := VideoPlayerHelper.cpp SampleUtils.cpp
-LOCAL_LDLIBS    := -llog -lGLESv3
+LOCAL_SRC_FILES := VideoPlayerHelper.cpp SampleUtils.cpp \
+                   ../../../VuforiaMediaCommon/src/CachingProxy.cpp \
+                   ../../../VuforiaMediaCommon/src/CachingProxyApi.cpp \
+                   ../../../VuforiaMediaCommon/src/DataSetIndex.cpp \
+                   ../../../VuforiaMediaCommon/src/DataSetIndexApi.cpp \
+                   ../../../VuforiaMediaCommon/src/FileUtils.cpp \
+                   ../../../VuforiaMediaCommon/src/FrameSelector.cpp \
+                   ../../../VuforiaMediaCommon/src/GpuMemoryBudget.cpp \
+                   ../../../VuforiaMediaCommon/src/GpuMemoryBudgetApi.cpp \
+                   ../../../VuforiaMediaCommon/src/GpuResourceRegistry.cpp \
+                   ../../../VuforiaMediaCommon/src/HttpClient.cpp \
+                   ../../../VuforiaMediaCommon/src/MappedFile.cpp \
+                   ../../../VuforiaMediaCommon/src/PlaybackStats.cpp \
+                   ../../../VuforiaMediaCommon/src/PlayerStatusBlock.cpp \
+                   ../../../VuforiaMediaCommon/src/Playlist.cpp \
+                   ../../../VuforiaMediaCommon/src/RangeCache.cpp \
+                   ../../../VuforiaMediaCommon/src/SocketUtils.cpp \
+                   ../../../VuforiaMediaCommon/src/ZipArchive.cpp
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../../VuforiaMediaCommon/src
+LOCAL_LDLIBS    := -llog -lEGL -lGLESv3
 
 include $(BUILD_SHARED_LIBRARY)
@@ -4,4 +4,5 @@
 #==============================================================================
 
 APP_ABI := armeabi-v7a 
-
+APP_STL := c++_static
+APP_CPPFLAGS += -std=c++11
@@ -8,6 +8,10 @@ Confidential and Proprietary - Protected under copyright and other laws.
 
 #include <jni.h>
 #include <stdlib.h>
+#include <mutex>
+#include <string>
+
+#include <EGL/egl.h>
 
 //Superset of OGL2
 #include <GLES3/gl3.h>
@@ -17,7 +21,15 @@ Confidential and Proprietary - Protected under copyright and other laws.
 #include <GLES2/gl2ext.h>
 
 #include "SampleUtils.h"
-#include "CubeShaders.h"
+#include "CopyShaders.h"
+#include "FrameSelector.h"
+#include "GpuMemoryBudget.h"
+#include "GpuResourceRegistry.h"
+#include "PlaybackStats.h"
+#include "PlayerStatusBlock.h"
+#include "ZipArchive.h"
+
+using namespace VuforiaMedia;
 
 
 #ifdef __cplusplus
@@ -26,11 +38,32 @@ extern "C"
 #endif
 
 
-unsigned int shaderProgramID    = 0;
-GLint vertexHandle              = 0;
-GLint textureCoordHandle        = 0;
-GLint mvpMatrixHandle           = 0;
-GLint textureMatrixHandle       = 0;
+// The SurfaceTexture frame is transformed by its texture matrix and flipped
+// vertically to the orientation of Unity textures. The copy variant also
+// crops it, or recombines a frame packed with its colour in the left half
+// and its alpha in the right half, when the player asks for it.
+static const unsigned int SURFACE_TEXTURE_GEOMETRY = COPY_GEOMETRY_FLIP_Y | COPY_GEOMETRY_TEXTURE_MATRIX;
+
+// Copy programs, owned by the GPU resource registry, by variant: the
+// locations are looked up again when a program is rebuilt after a context loss
+struct CopyProgram
+{
+    GLuint program;
+    GLint vertexHandle;
+    GLint textureCoordHandle;
+    GLint mvpMatrixHandle;
+    GLint textureMatrixHandle;
+    GLint cropRectHandle;
+};
+static CopyProgram copyPrograms[COPY_SHADER_VARIANT_COUNT];
+
+// Display cadence of the frames latched by each player, by status slot: the
+// SurfaceTexture always latches the newest frame, so the frames cannot be
+// chosen by display time here, only measured
+static JudderMeter judderMeters[PlayerStatusBlock::SLOT_COUNT];
+
+// Decoded, displayed and dropped frames of each player, by status slot
+static PlaybackStatsCounters playbackStats[PlayerStatusBlock::SLOT_COUNT];
 
 // Used to know which version of OpenGL we are using and render video accordingly
 int _glVersion = -1;
@@ -44,13 +77,13 @@ float orthoQuadVertices[] =
     1.0f,  1.0f, 0.0f,
     -1.0f,  1.0f, 0.0f
 };
-// Note this intentionally flips the texture horizontally:
+// Flips are done by the copy shader variant
 float orthoQuadTexCoords[] =
 {
-    1.0f, 0.0f,
     0.0f, 0.0f,
-    0.0f, 1.0f,
-    1.0f, 1.0f
+    1.0f, 0.0f,
+    1.0f, 1.0f,
+    0.0f, 1.0f
 };
 unsigned char orthoQuadIndices[]=
 {
@@ -83,16 +116,12 @@ setOrthographicProjectionMatrix(float orthoMatrix[16])
 
 
 JNIEXPORT int JNICALL
-Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_initMediaTexture(JNIEnv* env, jobject obj)
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_initMediaTexture(JNIEnv* env, jobject obj, jint slot)
 {
-    // Generate OpenGL texture objects for SurfaceTexture:
-    GLuint mediaTextureID;
-    glGenTextures(1, &mediaTextureID);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, mediaTextureID);
-    glTexParameterf(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
-    return mediaTextureID;
+    // Generate OpenGL texture objects for SurfaceTexture, in the current context
+    GpuResourceRegistry& registry = GpuResourceRegistry::Instance();
+    registry.RestoreIfLost(eglGetCurrentContext());
+    return registry.CreateMediaTexture(slot);
 }
 
 
@@ -111,32 +140,71 @@ Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_initNative(JNIEnv *, jobject, ji
 }
 
 
+// Buffers of the SurfaceTexture queue the decoder renders to, in YUV 4:2:0
+static const int SURFACE_TEXTURE_BUFFER_COUNT = 3;
+
+// Storage of the video texture the FBO renders to, with an alpha channel
+// for packed alpha videos
+static const GpuTextureFormat VIDEO_TEXTURE_FORMAT = { GL_RGB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5 };
+static const GpuTextureFormat PACKED_ALPHA_TEXTURE_FORMAT = { GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE };
+
+
+// Look up the locations in the copy program, when it was (re)built
+static const CopyProgram*
+useCopyProgram(bool cropped, bool packedAlpha)
+{
+    const CopyShaderSource* shader = FindCopyShader(COPY_SAMPLER_EXTERNAL_OES,
+        SURFACE_TEXTURE_GEOMETRY | (cropped ? COPY_GEOMETRY_CROP : 0),
+        COPY_COLOR_NONE, packedAlpha ? COPY_OUTPUT_PACKED_ALPHA : COPY_OUTPUT_RGBA);
+    if (shader == NULL)
+        return NULL;
+
+    GLuint program = GpuResourceRegistry::Instance().GetCopyProgram(*shader);
+    if (program == 0)
+        return NULL;
+
+    CopyProgram& copyProgram = copyPrograms[shader->index];
+    if (program != copyProgram.program)
+    {
+        copyProgram.program             = program;
+        copyProgram.vertexHandle        = glGetAttribLocation(program,
+                                                              "vertexPosition");
+        copyProgram.textureCoordHandle  = glGetAttribLocation(program,
+                                                              "vertexTexCoord");
+        copyProgram.mvpMatrixHandle     = glGetUniformLocation(program,
+                                                               "modelViewProjectionMatrix");
+        copyProgram.textureMatrixHandle = glGetUniformLocation(program,
+                                                               "textureMatrix");
+        copyProgram.cropRectHandle      = glGetUniformLocation(program,
+                                                               "cropRect");
+    }
+
+    glUseProgram(program);
+    return &copyProgram;
+}
+
+
 JNIEXPORT int JNICALL
-Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_initFBO(JNIEnv* env, jobject obj, jint destTextureID, int videoWidth, int videoHeight)
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_initFBO(JNIEnv* env, jobject obj, jint slot, jint destTextureID, int videoWidth, int videoHeight,
+                                                         int frameWidth, int frameHeight, jboolean packedAlpha)
 {
     //LOG("VuforiaMedia initFBO, destTextureID: %d, size: %d, %d", destTextureID, videoWidth, videoHeight);
     
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, destTextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, videoWidth, videoHeight, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 0);
-    
-    GLuint fbo;
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, destTextureID, 0);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GpuResourceRegistry& registry = GpuResourceRegistry::Instance();
+    registry.RestoreIfLost(eglGetCurrentContext());
+
+    // The FBO renders to the video texture, which is its only storage; the
+    // decoder renders whole frames (of frameWidth x frameHeight), of which
+    // the video texture may only hold a crop, or half for packed alpha
+    GpuMemoryBudget& budget = GpuMemoryBudget::Instance();
+    budget.SetAllocation(slot, GPU_MEMORY_VIDEO_TEXTURE,
+        GpuMemoryBudget::GetTextureSize(videoWidth, videoHeight, packedAlpha ? 4 : 2));
+    budget.SetAllocation(slot, GPU_MEMORY_FRAME_BUFFER,
+        GpuMemoryBudget::GetTextureSize(frameWidth, frameHeight, 1) * 3 / 2 * SURFACE_TEXTURE_BUFFER_COUNT);
     
-    shaderProgramID     = SampleUtils::createProgramFromBuffer(cubeMeshVertexShader,
-                                                               cubeFragmentShader);
-    vertexHandle        = glGetAttribLocation(shaderProgramID,
-                                              "vertexPosition");
-    textureCoordHandle  = glGetAttribLocation(shaderProgramID,
-                                              "vertexTexCoord");
-    mvpMatrixHandle     = glGetUniformLocation(shaderProgramID,
-                                               "modelViewProjectionMatrix");
-    textureMatrixHandle = glGetUniformLocation(shaderProgramID,
-                                               "textureMatrix");
+    // Sizes the video texture and renders to it
+    GLuint fbo = registry.CreateFrameBuffer(slot, destTextureID, videoWidth, videoHeight,
+        packedAlpha ? PACKED_ALPHA_TEXTURE_FORMAT : VIDEO_TEXTURE_FORMAT);
     
     setOrthographicProjectionMatrix(orthoProjMatrix);
     
@@ -147,8 +215,40 @@ Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_initFBO(JNIEnv* env, jobject obj
 
 
 JNIEXPORT void JNICALL
-Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_copyTexture(JNIEnv* env, jobject obj, jint mediaTextureID, jint destTextureID, jint fbo,
-                                              jfloatArray textureMat, jint videoWidth, jint videoHeight)
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_releaseFBO(JNIEnv*, jobject, jint slot, jint fbo)
+{
+    GpuResourceRegistry::Instance().ReleaseFrameBuffer(slot, (GLuint)fbo);
+}
+
+
+// Called on the rendering thread before each copy. After a context loss, the
+// GPU objects of all the players are rebuilt at once on the first call; each
+// player then gets its new media texture and FBO (resources) once, and
+// returns true.
+JNIEXPORT jboolean JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_restoreGpuResources(JNIEnv* env, jobject, jint slot, jintArray resources)
+{
+    GpuResourceRegistry& registry = GpuResourceRegistry::Instance();
+    if (registry.RestoreIfLost(eglGetCurrentContext()))
+    {
+        LOG("VuforiaMedia GPU resources restored after a context loss");
+        SampleUtils::checkGlError("VuforiaMedia restoreGpuResources");
+    }
+
+    GpuResources restored;
+    if (!registry.TakeRestored(slot, restored))
+        return JNI_FALSE;
+
+    jint values[2] = { (jint)restored.mediaTexture, (jint)restored.frameBuffer };
+    env->SetIntArrayRegion(resources, 0, 2, values);
+    return JNI_TRUE;
+}
+
+
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_copyTexture(JNIEnv* env, jobject obj, jint mediaTextureID, jint fbo,
+                                              jfloatArray textureMat, jint videoWidth, jint videoHeight,
+                                              jboolean packedAlpha, jfloatArray cropRect)
 {
 	GLint saved_viewport[4];
 	glGetIntegerv(GL_VIEWPORT, saved_viewport);
@@ -170,24 +270,37 @@ Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_copyTexture(JNIEnv* env, jobject
     if(_glVersion > 2)
       glBindVertexArray(0);
 
-    glUseProgram(shaderProgramID);
+    const CopyProgram* copyProgram = useCopyProgram(cropRect != NULL, packedAlpha == JNI_TRUE);
+    if (copyProgram == NULL)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(saved_viewport[0], saved_viewport[1], saved_viewport[2], saved_viewport[3]);
+        return;
+    }
     
-    glVertexAttribPointer(vertexHandle, 3, GL_FLOAT, GL_FALSE, 0,
+    glVertexAttribPointer(copyProgram->vertexHandle, 3, GL_FLOAT, GL_FALSE, 0,
                           (const GLvoid*) &orthoQuadVertices[0]);
-    glVertexAttribPointer(textureCoordHandle, 2, GL_FLOAT, GL_FALSE, 0,
+    glVertexAttribPointer(copyProgram->textureCoordHandle, 2, GL_FLOAT, GL_FALSE, 0,
                           (const GLvoid*) &orthoQuadTexCoords[0]);
     
+    // The video texture has the size of the crop, which the quad samples alone
     glViewport(0, 0, videoWidth, videoHeight);
     
-    glEnableVertexAttribArray(vertexHandle);
-    glEnableVertexAttribArray(textureCoordHandle);
+    glEnableVertexAttribArray(copyProgram->vertexHandle);
+    glEnableVertexAttribArray(copyProgram->textureCoordHandle);
     
     float *textureMatArray = env->GetFloatArrayElements(textureMat, 0);
     
-    glUniformMatrix4fv(mvpMatrixHandle, 1, GL_FALSE,
+    glUniformMatrix4fv(copyProgram->mvpMatrixHandle, 1, GL_FALSE,
                        (GLfloat*) &orthoProjMatrix[0]);
-    glUniformMatrix4fv(textureMatrixHandle, 1, GL_FALSE,
+    glUniformMatrix4fv(copyProgram->textureMatrixHandle, 1, GL_FALSE,
                        (GLfloat*) textureMatArray);
+    if (cropRect != NULL)
+    {
+        float *cropRectArray = env->GetFloatArrayElements(cropRect, 0);
+        glUniform4fv(copyProgram->cropRectHandle, 1, (GLfloat*) cropRectArray);
+        env->ReleaseFloatArrayElements(cropRect, cropRectArray, JNI_ABORT);
+    }
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE,
                    (const GLvoid*) &orthoQuadIndices[0]);
     
@@ -201,6 +314,208 @@ Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_copyTexture(JNIEnv* env, jobject
 }
 
 
+
+JNIEXPORT int JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_acquireStatusSlot(JNIEnv *, jobject)
+{
+    int slot = PlayerStatusBlock::Instance().AcquireSlot();
+    if (slot >= 0)
+    {
+        judderMeters[slot].ResetStats();
+        playbackStats[slot].Reset();
+    }
+    return slot;
+}
+
+
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_releaseStatusSlot(JNIEnv *, jobject, jint slot)
+{
+    GpuMemoryBudget::Instance().ReleasePlayer(slot);
+    GpuResourceRegistry::Instance().ReleasePlayer(slot);
+    PlayerStatusBlock::Instance().ReleaseSlot(slot);
+}
+
+
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_publishNativeStatus(JNIEnv *, jobject, jint slot,
+    jint state, jfloat position, jfloat duration, jint bufferingPercentage, jint frameCounter,
+    jint videoWidth, jint videoHeight, jint playlistIndex)
+{
+    PlayerStatus status;
+    status.state = state;
+    status.position = position;
+    status.duration = duration;
+    status.bufferingPercentage = bufferingPercentage;
+    status.frameCounter = (uint32_t)frameCounter;
+    status.width = videoWidth;
+    status.height = videoHeight;
+    status.playlistIndex = playlistIndex;
+
+    PlayerStatusBlock::Instance().Publish(slot, status);
+}
+
+
+// Called on every render while playing, from the rendering thread, with the
+// SurfaceTexture timestamp of the latched frame
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_recordFrameTiming(JNIEnv *, jobject, jint slot,
+    jdouble displayTime, jboolean newFrame, jdouble presentationTime)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT)
+        return;
+
+    judderMeters[slot].OnRefresh(displayTime, newFrame == JNI_TRUE, presentationTime);
+}
+
+
+// Called from the rendering thread when a new frame was latched; the frames
+// made available since the previous latch were decoded, all but the newest
+// passed over (none are known without a frame listener)
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_recordPresentedFrame(JNIEnv *, jobject, jint slot,
+    jdouble displayTime, jdouble lateness, jint framesLatched)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT)
+        return;
+
+    if (framesLatched > 0)
+    {
+        playbackStats[slot].AddDecoded((uint32_t)framesLatched);
+        playbackStats[slot].AddDropped((uint32_t)framesLatched - 1);
+    }
+    playbackStats[slot].AddPresented(lateness, displayTime);
+}
+
+
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_recordCopyTime(JNIEnv *, jobject, jint slot, jdouble copyTime)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT)
+        return;
+
+    playbackStats[slot].AddCopyTime(copyTime);
+}
+
+
+// Called when playback starts or seeks: the video standing still until the
+// next frame is not a stall
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_markPlaybackStarted(JNIEnv *, jobject, jint slot)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT)
+        return;
+
+    playbackStats[slot].OnPlaybackStarted();
+}
+
+
+JNIEXPORT void JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_resetPlaybackStats(JNIEnv *, jobject, jint slot)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT)
+        return;
+
+    playbackStats[slot].Reset();
+}
+
+
+// The APK is opened once, its central directory is then looked up for every load
+static std::mutex apkMutex;
+static ZipArchive apk;
+
+static std::string
+getStringUTF(JNIEnv* env, jstring string)
+{
+    std::string result;
+    const char* chars = env->GetStringUTFChars(string, NULL);
+    if (chars != NULL)
+    {
+        result = chars;
+        env->ReleaseStringUTFChars(string, chars);
+    }
+    return result;
+}
+
+
+// Finds an asset stored uncompressed in the APK, so that the MediaPlayer can
+// read it in place. range receives its data offset and length in the APK.
+JNIEXPORT jboolean JNICALL
+Java_com_vuforia_VuforiaMedia_VideoPlayerHelper_findStoredAsset(JNIEnv* env, jobject,
+    jstring apkPath, jstring entryName, jlongArray range)
+{
+    std::string path = getStringUTF(env, apkPath);
+    std::string name = getStringUTF(env, entryName);
+
+    std::lock_guard<std::mutex> lock(apkMutex);
+
+    if (apk.GetPath() != path && !apk.Open(path))
+    {
+        LOG("VuforiaMedia could not read the APK central directory");
+        return JNI_FALSE;
+    }
+
+    ZipEntry entry;
+    switch (apk.FindEntry(name, entry))
+    {
+    case ZIP_ENTRY_FOUND:
+        break;
+    case ZIP_ENTRY_MISSING:
+        return JNI_FALSE;
+    case ZIP_ENTRY_COMPRESSED:
+        LOG("VuforiaMedia %s is compressed in the APK and cannot be read in place", name.c_str());
+        return JNI_FALSE;
+    case ZIP_ENTRY_MISALIGNED:
+        LOG("VuforiaMedia %s is not aligned in the APK, zipalign it", name.c_str());
+        return JNI_FALSE;
+    default:
+        LOG("VuforiaMedia %s is invalid in the APK", name.c_str());
+        return JNI_FALSE;
+    }
+
+    jlong values[2] = { (jlong)entry.dataOffset, (jlong)entry.size };
+    env->SetLongArrayRegion(range, 0, 2, values);
+    return JNI_TRUE;
+}
+
+
+// Called from Unity (P/Invoke): returns the shared status block, which is
+// mapped once and then read every frame without going through JNI
+__attribute__((visibility("default"))) const void*
+videoPlayerGetStatusBlockAndroid(int* slotStride, int* slotCount)
+{
+    PlayerStatusBlock& statusBlock = PlayerStatusBlock::Instance();
+    if (slotStride != NULL)
+        *slotStride = statusBlock.GetSlotStride();
+    if (slotCount != NULL)
+        *slotCount = statusBlock.GetSlotCount();
+    return statusBlock.GetData();
+}
+
+
+// Called from Unity (P/Invoke): display cadence of the frames of a player
+__attribute__((visibility("default"))) bool
+videoPlayerGetJudderStatsAndroid(int slot, JudderStats* stats)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT || stats == NULL)
+        return false;
+
+    *stats = judderMeters[slot].GetStats();
+    return true;
+}
+
+
+// Called from Unity (P/Invoke): decoded, displayed and dropped frames of a player
+__attribute__((visibility("default"))) bool
+videoPlayerGetPlaybackStatsAndroid(int slot, PlaybackStats* stats)
+{
+    if (slot < 0 || slot >= PlayerStatusBlock::SLOT_COUNT || stats == NULL)
+        return false;
+
+    *stats = playbackStats[slot].GetSnapshot();
+    return true;
+}
+
 #ifdef __cplusplus
 }
 #endif
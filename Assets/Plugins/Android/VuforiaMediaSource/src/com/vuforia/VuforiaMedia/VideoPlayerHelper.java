@@ -12,9 +12,15 @@ countries.
 
 package com.vuforia.VuforiaMedia;
 
+import java.io.File;
 import java.io.IOException;
 import java.lang.reflect.Constructor;
+import java.lang.reflect.InvocationHandler;
 import java.lang.reflect.Method;
+import java.lang.reflect.Proxy;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.locks.LockSupport;
 import java.util.concurrent.locks.ReentrantLock;
 
 import android.app.Activity;
@@ -26,13 +32,14 @@ import android.media.MediaPlayer.OnCompletionListener;
 import android.media.MediaPlayer.OnErrorListener;
 import android.media.MediaPlayer.OnPreparedListener;
 import android.os.Build;
+import android.os.ParcelFileDescriptor;
 import android.view.Surface;
 
 /** The main class for the VideoPlayer plugin. */
 public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateListener, OnCompletionListener, OnErrorListener
 {
     public static final float       CURRENT_POSITION            = -1;
-    private MediaPlayer             mMediaPlayer                = null;
+    private volatile MediaPlayer    mMediaPlayer                = null;
     private MEDIA_TYPE              mVideoType                  = MEDIA_TYPE.UNKNOWN;
     private Object                  mSurfaceTexture             = null;
     private int                     mCurrentBufferingPercentage = 0;
@@ -40,7 +47,7 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
     private int                     mTextureID                  = 0;
     //Intent                          mPlayerHelperActivityIntent = null;
     private Activity                mParentActivity             = null;
-    private MEDIA_STATE             mCurrentState               = MEDIA_STATE.NOT_READY;
+    private volatile MEDIA_STATE    mCurrentState               = MEDIA_STATE.NOT_READY;
     private boolean                 mShouldPlayImmediately      = false;
     private float                   mSeekPosition               = CURRENT_POSITION;
     private ReentrantLock           mMediaPlayerLock            = null;
@@ -50,16 +57,80 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
     private int mDestTextureID                                  = -1;
     private int mFBO                                            = -1;
 
+    private int mStatusSlot                                     = -1;
+    private int mFrameCounter                                   = 0;
+
+    // Last values read from the media player, published again while it is busy
+    private float mStatusPosition                               = 0;
+    private float mStatusDuration                               = 0;
+    private int mStatusWidth                                    = 0;
+    private int mStatusHeight                                   = 0;
+
+    // Control calls are queued by the script thread and run on the command thread,
+    // which alone calls into the media player for them
+    private final ConcurrentLinkedQueue<Command> mCommands      = new ConcurrentLinkedQueue<Command>();
+    private volatile Thread mCommandThread                      = null;
+    private volatile boolean mCommandThreadRunning              = false;
+
+    // Playlist: mPlaylist[0] is the loaded movie. The next item is prepared on a
+    // second media player before the current one ends, then swapped in on the
+    // same surface, so that the video texture is kept
+    private static final float PREROLL_LEAD_SECONDS             = 2.0f;
+    private volatile String[] mPlaylist                         = null;
+    private volatile boolean mLooping                           = false;
+    private volatile int mPlaylistIndex                         = 0;
+    private volatile boolean mPrerollRequested                  = false;
+    private volatile MediaPlayer mNextPlayer                    = null;
+    private volatile boolean mNextPrepared                      = false;
+    private volatile boolean mNextFailed                        = false;
+    private volatile boolean mAdvancePending                    = false;
+    private int mNextIndex                                      = -1;
+    private Surface mSurface                                    = null;
+    private float mVolume                                       = 1.0f;
+    private int mFBOWidth                                       = 0;
+    private int mFBOHeight                                      = 0;
+
+    // Packed alpha videos hold the colour in the left half of their frames and
+    // the alpha in the right half; the video texture gets the size of a half
+    private volatile boolean mPackedAlpha                       = false;
+    private boolean mFBOPackedAlpha                             = false;
+
+    // Region of the frames copied to the video texture, normalised from their
+    // top left corner (x, y, width, height), null for the whole frame; the
+    // video texture gets its size
+    private volatile float[] mCrop                              = null;
+    private final float[] mCopyCropRect                         = new float[4];
+
+    // After a loss of the OpenGL ES context, the native side rebuilds the media
+    // texture and the FBO; the decoder is moved to a surface texture on the new
+    // media texture, and the one of the lost context is released afterwards
+    private final int[] mRestoredResources                      = new int[2];
+    private volatile Object mLostSurfaceTexture                 = null;
+
+    // Timestamp of the frame last latched, telling a new frame from the
+    // previous one when measuring the display cadence
+    private long mLatchedFrameTimestamp                         = -1;
+
+    // Frames the decoder made available on the surface texture since the last
+    // latch, and when the newest one arrived; MediaPlayer renders each frame
+    // at its presentation time, so the wait until the latch is its lateness
+    private final AtomicInteger mFramesAvailable                = new AtomicInteger(0);
+    private volatile long mFrameAvailableTime                   = 0;
+
 
     private static Constructor<?> _surfaceTextureConstructor;
     private static Constructor<?> _surfaceConstructor;
 
     private static Method _updateTexImageFunc;
     private static Method _getTransformMatrixFunc;
+    private static Method _getTimestampFunc;
     private static Method _releaseFunc;
+    private static Method _setOnFrameAvailableListenerFunc;
+    private static Class<?> _onFrameAvailableListenerClass;
 
     private final String CLASSNAME_SURFACETEXTURE               = "android.graphics.SurfaceTexture";
     private final String CLASSNAME_SURFACE                      = "android.view.Surface";
+    private final String CLASSNAME_ONFRAMEAVAILABLELISTENER     = "android.graphics.SurfaceTexture$OnFrameAvailableListener";
 
 
     // This enum declares the possible states a media can have
@@ -83,6 +154,38 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         }
     }
 
+    // This enum declares the control calls run on the command thread
+    private enum COMMAND {
+        LOAD,
+        PLAY,
+        PAUSE,
+        STOP,
+        SEEK,
+        SET_VOLUME,
+        UNLOAD,
+        UPDATE_LOOP,
+        PREROLL,
+        ADVANCE,
+        RESTORE_SURFACE
+    }
+
+    // A queued control call and its arguments
+    private static final class Command
+    {
+        final COMMAND   type;
+        final float     value;      // position or volume
+        final String    filename;   // LOAD only
+        final boolean   flag;       // LOAD: play once prepared, UNLOAD: after an error
+
+        Command(COMMAND type, float value, String filename, boolean flag)
+        {
+            this.type = type;
+            this.value = value;
+            this.filename = filename;
+            this.flag = flag;
+        }
+    }
+
     // This enum declares what type of playback we can do, share with the team
     public enum MEDIA_TYPE {
         ON_TEXTURE              (0),
@@ -104,11 +207,24 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
 
     // Native methods
     public native void initNative(int openGLVersion);
-    public native int initMediaTexture();
+    public native int initMediaTexture(int slot);
     public native void bindMediaTexture(int mediaTextureID);
-    public native int initFBO(int destTextureID, int videoWidth, int videoHeight);
-    public native void copyTexture(int mediaTextureID, int destTextureID, int fbo,
-            float[] textureMat, int videoWidth, int videoHeight);
+    public native int initFBO(int slot, int destTextureID, int videoWidth, int videoHeight,
+            int frameWidth, int frameHeight, boolean packedAlpha);
+    public native void releaseFBO(int slot, int fbo);
+    public native boolean restoreGpuResources(int slot, int[] resources);
+    public native void copyTexture(int mediaTextureID, int fbo,
+            float[] textureMat, int videoWidth, int videoHeight, boolean packedAlpha, float[] cropRect);
+    public native int acquireStatusSlot();
+    public native void releaseStatusSlot(int slot);
+    public native boolean findStoredAsset(String apkPath, String entryName, long[] range);
+    public native void publishNativeStatus(int slot, int state, float position, float duration,
+            int bufferingPercentage, int frameCounter, int videoWidth, int videoHeight, int playlistIndex);
+    public native void recordFrameTiming(int slot, double displayTime, boolean newFrame, double presentationTime);
+    public native void recordPresentedFrame(int slot, double displayTime, double lateness, int framesLatched);
+    public native void recordCopyTime(int slot, double copyTime);
+    public native void markPlaybackStarted(int slot);
+    public native void resetPlaybackStats(int slot);
 
 
     /** Static initializer block to load native libraries on start-up. */
@@ -146,6 +262,14 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         mMediaPlayerLock = new ReentrantLock();
         mSurfaceTextureLock = new ReentrantLock();
         initNative(openGLVersion);
+        startCommandThread();
+
+        if (mStatusSlot < 0)
+        {
+            mStatusSlot = acquireStatusSlot();
+            if (mStatusSlot < 0)
+                DebugLog.LOGW("No free status slot, the status of this video will not be shared");
+        }
         
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.ICE_CREAM_SANDWICH)
         {
@@ -186,6 +310,23 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
                     return false;
                 }
 
+                // Retrieve SurfaceTexture.getTimestamp function (optional, only
+                // used to measure the display cadence)
+                _getTimestampFunc = retrieveClassMethod(surfaceTextureClass, "getTimestamp");
+
+                // Retrieve SurfaceTexture.setOnFrameAvailableListener function
+                // (optional, only used to count the decoded frames)
+                try
+                {
+                    _onFrameAvailableListenerClass = Class.forName(CLASSNAME_ONFRAMEAVAILABLELISTENER);
+                    _setOnFrameAvailableListenerFunc = retrieveClassMethod(surfaceTextureClass,
+                        "setOnFrameAvailableListener", _onFrameAvailableListenerClass);
+                }
+                catch (ClassNotFoundException e)
+                {
+                    DebugLog.LOGW("Couldn't find SurfaceTexture.OnFrameAvailableListener, decoded frames will not be counted");
+                }
+
                 // Retrieve SurfaceTexture.release function
                 _releaseFunc = retrieveClassMethod(surfaceTextureClass, "release");
                 if (_releaseFunc == null)
@@ -209,6 +350,9 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
     {
         unload();
 
+        // Runs the commands still queued, the unload included
+        stopCommandThread();
+
         mSurfaceTextureLock.lock();
         if (mSurfaceTexture != null)
         {
@@ -224,10 +368,18 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         }
         mSurfaceTextureLock.unlock();
 
+        if (mStatusSlot >= 0)
+        {
+            releaseStatusSlot(mStatusSlot);
+            mStatusSlot = -1;
+        }
+
         return true;
     }
 
-    /** Loads a local or remote movie file */
+    /** Loads a local or remote movie file.
+        The texture is set up right away, the media player is created and prepared
+        on the command thread: failures are reported through the ERROR state. */
     public boolean load(String filename, int type, boolean playOnTextureImmediately, float seekPosition)
     {
         // If the client requests that we should be able to play ON_TEXTURE then we need
@@ -238,136 +390,75 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         boolean canBeOnTexture = false;
         boolean canBeFullscreen = false;
 
-        boolean result = false;
-        mMediaPlayerLock.lock();
-        mSurfaceTextureLock.lock();
+        // If the media has already been loaded then exit.
+        // The client must first call unload() before calling load again
+        if (mVideoType != MEDIA_TYPE.UNKNOWN)
+        {
+            DebugLog.LOGD("Already loaded");
+            return false;
+        }
 
-            // If the media has already been loaded then exit.
-            // The client must first call unload() before calling load again
-            if ((mCurrentState == MEDIA_STATE.READY) || (mMediaPlayer != null))
-            {
-                DebugLog.LOGD("Already loaded");
-            }
-            else
-            {
-                if (((requestedType == MEDIA_TYPE.ON_TEXTURE) ||                        // If the client requests on texture only
-                    (requestedType == MEDIA_TYPE.ON_TEXTURE_FULLSCREEN)) &&             // or on texture with full screen
-                    (Build.VERSION.SDK_INT >= Build.VERSION_CODES.ICE_CREAM_SANDWICH))  // and this is an ICS device
-                {
-                    // Create a GL_TEXTURE_EXTERNAL_OES texture for use with the surface texture
-                    mMediaTextureID = initMediaTexture();
-        
-                    if (!setupSurfaceTexture(mMediaTextureID))
-                    {
-                        DebugLog.LOGD("Can't load file to ON_TEXTURE because the Surface Texture is not ready");
-                    }
-                    else
-                    {
-                        // Get the asset file descriptor, if it exists
-                        AssetFileDescriptor afd = null;
-                        try
-                        {
-                            afd = mParentActivity.getAssets().openFd(filename);
-                        }
-                        catch(IOException e)
-                        {
-                            afd = null;
-                        }
+        resetPlaybackStats(mStatusSlot);
+        mFramesAvailable.set(0);
 
-                        try
-                        {
-                            mMediaPlayer = new MediaPlayer();
-            
-                            if (afd != null)
-                            {
-                                mMediaPlayer.setDataSource(afd.getFileDescriptor(),afd.getStartOffset(),afd.getLength());
-                                afd.close();
-                            }
-                            else
-                            {
-                                mMediaPlayer.setDataSource(filename);
-                            }
-
-                            Object argList[] = new Object[1];
-                            argList[0] = mSurfaceTexture;
-                            Surface surface = (Surface) _surfaceConstructor.newInstance(argList);
-
-                            mMediaPlayer.setOnPreparedListener(this);
-                            mMediaPlayer.setOnBufferingUpdateListener(this);
-                            mMediaPlayer.setOnCompletionListener(this);
-                            mMediaPlayer.setOnErrorListener(this);
-                            mMediaPlayer.setAudioStreamType(AudioManager.STREAM_MUSIC);
-                            mMediaPlayer.setSurface(surface);
-                            canBeOnTexture = true;
-                            mShouldPlayImmediately = playOnTextureImmediately;
-                            mMediaPlayer.prepareAsync();
-                        }
-                        catch (Exception e)
-                        {
-                            DebugLog.LOGD("Could not create a Media Player");
-                            mCurrentState = MEDIA_STATE.ERROR; 
-                            mMediaPlayerLock.unlock();
-                            mSurfaceTextureLock.unlock();
-                            return false;
-                        }
-                    }
-                }
+        if (((requestedType == MEDIA_TYPE.ON_TEXTURE) ||                        // If the client requests on texture only
+            (requestedType == MEDIA_TYPE.ON_TEXTURE_FULLSCREEN)) &&             // or on texture with full screen
+            (Build.VERSION.SDK_INT >= Build.VERSION_CODES.ICE_CREAM_SANDWICH))  // and this is an ICS device
+        {
+            // Create a GL_TEXTURE_EXTERNAL_OES texture for use with the surface texture
+            mMediaTextureID = initMediaTexture(mStatusSlot);
 
-                // If the client requests that we should be able to play FULLSCREEN
-                // then we need to create a FullscreenPlaybackActivity
-                if ((requestedType == MEDIA_TYPE.FULLSCREEN) || (requestedType == MEDIA_TYPE.ON_TEXTURE_FULLSCREEN))
-                {
-                    //mPlayerHelperActivityIntent = new Intent(mParentActivity, FullscreenPlayback.class);
-                    //mPlayerHelperActivityIntent.setAction(android.content.Intent.ACTION_VIEW);
-                    canBeFullscreen = true;
-                }
+            mSurfaceTextureLock.lock();
+                canBeOnTexture = setupSurfaceTexture(mMediaTextureID);
+            mSurfaceTextureLock.unlock();
+
+            if (!canBeOnTexture)
+            {
+                DebugLog.LOGD("Can't load file to ON_TEXTURE because the Surface Texture is not ready");
+            }
+        }
 
-                // We store the parameters for further use
-                mMovieName = filename;
-                mSeekPosition = seekPosition;
+        // If the client requests that we should be able to play FULLSCREEN
+        // then we need to create a FullscreenPlaybackActivity
+        if ((requestedType == MEDIA_TYPE.FULLSCREEN) || (requestedType == MEDIA_TYPE.ON_TEXTURE_FULLSCREEN))
+        {
+            //mPlayerHelperActivityIntent = new Intent(mParentActivity, FullscreenPlayback.class);
+            //mPlayerHelperActivityIntent.setAction(android.content.Intent.ACTION_VIEW);
+            canBeFullscreen = true;
+        }
 
-                if (canBeFullscreen && canBeOnTexture)  mVideoType = MEDIA_TYPE.ON_TEXTURE_FULLSCREEN;
-                else if (canBeFullscreen) {             mVideoType = MEDIA_TYPE.FULLSCREEN; mCurrentState = MEDIA_STATE.READY; } // If it is pure fullscreen then we're ready otherwise we let the MediaPlayer load first
-                else if (canBeOnTexture)                mVideoType = MEDIA_TYPE.ON_TEXTURE;
-                else                                    mVideoType = MEDIA_TYPE.UNKNOWN;
+        // We store the parameters for further use
+        mMovieName = filename;
 
-                result = true;
-            }
+        if (canBeFullscreen && canBeOnTexture)  mVideoType = MEDIA_TYPE.ON_TEXTURE_FULLSCREEN;
+        else if (canBeFullscreen) {             mVideoType = MEDIA_TYPE.FULLSCREEN; setState(MEDIA_STATE.READY); } // If it is pure fullscreen then we're ready otherwise we let the MediaPlayer load first
+        else if (canBeOnTexture)                mVideoType = MEDIA_TYPE.ON_TEXTURE;
+        else                                    mVideoType = MEDIA_TYPE.UNKNOWN;
 
-        mSurfaceTextureLock.unlock();
-        mMediaPlayerLock.unlock();
+        if (canBeOnTexture)
+            postCommand(new Command(COMMAND.LOAD, seekPosition, filename, playOnTextureImmediately));
 
-        return result;
+        return true;
     }
 
     /** Unloads the currently loaded movie
         After this is called a new load() has to be invoked */
     public boolean unload()
     {
-        mMediaPlayerLock.lock();
-            if (mMediaPlayer != null) {
-                try 
-                {
-                    mMediaPlayer.stop();
-                } 
-                catch (Exception e) 
-                {
-                    mMediaPlayerLock.unlock();
-                    DebugLog.LOGE("Could not start playback");
-                }
-                        
-                mMediaPlayer.release();
-                mMediaPlayer = null;
-            }
-        mMediaPlayerLock.unlock();
-
         // TODO: unload native textures
 
-        mCurrentState = MEDIA_STATE.NOT_READY;
+        postCommand(new Command(COMMAND.UNLOAD, 0, null, false));
         mVideoType = MEDIA_TYPE.UNKNOWN;
         return true;
     }
 
+    /** Unloads the movie and leaves the ERROR state behind */
+    private void unloadAfterError()
+    {
+        postCommand(new Command(COMMAND.UNLOAD, 0, null, true));
+        mVideoType = MEDIA_TYPE.UNKNOWN;
+    }
+
     /** Indicates whether the movie can be played on a texture */
     public boolean isPlayableOnTexture()
     {
@@ -411,7 +502,7 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         int result=-1;
         mMediaPlayerLock.lock();
             if (mMediaPlayer != null)
-                result = mMediaPlayer.getVideoWidth();
+                result = getTextureWidth(mMediaPlayer.getVideoWidth());
         mMediaPlayerLock.unlock();
 
         return result;
@@ -435,7 +526,7 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         int result=-1;
         mMediaPlayerLock.lock();
             if (mMediaPlayer != null)
-                result = mMediaPlayer.getVideoHeight();
+                result = getTextureHeight(mMediaPlayer.getVideoHeight());
         mMediaPlayerLock.unlock();
 
         return result;
@@ -499,48 +590,7 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
                 return false;
             }
 
-            mMediaPlayerLock.lock();
-                // If the client requests a given position
-                if (seekPosition != CURRENT_POSITION)
-                {
-                    try 
-                    {
-                        mMediaPlayer.seekTo((int)seekPosition*1000);
-                    } 
-                    catch (Exception e) 
-                    {
-                        mMediaPlayerLock.unlock();
-                        DebugLog.LOGE("Could not seek to position");
-                    }
-                }
-                else    // If it had reached the end loop it back
-                    if (mCurrentState == MEDIA_STATE.REACHED_END)
-                    {
-                        try 
-                        {
-                            mMediaPlayer.seekTo(0);
-                        } 
-                        catch (Exception e) 
-                        {
-                            mMediaPlayerLock.unlock();
-                            DebugLog.LOGE("Could not seek to position");
-                        }
-                    }
-
-                // Then simply start playing
-                try 
-                {
-                    mMediaPlayer.start();
-                } 
-                catch (Exception e) 
-                {
-                    mMediaPlayerLock.unlock();
-                    DebugLog.LOGE("Could not start playback");
-                }
-                mCurrentState = MEDIA_STATE.PLAYING;
-
-            mMediaPlayerLock.unlock();
-
+            postCommand(new Command(COMMAND.PLAY, seekPosition, null, false));
             return true;
         }
     }
@@ -560,29 +610,8 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
             return false;
         }
 
-        boolean result = false;
-
-        mMediaPlayerLock.lock();
-            if (mMediaPlayer != null)
-            {
-                if (mMediaPlayer.isPlaying())
-                {
-                    try 
-                    {
-                        mMediaPlayer.pause();
-                    } 
-                    catch (Exception e) 
-                    {
-                        mMediaPlayerLock.unlock();
-                        DebugLog.LOGE("Could not pause playback");
-                    }
-                    mCurrentState = MEDIA_STATE.PAUSED;
-                    result = true;
-                }
-            }
-        mMediaPlayerLock.unlock();
-
-        return result;
+        postCommand(new Command(COMMAND.PAUSE, 0, null, false));
+        return true;
     }
 
     /** Stops the current movie being played */
@@ -600,27 +629,8 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
             return false;
         }
 
-        boolean result = false;
-
-        mMediaPlayerLock.lock();
-            if (mMediaPlayer != null)
-            {
-                mCurrentState = MEDIA_STATE.STOPPED;
-                try 
-                {
-                    mMediaPlayer.stop();
-                } 
-                catch (Exception e) 
-                {
-                    mMediaPlayerLock.unlock();
-                    DebugLog.LOGE("Could not stop playback");
-                }
-                
-                result = true;
-            }
-        mMediaPlayerLock.unlock();
-
-        return result;
+        postCommand(new Command(COMMAND.STOP, 0, null, false));
+        return true;
     }
 
     /** Tells the VideoPlayerHelper to update the data from the video feed */
@@ -637,11 +647,33 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
         mSurfaceTextureLock.lock();
             if (mSurfaceTexture != null)
             {
+                // The GPU objects are rebuilt in place after a context loss,
+                // instead of reloading the movie
+                if (restoreGpuResources(mStatusSlot, mRestoredResources))
+                    onGpuResourcesRestored();
+
                 // Only request an update if currently playing
                 if (mCurrentState == MEDIA_STATE.PLAYING)
                 {
                     try
                     {
+                        // The next playlist item (or crop) may have another size
+                        int textureWidth = getTextureWidth(mStatusWidth);
+                        int textureHeight = getTextureHeight(mStatusHeight);
+                        if (mFBO != 0 && textureWidth > 0 && textureHeight > 0 &&
+                            (textureWidth != mFBOWidth || textureHeight != mFBOHeight ||
+                             mPackedAlpha != mFBOPackedAlpha))
+                        {
+                            releaseFBO(mStatusSlot, mFBO);
+                            mFBOPackedAlpha = mPackedAlpha;
+                            mFBO = initFBO(mStatusSlot, mDestTextureID, textureWidth, textureHeight,
+                                           mStatusWidth, mStatusHeight, mFBOPackedAlpha);
+                            mFBOWidth = textureWidth;
+                            mFBOHeight = textureHeight;
+                        }
+
+                        long latchTime = System.nanoTime();
+                        int framesLatched = mFramesAvailable.get();
                         _updateTexImageFunc.invoke(mSurfaceTexture);
 
                         float[] mtx = new float[16];
@@ -651,8 +683,33 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
                         _getTransformMatrixFunc.invoke(mSurfaceTexture, argList);
 
                         // Copy texture from GL_TEXTURE_EXTERNAL_OES to GL_TEXTURE_2D object
-                        copyTexture(mMediaTextureID, mDestTextureID, mFBO, mtx,
-                                mMediaPlayer.getVideoWidth(), mMediaPlayer.getVideoHeight());
+                        long copyStartTime = System.nanoTime();
+                        copyTexture(mMediaTextureID, mFBO, mtx, mFBOWidth, mFBOHeight,
+                                    mFBOPackedAlpha, getCopyCropRect(mStatusWidth, mStatusHeight));
+                        recordCopyTime(mStatusSlot, (System.nanoTime() - copyStartTime) / 1.0e9);
+                        ++mFrameCounter;
+
+                        // The latched frame is always the newest one, so its
+                        // timing is only measured against the time of this render
+                        boolean newFrame = framesLatched > 0;
+                        if (_getTimestampFunc != null)
+                        {
+                            long timestamp = (Long)_getTimestampFunc.invoke(mSurfaceTexture);
+                            newFrame = timestamp != mLatchedFrameTimestamp;
+                            recordFrameTiming(mStatusSlot, System.nanoTime() / 1.0e9,
+                                              newFrame, timestamp / 1.0e9);
+                            mLatchedFrameTimestamp = timestamp;
+                        }
+
+                        // The frames available before the latched one were
+                        // never displayed (without the listener, neither they
+                        // nor the lateness are known)
+                        if (newFrame)
+                        {
+                            mFramesAvailable.addAndGet(-framesLatched);
+                            double lateness = (framesLatched > 0) ? (latchTime - mFrameAvailableTime) / 1.0e9 : 0.0;
+                            recordPresentedFrame(mStatusSlot, latchTime / 1.0e9, lateness, framesLatched);
+                        }
                     }
                     catch (Exception e)
                     {
@@ -665,6 +722,21 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
             }
         mSurfaceTextureLock.unlock();
 
+        // Keep the shared position and frame counter up to date while playing
+        if (mCurrentState == MEDIA_STATE.PLAYING)
+        {
+            publishStatus();
+
+            // Have the next playlist item prepared before the current one ends
+            if (!mPrerollRequested && mStatusDuration > 0 &&
+                mStatusPosition + PREROLL_LEAD_SECONDS >= mStatusDuration &&
+                getNextPlaylistIndex() >= 0)
+            {
+                mPrerollRequested = true;
+                postCommand(new Command(COMMAND.PREROLL, 0, null, false));
+            }
+        }
+
         return result;
     }
 
@@ -683,24 +755,8 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
             return false;
         }
 
-        boolean result = false;
-        mMediaPlayerLock.lock();
-            if (mMediaPlayer != null)
-            {
-                try 
-                {
-                    mMediaPlayer.seekTo((int)position*1000);
-                } 
-                catch (Exception e) 
-                {
-                    mMediaPlayerLock.unlock();
-                    DebugLog.LOGE("Could not seek to position");
-                }
-                result = true;
-            }
-        mMediaPlayerLock.unlock();
-
-        return result;
+        postCommand(new Command(COMMAND.SEEK, position, null, false));
+        return true;
     }
 
     /** Gets the current seek position */
@@ -742,16 +798,34 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
             return false;
         }
 
-        boolean result = false;
-        mMediaPlayerLock.lock();
-            if (mMediaPlayer != null)
-            {
-                mMediaPlayer.setVolume(value, value);
-                result = true;
-            }
-        mMediaPlayerLock.unlock();
+        postCommand(new Command(COMMAND.SET_VOLUME, value, null, false));
+        return true;
+    }
 
-        return result;
+    /** Plays the movie, or the playlist, again from its start once it ends */
+    public boolean setLooping(boolean looping)
+    {
+        mLooping = looping;
+        postCommand(new Command(COMMAND.UPDATE_LOOP, 0, null, false));
+        return true;
+    }
+
+    /** Recombines frames holding the colour in their left half and the alpha
+        in their right half into a transparent video texture, of the size of a
+        half. Call it before setting the video texture. */
+    public boolean setPackedAlpha(boolean packedAlpha)
+    {
+        mPackedAlpha = packedAlpha;
+        return true;
+    }
+
+    /** Sets the movies played one after the other; items[0] is the loaded movie */
+    public boolean setPlaylist(String[] items)
+    {
+        mPlaylist = (items != null && items.length > 0) ? items.clone() : null;
+        mPrerollRequested = false;
+        postCommand(new Command(COMMAND.UPDATE_LOOP, 0, null, false));
+        return true;
     }
 
     /**
@@ -775,71 +849,835 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
                     mCurrentBufferingPercentage = arg1;
             }
         mMediaPlayerLock.unlock();
+
+        publishStatus();
     }
 
-    /** With this we can set the parent activity */
-    public void setActivity(Activity newActivity)
+    /** Copies only this region of the video, normalised from its top left
+        corner, to a video texture of its size. A crop of the same size in
+        pixels can be moved while playing; otherwise the video texture is
+        resized. */
+    public boolean setCrop(float x, float y, float width, float height)
     {
-        mParentActivity = newActivity;
+        float left = Math.max(x, 0.0f);
+        float top = Math.max(y, 0.0f);
+        float right = Math.min(x + width, 1.0f);
+        float bottom = Math.min(y + height, 1.0f);
+        if (!(right > left && bottom > top))
+            return false;
+
+        if (left <= 0.0f && top <= 0.0f && right >= 1.0f && bottom >= 1.0f)
+            mCrop = null;
+        else
+            mCrop = new float[] { left, top, right - left, bottom - top };
+        return true;
     }
 
-    /** To set a value upon completion */
-    public void onCompletion(MediaPlayer arg0)
+    /** Returns the first pixel of the crop along a side of the given length,
+        snapped as the common VideoCrop.h does */
+    private static int getCropStart(float start, int length)
     {
-        // Signal that the video finished playing
-        mCurrentState = MEDIA_STATE.REACHED_END;
+        return Math.min((int)Math.floor(start * length + 0.5f), length - 1);
     }
 
-    /** Used to set up the surface texture */
-    public boolean setupSurfaceTexture(int nativeTextureID)
+    /** Returns the end pixel of the crop, keeping at least one pixel */
+    private static int getCropEnd(float start, float size, int length)
     {
-        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.ICE_CREAM_SANDWICH)
-        {
-            // We create a surface texture where the video can be played
-            // We have to give it a texture id of an already created (in native) // OpenGL texture
-            //mSurfaceTextureLock.lock();  already called within a lock block
+        return Math.max((int)Math.floor((start + size) * length + 0.5f), getCropStart(start, length) + 1);
+    }
 
-                Object argList[] = new Object[1];
-                argList[0] = new Integer(nativeTextureID);
+    /** Returns the width of the video texture for frames of the given width:
+        half of it for packed alpha, then the width of the crop */
+    private int getTextureWidth(int videoWidth)
+    {
+        int frameWidth = (mPackedAlpha && videoWidth > 0) ? videoWidth / 2 : videoWidth;
+        float[] crop = mCrop;
+        if (crop == null || frameWidth <= 0)
+            return frameWidth;
+        return getCropEnd(crop[0], crop[2], frameWidth) - getCropStart(crop[0], frameWidth);
+    }
 
-                try
-                {
-                    mSurfaceTexture = _surfaceTextureConstructor.newInstance(argList);
-                }
-                catch (Exception e)
+    /** Returns the height of the video texture for frames of the given height */
+    private int getTextureHeight(int videoHeight)
+    {
+        float[] crop = mCrop;
+        if (crop == null || videoHeight <= 0)
+            return videoHeight;
+        return getCropEnd(crop[1], crop[3], videoHeight) - getCropStart(crop[1], videoHeight);
+    }
+
+    /** Returns the crop in the texture coordinates of the copy shader, from the
+        bottom left corner of the frame, or null to copy the whole frame */
+    private float[] getCopyCropRect(int videoWidth, int videoHeight)
+    {
+        int frameWidth = mPackedAlpha ? videoWidth / 2 : videoWidth;
+        float[] crop = mCrop;
+        if (crop == null || frameWidth <= 0 || videoHeight <= 0)
+            return null;
+
+        int left = getCropStart(crop[0], frameWidth);
+        int right = getCropEnd(crop[0], crop[2], frameWidth);
+        int top = getCropStart(crop[1], videoHeight);
+        int bottom = getCropEnd(crop[1], crop[3], videoHeight);
+
+        mCopyCropRect[0] = (float)left / frameWidth;
+        mCopyCropRect[1] = 1.0f - (float)bottom / videoHeight;
+        mCopyCropRect[2] = (float)(right - left) / frameWidth;
+        mCopyCropRect[3] = (float)(bottom - top) / videoHeight;
+        return mCopyCropRect;
+    }
+
+    /** Returns the slot of this video in the native status block, or -1 if it has none */
+    public int getStatusSlot()
+    {
+        return mStatusSlot;
+    }
+
+    /** Changes the media state and shares it with the native status block */
+    private void setState(MEDIA_STATE state)
+    {
+        mCurrentState = state;
+        publishStatus();
+    }
+
+    /** Publishes the current status into the native status block,
+        which Unity reads every frame without calling into Java */
+    private void publishStatus()
+    {
+        if (mStatusSlot < 0)
+            return;
+
+        float position = 0;
+        float duration = 0;
+        int width = 0;
+        int height = 0;
+
+        if ((mCurrentState != MEDIA_STATE.NOT_READY) && (mCurrentState != MEDIA_STATE.ERROR))
+        {
+            // This runs on the render thread too: rather than waiting for a platform
+            // call of the command thread, the values read last are published again
+            if (mMediaPlayerLock.tryLock())
+            {
+                if (mMediaPlayer != null)
                 {
-                    DebugLog.LOGE("Error in setupSurfaceTexture: " + e.getMessage());
-                    return false;
+                    try
+                    {
+                        mStatusPosition = mMediaPlayer.getCurrentPosition()/1000.0f;
+                        mStatusDuration = mMediaPlayer.getDuration()/1000.0f;
+                        mStatusWidth = mMediaPlayer.getVideoWidth();
+                        mStatusHeight = mMediaPlayer.getVideoHeight();
+                    }
+                    catch (Exception e)
+                    {
+                        DebugLog.LOGE("Could not read the status of the media player");
+                    }
                 }
+                mMediaPlayerLock.unlock();
+            }
 
-                mTextureID = nativeTextureID;
+            position = mStatusPosition;
+            duration = mStatusDuration;
+            width = getTextureWidth(mStatusWidth);
+            height = getTextureHeight(mStatusHeight);
+        }
 
-            //mSurfaceTextureLock.unlock();
+        publishNativeStatus(mStatusSlot, mCurrentState.type, position, duration,
+                mCurrentBufferingPercentage, mFrameCounter, width, height, mPlaylistIndex);
+    }
 
-            return true;
-        }
-        else
-            return false;
+    /** Starts the thread running the queued control calls */
+    private void startCommandThread()
+    {
+        if (mCommandThread != null)
+            return;
+
+        mCommandThreadRunning = true;
+        mCommandThread = new Thread(new Runnable()
+        {
+            public void run()
+            {
+                runCommands();
+            }
+        }, "VideoPlayerHelper");
+        mCommandThread.start();
     }
-    
-    /** This is called when the movie is ready for playback */
-    public void onPrepared(MediaPlayer mediaplayer) 
+
+    /** Stops the command thread once it has run the commands already queued */
+    private void stopCommandThread()
     {
-        mCurrentState = MEDIA_STATE.READY;
+        Thread thread = mCommandThread;
+        if (thread == null)
+            return;
 
-        // If requested an immediate play
-        if (mShouldPlayImmediately)
-            play(false, mSeekPosition);
+        mCommandThreadRunning = false;
+        LockSupport.unpark(thread);
+        try
+        {
+            thread.join();
+        }
+        catch (InterruptedException e)
+        {
+            Thread.currentThread().interrupt();
+        }
+        mCommandThread = null;
+    }
 
-        mSeekPosition = 0;
+    /** Queues a control call; this never waits, neither for a lock nor for the media player */
+    private void postCommand(Command command)
+    {
+        mCommands.offer(command);
+
+        Thread thread = mCommandThread;
+        if (thread != null)
+            LockSupport.unpark(thread);
     }
 
-    /** This is called if an error occurs while loading the video */
-    public boolean onError(MediaPlayer mp, int what, int extra)
+    /** Body of the command thread, the only consumer of the command queue */
+    private void runCommands()
     {
-        DebugLog.LOGE("Error while opening the file. Unloading the media player");
-        unload();
-        mCurrentState = MEDIA_STATE.ERROR;
+        while (true)
+        {
+            // Read before draining, so that the commands queued before a stop are run
+            boolean running = mCommandThreadRunning;
+
+            Command command;
+            while ((command = mCommands.poll()) != null)
+                runCommand(command);
+
+            if (!running)
+                return;
+
+            LockSupport.park(this);
+        }
+    }
+
+    /** Runs one control call; its outcome is published through the native status block */
+    private void runCommand(Command command)
+    {
+        switch (command.type)
+        {
+            case LOAD:          runLoad(command.filename, command.flag, command.value); break;
+            case PLAY:          runPlay(command.value); break;
+            case PAUSE:         runPause(); break;
+            case STOP:          runStop(); break;
+            case SEEK:          runSeekTo(command.value); break;
+            case SET_VOLUME:    runSetVolume(command.value); break;
+            case UNLOAD:        runUnload(command.flag); break;
+            case UPDATE_LOOP:   runUpdateLoop(); break;
+            case PREROLL:       runPreroll(); break;
+            case ADVANCE:       runAdvance(); break;
+            case RESTORE_SURFACE: runRestoreSurface(); break;
+        }
+
+        publishStatus();
+    }
+
+    /** Creates a media player reading the given movie, from the APK assets or from its path */
+    private MediaPlayer createMediaPlayer(String filename) throws Exception
+    {
+        // Assets stored uncompressed in the APK are read in place
+        String apkPath = mParentActivity.getPackageCodePath();
+        long[] assetRange = new long[2];
+        boolean storedAsset = findStoredAsset(apkPath, "assets/" + filename, assetRange);
+
+        // Otherwise get the asset file descriptor, if it exists
+        AssetFileDescriptor afd = null;
+        if (!storedAsset)
+        {
+            try
+            {
+                afd = mParentActivity.getAssets().openFd(filename);
+            }
+            catch(IOException e)
+            {
+                afd = null;
+            }
+        }
+
+        MediaPlayer player = new MediaPlayer();
+        try
+        {
+            if (storedAsset)
+            {
+                ParcelFileDescriptor apk = ParcelFileDescriptor.open(new File(apkPath), ParcelFileDescriptor.MODE_READ_ONLY);
+                player.setDataSource(apk.getFileDescriptor(), assetRange[0], assetRange[1]);
+                apk.close();
+            }
+            else if (afd != null)
+            {
+                player.setDataSource(afd.getFileDescriptor(),afd.getStartOffset(),afd.getLength());
+                afd.close();
+            }
+            else
+            {
+                player.setDataSource(filename);
+            }
+
+            player.setOnPreparedListener(this);
+            player.setOnBufferingUpdateListener(this);
+            player.setOnCompletionListener(this);
+            player.setOnErrorListener(this);
+            player.setAudioStreamType(AudioManager.STREAM_MUSIC);
+        }
+        catch (Exception e)
+        {
+            player.release();
+            throw e;
+        }
+
+        return player;
+    }
+
+    /** Creates the media player of the movie and starts preparing it */
+    private void runLoad(String filename, boolean playOnTextureImmediately, float seekPosition)
+    {
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                DebugLog.LOGD("Already loaded");
+            }
+            else
+            {
+                try
+                {
+                    mMediaPlayer = createMediaPlayer(filename);
+
+                    Object argList[] = new Object[1];
+                    argList[0] = mSurfaceTexture;
+                    mSurface = (Surface) _surfaceConstructor.newInstance(argList);
+
+                    mMediaPlayer.setSurface(mSurface);
+                    mShouldPlayImmediately = playOnTextureImmediately;
+                    mSeekPosition = seekPosition;
+                    mPlaylistIndex = 0;
+                    mMediaPlayer.setLooping(loopsSingleItem());
+                    mMediaPlayer.prepareAsync();
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGD("Could not create a Media Player");
+                    mMediaPlayer = null;
+                    setState(MEDIA_STATE.ERROR);
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    private void runPlay(float seekPosition)
+    {
+        // A finished playlist starts over from its first item
+        if (mCurrentState == MEDIA_STATE.REACHED_END && mPlaylistIndex != 0 && mPlaylist != null)
+        {
+            runSwitchToItem(0);
+            return;
+        }
+
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                try
+                {
+                    // If the client requests a given position
+                    if (seekPosition != CURRENT_POSITION)
+                        mMediaPlayer.seekTo((int)seekPosition*1000);
+                    else if (mCurrentState == MEDIA_STATE.REACHED_END)   // If it had reached the end loop it back
+                        mMediaPlayer.seekTo(0);
+
+                    // Then simply start playing
+                    mMediaPlayer.start();
+                    setState(MEDIA_STATE.PLAYING);
+
+                    // The time the video stood still is not a stall
+                    markPlaybackStarted(mStatusSlot);
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not start playback");
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    private void runPause()
+    {
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                try
+                {
+                    if (mMediaPlayer.isPlaying())
+                    {
+                        mMediaPlayer.pause();
+                        setState(MEDIA_STATE.PAUSED);
+                    }
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not pause playback");
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    private void runStop()
+    {
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                setState(MEDIA_STATE.STOPPED);
+                try
+                {
+                    mMediaPlayer.stop();
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not stop playback");
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    private void runSeekTo(float position)
+    {
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                try
+                {
+                    mMediaPlayer.seekTo((int)position*1000);
+                    markPlaybackStarted(mStatusSlot);
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not seek to position");
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    private void runSetVolume(float value)
+    {
+        mVolume = value;
+
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                try
+                {
+                    mMediaPlayer.setVolume(value, value);
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not set the volume");
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    private void runUnload(boolean afterError)
+    {
+        releaseNextPlayer();
+        mAdvancePending = false;
+        mPrerollRequested = false;
+
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                try
+                {
+                    mMediaPlayer.stop();
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not stop playback");
+                }
+
+                mMediaPlayer.release();
+                mMediaPlayer = null;
+            }
+
+            if (mSurface != null)
+            {
+                mSurface.release();
+                mSurface = null;
+            }
+            mPlaylistIndex = 0;
+        mMediaPlayerLock.unlock();
+
+        setState(afterError ? MEDIA_STATE.ERROR : MEDIA_STATE.NOT_READY);
+    }
+
+    /** Returns true if the looping is done by the media player itself, on a single movie */
+    private boolean loopsSingleItem()
+    {
+        String[] playlist = mPlaylist;
+        return mLooping && (playlist == null || playlist.length <= 1);
+    }
+
+    /** Returns the playlist item played after the current one, or -1 if there is none */
+    private int getNextPlaylistIndex()
+    {
+        String[] playlist = mPlaylist;
+        if (playlist == null || playlist.length <= 1)
+            return -1;
+
+        if (mPlaylistIndex + 1 < playlist.length)
+            return mPlaylistIndex + 1;
+
+        return mLooping ? 0 : -1;
+    }
+
+    /** Applies a looping or playlist change; a pre-rolled item may not be the next one anymore */
+    private void runUpdateLoop()
+    {
+        releaseNextPlayer();
+        mAdvancePending = false;
+
+        mMediaPlayerLock.lock();
+            if (mMediaPlayer != null)
+            {
+                try
+                {
+                    mMediaPlayer.setLooping(loopsSingleItem());
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Could not set the looping");
+                }
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    /** Moves the media player to the surface texture rebuilt after a context loss */
+    private void runRestoreSurface()
+    {
+        Object surfaceTexture;
+        mSurfaceTextureLock.lock();
+            surfaceTexture = mSurfaceTexture;
+        mSurfaceTextureLock.unlock();
+
+        mMediaPlayerLock.lock();
+            try
+            {
+                Surface previous = mSurface;
+
+                Object argList[] = new Object[1];
+                argList[0] = surfaceTexture;
+                mSurface = (Surface) _surfaceConstructor.newInstance(argList);
+
+                // A pre-rolled playlist item is given the surface when it is swapped in
+                if (mMediaPlayer != null)
+                    mMediaPlayer.setSurface(mSurface);
+
+                if (previous != null)
+                    previous.release();
+            }
+            catch (Exception e)
+            {
+                DebugLog.LOGE("Could not restore the surface: " + e.getMessage());
+            }
+        mMediaPlayerLock.unlock();
+
+        // The decoder no longer renders to the surface texture of the lost context
+        Object lost = mLostSurfaceTexture;
+        mLostSurfaceTexture = null;
+        if (lost != null)
+        {
+            try
+            {
+                _releaseFunc.invoke(lost);
+            }
+            catch (Exception e)
+            {
+                DebugLog.LOGE("Could not release the lost surface texture: " + e.getMessage());
+            }
+        }
+    }
+
+    /** Starts preparing the next playlist item on a second media player */
+    private void runPreroll()
+    {
+        int index = getNextPlaylistIndex();
+        if (index < 0 || (mNextPlayer != null && mNextIndex == index))
+            return;
+
+        releaseNextPlayer();
+
+        try
+        {
+            MediaPlayer player = createMediaPlayer(mPlaylist[index]);
+            mNextPrepared = false;
+            mNextFailed = false;
+            mNextIndex = index;
+            mNextPlayer = player;
+            player.prepareAsync();
+        }
+        catch (Exception e)
+        {
+            DebugLog.LOGE("Could not pre-roll the next playlist item");
+            releaseNextPlayer();
+        }
+    }
+
+    /** Moves to the next playlist item once the current one has ended */
+    private void runAdvance()
+    {
+        int index = getNextPlaylistIndex();
+        if (index < 0)
+        {
+            setState(MEDIA_STATE.REACHED_END);
+            return;
+        }
+
+        runSwitchToItem(index);
+    }
+
+    /** Swaps the media player of a playlist item in, on the surface of the current one */
+    private void runSwitchToItem(int index)
+    {
+        mAdvancePending = false;
+
+        String[] playlist = mPlaylist;
+        if (playlist == null || index >= playlist.length)
+            return;
+
+        MediaPlayer next = null;
+        if (mNextPlayer != null && mNextIndex == index && !mNextFailed)
+        {
+            if (!mNextPrepared)
+            {
+                // Keep showing the last frame, onPrepared() comes back here
+                mAdvancePending = true;
+                return;
+            }
+
+            next = mNextPlayer;
+            mNextPlayer = null;
+            mNextIndex = -1;
+        }
+        else
+        {
+            // Not pre-rolled: prepare it now, on this thread
+            releaseNextPlayer();
+            try
+            {
+                next = createMediaPlayer(playlist[index]);
+                next.prepare();
+            }
+            catch (Exception e)
+            {
+                DebugLog.LOGE("Could not open the playlist item " + index);
+                if (next != null)
+                    next.release();
+                setState(MEDIA_STATE.ERROR);
+                return;
+            }
+        }
+
+        mMediaPlayerLock.lock();
+            try
+            {
+                // The surface takes the frames of a single player at a time
+                if (mMediaPlayer != null)
+                    mMediaPlayer.release();
+
+                mMediaPlayer = next;
+                mPlaylistIndex = index;
+                mPrerollRequested = false;
+
+                next.setSurface(mSurface);
+                next.setVolume(mVolume, mVolume);
+                next.start();
+                setState(MEDIA_STATE.PLAYING);
+            }
+            catch (Exception e)
+            {
+                DebugLog.LOGE("Could not start the playlist item " + index);
+                setState(MEDIA_STATE.ERROR);
+            }
+        mMediaPlayerLock.unlock();
+    }
+
+    /** Releases the pre-rolled media player, if any */
+    private void releaseNextPlayer()
+    {
+        MediaPlayer player = mNextPlayer;
+        mNextPlayer = null;
+        mNextIndex = -1;
+        mNextPrepared = false;
+        mNextFailed = false;
+
+        if (player != null)
+            player.release();
+    }
+
+    /** With this we can set the parent activity */
+    public void setActivity(Activity newActivity)
+    {
+        mParentActivity = newActivity;
+    }
+
+    /** To set a value upon completion */
+    public void onCompletion(MediaPlayer arg0)
+    {
+        if (arg0 != mMediaPlayer)
+            return;
+
+        // Go on with the next playlist item, or signal that the video finished playing
+        if (getNextPlaylistIndex() >= 0)
+            postCommand(new Command(COMMAND.ADVANCE, 0, null, false));
+        else
+            setState(MEDIA_STATE.REACHED_END);
+    }
+
+    /** Takes the media texture and FBO rebuilt after a context loss
+        (called on the rendering thread, within the surface texture lock) */
+    private void onGpuResourcesRestored()
+    {
+        DebugLog.LOGD("GPU resources restored, resuming at the current position");
+
+        mMediaTextureID = mRestoredResources[0];
+        mFBO = mRestoredResources[1];
+
+        // The surface texture is bound to the lost context: the decoder keeps
+        // rendering to it until the command thread has moved it to the new one
+        Object lost = mSurfaceTexture;
+        if (!setupSurfaceTexture(mMediaTextureID))
+        {
+            mSurfaceTexture = lost;
+            return;
+        }
+        if (mLostSurfaceTexture == null)
+        {
+            mLostSurfaceTexture = lost;
+        }
+        else
+        {
+            // Lost again before the decoder was moved: it never rendered to this one
+            try
+            {
+                _releaseFunc.invoke(lost);
+            }
+            catch (Exception e)
+            {
+                DebugLog.LOGE("Could not release the lost surface texture: " + e.getMessage());
+            }
+        }
+        postCommand(new Command(COMMAND.RESTORE_SURFACE, 0, null, false));
+    }
+
+    /** Used to set up the surface texture */
+    public boolean setupSurfaceTexture(int nativeTextureID)
+    {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.ICE_CREAM_SANDWICH)
+        {
+            // We create a surface texture where the video can be played
+            // We have to give it a texture id of an already created (in native) // OpenGL texture
+            //mSurfaceTextureLock.lock();  already called within a lock block
+
+                Object argList[] = new Object[1];
+                argList[0] = new Integer(nativeTextureID);
+
+                try
+                {
+                    mSurfaceTexture = _surfaceTextureConstructor.newInstance(argList);
+                }
+                catch (Exception e)
+                {
+                    DebugLog.LOGE("Error in setupSurfaceTexture: " + e.getMessage());
+                    return false;
+                }
+
+                listenForAvailableFrames(mSurfaceTexture);
+
+                mTextureID = nativeTextureID;
+
+            //mSurfaceTextureLock.unlock();
+
+            return true;
+        }
+        else
+            return false;
+    }
+    
+    /** Counts the frames the decoder makes available on a surface texture */
+    private void listenForAvailableFrames(Object surfaceTexture)
+    {
+        if (_setOnFrameAvailableListenerFunc == null)
+            return;
+
+        // The listener interface is implemented through a proxy, like the
+        // surface texture is only reached through reflection
+        Object listener = Proxy.newProxyInstance(_onFrameAvailableListenerClass.getClassLoader(),
+            new Class<?>[] { _onFrameAvailableListenerClass },
+            new InvocationHandler()
+            {
+                @Override
+                public Object invoke(Object proxy, Method method, Object[] args)
+                {
+                    String name = method.getName();
+                    if (name.equals("onFrameAvailable"))
+                    {
+                        mFrameAvailableTime = System.nanoTime();
+                        mFramesAvailable.incrementAndGet();
+                        return null;
+                    }
+                    if (name.equals("hashCode"))
+                        return System.identityHashCode(proxy);
+                    if (name.equals("equals"))
+                        return proxy == args[0];
+                    if (name.equals("toString"))
+                        return "OnFrameAvailableListener@" + Integer.toHexString(System.identityHashCode(proxy));
+                    return null;
+                }
+            });
+
+        try
+        {
+            _setOnFrameAvailableListenerFunc.invoke(surfaceTexture, listener);
+        }
+        catch (Exception e)
+        {
+            DebugLog.LOGE("Could not listen for the available frames: " + e.getMessage());
+        }
+    }
+
+    /** This is called when the movie is ready for playback */
+    public void onPrepared(MediaPlayer mediaplayer) 
+    {
+        // The pre-rolled playlist item is swapped in by the command thread
+        if (mediaplayer == mNextPlayer)
+        {
+            mNextPrepared = true;
+            if (mAdvancePending)
+                postCommand(new Command(COMMAND.ADVANCE, 0, null, false));
+            return;
+        }
+
+        setState(MEDIA_STATE.READY);
+
+        // If requested an immediate play
+        if (mShouldPlayImmediately)
+            play(false, mSeekPosition);
+
+        mSeekPosition = 0;
+    }
+
+    /** This is called if an error occurs while loading the video */
+    public boolean onError(MediaPlayer mp, int what, int extra)
+    {
+        // A failed pre-roll is opened again when its turn comes
+        if (mp == mNextPlayer)
+        {
+            DebugLog.LOGE("Error while pre-rolling the next playlist item");
+            mNextFailed = true;
+            if (mAdvancePending)
+                postCommand(new Command(COMMAND.ADVANCE, 0, null, false));
+            return true;
+        }
+
+        DebugLog.LOGE("Error while opening the file. Unloading the media player");
+        unloadAfterError();
         return true;
     }
 
@@ -854,12 +1692,18 @@ public class VideoPlayerHelper implements OnPreparedListener, OnBufferingUpdateL
 
         mDestTextureID = textureID;
 
-        int videoWidth = mMediaPlayer.getVideoWidth();
-        int videoHeight = mMediaPlayer.getVideoHeight();
+        int frameWidth = mMediaPlayer.getVideoWidth();
+        int frameHeight = mMediaPlayer.getVideoHeight();
+        int videoWidth = getTextureWidth(frameWidth);
+        int videoHeight = getTextureHeight(frameHeight);
 
         if (videoWidth > 0 && videoHeight > 0)
         {
-            mFBO = initFBO(mDestTextureID, videoWidth, videoHeight);
+            mFBOPackedAlpha = mPackedAlpha;
+            mFBO = initFBO(mStatusSlot, mDestTextureID, videoWidth, videoHeight,
+                           frameWidth, frameHeight, mFBOPackedAlpha);
+            mFBOWidth = videoWidth;
+            mFBOHeight = videoHeight;
             return true;
         }
 
@@ -0,0 +1,278 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "AVSyncEngine.h"
+#include "TestUtils.h"
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    typedef AVSyncEngine<int> TestEngine;
+
+    const double FRAME_RATE = 30.0;
+    const double FRAME_DURATION = 1.0 / FRAME_RATE;
+
+    // Decodes frame n at n / 30 s, up to a frame count; can be repositioned
+    // like a decoder after a resync
+    class FakeDecoder
+    {
+    public:
+        explicit FakeDecoder(int frameCount) : m_frameCount(frameCount), m_next(0), m_decoded(0) {}
+
+        TestEngine::DecodeFunc Func()
+        {
+            return [this](double& presentationTime, int& frame)
+            {
+                if (m_next >= m_frameCount)
+                {
+                    return false;
+                }
+                frame = m_next;
+                presentationTime = m_next / FRAME_RATE;
+                ++m_next;
+                ++m_decoded;
+                return true;
+            };
+        }
+
+        void Seek(double time) { m_next = (int)(time * FRAME_RATE); }
+        int GetDecoded() const { return m_decoded; }
+        void ResetDecoded() { m_decoded = 0; }
+
+    private:
+        int m_frameCount;
+        int m_next;
+        int m_decoded;
+    };
+
+    struct Released
+    {
+        int count;
+        Released() : count(0) {}
+        TestEngine::ReleaseFunc Func() { return [this](int) { ++count; }; }
+    };
+
+    // Ticks faster than the frame rate display every frame once, on time,
+    // without counting the ticks in between as duplicates
+    void TestOnTime()
+    {
+        ExternalClock clock;
+        Released released;
+        TestEngine engine(clock, released.Func());
+        engine.SetFrameRate(FRAME_RATE);
+        FakeDecoder decoder(90);
+        TestEngine::DecodeFunc decode = decoder.Func();
+
+        int presented = 0;
+        int lastFrame = -1;
+        int outOfOrder = 0;
+        TestEngine::TickResult result = TestEngine::TICK_SAME_FRAME;
+        for (int tick = 0; tick < 2000 && result != TestEngine::TICK_END_OF_STREAM; ++tick)
+        {
+            clock.SetTime(tick / 240.0);
+            int frame = -1;
+            result = engine.Tick(decode, frame);
+            if (result == TestEngine::TICK_NEW_FRAME)
+            {
+                outOfOrder += frame <= lastFrame ? 1 : 0;
+                lastFrame = frame;
+                ++presented;
+            }
+        }
+
+        const SyncStats& stats = engine.GetStats();
+        CHECK(result == TestEngine::TICK_END_OF_STREAM);
+        CHECK(presented == 90);
+        CHECK(outOfOrder == 0);
+        CHECK(stats.presented == 90);
+        CHECK(stats.dropped == 0);
+        CHECK(stats.late == 0);
+        CHECK(stats.duplicated == 0);
+        CHECK(stats.resyncs == 0);
+        CHECK(released.count == 0);
+    }
+
+    void TestNextDueTime()
+    {
+        ExternalClock clock;
+        TestEngine engine(clock, TestEngine::ReleaseFunc());
+        engine.SetFrameRate(FRAME_RATE);
+        FakeDecoder decoder(10);
+
+        double due = 0.0;
+        CHECK(!engine.GetNextDueTime(due));
+
+        int frame = -1;
+        CHECK(engine.Tick(decoder.Func(), frame) == TestEngine::TICK_NEW_FRAME && frame == 0);
+
+        // Frame 1 is queued; due one tolerance (a frame duration) ahead of its time
+        CHECK(engine.GetNextDueTime(due));
+        CHECK_NEAR(due, 1.0 / FRAME_RATE - FRAME_DURATION, 1e-9);
+
+        SyncPolicy policy;
+        policy.tolerance = 0.005;
+        engine.SetPolicy(policy);
+        CHECK(engine.GetNextDueTime(due));
+        CHECK_NEAR(due, 1.0 / FRAME_RATE - 0.005, 1e-9);
+    }
+
+    // After a stall the decoder catches up at most maxDecodesPerTick frames per
+    // tick; the newest due frame is displayed, late, the older ones dropped
+    void TestCatchUpPresentingLateFrames()
+    {
+        ExternalClock clock;
+        Released released;
+        TestEngine engine(clock, released.Func());
+        engine.SetFrameRate(FRAME_RATE);
+        SyncPolicy policy;
+        policy.maxDecodesPerTick = 4;
+        policy.resyncThreshold = 0.0;
+        engine.SetPolicy(policy);
+        FakeDecoder decoder(90);
+        TestEngine::DecodeFunc decode = decoder.Func();
+
+        int frame = -1;
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_NEW_FRAME && frame == 0);
+
+        clock.SetTime(0.5);
+        int cappedTicks = 0;
+        while (frame < 15)
+        {
+            decoder.ResetDecoded();
+            TestEngine::TickResult result = engine.Tick(decode, frame);
+            CHECK(decoder.GetDecoded() <= 4);
+            CHECK(result == TestEngine::TICK_NEW_FRAME);
+            if (++cappedTicks > 10)
+            {
+                break;
+            }
+        }
+
+        // Frames 1..15 are decoded four per tick: 4, 8, 12, then 15 on time
+        const SyncStats& stats = engine.GetStats();
+        CHECK(frame == 15);
+        CHECK(cappedTicks == 4);
+        CHECK(stats.presented == 5);
+        CHECK(stats.late == 3);
+        CHECK(stats.dropped == 11);
+        CHECK(released.count == 11);
+        CHECK(stats.duplicated == 0);
+    }
+
+    // Dropping late frames instead: nothing is displayed until the decoder
+    // reaches the clock, and the frame on screen meanwhile is a duplicate
+    void TestCatchUpDroppingLateFrames()
+    {
+        ExternalClock clock;
+        Released released;
+        TestEngine engine(clock, released.Func());
+        engine.SetFrameRate(FRAME_RATE);
+        SyncPolicy policy;
+        policy.lateFramePolicy = SyncPolicy::DROP_LATE_FRAMES;
+        policy.maxDecodesPerTick = 4;
+        policy.resyncThreshold = 0.0;
+        engine.SetPolicy(policy);
+        FakeDecoder decoder(90);
+        TestEngine::DecodeFunc decode = decoder.Func();
+
+        int frame = -1;
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_NEW_FRAME && frame == 0);
+
+        clock.SetTime(0.5);
+        int ticks = 0;
+        TestEngine::TickResult result = TestEngine::TICK_SAME_FRAME;
+        while (result != TestEngine::TICK_NEW_FRAME && ++ticks < 10)
+        {
+            result = engine.Tick(decode, frame);
+        }
+
+        const SyncStats& stats = engine.GetStats();
+        CHECK(result == TestEngine::TICK_NEW_FRAME);
+        CHECK(frame == 15);
+        CHECK(ticks == 4);
+        CHECK(stats.presented == 2);
+        CHECK(stats.late == 0);
+        CHECK(stats.dropped == 14);
+        CHECK(stats.duplicated == 3);
+        CHECK(released.count == 14);
+    }
+
+    // Too far behind, the engine asks for the decoder to be repositioned
+    void TestResync()
+    {
+        ExternalClock clock;
+        Released released;
+        TestEngine engine(clock, released.Func());
+        engine.SetFrameRate(FRAME_RATE);
+        FakeDecoder decoder(300);
+        TestEngine::DecodeFunc decode = decoder.Func();
+
+        int frame = -1;
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_NEW_FRAME && frame == 0);
+
+        clock.SetTime(5.0);
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_RESYNC_NEEDED);
+        CHECK(engine.GetStats().resyncs == 1);
+
+        engine.Flush();
+        decoder.Seek(clock.Now());
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_NEW_FRAME);
+        CHECK(frame == 150);
+        CHECK(engine.GetStats().late == 0);
+
+        // Queued frames are released by the flush and with the engine
+        int queuedBefore = released.count;
+        engine.Flush();
+        CHECK(released.count > queuedBefore);
+    }
+
+    void TestEndOfStream()
+    {
+        ExternalClock clock;
+        Released released;
+        TestEngine engine(clock, released.Func());
+        engine.SetFrameRate(FRAME_RATE);
+        FakeDecoder decoder(3);
+        TestEngine::DecodeFunc decode = decoder.Func();
+
+        int presented = 0;
+        int frame = -1;
+        TestEngine::TickResult result = TestEngine::TICK_SAME_FRAME;
+        for (int tick = 0; tick < 100 && result != TestEngine::TICK_END_OF_STREAM; ++tick)
+        {
+            clock.SetTime(tick / 60.0);
+            result = engine.Tick(decode, frame);
+            presented += result == TestEngine::TICK_NEW_FRAME ? 1 : 0;
+        }
+        CHECK(result == TestEngine::TICK_END_OF_STREAM);
+        CHECK(presented == 3);
+
+        // Once ended, it stays so
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_END_OF_STREAM);
+
+        // A flush (seek) starts the stream over
+        engine.Flush();
+        decoder.Seek(0.0);
+        clock.SetTime(0.0);
+        CHECK(engine.Tick(decode, frame) == TestEngine::TICK_NEW_FRAME && frame == 0);
+
+        engine.ResetStats();
+        const SyncStats& stats = engine.GetStats();
+        CHECK(stats.presented == 0 && stats.dropped == 0 && stats.late == 0 && stats.duplicated == 0);
+    }
+}
+
+int main()
+{
+    TestOnTime();
+    TestNextDueTime();
+    TestCatchUpPresentingLateFrames();
+    TestCatchUpDroppingLateFrames();
+    TestResync();
+    TestEndOfStream();
+    return VuforiaMediaTest::TestResult("AVSyncEngineTest");
+}
@@ -0,0 +1,357 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "CachingProxy.h"
+#include "HttpClient.h"
+#include "TestUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    typedef std::vector<uint8_t> Bytes;
+
+    Bytes MakeResource(size_t size, uint8_t seed)
+    {
+        Bytes data(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            data[i] = (uint8_t)(i * 31 + i / 7 + seed);
+        }
+        return data;
+    }
+
+    // Remote server on the loopback interface. Sized resources are served by
+    // range; unsized ones come whole, without Content-Length or Content-Range.
+    class TestServer
+    {
+    public:
+        TestServer() : m_listener(SocketUtils::INVALID), m_port(0), m_running(false), m_requests(0) {}
+        ~TestServer() { Stop(); }
+
+        void AddResource(const std::string& path, const Bytes& data, bool sized)
+        {
+            m_resources[path] = Resource(data, sized);
+        }
+
+        bool Start()
+        {
+            m_listener = SocketUtils::ListenLoopback(m_port);
+            if (m_listener == SocketUtils::INVALID)
+            {
+                return false;
+            }
+            m_running = true;
+            m_thread = std::thread(&TestServer::Serve, this);
+            return true;
+        }
+
+        void Stop()
+        {
+            if (m_running)
+            {
+                m_running = false;
+                m_thread.join();
+                SocketUtils::Close(m_listener);
+                m_listener = SocketUtils::INVALID;
+            }
+        }
+
+        std::string GetUrl(const std::string& path) const
+        {
+            return "http://127.0.0.1:" + std::to_string(m_port) + path;
+        }
+
+        int GetRequestCount() const { return m_requests; }
+
+    private:
+        typedef std::pair<Bytes, bool> Resource;
+
+        // One connection at a time is enough for the proxy
+        void Serve()
+        {
+            while (m_running)
+            {
+                if (!SocketUtils::WaitReadable(m_listener, 20))
+                {
+                    continue;
+                }
+                SocketUtils::Socket socket = SocketUtils::Accept(m_listener, 5000);
+                if (socket != SocketUtils::INVALID)
+                {
+                    ++m_requests;
+                    Respond(socket);
+                    SocketUtils::Close(socket);
+                }
+            }
+        }
+
+        void Respond(SocketUtils::Socket socket)
+        {
+            std::string request;
+            char buffer[1024];
+            while (request.find("\r\n\r\n") == std::string::npos)
+            {
+                int count = SocketUtils::Receive(socket, buffer, sizeof(buffer));
+                if (count <= 0)
+                {
+                    return;
+                }
+                request.append(buffer, (size_t)count);
+            }
+
+            char path[256];
+            std::map<std::string, Resource>::const_iterator found = m_resources.end();
+            if (sscanf(request.c_str(), "GET %255s", path) == 1)
+            {
+                found = m_resources.find(path);
+            }
+            if (found == m_resources.end())
+            {
+                SocketUtils::SendAll(socket, std::string("HTTP/1.0 404 Not Found\r\n\r\n"));
+                return;
+            }
+
+            const Bytes& data = found->second.first;
+            if (!found->second.second)
+            {
+                SocketUtils::SendAll(socket, std::string("HTTP/1.0 200 OK\r\nContent-Type: video/mp4\r\n\r\n"));
+                SocketUtils::SendAll(socket, data.data(), data.size());
+                return;
+            }
+
+            // The client always asks for a range
+            unsigned long long first = 0;
+            unsigned long long last = data.size() - 1;
+            size_t range = request.find("Range: bytes=");
+            if (range != std::string::npos)
+            {
+                sscanf(request.c_str() + range, "Range: bytes=%llu-%llu", &first, &last);
+            }
+            last = std::min<unsigned long long>(last, data.size() - 1);
+
+            char headers[256];
+            snprintf(headers, sizeof(headers),
+                     "HTTP/1.0 206 Partial Content\r\n"
+                     "Content-Type: video/mp4\r\n"
+                     "Content-Range: bytes %llu-%llu/%llu\r\n"
+                     "Content-Length: %llu\r\n"
+                     "\r\n",
+                     first, last, (unsigned long long)data.size(), last - first + 1);
+            SocketUtils::SendAll(socket, std::string(headers));
+            SocketUtils::SendAll(socket, &data[(size_t)first], (size_t)(last - first + 1));
+        }
+
+        std::map<std::string, Resource> m_resources;
+        SocketUtils::Socket m_listener;
+        int m_port;
+        std::atomic<bool> m_running;
+        std::atomic<int> m_requests;
+        std::thread m_thread;
+    };
+
+    bool Download(const std::string& url, uint64_t start, int64_t end, Bytes& body, HttpClient* response = nullptr)
+    {
+        HttpClient client;
+        HttpClient& active = (response != nullptr) ? *response : client;
+        if (!active.Get(url, start, end))
+        {
+            return false;
+        }
+        body.clear();
+        uint8_t buffer[16384];
+        int count;
+        while ((count = active.Read(buffer, sizeof(buffer))) > 0)
+        {
+            body.insert(body.end(), buffer, buffer + count);
+        }
+        return count == 0;
+    }
+
+    bool IsRange(const Bytes& body, const Bytes& resource, size_t start, size_t end)
+    {
+        return body.size() == end - start + 1 && memcmp(body.data(), &resource[start], body.size()) == 0;
+    }
+
+    // Sends a request as written and returns the whole response
+    std::string SendRaw(const std::string& localUrl, const std::string& method, const std::string& headers)
+    {
+        int port = 0;
+        sscanf(localUrl.c_str(), "http://127.0.0.1:%d", &port);
+        std::string path = localUrl.substr(localUrl.find('/', strlen("http://")));
+
+        SocketUtils::Socket socket = SocketUtils::Connect("127.0.0.1", port, 5000);
+        if (socket == SocketUtils::INVALID)
+        {
+            return std::string();
+        }
+        SocketUtils::SendAll(socket, method + " " + path + " HTTP/1.1\r\n" + headers + "\r\n");
+        std::string response;
+        char buffer[4096];
+        int count;
+        while ((count = SocketUtils::Receive(socket, buffer, sizeof(buffer))) > 0)
+        {
+            response.append(buffer, (size_t)count);
+        }
+        SocketUtils::Close(socket);
+        return response;
+    }
+
+    bool StartsWith(const std::string& text, const std::string& prefix)
+    {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    const size_t CHUNK_SIZE = RangeCache::CHUNK_SIZE;
+    const size_t RESOURCE_SIZE = 2 * CHUNK_SIZE + 1234;
+
+    void TestRanges(TestServer& server, const Bytes& resource)
+    {
+        CachingProxy& proxy = CachingProxy::Instance();
+        std::string url = server.GetUrl("/videos/a.mp4?token=1");
+        std::string localUrl = proxy.GetLocalUrl(url);
+        CHECK(StartsWith(localUrl, "http://127.0.0.1:"));
+        CHECK(localUrl.size() > 6 && localUrl.compare(localUrl.size() - 6, 6, "/a.mp4") == 0);
+        CHECK(proxy.GetLocalUrl("https://example.com/a.mp4") == "https://example.com/a.mp4");
+        CHECK(proxy.GetLocalUrl("file:///sdcard/a.mp4") == "file:///sdcard/a.mp4");
+
+        // A range across chunks, then the whole resource
+        Bytes body;
+        HttpClient response;
+        CHECK(Download(localUrl, 200000, 400000, body, &response));
+        CHECK(IsRange(body, resource, 200000, 400000));
+        CHECK(response.GetBodyOffset() == 200000);
+        CHECK(response.GetTotalSize() == RESOURCE_SIZE);
+        CHECK(response.GetContentType() == "video/mp4");
+
+        // Ranges past the end are cut
+        CHECK(Download(localUrl, 500000, 600000, body));
+        CHECK(IsRange(body, resource, 500000, RESOURCE_SIZE - 1));
+
+        CHECK(Download(localUrl, 0, -1, body));
+        CHECK(IsRange(body, resource, 0, RESOURCE_SIZE - 1));
+        CHECK(proxy.GetCachedBytes() == RESOURCE_SIZE);
+
+        // Now served from the cache only
+        int requests = server.GetRequestCount();
+        CHECK(Download(localUrl, CHUNK_SIZE - 10, CHUNK_SIZE + 10, body));
+        CHECK(IsRange(body, resource, CHUNK_SIZE - 10, CHUNK_SIZE + 10));
+        CHECK(server.GetRequestCount() == requests);
+
+        std::string suffix = SendRaw(localUrl, "GET", "Range: bytes=-100\r\n");
+        char contentRange[128];
+        snprintf(contentRange, sizeof(contentRange), "Content-Range: bytes %u-%u/%u\r\n",
+                 (unsigned)(RESOURCE_SIZE - 100), (unsigned)(RESOURCE_SIZE - 1), (unsigned)RESOURCE_SIZE);
+        CHECK(StartsWith(suffix, "HTTP/1.1 206 Partial Content\r\n"));
+        CHECK(suffix.find(contentRange) != std::string::npos);
+        CHECK(suffix.size() > 100 &&
+              memcmp(suffix.data() + suffix.size() - 100, &resource[RESOURCE_SIZE - 100], 100) == 0);
+
+        std::string whole = SendRaw(localUrl, "GET", "");
+        CHECK(StartsWith(whole, "HTTP/1.1 200 OK\r\n"));
+        CHECK(whole.find("Content-Length: " + std::to_string(RESOURCE_SIZE) + "\r\n") != std::string::npos);
+
+        std::string head = SendRaw(localUrl, "HEAD", "Range: bytes=10-19\r\n");
+        CHECK(StartsWith(head, "HTTP/1.1 206 Partial Content\r\n"));
+        CHECK(head.size() >= 4 && head.compare(head.size() - 4, 4, "\r\n\r\n") == 0);
+
+        std::string unsatisfiable = SendRaw(localUrl, "GET", "Range: bytes=" + std::to_string(RESOURCE_SIZE) + "-\r\n");
+        CHECK(StartsWith(unsatisfiable, "HTTP/1.1 416 Range Not Satisfiable\r\n"));
+        CHECK(unsatisfiable.find("Content-Range: bytes */" + std::to_string(RESOURCE_SIZE) + "\r\n") != std::string::npos);
+        CHECK(StartsWith(SendRaw(localUrl, "GET", "Range: bytes=20-10\r\n"), "HTTP/1.1 416"));
+
+        std::string unknownPath = localUrl.substr(0, localUrl.find('/', strlen("http://"))) + "/0000/a.mp4";
+        CHECK(StartsWith(SendRaw(unknownPath, "GET", ""), "HTTP/1.1 404"));
+        CHECK(StartsWith(SendRaw(localUrl, "POST", ""), "HTTP/1.1 405"));
+        CHECK(server.GetRequestCount() == requests);
+    }
+
+    // A server that does not tell the size: the decoder is sent to it
+    void TestUnsized(TestServer& server, const Bytes& resource)
+    {
+        CachingProxy& proxy = CachingProxy::Instance();
+        std::string url = server.GetUrl("/live.mp4");
+        std::string localUrl = proxy.GetLocalUrl(url);
+        CHECK(localUrl != url);
+
+        std::string redirect = SendRaw(localUrl, "GET", "Range: bytes=0-\r\n");
+        CHECK(StartsWith(redirect, "HTTP/1.1 307 Temporary Redirect\r\n"));
+        CHECK(redirect.find("Location: " + url + "\r\n") != std::string::npos);
+
+        // The client follows the redirect
+        Bytes body;
+        HttpClient response;
+        CHECK(Download(localUrl, 0, -1, body, &response));
+        CHECK(body == resource);
+        CHECK(response.GetTotalSize() == 0);
+
+        // Later loads skip the proxy
+        CHECK(proxy.GetLocalUrl(url) == url);
+    }
+
+    // The budget holds one resource: caching a second evicts the first
+    void TestEvictionAndReplay(TestServer& server, const Bytes& second, const std::string& cacheDirectory)
+    {
+        CachingProxy& proxy = CachingProxy::Instance();
+        std::string firstUrl = server.GetUrl("/videos/a.mp4?token=1");
+        std::string secondUrl = server.GetUrl("/videos/b.mp4");
+
+        Bytes body;
+        CHECK(Download(proxy.GetLocalUrl(secondUrl), 0, -1, body));
+        CHECK(body == second);
+        CHECK(proxy.GetCachedBytes() == RESOURCE_SIZE);
+
+        // With the server gone, the cached resource still plays, the evicted one does not
+        server.Stop();
+        CHECK(Download(proxy.GetLocalUrl(secondUrl), 0, -1, body));
+        CHECK(body == second);
+        CHECK(Download(proxy.GetLocalUrl(secondUrl), 1000, 2000, body));
+        CHECK(IsRange(body, second, 1000, 2000));
+        CHECK(!Download(proxy.GetLocalUrl(firstUrl), 0, -1, body));
+        CHECK(StartsWith(SendRaw(proxy.GetLocalUrl(firstUrl), "GET", ""), "HTTP/1.1 502"));
+
+        // And after a restart, from the files
+        proxy.Stop();
+        CHECK(proxy.Start(cacheDirectory, RESOURCE_SIZE + CHUNK_SIZE));
+        CHECK(proxy.GetCachedBytes() == RESOURCE_SIZE);
+        CHECK(Download(proxy.GetLocalUrl(secondUrl), 0, -1, body));
+        CHECK(body == second);
+
+        proxy.ClearCache();
+        CHECK(proxy.GetCachedBytes() == 0);
+        CHECK(!Download(proxy.GetLocalUrl(secondUrl), 0, -1, body));
+    }
+}
+
+int main()
+{
+    VuforiaMediaTest::TempDirectory directory;
+    std::string cacheDirectory = directory.GetPath() + "/cache";
+
+    Bytes first = MakeResource(RESOURCE_SIZE, 1);
+    Bytes second = MakeResource(RESOURCE_SIZE, 2);
+    Bytes unsized = MakeResource(100000, 3);
+    TestServer server;
+    server.AddResource("/videos/a.mp4?token=1", first, true);
+    server.AddResource("/videos/b.mp4", second, true);
+    server.AddResource("/live.mp4", unsized, false);
+    CHECK(server.Start());
+    CHECK(CachingProxy::Instance().Start(cacheDirectory, RESOURCE_SIZE + CHUNK_SIZE));
+
+    TestRanges(server, first);
+    TestUnsized(server, unsized);
+    TestEvictionAndReplay(server, second, cacheDirectory);
+
+    CachingProxy::Instance().Stop();
+    return VuforiaMediaTest::TestResult("CachingProxyTest");
+}
@@ -0,0 +1,462 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "CopyShaders.h"
+#include "HeadlessContext.h"
+#include "TestUtils.h"
+
+#include <GLES2/gl2.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    GLuint CompileShader(GLenum type, const char* const* parts, int partCount, int index)
+    {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, partCount, parts, NULL);
+        glCompileShader(shader);
+
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (!compiled)
+        {
+            char log[1024] = "";
+            glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+            printf("variant %d: %s shader failed to compile:\n%s\n", index,
+                type == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    // Synthetic frame the copy programs draw from: RGBA texels, and the same
+    // kind of frame as video range YUV planes, the chroma at half resolution
+    const int FRAME_WIDTH = 16;
+    const int FRAME_HEIGHT = 8;
+
+    class SyntheticFrame
+    {
+    public:
+        SyntheticFrame() :
+            m_rgba(FRAME_WIDTH * FRAME_HEIGHT * 4),
+            m_y(FRAME_WIDTH * FRAME_HEIGHT),
+            m_uv((FRAME_WIDTH / 2) * (FRAME_HEIGHT / 2) * 2)
+        {
+            for (int y = 0; y < FRAME_HEIGHT; ++y)
+            {
+                for (int x = 0; x < FRAME_WIDTH; ++x)
+                {
+                    unsigned char* texel = &m_rgba[(y * FRAME_WIDTH + x) * 4];
+                    texel[0] = (unsigned char)(x * 16 + 3);
+                    texel[1] = (unsigned char)(y * 30 + 7);
+                    texel[2] = (unsigned char)((x * y * 5 + 11) & 0xff);
+                    texel[3] = (unsigned char)(255 - x * 8 - y);
+                    m_y[y * FRAME_WIDTH + x] = (unsigned char)(16 + (x * 13 + y * 17) % 220);
+                }
+            }
+            for (int y = 0; y < FRAME_HEIGHT / 2; ++y)
+            {
+                for (int x = 0; x < FRAME_WIDTH / 2; ++x)
+                {
+                    m_uv[(y * (FRAME_WIDTH / 2) + x) * 2] = (unsigned char)(40 + x * 20);
+                    m_uv[(y * (FRAME_WIDTH / 2) + x) * 2 + 1] = (unsigned char)(60 + y * 40);
+                }
+            }
+
+            m_rgbaTexture = CreateTexture(GL_RGBA, FRAME_WIDTH, FRAME_HEIGHT, &m_rgba[0]);
+            m_yTexture = CreateTexture(GL_LUMINANCE, FRAME_WIDTH, FRAME_HEIGHT, &m_y[0]);
+            m_uvTexture = CreateTexture(GL_LUMINANCE_ALPHA, FRAME_WIDTH / 2, FRAME_HEIGHT / 2, &m_uv[0]);
+        }
+
+        ~SyntheticFrame()
+        {
+            GLuint textures[3] = { m_rgbaTexture, m_yTexture, m_uvTexture };
+            glDeleteTextures(3, textures);
+        }
+
+        // Binds the textures the program samples, as the players do
+        void Bind(const CopyShaderSource& source, GLuint program) const
+        {
+            if (source.sampler == COPY_SAMPLER_YUV_PLANES)
+            {
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, m_yTexture);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, m_uvTexture);
+                glUniform1i(glGetUniformLocation(program, "texSamplerY"), 0);
+                glUniform1i(glGetUniformLocation(program, "texSamplerUV"), 1);
+            }
+            else
+            {
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, m_rgbaTexture);
+                glUniform1i(glGetUniformLocation(program, "texSampler2D"), 0);
+            }
+        }
+
+        // Texel a nearest filtered fetch at (u, v) returns, as texture2D does
+        void Fetch(const CopyShaderSource& source, double u, double v, double color[4]) const
+        {
+            if (source.sampler != COPY_SAMPLER_YUV_PLANES)
+            {
+                const unsigned char* texel = &m_rgba[(Texel(v, FRAME_HEIGHT) * FRAME_WIDTH + Texel(u, FRAME_WIDTH)) * 4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    color[i] = texel[i] / 255.0;
+                }
+                return;
+            }
+
+            // Column-major matrices of the shaders, from video range
+            const double* coefficients = source.color == COPY_COLOR_BT601 ?
+                BT601 : BT709;
+            const int chromaIndex = Texel(v, FRAME_HEIGHT / 2) * (FRAME_WIDTH / 2) + Texel(u, FRAME_WIDTH / 2);
+            const double yuv[3] =
+            {
+                FetchLuma(u, v) - 0.0625,
+                m_uv[chromaIndex * 2] / 255.0 - 0.5,
+                m_uv[chromaIndex * 2 + 1] / 255.0 - 0.5
+            };
+            for (int i = 0; i < 3; ++i)
+            {
+                color[i] = coefficients[i] * yuv[0] + coefficients[3 + i] * yuv[1] + coefficients[6 + i] * yuv[2];
+            }
+            color[3] = 1.0;
+        }
+
+        double FetchLuma(double u, double v) const
+        {
+            return m_y[Texel(v, FRAME_HEIGHT) * FRAME_WIDTH + Texel(u, FRAME_WIDTH)] / 255.0;
+        }
+
+    private:
+        SyntheticFrame(const SyntheticFrame&);
+        SyntheticFrame& operator=(const SyntheticFrame&);
+
+        static const double BT601[9];
+        static const double BT709[9];
+
+        static GLuint CreateTexture(GLenum format, int width, int height, const unsigned char* data)
+        {
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            return texture;
+        }
+
+        static int Texel(double coordinate, int size)
+        {
+            int texel = (int)floor(coordinate * size);
+            return texel < 0 ? 0 : texel >= size ? size - 1 : texel;
+        }
+
+        std::vector<unsigned char> m_rgba;
+        std::vector<unsigned char> m_y;
+        std::vector<unsigned char> m_uv;
+        GLuint m_rgbaTexture;
+        GLuint m_yTexture;
+        GLuint m_uvTexture;
+    };
+
+    const double SyntheticFrame::BT601[9] = { 1.164, 1.164, 1.164, 0.0, -0.392, 2.017, 1.596, -0.813, 0.0 };
+    const double SyntheticFrame::BT709[9] = { 1.164, 1.164, 1.164, 0.0, -0.213, 2.112, 1.793, -0.533, 0.0 };
+
+    // Texture matrix the draws use: a vertical flip, as SurfaceTexture gives
+    const GLfloat TEXTURE_MATRIX[16] = { 1, 0, 0, 0, 0, -1, 0, 0, 0, 0, 1, 0, 0, 1, 0, 1 };
+    const GLfloat IDENTITY_MATRIX[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    // Crop the draws use (x, y, width, height in texture coordinates): the
+    // middle of the frame, on whole texels, so that each pixel of the output
+    // falls on the centre of a texel
+    const GLfloat CROP_RECT[4] = { 0.25f, 0.25f, 0.5f, 0.5f };
+
+    double Clamp01(double value)
+    {
+        return value < 0.0 ? 0.0 : value > 1.0 ? 1.0 : value;
+    }
+
+    // What the variant writes for the quad texture coordinates (u, v): the
+    // same steps as its shaders, on the CPU
+    void ReferenceColor(const CopyShaderSource& source, const SyntheticFrame& frame, double u, double v,
+        double color[4])
+    {
+        if (source.geometry & COPY_GEOMETRY_FLIP_X)
+        {
+            u = 1.0 - u;
+        }
+        if (source.geometry & COPY_GEOMETRY_FLIP_Y)
+        {
+            v = 1.0 - v;
+        }
+        if (source.geometry & COPY_GEOMETRY_CROP)
+        {
+            u = CROP_RECT[0] + u * CROP_RECT[2];
+            v = CROP_RECT[1] + v * CROP_RECT[3];
+        }
+
+        const bool packed = source.output == COPY_OUTPUT_PACKED_ALPHA;
+        double alphaU = u * 0.5 + 0.5;
+        if (packed)
+        {
+            u *= 0.5;
+        }
+        if (source.geometry & COPY_GEOMETRY_TEXTURE_MATRIX)
+        {
+            v = 1.0 - v;
+        }
+
+        frame.Fetch(source, u, v, color);
+        switch (source.output)
+        {
+        case COPY_OUTPUT_PACKED_ALPHA:
+            if (source.sampler == COPY_SAMPLER_YUV_PLANES)
+            {
+                color[3] = Clamp01((frame.FetchLuma(alphaU, v) - 0.0625) * 1.164);
+            }
+            else
+            {
+                double alphaColor[4];
+                frame.Fetch(source, alphaU, v, alphaColor);
+                color[3] = alphaColor[1];
+            }
+            break;
+        case COPY_OUTPUT_OPAQUE:
+            color[3] = 1.0;
+            break;
+        case COPY_OUTPUT_BGRA:
+        {
+            double red = color[0];
+            color[0] = color[2];
+            color[2] = red;
+        }
+        break;
+        default:
+            break;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            color[i] = Clamp01(color[i]);
+        }
+    }
+
+    // Draws the frame with the variant into a texture of the size of its
+    // output (the crop, or the half of a packed frame), as the players do,
+    // reads it back and compares each pixel to the reference within 1/255
+    bool DrawMatchesReference(const CopyShaderSource& source, GLuint program, const SyntheticFrame& frame)
+    {
+        const bool cropped = (source.geometry & COPY_GEOMETRY_CROP) != 0;
+        const int width = (int)(FRAME_WIDTH * (cropped ? CROP_RECT[2] : 1.0f)) /
+            (source.output == COPY_OUTPUT_PACKED_ALPHA ? 2 : 1);
+        const int height = (int)(FRAME_HEIGHT * (cropped ? CROP_RECT[3] : 1.0f));
+
+        GLuint target = 0;
+        glGenTextures(1, &target);
+        glBindTexture(GL_TEXTURE_2D, target);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        GLuint frameBuffer = 0;
+        glGenFramebuffers(1, &frameBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+        const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+        std::vector<unsigned char> pixels(width * height * 4);
+        if (complete)
+        {
+            const GLfloat positions[] = { -1, -1, 0, 1, -1, 0, 1, 1, 0, -1, 1, 0 };
+            const GLfloat texCoords[] = { 0, 0, 1, 0, 1, 1, 0, 1 };
+
+            glViewport(0, 0, width, height);
+            glClearColor(0, 0, 0, 0);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glUseProgram(program);
+            frame.Bind(source, program);
+
+            GLint positionHandle = glGetAttribLocation(program, "vertexPosition");
+            GLint texCoordHandle = glGetAttribLocation(program, "vertexTexCoord");
+            glVertexAttribPointer(positionHandle, 3, GL_FLOAT, GL_FALSE, 0, positions);
+            glVertexAttribPointer(texCoordHandle, 2, GL_FLOAT, GL_FALSE, 0, texCoords);
+            glEnableVertexAttribArray(positionHandle);
+            glEnableVertexAttribArray(texCoordHandle);
+            glUniformMatrix4fv(glGetUniformLocation(program, "modelViewProjectionMatrix"), 1, GL_FALSE,
+                IDENTITY_MATRIX);
+            if (source.geometry & COPY_GEOMETRY_TEXTURE_MATRIX)
+            {
+                glUniformMatrix4fv(glGetUniformLocation(program, "textureMatrix"), 1, GL_FALSE, TEXTURE_MATRIX);
+            }
+            if (cropped)
+            {
+                glUniform4fv(glGetUniformLocation(program, "cropRect"), 1, CROP_RECT);
+            }
+
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+            glDisableVertexAttribArray(positionHandle);
+            glDisableVertexAttribArray(texCoordHandle);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+            glUseProgram(0);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &frameBuffer);
+        glDeleteTextures(1, &target);
+        if (!complete)
+        {
+            printf("variant %d: incomplete frame buffer\n", source.index);
+            return false;
+        }
+
+        int mismatches = 0;
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                double expected[4];
+                ReferenceColor(source, frame, (x + 0.5) / width, (y + 0.5) / height, expected);
+                const unsigned char* pixel = &pixels[(y * width + x) * 4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    if (fabs(pixel[i] - expected[i] * 255.0) > 1.0 && mismatches++ == 0)
+                    {
+                        printf("variant %d: pixel (%d, %d) component %d is %d, expected %.1f\n", source.index,
+                            x, y, i, pixel[i], expected[i] * 255.0);
+                    }
+                }
+            }
+        }
+        return mismatches == 0;
+    }
+
+    // The parameters of each variant are the ones its index is looked up by
+    void TestVariantTable()
+    {
+        int mismatches = 0;
+        for (int index = 0; index < COPY_SHADER_VARIANT_COUNT; ++index)
+        {
+            const CopyShaderSource& source = CopyShaderTable::VARIANTS[index];
+            if (source.index != index ||
+                GetCopyShaderIndex(source.sampler, source.geometry, source.color, source.output) != index ||
+                FindCopyShader(source.sampler, source.geometry, source.color, source.output) != &source)
+            {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+
+        CHECK(FindCopyShader(COPY_SAMPLER_2D, COPY_GEOMETRY_NONE, COPY_COLOR_BT601, COPY_OUTPUT_RGBA) == NULL);
+        CHECK(FindCopyShader(COPY_SAMPLER_YUV_PLANES, COPY_GEOMETRY_NONE, COPY_COLOR_NONE, COPY_OUTPUT_RGBA) == NULL);
+        CHECK(FindCopyShader(COPY_SAMPLER_2D, COPY_GEOMETRY_COUNT, COPY_COLOR_NONE, COPY_OUTPUT_RGBA) == NULL);
+        CHECK((CopyShaderVariant<COPY_SAMPLER_2D, COPY_GEOMETRY_FLIP_Y, COPY_COLOR_NONE, COPY_OUTPUT_RGBA>::Get().geometry ==
+            COPY_GEOMETRY_FLIP_Y));
+    }
+
+    // Every variant compiles and links, with the uniforms its options need, and
+    // the ones reading from textures the test can fill copy the synthetic frame
+    // as expected (external images need an EGLImage producer, which is not
+    // available without a device)
+    void TestVariantsCompile(bool hasExternalImage)
+    {
+        SyntheticFrame frame;
+        int compiled = 0;
+        int drawn = 0;
+        int skipped = 0;
+        for (int index = 0; index < COPY_SHADER_VARIANT_COUNT; ++index)
+        {
+            const CopyShaderSource& source = CopyShaderTable::VARIANTS[index];
+            if (source.sampler == COPY_SAMPLER_EXTERNAL_OES && !hasExternalImage)
+            {
+                ++skipped;
+                continue;
+            }
+
+            GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, source.vertex,
+                CopyShaderSource::VERTEX_PART_COUNT, index);
+            GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, source.fragment,
+                CopyShaderSource::FRAGMENT_PART_COUNT, index);
+            CHECK(vertexShader != 0);
+            CHECK(fragmentShader != 0);
+            if (vertexShader == 0 || fragmentShader == 0)
+            {
+                glDeleteShader(vertexShader);
+                glDeleteShader(fragmentShader);
+                continue;
+            }
+
+            GLuint program = glCreateProgram();
+            glAttachShader(program, vertexShader);
+            glAttachShader(program, fragmentShader);
+            glLinkProgram(program);
+
+            GLint linked = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            if (!linked)
+            {
+                char log[1024] = "";
+                glGetProgramInfoLog(program, sizeof(log), NULL, log);
+                printf("variant %d: program failed to link:\n%s\n", index, log);
+            }
+            CHECK(linked);
+
+            if (linked)
+            {
+                ++compiled;
+                const bool hasMatrix = (source.geometry & COPY_GEOMETRY_TEXTURE_MATRIX) != 0;
+                const bool hasCrop = (source.geometry & COPY_GEOMETRY_CROP) != 0;
+                const bool hasPlanes = source.sampler == COPY_SAMPLER_YUV_PLANES;
+                CHECK(glGetAttribLocation(program, "vertexPosition") >= 0);
+                CHECK(glGetAttribLocation(program, "vertexTexCoord") >= 0);
+                CHECK(glGetUniformLocation(program, "modelViewProjectionMatrix") >= 0);
+                CHECK((glGetUniformLocation(program, "textureMatrix") >= 0) == hasMatrix);
+                CHECK((glGetUniformLocation(program, "cropRect") >= 0) == hasCrop);
+                CHECK((glGetUniformLocation(program, "texSampler2D") >= 0) == !hasPlanes);
+                CHECK((glGetUniformLocation(program, "texSamplerY") >= 0) == hasPlanes);
+                CHECK((glGetUniformLocation(program, "texSamplerUV") >= 0) == hasPlanes);
+
+                if (source.sampler != COPY_SAMPLER_EXTERNAL_OES)
+                {
+                    ++drawn;
+                    CHECK(DrawMatchesReference(source, program, frame));
+                }
+            }
+
+            glDeleteProgram(program);
+            glDeleteShader(vertexShader);
+            glDeleteShader(fragmentShader);
+        }
+
+        printf("%d variants compiled and linked, %d drawn, %d skipped\n", compiled, drawn, skipped);
+        CHECK(compiled + skipped == COPY_SHADER_VARIANT_COUNT);
+    }
+}
+
+int main()
+{
+    TestVariantTable();
+
+    VuforiaMediaTest::HeadlessContext context;
+    if (!context.Create())
+    {
+        printf("CopyShadersTest: no GLES 2 context, skipped\n");
+        return VuforiaMediaTest::SKIP_TEST;
+    }
+    printf("Compiling with %s\n", (const char*)glGetString(GL_RENDERER));
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    const bool hasExternalImage = extensions != NULL && strstr(extensions, "GL_OES_EGL_image_external") != NULL;
+    TestVariantsCompile(hasExternalImage);
+
+    return VuforiaMediaTest::TestResult("CopyShadersTest");
+}
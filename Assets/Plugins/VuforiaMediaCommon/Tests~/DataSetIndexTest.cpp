@@ -0,0 +1,262 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "DataSetIndex.h"
+#include "FileUtils.h"
+#include "TestUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // The databases of the sample, see CMakeLists.txt
+    const std::string DATABASE_DIR = QCAR_DATABASE_DIR;
+
+    struct Database
+    {
+        const char* name;
+        size_t targetCount;
+    };
+
+    const Database DATABASES[] =
+    {
+        { "FlakesBox", 7 },
+        { "StonesAndChips", 2 },
+        { "StonesAndWood", 2 },
+        { "Tarmac", 1 },
+        { "sodacan", 1 },
+        { "target_images", 3 }
+    };
+
+    bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& data)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        data.clear();
+        uint8_t buffer[65536];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + read);
+        }
+        fclose(file);
+        return true;
+    }
+
+    bool WriteWholeFile(const std::string& path, const std::vector<uint8_t>& data)
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = data.empty() || fwrite(data.data(), 1, data.size(), file) == data.size();
+        return fclose(file) == 0 && written;
+    }
+
+    std::shared_ptr<DataSetIndex> LoadDatabase(const std::string& directory, const std::string& name,
+                                               const std::string& cacheDirectory)
+    {
+        return DataSetIndex::LoadOrBuild(directory + "/" + name + ".xml", directory + "/" + name + ".dat",
+                                         cacheDirectory);
+    }
+
+    // Data ranges as laid out in the .dat archives: from the first local header
+    // of the target's entries, header and compressed bytes, and uncompressed bytes
+    void CheckTarget(const DataSetIndex& index, const char* name, int type, float width, float height,
+                     uint32_t dataOffset, uint32_t dataSize, uint32_t memorySize)
+    {
+        DataSetTarget target;
+        CHECK(index.FindTarget(name, target));
+        if (!index.FindTarget(name, target))
+        {
+            return;
+        }
+        CHECK(strcmp(target.name, name) == 0);
+        CHECK(target.type == type);
+        CHECK_NEAR(target.size[0], width, 1e-6);
+        CHECK_NEAR(target.size[1], height, 1e-6);
+        CHECK(target.dataOffset == dataOffset);
+        CHECK(target.dataSize == dataSize);
+        CHECK(target.memorySize == memorySize);
+    }
+
+    void CheckSampleTargets(const std::string& directory, const std::string& cacheDirectory)
+    {
+        for (size_t i = 0; i < sizeof(DATABASES) / sizeof(DATABASES[0]); ++i)
+        {
+            std::shared_ptr<DataSetIndex> index = LoadDatabase(directory, DATABASES[i].name, cacheDirectory);
+            CHECK(index);
+            if (!index)
+            {
+                continue;
+            }
+            CHECK(index->GetTargetCount() == DATABASES[i].targetCount);
+
+            // Sorted by name, and all found
+            DataSetTarget previous = { "", 0, { 0.0f, 0.0f, 0.0f }, 0, 0, 0 };
+            for (size_t t = 0; t < index->GetTargetCount(); ++t)
+            {
+                DataSetTarget target;
+                DataSetTarget found;
+                CHECK(index->GetTarget(t, target));
+                CHECK(strcmp(previous.name, target.name) < 0);
+                CHECK(index->FindTarget(target.name, found) && found.name == target.name);
+                previous = target;
+            }
+            DataSetTarget target;
+            CHECK(!index->GetTarget(index->GetTargetCount(), target));
+        }
+
+        std::shared_ptr<DataSetIndex> stonesAndChips = LoadDatabase(directory, "StonesAndChips", cacheDirectory);
+        std::shared_ptr<DataSetIndex> stonesAndWood = LoadDatabase(directory, "StonesAndWood", cacheDirectory);
+        std::shared_ptr<DataSetIndex> sodacan = LoadDatabase(directory, "sodacan", cacheDirectory);
+        std::shared_ptr<DataSetIndex> flakesBox = LoadDatabase(directory, "FlakesBox", cacheDirectory);
+        std::shared_ptr<DataSetIndex> targetImages = LoadDatabase(directory, "target_images", cacheDirectory);
+        if (!stonesAndChips || !stonesAndWood || !sodacan || !flakesBox || !targetImages)
+        {
+            return;
+        }
+
+        CheckTarget(*stonesAndChips, "stones", DATA_SET_IMAGE_TARGET, 0.247f, 0.1729f, 349252, 59475, 61061);
+        CheckTarget(*targetImages, "image_1", DATA_SET_IMAGE_TARGET, 50.0f, 37.599468f, 172725, 31488, 32171);
+
+        // Virtual buttons are not targets
+        CheckTarget(*stonesAndWood, "wood", DATA_SET_IMAGE_TARGET, 0.247f, 0.173f, 59485, 53045, 54278);
+        DataSetTarget target;
+        CHECK(!stonesAndWood->FindTarget("blue", target));
+
+        // Entries "CylinderApp.Body.*" belong to the cylinder
+        CheckTarget(*sodacan, "CylinderApp", DATA_SET_CYLINDER_TARGET, 0.095f, 0.0f, 179408, 115381, 158948);
+
+        // Dotted names take their own entries; the multi target those of its parts
+        CheckTarget(*flakesBox, "FlakesBox.Front", DATA_SET_IMAGE_TARGET, 0.09f, 0.12f, 0, 45706, 46714);
+        CheckTarget(*flakesBox, "FlakesBox", DATA_SET_MULTI_TARGET, 0.0f, 0.0f, 0, 223536, 228410);
+
+        CHECK(!flakesBox->FindTarget("FlakesBox.Fr", target));
+        CHECK(!flakesBox->FindTarget("FlakesBox.Front.tex", target));
+        CHECK(!flakesBox->FindTarget("", target));
+        CHECK(!stonesAndChips->FindTarget("Stones", target));
+    }
+
+    void TestSampleDatabases()
+    {
+        VuforiaMediaTest::TempDirectory cache;
+
+        // Built, then loaded from the sidecars
+        CheckSampleTargets(DATABASE_DIR, cache.GetPath());
+        std::vector<std::string> sidecars;
+        FileUtils::ListFiles(cache.GetPath(), ".targets", sidecars);
+        CHECK(sidecars.size() == sizeof(DATABASES) / sizeof(DATABASES[0]));
+        CheckSampleTargets(DATABASE_DIR, cache.GetPath());
+
+        CHECK(!LoadDatabase(DATABASE_DIR, "Missing", cache.GetPath()));
+    }
+
+    void TestSidecarRebuild()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::string cacheDirectory = directory.GetPath() + "/cache";
+        std::string xmlPath = directory.GetPath() + "/StonesAndChips.xml";
+        std::string datPath = directory.GetPath() + "/StonesAndChips.dat";
+
+        std::vector<uint8_t> xml;
+        std::vector<uint8_t> dat;
+        CHECK(ReadWholeFile(DATABASE_DIR + "/StonesAndChips.xml", xml));
+        CHECK(ReadWholeFile(DATABASE_DIR + "/StonesAndChips.dat", dat));
+        CHECK(WriteWholeFile(xmlPath, xml));
+        CHECK(WriteWholeFile(datPath, dat));
+
+        std::shared_ptr<DataSetIndex> built = DataSetIndex::LoadOrBuild(xmlPath, datPath, cacheDirectory);
+        CHECK(built && built->GetTargetCount() == 2);
+
+        // With the archive unreadable but the same size, only the sidecar can answer
+        std::vector<uint8_t> damagedDat(dat.size(), 0);
+        CHECK(WriteWholeFile(datPath, damagedDat));
+        std::shared_ptr<DataSetIndex> loaded = DataSetIndex::LoadOrBuild(xmlPath, datPath, cacheDirectory);
+        CHECK(loaded && loaded->GetTargetCount() == 2);
+        DataSetTarget target;
+        CHECK(loaded && loaded->FindTarget("chips", target) && target.dataOffset == 289898);
+
+        // A new descriptor invalidates the sidecar
+        std::string text(xml.begin(), xml.end());
+        size_t tracking = text.find("</Tracking>");
+        CHECK(tracking != std::string::npos);
+        text.insert(tracking, "<ImageTarget name=\"added\" size=\"1 2\"/>\n");
+        std::vector<uint8_t> newXml(text.begin(), text.end());
+        CHECK(WriteWholeFile(xmlPath, newXml));
+        CHECK(!DataSetIndex::LoadOrBuild(xmlPath, datPath, cacheDirectory));
+
+        CHECK(WriteWholeFile(datPath, dat));
+        std::shared_ptr<DataSetIndex> rebuilt = DataSetIndex::LoadOrBuild(xmlPath, datPath, cacheDirectory);
+        CHECK(rebuilt && rebuilt->GetTargetCount() == 3);
+        CHECK(rebuilt && rebuilt->FindTarget("added", target) && target.dataSize == 0);
+
+        // So does a new archive of another size
+        CHECK(WriteWholeFile(xmlPath, xml));
+        CHECK(LoadDatabase(directory.GetPath(), "StonesAndChips", cacheDirectory));
+        dat.resize(dat.size() + 1, 0);
+        damagedDat.resize(dat.size(), 0);
+        CHECK(WriteWholeFile(datPath, damagedDat));
+        CHECK(!DataSetIndex::LoadOrBuild(xmlPath, datPath, cacheDirectory));
+    }
+
+    void TestSaveAndLoad()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::string path = directory.GetPath() + "/index.targets";
+
+        std::vector<uint8_t> xml;
+        CHECK(ReadWholeFile(DATABASE_DIR + "/FlakesBox.xml", xml));
+        ZipArchive dat;
+        CHECK(dat.Open(DATABASE_DIR + "/FlakesBox.dat"));
+
+        DataSetIndex index;
+        CHECK(index.Build(xml.data(), xml.size(), dat));
+        CHECK(index.Save(path, 42));
+
+        DataSetIndex loaded;
+        CHECK(loaded.Load(path, 42));
+        CHECK(loaded.GetTargetCount() == 7);
+        DataSetTarget target;
+        CHECK(loaded.FindTarget("FlakesBox.Back", target) && target.dataOffset == 175123);
+        CHECK(!loaded.Load(path, 43));
+        CHECK(loaded.GetTargetCount() == 0);
+
+        // Names pointing out of the string pool
+        std::vector<uint8_t> sidecar;
+        CHECK(ReadWholeFile(path, sidecar));
+        std::vector<uint8_t> damaged = sidecar;
+        damaged[24] = 0xFF;
+        CHECK(WriteWholeFile(path, damaged));
+        CHECK(!loaded.Load(path, 42));
+        damaged = sidecar;
+        damaged.pop_back();
+        CHECK(WriteWholeFile(path, damaged));
+        CHECK(!loaded.Load(path, 42));
+
+        DataSetIndex empty;
+        CHECK(!empty.Save(path, 42));
+        const char noTargets[] = "<QCARConfig><Tracking></Tracking></QCARConfig>";
+        CHECK(!empty.Build((const uint8_t*)noTargets, sizeof(noTargets) - 1, dat));
+        const char duplicates[] = "<Tracking><ImageTarget name=\"a\"/><ImageTarget name=\"a\"/></Tracking>";
+        CHECK(!empty.Build((const uint8_t*)duplicates, sizeof(duplicates) - 1, dat));
+    }
+}
+
+int main()
+{
+    TestSampleDatabases();
+    TestSidecarRebuild();
+    TestSaveAndLoad();
+    return VuforiaMediaTest::TestResult("DataSetIndexTest");
+}
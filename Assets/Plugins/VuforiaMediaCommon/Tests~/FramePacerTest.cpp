@@ -0,0 +1,195 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "AVSyncEngine.h"
+#include "FramePacer.h"
+#include "TestUtils.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const double EPSILON = 1e-9;
+
+    void TestWaitTimes()
+    {
+        ExternalClock clock;
+        FramePacer pacer(clock);
+        pacer.SetFrameRate(30.0);
+        pacer.SetDisplayRefreshRate(60.0);
+        clock.SetTime(1.0);
+
+        // No frame queued: poll at the display refresh
+        CHECK_NEAR(pacer.GetWaitTime(false, 0.0), 1.0 / 60.0, EPSILON);
+
+        // Sleep until the next frame is due
+        CHECK_NEAR(pacer.GetWaitTime(true, 1.02), 0.02, EPSILON);
+
+        // Due within half a refresh, or late: displayed now
+        CHECK_NEAR(pacer.GetWaitTime(true, 1.005), 0.0, EPSILON);
+        CHECK_NEAR(pacer.GetWaitTime(true, 0.9), 0.0, EPSILON);
+
+        // Far away (clock stalled or seeked): bounded by a frame duration
+        CHECK_NEAR(pacer.GetWaitTime(true, 2.0), 1.0 / 30.0, EPSILON);
+
+        // Invalid rates are ignored
+        pacer.SetFrameRate(0.0);
+        pacer.SetDisplayRefreshRate(-1.0);
+        CHECK_NEAR(pacer.GetWaitTime(false, 0.0), 1.0 / 60.0, EPSILON);
+        CHECK_NEAR(pacer.GetWaitTime(true, 2.0), 1.0 / 30.0, EPSILON);
+
+        pacer.SetDisplayRefreshRate(120.0);
+        CHECK_NEAR(pacer.GetWaitTime(true, 1.005), 0.005, EPSILON);
+    }
+
+    // The pump thread runs the engine and the pacer against a fake clock: each
+    // tick moves the clock on by the wait the pacer asked for (plus a little
+    // scheduling slack) and returns without sleeping, so three seconds of 30 fps
+    // media play in a few milliseconds and every frame is displayed on time
+    void TestPumpOnFakeClock(double slack, double stallAt, double stallDuration)
+    {
+        ExternalClock clock;
+        FramePacer pacer(clock);
+        pacer.SetFrameRate(30.0);
+        pacer.SetDisplayRefreshRate(60.0);
+
+        int released = 0;
+        AVSyncEngine<int> engine(clock, [&](int) { ++released; });
+        engine.SetFrameRate(30.0);
+
+        const int frameCount = 90;
+        int nextFrame = 0;
+        AVSyncEngine<int>::DecodeFunc decode = [&](double& presentationTime, int& frame)
+        {
+            if (nextFrame >= frameCount)
+            {
+                return false;
+            }
+            frame = nextFrame;
+            presentationTime = nextFrame / 30.0;
+            ++nextFrame;
+            return true;
+        };
+
+        int presented = 0;
+        int outOfOrder = 0;
+        int lastFrame = -1;
+        int ticks = 0;
+        double maxWait = 0.0;
+        double stalledFor = 0.0;
+
+        FramePumpThread pump;
+        CHECK(pump.Start([&]()
+        {
+            ++ticks;
+            int frame = 0;
+            AVSyncEngine<int>::TickResult result = engine.Tick(decode, frame);
+            if (result == AVSyncEngine<int>::TICK_END_OF_STREAM || ticks > 10000)
+            {
+                return -1.0;
+            }
+            if (result == AVSyncEngine<int>::TICK_NEW_FRAME)
+            {
+                if (frame <= lastFrame)
+                {
+                    ++outOfOrder;
+                }
+                lastFrame = frame;
+                ++presented;
+            }
+
+            double due = 0.0;
+            bool hasNext = engine.GetNextDueTime(due);
+            double wait = pacer.GetWaitTime(hasNext, due);
+            if (wait > maxWait)
+            {
+                maxWait = wait;
+            }
+
+            // The master clock stops for a while (buffering), then resumes
+            double now = clock.Now();
+            if (now >= stallAt && stalledFor < stallDuration)
+            {
+                stalledFor += wait + slack;
+                return 0.0;
+            }
+            clock.SetTime(now + wait + slack);
+            return 0.0;
+        }));
+
+        const std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (pump.IsRunning() && std::chrono::steady_clock::now() < timeout)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(!pump.IsRunning());
+        pump.Stop();
+
+        const SyncStats& stats = engine.GetStats();
+        CHECK(presented == frameCount);
+        CHECK(outOfOrder == 0);
+        CHECK(stats.dropped == 0);
+        CHECK(released == 0);
+        CHECK(ticks < 10000);
+        CHECK(maxWait <= 1.0 / 30.0 + EPSILON);
+
+        // Without a stall the pump wakes about once per frame, not per refresh
+        if (stallDuration == 0.0)
+        {
+            CHECK(ticks <= frameCount * 2 + 2);
+        }
+    }
+
+    void TestPumpStop()
+    {
+        FramePumpThread pump;
+        std::atomic<int> ticks(0);
+
+        // Stopping wakes the pump from a long sleep
+        CHECK(pump.Start([&]() { ++ticks; return 10.0; }));
+        CHECK(!pump.Start([&]() { return 0.0; }));
+        while (ticks.load() == 0)
+        {
+            std::this_thread::yield();
+        }
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        pump.Stop();
+        const double stopSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        CHECK(stopSeconds < 1.0);
+        CHECK(!pump.IsRunning());
+        CHECK(ticks.load() == 1);
+
+        // A tick ends the pump, which can then be started again
+        ticks.store(0);
+        CHECK(pump.Start([&]() { return ++ticks < 5 ? 0.0 : -1.0; }));
+        while (pump.IsRunning())
+        {
+            std::this_thread::yield();
+        }
+        CHECK(ticks.load() == 5);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            CHECK(pump.Start([&]() { return 0.0005; }));
+            pump.Stop();
+        }
+        CHECK(!pump.IsRunning());
+    }
+}
+
+int main()
+{
+    TestWaitTimes();
+    TestPumpOnFakeClock(0.0001, 100.0, 0.0);
+    TestPumpOnFakeClock(0.0005, 100.0, 0.0);
+    TestPumpOnFakeClock(0.0005, 1.0, 0.5);
+    TestPumpStop();
+    return VuforiaMediaTest::TestResult("FramePacerTest");
+}
@@ -0,0 +1,153 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FrameQueue.h"
+#include "TestUtils.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    typedef FrameQueue<uintptr_t, 3> TestQueue;
+
+    void TestOverwriteOldest()
+    {
+        std::vector<uintptr_t> released;
+        {
+            TestQueue queue([&](uintptr_t frame) { released.push_back(frame); });
+            uintptr_t frame = 0;
+
+            CHECK(queue.Push(1));
+            CHECK(queue.Push(2));
+            CHECK(queue.Push(3));
+            CHECK(!queue.Push(4));
+            CHECK(!queue.Push(5));
+            CHECK(released.size() == 2 && released[0] == 1 && released[1] == 2);
+
+            CHECK(queue.Pop(frame) && frame == 3);
+            CHECK(queue.PopLatest(frame) && frame == 5);
+            CHECK(released.size() == 3 && released[2] == 4);
+            CHECK(!queue.Pop(frame));
+
+            FrameQueueStats stats = queue.GetStats();
+            CHECK(stats.depth == 0);
+            CHECK(stats.maxDepth == 3);
+            CHECK(stats.pushed == 5);
+            CHECK(stats.popped == 3);
+            CHECK(stats.overwritten == 2);
+
+            queue.ResetStats();
+            stats = queue.GetStats();
+            CHECK(stats.maxDepth == 0 && stats.pushed == 0 && stats.popped == 0 && stats.overwritten == 0);
+
+            // Frames still queued are released with the queue
+            queue.Push(6);
+            queue.Push(7);
+        }
+        CHECK(released.size() == 5 && released[3] == 6 && released[4] == 7);
+    }
+
+    // A decoder thread pushing into a renderer popping as fast as it can: the
+    // renderer sees increasing frames, and every frame is either displayed or
+    // released exactly once
+    void TestStress(bool popLatest, uintptr_t frameCount)
+    {
+        std::vector<std::atomic<uint8_t> > seen(frameCount + 1);
+        for (size_t i = 0; i < seen.size(); ++i)
+        {
+            seen[i].store(0);
+        }
+
+        std::atomic<uint32_t> releaseCount(0);
+        long displayed = 0;
+        long outOfOrder = 0;
+        FrameQueueStats stats;
+        {
+            TestQueue queue([&](uintptr_t frame)
+            {
+                seen[frame].fetch_add(1);
+                releaseCount.fetch_add(1);
+            });
+
+            std::atomic<bool> done(false);
+            std::thread renderer([&]()
+            {
+                uintptr_t last = 0;
+                uintptr_t frame = 0;
+                while (true)
+                {
+                    const bool producerDone = done.load();
+                    const bool got = popLatest ? queue.PopLatest(frame) : queue.Pop(frame);
+                    if (got)
+                    {
+                        if (frame <= last)
+                        {
+                            ++outOfOrder;
+                        }
+                        last = frame;
+                        seen[frame].fetch_add(1);
+                        ++displayed;
+                    }
+                    else if (producerDone)
+                    {
+                        break;
+                    }
+                }
+            });
+
+            for (uintptr_t frame = 1; frame <= frameCount; ++frame)
+            {
+                queue.Push(frame);
+            }
+            done.store(true);
+            renderer.join();
+
+            stats = queue.GetStats();
+        }
+
+        CHECK(outOfOrder == 0);
+        CHECK(stats.depth == 0);
+        CHECK(stats.maxDepth <= 3);
+        CHECK(stats.pushed == frameCount);
+        CHECK(stats.popped + stats.overwritten == stats.pushed);
+        CHECK((long)releaseCount.load() + displayed == (long)frameCount);
+        if (popLatest)
+        {
+            // Frames superseded by PopLatest count as popped but are released
+            CHECK((long)releaseCount.load() >= (long)stats.overwritten);
+        }
+        else
+        {
+            CHECK(releaseCount.load() == stats.overwritten);
+            CHECK((long)stats.popped == displayed);
+        }
+
+        long wrongCounts = 0;
+        for (uintptr_t frame = 1; frame <= frameCount; ++frame)
+        {
+            if (seen[frame].load() != 1)
+            {
+                ++wrongCounts;
+            }
+        }
+        CHECK(wrongCounts == 0);
+    }
+}
+
+int main()
+{
+    TestOverwriteOldest();
+    for (int round = 0; round < 2; ++round)
+    {
+        TestStress(false, 1000000);
+        TestStress(true, 1000000);
+    }
+    return VuforiaMediaTest::TestResult("FrameQueueTest");
+}
@@ -0,0 +1,255 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FrameSelector.h"
+#include "TestUtils.h"
+
+#include <stdint.h>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const double REFRESH_60 = 1.0 / 60.0;
+
+    // Small deterministic generator, so that the jitter is the same on every host
+    class Jitter
+    {
+    public:
+        explicit Jitter(double amplitude) : m_amplitude(amplitude), m_state(12345) {}
+
+        double Next()
+        {
+            m_state = m_state * 1103515245u + 12345u;
+            double unit = (double)((m_state >> 8) & 0xffff) / 65535.0;
+            return m_amplitude * (2.0 * unit - 1.0);
+        }
+
+    private:
+        double m_amplitude;
+        uint32_t m_state;
+    };
+
+    struct CadenceResult
+    {
+        JudderStats stats;
+        std::vector<int> runs;      // refreshes each displayed frame stayed on screen
+        int outOfOrder;
+        int leaked;                 // frames neither displayed nor released
+    };
+
+    // Renders a synthetic cadence: frameRate fps content on a refreshRate Hz
+    // display, the display time of each render offset by phase plus jitter,
+    // with the decoder running lookahead seconds ahead of the display
+    CadenceResult RunCadence(double frameRate, double refreshRate, double phase, double jitter,
+        double lookahead, int refreshes)
+    {
+        CadenceResult result;
+        result.outOfOrder = 0;
+
+        int released = 0;
+        int pushed = 0;
+        int displayed = 0;
+        {
+            FrameSelector<int, 4> selector([&](int) { ++released; });
+            selector.SetDisplayRefreshRate(refreshRate);
+
+            Jitter displayJitter(jitter);
+            int nextFrame = 0;
+            int lastFrame = -1;
+            int run = 0;
+            for (int k = 0; k < refreshes; ++k)
+            {
+                double displayTime = k / refreshRate + phase + displayJitter.Next();
+                while (nextFrame / frameRate <= displayTime + lookahead)
+                {
+                    selector.Push(nextFrame / frameRate, nextFrame);
+                    ++nextFrame;
+                    ++pushed;
+                }
+
+                int frame = 0;
+                if (selector.Select(displayTime, frame))
+                {
+                    if (frame <= lastFrame)
+                    {
+                        ++result.outOfOrder;
+                    }
+                    lastFrame = frame;
+                    ++displayed;
+                    if (run > 0)
+                    {
+                        result.runs.push_back(run);
+                    }
+                    run = 1;
+                }
+                else
+                {
+                    ++run;
+                }
+            }
+            result.stats = selector.GetStats();
+        }
+        result.leaked = pushed - displayed - released;
+        return result;
+    }
+
+    // Runs after the first few renders, while the interval between renders is
+    // still being measured from jittery display times, and before the last,
+    // incomplete one
+    bool AllRunsAre(const CadenceResult& result, int length)
+    {
+        for (size_t i = 10; i + 1 < result.runs.size(); ++i)
+        {
+            if (result.runs[i] != length)
+            {
+                return false;
+            }
+        }
+        return result.runs.size() > 20;
+    }
+
+    void Test30In60()
+    {
+        // Frame boundaries on the refresh middles, where a jittery display
+        // time would alternate between frames without the cadence
+        CadenceResult result = RunCadence(30.0, 60.0, 0.5 * REFRESH_60, 0.0015, 2.0 * REFRESH_60, 600);
+        CHECK(AllRunsAre(result, 2));
+        CHECK(result.outOfOrder == 0);
+        CHECK(result.leaked == 0);
+        CHECK(result.stats.skipped == 0);
+        CHECK(result.stats.frames == 300);
+        CHECK(result.stats.refreshes == 600);
+        CHECK(result.stats.judder < 0.002f);
+        CHECK(result.stats.maxJudder < 0.0031f);
+        CHECK_NEAR(result.stats.refreshInterval, REFRESH_60, 0.0005);
+    }
+
+    void Test24In60()
+    {
+        // 3:2 pulldown: frames alternate between three and two refreshes, each
+        // off its 41.7 ms duration by 8.3 ms
+        CadenceResult result = RunCadence(24.0, 60.0, 0.3 * REFRESH_60, 0.001, 2.0 * REFRESH_60, 600);
+        bool pulldown = result.runs.size() > 4;
+        for (size_t i = 3; i + 1 < result.runs.size(); ++i)
+        {
+            if ((result.runs[i] != 2 && result.runs[i] != 3) || result.runs[i] + result.runs[i - 1] != 5)
+            {
+                pulldown = false;
+            }
+        }
+        CHECK(pulldown);
+        CHECK(result.outOfOrder == 0);
+        CHECK(result.leaked == 0);
+        CHECK(result.stats.skipped == 0);
+        CHECK(result.stats.judder > 0.0080f && result.stats.judder < 0.0087f);
+    }
+
+    void TestOtherCadences()
+    {
+        CadenceResult sameRate = RunCadence(60.0, 60.0, 0.5 * REFRESH_60, 0.0015, 2.0 * REFRESH_60, 600);
+        CHECK(AllRunsAre(sameRate, 1));
+        CHECK(sameRate.leaked == 0);
+
+        // Twice the refresh rate: every other frame is passed over, steadily
+        CadenceResult doubleRate = RunCadence(60.0, 30.0, 0.2 * REFRESH_60, 0.001, 2.0 * REFRESH_60, 300);
+        CHECK(AllRunsAre(doubleRate, 1));
+        CHECK(doubleRate.stats.skipped > 140);
+        CHECK(doubleRate.stats.judder < 0.0021f);
+        CHECK(doubleRate.leaked == 0);
+
+        // Decoder behind the display: the newest frame is displayed at once
+        CadenceResult late = RunCadence(30.0, 60.0, 0.3 * REFRESH_60, 0.0, -0.05, 600);
+        CHECK(late.stats.frames > 250);
+        CHECK(late.outOfOrder == 0);
+        CHECK(late.leaked == 0);
+    }
+
+    void TestSeekAndCapacity()
+    {
+        int released = 0;
+        FrameSelector<int, 4> selector([&](int) { ++released; });
+        int frame = 0;
+
+        // The first frame is displayed even if early
+        selector.Push(1.0, 30);
+        CHECK(selector.Select(0.9, frame) && frame == 30);
+        selector.Push(1.1, 33);
+        CHECK(!selector.Select(0.95, frame));
+
+        // An earlier frame (seek) discards the queued ones
+        selector.Push(0.0, 0);
+        CHECK(released == 1);
+        CHECK(selector.GetQueuedCount() == 1);
+        CHECK(selector.Select(0.0, frame) && frame == 0);
+
+        // Past the capacity the oldest frames are passed over
+        for (int i = 1; i <= 6; ++i)
+        {
+            selector.Push(i / 30.0, i);
+        }
+        CHECK(selector.GetQueuedCount() == 4);
+        CHECK(released == 3);
+        CHECK(selector.GetStats().skipped == 2);
+        CHECK(selector.Select(0.2, frame) && frame == 6);
+        CHECK(released == 6);
+
+        selector.ResetStats();
+        CHECK(selector.GetStats().frames == 0);
+        CHECK(!selector.Select(0.21, frame));
+        JudderStats stats = selector.GetStats();
+        CHECK(stats.frames == 0 && stats.refreshes == 1 && stats.repeated == 1);
+
+        selector.Push(0.3, 9);
+        selector.Flush();
+        CHECK(released == 7);
+        CHECK(selector.GetQueuedCount() == 0);
+    }
+
+    void TestMeterStall()
+    {
+        // 30 fps on 60 Hz, then a pause: the gap is not judder
+        JudderMeter meter;
+        for (int k = 0; k < 100; ++k)
+        {
+            meter.OnRefresh(k * REFRESH_60, (k % 2) == 0, (k / 2) / 30.0);
+        }
+        meter.OnRefresh(10.0, true, 50 / 30.0);
+        for (int k = 1; k < 10; ++k)
+        {
+            meter.OnRefresh(10.0 + k * REFRESH_60, (k % 2) == 0, (50 + k / 2) / 30.0);
+        }
+
+        JudderStats stats = meter.GetStats();
+        CHECK(stats.frames == 55);
+        CHECK(stats.repeated == 55);
+        CHECK(stats.maxJudder < 1e-6f);
+        CHECK_NEAR(stats.refreshInterval, REFRESH_60, 1e-6);
+
+        // A frame latched one refresh late adds a whole refresh of judder
+        meter.OnRefresh(10.0 + 10 * REFRESH_60, false, 0.0);
+        meter.OnRefresh(10.0 + 11 * REFRESH_60, true, 55 / 30.0);
+        CHECK_NEAR(meter.GetStats().maxJudder, REFRESH_60, 1e-6);
+
+        meter.OnSkipped(3);
+        CHECK(meter.GetStats().skipped == 3);
+        meter.ResetStats();
+        stats = meter.GetStats();
+        CHECK(stats.frames == 0 && stats.skipped == 0 && stats.maxJudder == 0.0f);
+        CHECK_NEAR(stats.refreshInterval, REFRESH_60, 1e-6);
+    }
+}
+
+int main()
+{
+    Test30In60();
+    Test24In60();
+    TestOtherCadences();
+    TestSeekAndCapacity();
+    TestMeterStall();
+    return VuforiaMediaTest::TestResult("FrameSelectorTest");
+}
@@ -0,0 +1,229 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FrameTextureSource.h"
+#include "TestUtils.h"
+
+#include <set>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // Backend wrapping a frame as a numbered texture and recording what it holds
+    class FakeBackend
+    {
+    public:
+        struct Texture
+        {
+            Texture() : id(0), frame(nullptr) {}
+
+            int id;
+            void* frame;
+        };
+
+        FakeBackend() :
+            m_nextId(1),
+            m_failingFrame(nullptr),
+            m_wrapCount(0),
+            m_flushCount(0)
+        {
+        }
+
+        // Deleted by the source, which releases its textures first
+        ~FakeBackend()
+        {
+            CHECK(m_live.empty() && m_released.empty());
+        }
+
+        bool Wrap(void* frame, Texture& texture)
+        {
+            CHECK(texture.id == 0);
+            if (frame == m_failingFrame)
+            {
+                return false;
+            }
+            texture.id = m_nextId++;
+            texture.frame = frame;
+            m_live.insert(texture.id);
+            ++m_wrapCount;
+            return true;
+        }
+
+        void* GetTexturePtr(const Texture& texture) const
+        {
+            CHECK(m_live.count(texture.id) == 1);
+            return texture.frame;
+        }
+
+        void Release(Texture& texture)
+        {
+            CHECK(m_live.erase(texture.id) == 1);
+            m_released.push_back(texture.id);
+            texture = Texture();
+        }
+
+        void Flush()
+        {
+            m_recycled.insert(m_recycled.end(), m_released.begin(), m_released.end());
+            m_released.clear();
+            ++m_flushCount;
+        }
+
+        bool IsLive(int id) const { return m_live.count(id) == 1; }
+        size_t GetLiveCount() const { return m_live.size(); }
+        size_t GetRecycledCount() const { return m_recycled.size(); }
+        bool HasPendingReleases() const { return !m_released.empty(); }
+        int GetWrapCount() const { return m_wrapCount; }
+        int GetFlushCount() const { return m_flushCount; }
+
+        void SetFailingFrame(void* frame) { m_failingFrame = frame; }
+
+    private:
+        int m_nextId;
+        void* m_failingFrame;
+        std::set<int> m_live;
+        std::vector<int> m_released;        // released since the last flush
+        std::vector<int> m_recycled;
+        int m_wrapCount;
+        int m_flushCount;
+    };
+
+    typedef WrappedFrameTextureSource<FakeBackend> Source;
+
+    const int IN_FLIGHT = Source::IN_FLIGHT_FRAMES;
+
+    char g_frames[16];
+
+    void* Frame(int i) { return &g_frames[i]; }
+
+    // Textures are ids 1, 2, ... in wrapping order: the last IN_FLIGHT ones stay alive
+    void TestRetention()
+    {
+        FakeBackend* backend = new FakeBackend();
+        Source source(backend);
+        CHECK(source.GetTexturePtr() == nullptr);
+        CHECK(!source.SetFrame(nullptr));
+        CHECK(backend->GetWrapCount() == 0);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(source.SetFrame(Frame(i)));
+            CHECK(source.GetTexturePtr() == Frame(i));
+
+            int wrapped = i + 1;
+            CHECK(backend->GetLiveCount() == (size_t)(wrapped < IN_FLIGHT ? wrapped : IN_FLIGHT));
+            for (int id = 1; id <= wrapped; ++id)
+            {
+                CHECK(backend->IsLive(id) == (id > wrapped - IN_FLIGHT));
+            }
+            // Released textures are recycled before the next wrap
+            CHECK(!backend->HasPendingReleases());
+            CHECK(backend->GetRecycledCount() == (size_t)(wrapped > IN_FLIGHT ? wrapped - IN_FLIGHT : 0));
+        }
+    }
+
+    // A frame set again is neither wrapped again nor retires older textures
+    void TestRepeatedFrame()
+    {
+        FakeBackend* backend = new FakeBackend();
+        Source source(backend);
+
+        CHECK(source.SetFrame(Frame(0)));
+        CHECK(source.SetFrame(Frame(1)));
+        CHECK(source.SetFrame(Frame(2)));
+        int flushCount = backend->GetFlushCount();
+        for (int i = 0; i < 5; ++i)
+        {
+            CHECK(source.SetFrame(Frame(2)));
+        }
+        CHECK(source.GetTexturePtr() == Frame(2));
+        CHECK(backend->GetWrapCount() == 3);
+        CHECK(backend->GetFlushCount() == flushCount);
+        CHECK(backend->IsLive(1) && backend->IsLive(2) && backend->IsLive(3));
+
+        // An older frame coming back is a new frame
+        CHECK(source.SetFrame(Frame(0)));
+        CHECK(source.GetTexturePtr() == Frame(0));
+        CHECK(backend->GetWrapCount() == 4);
+        CHECK(!backend->IsLive(1) && backend->IsLive(2) && backend->IsLive(3) && backend->IsLive(4));
+    }
+
+    // A frame that cannot be wrapped keeps the current texture
+    void TestWrapFailure()
+    {
+        FakeBackend* backend = new FakeBackend();
+        Source source(backend);
+
+        backend->SetFailingFrame(Frame(0));
+        CHECK(!source.SetFrame(Frame(0)));
+        CHECK(source.GetTexturePtr() == nullptr);
+        CHECK(backend->GetLiveCount() == 0);
+
+        CHECK(source.SetFrame(Frame(1)));
+        CHECK(source.SetFrame(Frame(2)));
+        CHECK(source.SetFrame(Frame(3)));
+
+        backend->SetFailingFrame(Frame(4));
+        CHECK(!source.SetFrame(Frame(4)));
+        CHECK(source.GetTexturePtr() == Frame(3));
+        CHECK(backend->IsLive(2) && backend->IsLive(3));
+        CHECK(!source.SetFrame(Frame(4)));
+        CHECK(source.GetTexturePtr() == Frame(3));
+
+        // The ring carries on from the failed entry
+        CHECK(source.SetFrame(Frame(5)));
+        CHECK(source.GetTexturePtr() == Frame(5));
+        CHECK(backend->GetLiveCount() == (size_t)IN_FLIGHT);
+        CHECK(backend->IsLive(2) && backend->IsLive(3) && backend->IsLive(4));
+        CHECK(source.SetFrame(Frame(6)));
+        CHECK(!backend->IsLive(2) && backend->IsLive(5));
+        CHECK(source.SetFrame(Frame(5)));
+        CHECK(backend->GetWrapCount() == 6);
+    }
+
+    // Clear releases everything; the source starts over afterwards
+    void TestClear()
+    {
+        FakeBackend* backend = new FakeBackend();
+        Source source(backend);
+        source.Clear();
+        CHECK(backend->GetLiveCount() == 0);
+
+        for (int i = 0; i < 5; ++i)
+        {
+            CHECK(source.SetFrame(Frame(i)));
+        }
+        source.Clear();
+        CHECK(source.GetTexturePtr() == nullptr);
+        CHECK(backend->GetLiveCount() == 0);
+        CHECK(!backend->HasPendingReleases());
+        CHECK(backend->GetRecycledCount() == 5);
+
+        // The same frame after a clear is wrapped again
+        CHECK(source.SetFrame(Frame(4)));
+        CHECK(source.GetTexturePtr() == Frame(4));
+        CHECK(backend->GetWrapCount() == 6);
+        CHECK(source.SetFrame(Frame(5)));
+        CHECK(backend->GetLiveCount() == 2);
+        CHECK(backend->GetRecycledCount() == 5);
+
+        source.Clear();
+        source.Clear();
+        CHECK(backend->GetRecycledCount() == 7);
+        CHECK(source.SetFrame(Frame(6)));
+    }
+}
+
+int main()
+{
+    TestRetention();
+    TestRepeatedFrame();
+    TestWrapFailure();
+    TestClear();
+    return VuforiaMediaTest::TestResult("FrameTextureSourceTest");
+}
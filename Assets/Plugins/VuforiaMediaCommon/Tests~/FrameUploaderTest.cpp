@@ -0,0 +1,206 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FrameUploader.h"
+#include "HeadlessContext.h"
+#include "TestUtils.h"
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <string.h>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const int BYTES_PER_TEXEL = FrameUploader::BYTES_PER_TEXEL;
+
+    // BGRA frame with padding after each row
+    std::vector<unsigned char> MakeFrame(int width, int height, size_t bytesPerRow, int seed)
+    {
+        std::vector<unsigned char> frame(bytesPerRow * height, 0xEE);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                unsigned char* texel = &frame[y * bytesPerRow + x * BYTES_PER_TEXEL];
+                texel[0] = (unsigned char)(x * 3 + y + seed);
+                texel[1] = (unsigned char)(y * 5 + x / 3);
+                texel[2] = (unsigned char)((x ^ y) + seed);
+                texel[3] = (unsigned char)(255 - x - y);
+            }
+        }
+        return frame;
+    }
+
+    // Reads the texture back as RGBA and compares it with the BGRA frame
+    bool TextureMatches(GLuint texture, const std::vector<unsigned char>& frame, int width, int height,
+                        size_t bytesPerRow)
+    {
+        GLuint framebuffer = 0;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+        std::vector<unsigned char> pixels((size_t)width * height * 4);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if (complete)
+        {
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        if (!complete || glGetError() != GL_NO_ERROR)
+        {
+            return false;
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                const unsigned char* expected = &frame[y * bytesPerRow + x * BYTES_PER_TEXEL];
+                const unsigned char* actual = &pixels[((size_t)y * width + x) * 4];
+                if (actual[0] != expected[2] || actual[1] != expected[1] ||
+                    actual[2] != expected[0] || actual[3] != expected[3])
+                {
+                    printf("texel %d,%d of %dx%d (%u bytes per row) differs\n", x, y, width, height,
+                           (unsigned)bytesPerRow);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool UploadMatches(FrameUploader& uploader, GLuint texture, int width, int height, size_t bytesPerRow, int seed)
+    {
+        std::vector<unsigned char> frame = MakeFrame(width, height, bytesPerRow, seed);
+        return uploader.Upload(texture, &frame[0], width, height, bytesPerRow) &&
+               TextureMatches(texture, frame, width, height, bytesPerRow);
+    }
+
+    // Unpadded rows take a single upload; rows padded to a multiple of the texel
+    // size use GL_UNPACK_ROW_LENGTH where available; other padding is dropped
+    // in the staging buffer
+    void TestUploadPaths(int width, int height)
+    {
+        const size_t rowSize = (size_t)width * BYTES_PER_TEXEL;
+        const size_t layouts[] = { rowSize, rowSize + 64, (rowSize + 255) & ~(size_t)255, rowSize + 6 };
+
+        for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); ++i)
+        {
+            FrameUploader uploader;
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+
+            // The second frame reuses the storage
+            CHECK(UploadMatches(uploader, texture, width, height, layouts[i], 1));
+            CHECK(UploadMatches(uploader, texture, width, height, layouts[i], 2));
+            CHECK(UploadMatches(uploader, texture, width, height, rowSize, 3));
+
+            glDeleteTextures(1, &texture);
+        }
+    }
+
+    void TestResize(bool isES3)
+    {
+        FrameUploader uploader;
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        CHECK(UploadMatches(uploader, texture, 641, 359, 641 * 4, 1));
+
+        // Immutable storage, where glTexStorage2D takes the format, keeps its
+        // size: frames of another size need another texture
+        GLint immutable = GL_FALSE;
+        if (isES3)
+        {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        printf("%s storage\n", immutable ? "Immutable" : "Mutable");
+        if (immutable)
+        {
+            std::vector<unsigned char> frame = MakeFrame(640, 360, 640 * 4, 2);
+            CHECK(!uploader.Upload(texture, &frame[0], 640, 360, 640 * 4));
+            glGetError();
+        }
+        else
+        {
+            CHECK(UploadMatches(uploader, texture, 640, 360, 640 * 4, 2));
+        }
+
+        GLuint other = 0;
+        glGenTextures(1, &other);
+        CHECK(UploadMatches(uploader, other, 640, 360, 640 * 4, 3));
+
+        // A texture deleted behind the uploader's back, and its name reused
+        glDeleteTextures(1, &texture);
+        glDeleteTextures(1, &other);
+        uploader.Reset();
+        glGenTextures(1, &texture);
+        CHECK(UploadMatches(uploader, texture, 640, 360, 640 * 4, 4));
+        glDeleteTextures(1, &texture);
+    }
+
+    void TestInvalidArguments()
+    {
+        FrameUploader uploader;
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        std::vector<unsigned char> frame = MakeFrame(16, 16, 64, 0);
+        CHECK(!uploader.Upload(0, &frame[0], 16, 16, 64));
+        CHECK(!uploader.Upload(texture, nullptr, 16, 16, 64));
+        CHECK(!uploader.Upload(texture, &frame[0], 0, 16, 64));
+        CHECK(!uploader.Upload(texture, &frame[0], 16, 16, 63));
+        CHECK(uploader.Upload(texture, &frame[0], 16, 16, 64));
+
+        GLint bound = -1;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+        CHECK(bound == 0);
+        glDeleteTextures(1, &texture);
+    }
+
+    // Drivers may return a later version than requested
+    void TestContext(int clientVersion)
+    {
+        const char* version = (const char*)glGetString(GL_VERSION);
+        const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+        bool isES3 = version != nullptr && strncmp(version, "OpenGL ES ", 10) == 0 && version[10] >= '3';
+        bool hasRowLength = isES3 ||
+                            (extensions != nullptr && strstr(extensions, "GL_EXT_unpack_subimage") != nullptr);
+        printf("OpenGL ES %d context: %s, padded rows %s\n", clientVersion, version,
+               hasRowLength ? "by row length" : "staged");
+
+        TestUploadPaths(640, 360);
+        TestUploadPaths(641, 359);
+        TestResize(isES3);
+        TestInvalidArguments();
+    }
+}
+
+int main()
+{
+    VuforiaMediaTest::HeadlessContext context;
+    int testedContexts = 0;
+    for (int clientVersion = 2; clientVersion <= 3; ++clientVersion)
+    {
+        if (context.Create(clientVersion))
+        {
+            TestContext(clientVersion);
+            ++testedContexts;
+        }
+    }
+    if (testedContexts == 0)
+    {
+        printf("FrameUploaderTest: no GLES context, skipped\n");
+        return VuforiaMediaTest::SKIP_TEST;
+    }
+    return VuforiaMediaTest::TestResult("FrameUploaderTest");
+}
@@ -0,0 +1,179 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "GpuResourceRegistry.h"
+#include "HeadlessContext.h"
+#include "TestUtils.h"
+
+#include <GLES2/gl2.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    typedef CopyShaderVariant<COPY_SAMPLER_2D, COPY_GEOMETRY_FLIP_Y, COPY_COLOR_NONE, COPY_OUTPUT_RGBA> FlippedCopy;
+    typedef CopyShaderVariant<COPY_SAMPLER_2D, COPY_GEOMETRY_NONE, COPY_COLOR_NONE, COPY_OUTPUT_BGRA> SwappedCopy;
+
+    const GpuTextureFormat RGBA_FORMAT = { GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE };
+
+    // Players with both a media texture and a frame buffer, then one of each
+    const int FULL_PLAYERS[] = { 0, 5, GpuResourceRegistry::PLAYER_COUNT - 1 };
+    const int FRAME_BUFFER_PLAYER = 12;
+    const int MEDIA_TEXTURE_PLAYER = 7;
+    const int RELEASED_PLAYER = 9;
+
+    int GetWidth(int player) { return 64 + player; }
+    int GetHeight(int player) { return 32 + player; }
+
+    bool IsComplete(GLuint frameBuffer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return complete;
+    }
+
+    // The objects of the player exist in the current context, as recorded
+    void CheckPlayer(int player, const GpuResources& resources, bool hasMediaTexture, bool hasFrameBuffer)
+    {
+        GpuResources recorded;
+        CHECK(GpuResourceRegistry::Instance().GetResources(player, recorded));
+        CHECK(recorded.mediaTexture == resources.mediaTexture && recorded.frameBuffer == resources.frameBuffer);
+
+        CHECK((resources.mediaTexture != 0) == hasMediaTexture);
+        CHECK(!hasMediaTexture || glIsTexture(resources.mediaTexture));
+        CHECK((resources.frameBuffer != 0) == hasFrameBuffer);
+        if (hasFrameBuffer)
+        {
+            CHECK(glIsFramebuffer(resources.frameBuffer));
+            CHECK(IsComplete(resources.frameBuffer));
+            CHECK(resources.destTexture != 0 && glIsTexture(resources.destTexture));
+            CHECK(resources.width == GetWidth(player) && resources.height == GetHeight(player));
+        }
+    }
+
+    void CreateObjects()
+    {
+        GpuResourceRegistry& registry = GpuResourceRegistry::Instance();
+        CHECK(registry.GetCopyProgram(FlippedCopy::Get()) != 0);
+        CHECK(registry.GetCopyProgram(SwappedCopy::Get()) != 0);
+        CHECK(registry.GetCopyProgram(FlippedCopy::Get()) == registry.GetCopyProgram(FlippedCopy::Get()));
+
+        for (size_t i = 0; i < sizeof(FULL_PLAYERS) / sizeof(FULL_PLAYERS[0]); ++i)
+        {
+            int player = FULL_PLAYERS[i];
+            CHECK(registry.CreateMediaTexture(player) != 0);
+            GLuint destTexture = 0;
+            glGenTextures(1, &destTexture);
+            CHECK(registry.CreateFrameBuffer(player, destTexture, GetWidth(player), GetHeight(player),
+                                             RGBA_FORMAT) != 0);
+        }
+
+        GLuint destTexture = 0;
+        glGenTextures(1, &destTexture);
+        CHECK(registry.CreateFrameBuffer(FRAME_BUFFER_PLAYER, destTexture, GetWidth(FRAME_BUFFER_PLAYER),
+                                         GetHeight(FRAME_BUFFER_PLAYER), RGBA_FORMAT) != 0);
+        CHECK(registry.CreateMediaTexture(MEDIA_TEXTURE_PLAYER) != 0);
+
+        // Replaced objects are deleted
+        GLuint replaced = registry.CreateMediaTexture(MEDIA_TEXTURE_PLAYER);
+        CHECK(replaced != 0);
+        GpuResources resources;
+        CHECK(registry.GetResources(MEDIA_TEXTURE_PLAYER, resources) && resources.mediaTexture == replaced);
+
+        CHECK(registry.CreateMediaTexture(RELEASED_PLAYER) != 0);
+        registry.ReleasePlayer(RELEASED_PLAYER);
+
+        // Objects of invalid players are made but not recorded
+        CHECK(registry.CreateMediaTexture(-1) != 0);
+        CHECK(!registry.GetResources(-1, resources));
+        CHECK(registry.CreateFrameBuffer(0, 0, 16, 16, RGBA_FORMAT) == 0);
+    }
+
+    // Every player comes back from a single pass, reported once
+    void CheckRestored()
+    {
+        GpuResourceRegistry& registry = GpuResourceRegistry::Instance();
+        GpuResources resources;
+
+        for (size_t i = 0; i < sizeof(FULL_PLAYERS) / sizeof(FULL_PLAYERS[0]); ++i)
+        {
+            CHECK(registry.TakeRestored(FULL_PLAYERS[i], resources));
+            CheckPlayer(FULL_PLAYERS[i], resources, true, true);
+            CHECK(!registry.TakeRestored(FULL_PLAYERS[i], resources));
+        }
+        CHECK(registry.TakeRestored(FRAME_BUFFER_PLAYER, resources));
+        CheckPlayer(FRAME_BUFFER_PLAYER, resources, false, true);
+        CHECK(registry.TakeRestored(MEDIA_TEXTURE_PLAYER, resources));
+        CheckPlayer(MEDIA_TEXTURE_PLAYER, resources, true, false);
+        CHECK(!registry.TakeRestored(MEDIA_TEXTURE_PLAYER, resources));
+
+        CHECK(!registry.TakeRestored(RELEASED_PLAYER, resources));
+        CHECK(!registry.TakeRestored(1, resources));
+        CHECK(!registry.TakeRestored(-1, resources));
+
+        // The programs in use were rebuilt too
+        CHECK(glIsProgram(registry.GetCopyProgram(FlippedCopy::Get())));
+        CHECK(glIsProgram(registry.GetCopyProgram(SwappedCopy::Get())));
+    }
+
+    void TestRestore(VuforiaMediaTest::HeadlessContext& context)
+    {
+        GpuResourceRegistry& registry = GpuResourceRegistry::Instance();
+        const void* firstContext = eglGetCurrentContext();
+        CHECK(!registry.RestoreIfLost(firstContext));
+        CreateObjects();
+
+        GpuResources resources;
+        for (size_t i = 0; i < sizeof(FULL_PLAYERS) / sizeof(FULL_PLAYERS[0]); ++i)
+        {
+            CHECK(registry.GetResources(FULL_PLAYERS[i], resources));
+            CheckPlayer(FULL_PLAYERS[i], resources, true, true);
+        }
+        CHECK(!registry.RestoreIfLost(firstContext));
+        CHECK(!registry.TakeRestored(FULL_PLAYERS[0], resources));
+        CHECK(registry.GetRestoreCount() == 0);
+
+        // A new context given the handle of the lost one: it does not know the programs
+        context.Destroy();
+        CHECK(context.Create());
+        CHECK(registry.RestoreIfLost(firstContext));
+        CHECK(registry.GetRestoreCount() == 1);
+        CHECK(!registry.RestoreIfLost(firstContext));
+        CheckRestored();
+
+        // A new context with a handle of its own
+        context.Destroy();
+        CHECK(context.Create());
+        CHECK(registry.RestoreIfLost(&context));
+        CHECK(!registry.RestoreIfLost(&context));
+        CHECK(registry.GetRestoreCount() == 2);
+        CheckRestored();
+
+        // Released frame buffers are not restored
+        CHECK(registry.GetResources(FRAME_BUFFER_PLAYER, resources));
+        registry.ReleaseFrameBuffer(FRAME_BUFFER_PLAYER, resources.frameBuffer);
+        CHECK(registry.GetResources(FRAME_BUFFER_PLAYER, resources) && resources.frameBuffer == 0);
+        context.Destroy();
+        CHECK(context.Create());
+        CHECK(registry.RestoreIfLost(firstContext));
+        CHECK(!registry.TakeRestored(FRAME_BUFFER_PLAYER, resources));
+        CHECK(registry.TakeRestored(FULL_PLAYERS[0], resources));
+    }
+}
+
+int main()
+{
+    VuforiaMediaTest::HeadlessContext context;
+    if (!context.Create())
+    {
+        printf("GpuResourceRegistryTest: no GLES 2 context, skipped\n");
+        return VuforiaMediaTest::SKIP_TEST;
+    }
+
+    TestRestore(context);
+    return VuforiaMediaTest::TestResult("GpuResourceRegistryTest");
+}
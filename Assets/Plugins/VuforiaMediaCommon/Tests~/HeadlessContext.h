@@ -0,0 +1,104 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_HEADLESS_CONTEXT_H_
+#define _VUFORIA_MEDIA_HEADLESS_CONTEXT_H_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace VuforiaMediaTest
+{
+    // Exit status by which ctest reports a test as skipped
+    const int SKIP_TEST = 77;
+
+    // OpenGL ES context without any surface, on Mesa's surfaceless platform
+    // when there is no display. Can be destroyed and created again, like the
+    // context of an app going to the background.
+    class HeadlessContext
+    {
+    public:
+        HeadlessContext() :
+            m_display(EGL_NO_DISPLAY),
+            m_context(EGL_NO_CONTEXT)
+        {
+        }
+
+        ~HeadlessContext()
+        {
+            // The display is left initialized: terminating it unloads the
+            // Mesa driver, whose caches LeakSanitizer then reports as leaks
+            Destroy();
+        }
+
+        // clientVersion is 2 or 3
+        bool Create(int clientVersion = 2)
+        {
+            Destroy();
+
+            if (m_display == EGL_NO_DISPLAY)
+            {
+                PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+                if (getPlatformDisplay != NULL)
+                {
+                    m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+                }
+                if (m_display == EGL_NO_DISPLAY)
+                {
+                    m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+                }
+                if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, NULL, NULL))
+                {
+                    m_display = EGL_NO_DISPLAY;
+                    return false;
+                }
+            }
+            if (!eglBindAPI(EGL_OPENGL_ES_API))
+            {
+                return false;
+            }
+
+            const EGLint configAttributes[] =
+            {
+                EGL_RENDERABLE_TYPE, (clientVersion >= 3) ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_ES2_BIT,
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                EGL_NONE
+            };
+            EGLConfig config;
+            EGLint configCount = 0;
+            if (!eglChooseConfig(m_display, configAttributes, &config, 1, &configCount) || configCount < 1)
+            {
+                return false;
+            }
+
+            const EGLint contextAttributes[] = { EGL_CONTEXT_CLIENT_VERSION, clientVersion, EGL_NONE };
+            m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttributes);
+            return m_context != EGL_NO_CONTEXT &&
+                eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context);
+        }
+
+        // Deletes every object of the context
+        void Destroy()
+        {
+            if (m_context != EGL_NO_CONTEXT)
+            {
+                eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                eglDestroyContext(m_display, m_context);
+                m_context = EGL_NO_CONTEXT;
+            }
+        }
+
+    private:
+        HeadlessContext(const HeadlessContext&);
+        HeadlessContext& operator=(const HeadlessContext&);
+
+        EGLDisplay m_display;
+        EGLContext m_context;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_HEADLESS_CONTEXT_H_
@@ -0,0 +1,302 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "KeyframeIndex.h"
+#include "TestUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    typedef std::vector<uint8_t> Bytes;
+
+    void AppendBE32(Bytes& out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back((uint8_t)(value >> shift));
+        }
+    }
+
+    Bytes MakeBox(const char* type, const Bytes& payload)
+    {
+        Bytes box;
+        AppendBE32(box, (uint32_t)(8 + payload.size()));
+        box.insert(box.end(), type, type + 4);
+        box.insert(box.end(), payload.begin(), payload.end());
+        return box;
+    }
+
+    Bytes Concat(const Bytes& a, const Bytes& b, const Bytes& c = Bytes(), const Bytes& d = Bytes())
+    {
+        Bytes out(a);
+        out.insert(out.end(), b.begin(), b.end());
+        out.insert(out.end(), c.begin(), c.end());
+        out.insert(out.end(), d.begin(), d.end());
+        return out;
+    }
+
+    // Full box table: version and flags, entry count, then the 32-bit values
+    Bytes MakeTable(const char* type, uint32_t entryCount, const std::vector<uint32_t>& values)
+    {
+        Bytes payload;
+        AppendBE32(payload, 0);
+        AppendBE32(payload, entryCount);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            AppendBE32(payload, values[i]);
+        }
+        return MakeBox(type, payload);
+    }
+
+    Bytes MakeHandler(const char* handlerType)
+    {
+        Bytes payload(8, 0);
+        payload.insert(payload.end(), handlerType, handlerType + 4);
+        payload.resize(payload.size() + 13, 0);
+        return MakeBox("hdlr", payload);
+    }
+
+    Bytes MakeMediaHeader(uint32_t timescale, uint32_t duration)
+    {
+        Bytes payload(12, 0);
+        AppendBE32(payload, timescale);
+        AppendBE32(payload, duration);
+        payload.resize(payload.size() + 4, 0);
+        return MakeBox("mdhd", payload);
+    }
+
+    Bytes MakeTrack(const char* handlerType, const Bytes& sampleTables, const Bytes& editList)
+    {
+        Bytes minf = MakeBox("minf", MakeBox("stbl", sampleTables));
+        Bytes mdia = MakeBox("mdia", Concat(MakeMediaHeader(600, 2400), MakeHandler(handlerType), minf));
+        return MakeBox("trak", Concat(MakeBox("tkhd", Bytes(84, 0)), editList, mdia));
+    }
+
+    // Video at timescale 600: 60 frames at 30 fps then 30 at 15 fps (4 s),
+    // B-frame composition offsets of 40 ticks but 80 for sample 31, an edit
+    // list starting the presentation at media time 40 after an empty edit,
+    // and keyframes at samples 1, 31, 61 and 76.
+    // Presentation times: frame n of the first run at 20 n, keyframes at
+    // 0, 640, 1200 and 1800 ticks.
+    Bytes MakeVideoTables(bool withSyncSamples = true, uint32_t lastSyncSample = 76)
+    {
+        std::vector<uint32_t> stts = { 60, 20, 30, 40 };
+        std::vector<uint32_t> ctts = { 30, 40, 1, 80, 59, 40 };
+        std::vector<uint32_t> stss = { 1, 31, 61, lastSyncSample };
+        Bytes tables = Concat(MakeBox("stsd", Bytes(8, 0)), MakeTable("stts", 2, stts), MakeTable("ctts", 3, ctts));
+        if (withSyncSamples)
+        {
+            tables = Concat(tables, MakeTable("stss", 4, stss));
+        }
+        return tables;
+    }
+
+    Bytes MakeEditList()
+    {
+        // Version 0 entries: segment duration, media time, media rate
+        std::vector<uint32_t> entries = { 60, 0xFFFFFFFF, 0x00010000, 2400, 40, 0x00010000 };
+        return MakeBox("edts", MakeTable("elst", 2, entries));
+    }
+
+    Bytes MakeMovie(const Bytes& videoTables)
+    {
+        // An audio track comes first, and must be skipped
+        std::vector<uint32_t> audioStts = { 100, 1024 };
+        Bytes audio = MakeTrack("soun", MakeTable("stts", 1, audioStts), Bytes());
+        Bytes video = MakeTrack("vide", videoTables, MakeEditList());
+
+        Bytes ftyp = MakeBox("ftyp", Bytes(16, 0));
+        Bytes moov = MakeBox("moov", Concat(MakeBox("mvhd", Bytes(100, 0)), audio, video));
+        return Concat(ftyp, moov, MakeBox("mdat", Bytes(64, 0)));
+    }
+
+    bool WriteWholeFile(const std::string& path, const Bytes& data)
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+        return fclose(file) == 0 && written;
+    }
+
+    const double TICK = 1.0 / 600.0;
+
+    void CheckQueries(const KeyframeIndex& index)
+    {
+        CHECK(index.GetFrameCount() == 90);
+        CHECK(index.GetKeyframeCount() == 4);
+        CHECK_NEAR(index.GetDuration(), 4.0, 1e-9);
+
+        CHECK_NEAR(index.FindKeyframe(-1.0), 0.0, 1e-9);
+        CHECK_NEAR(index.FindKeyframe(0.5), 0.0, 1e-9);
+        CHECK_NEAR(index.FindKeyframe(1.05), 0.0, 1e-9);
+        CHECK_NEAR(index.FindKeyframe(640 * TICK), 640 * TICK, 1e-9);
+        CHECK_NEAR(index.FindKeyframe(2.5), 2.0, 1e-9);
+        CHECK_NEAR(index.FindKeyframe(100.0), 3.0, 1e-9);
+
+        CHECK_NEAR(index.FindFrame(0.0), 0.0, 1e-9);
+        CHECK_NEAR(index.FindFrame(0.51), 0.5, 1e-9);
+        CHECK_NEAR(index.FindFrame(19 * TICK), 0.0, 1e-9);
+        CHECK_NEAR(index.FindFrame(20 * TICK), 20 * TICK, 1e-9);
+        CHECK_NEAR(index.FindFrame(2.05), 2.0, 1e-9);
+        CHECK_NEAR(index.FindFrame(1254 * TICK), 1240 * TICK, 1e-9);
+        CHECK_NEAR(index.FindFrame(100.0), 2360 * TICK, 1e-9);
+
+        SeekPlan plan = index.PlanSeek(0.4);
+        CHECK_NEAR(plan.keyframeTime, 0.0, 1e-9);
+        CHECK_NEAR(plan.targetTime, 0.4, 1e-9);
+        CHECK(!plan.snapped);
+
+        // 0.9 s of decoding before the frame is too much by default
+        plan = index.PlanSeek(0.9);
+        CHECK_NEAR(plan.keyframeTime, 0.0, 1e-9);
+        CHECK_NEAR(plan.targetTime, 0.0, 1e-9);
+        CHECK(plan.snapped);
+
+        plan = index.PlanSeek(0.9, 1.0);
+        CHECK_NEAR(plan.targetTime, 0.9, 1e-9);
+        CHECK(!plan.snapped);
+
+        plan = index.PlanSeek(3.21);
+        CHECK_NEAR(plan.keyframeTime, 3.0, 1e-9);
+        CHECK_NEAR(plan.targetTime, 3.2, 1e-9);
+        CHECK(!plan.snapped);
+
+        // A keyframe presented between frame starts is never preceded by the target
+        plan = index.PlanSeek(645 * TICK);
+        CHECK_NEAR(plan.keyframeTime, 640 * TICK, 1e-9);
+        CHECK_NEAR(plan.targetTime, 640 * TICK, 1e-9);
+    }
+
+    void TestParse()
+    {
+        Bytes movie = MakeMovie(MakeVideoTables());
+        KeyframeIndex index;
+        CHECK(index.Parse(movie.data(), movie.size()));
+        CheckQueries(index);
+
+        // Without a sync sample table every frame is a keyframe
+        Bytes allKeyframes = MakeMovie(MakeVideoTables(false));
+        KeyframeIndex allKeyframesIndex;
+        CHECK(allKeyframesIndex.Parse(allKeyframes.data(), allKeyframes.size()));
+        CHECK(allKeyframesIndex.GetKeyframeCount() == 90);
+        CHECK_NEAR(allKeyframesIndex.FindKeyframe(0.51), 0.5, 1e-9);
+    }
+
+    void TestParseRejects()
+    {
+        KeyframeIndex index;
+        CHECK(!index.Parse(nullptr, 0));
+
+        Bytes badSync = MakeMovie(MakeVideoTables(true, 91));
+        CHECK(!index.Parse(badSync.data(), badSync.size()));
+        Bytes unorderedSync = MakeMovie(MakeVideoTables(true, 61));
+        CHECK(!index.Parse(unorderedSync.data(), unorderedSync.size()));
+
+        std::vector<uint32_t> audioStts = { 100, 1024 };
+        Bytes audioOnly = MakeBox("moov", MakeTrack("soun", MakeTable("stts", 1, audioStts), Bytes()));
+        CHECK(!index.Parse(audioOnly.data(), audioOnly.size()));
+
+        // Truncated files are rejected without reading past their end (see SANITIZE)
+        Bytes movie = MakeMovie(MakeVideoTables());
+        int accepted = 0;
+        for (size_t size = 0; size < movie.size(); ++size)
+        {
+            Bytes truncated(movie.begin(), movie.begin() + size);
+            KeyframeIndex truncatedIndex;
+            accepted += truncatedIndex.Parse(truncated.data(), truncated.size()) ? 1 : 0;
+        }
+
+        // Only the cuts in the trailing mdat still hold the whole moov
+        CHECK(accepted == 72);
+    }
+
+    void TestSidecar()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::string sidecarPath = directory.GetPath() + "/clip.keyframes";
+        KeyframeIndex::Source source = { 123456, 789 };
+
+        Bytes movie = MakeMovie(MakeVideoTables());
+        {
+            KeyframeIndex index;
+            CHECK(index.Parse(movie.data(), movie.size()));
+            CHECK(index.Save(sidecarPath, source));
+        }
+
+        KeyframeIndex loaded;
+        CHECK(loaded.Load(sidecarPath, source));
+        CheckQueries(loaded);
+
+        // Another version of the video
+        KeyframeIndex::Source resized = { 123457, 789 };
+        KeyframeIndex::Source modified = { 123456, 790 };
+        KeyframeIndex rejected;
+        CHECK(!rejected.Load(sidecarPath, resized));
+        CHECK(!rejected.Load(sidecarPath, modified));
+        CHECK(!rejected.Load(directory.GetPath() + "/missing.keyframes", source));
+
+        KeyframeIndex empty;
+        CHECK(!empty.Save(directory.GetPath() + "/empty.keyframes", source));
+
+        // A damaged sidecar
+        Bytes truncated(64, 0);
+        CHECK(WriteWholeFile(sidecarPath, truncated));
+        CHECK(!rejected.Load(sidecarPath, source));
+    }
+
+    void TestLoadOrBuild()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::string videoPath = directory.GetPath() + "/clip.mp4";
+        std::string cacheDirectory = directory.GetPath() + "/cache";
+        KeyframeIndex::Source source = { 1000, 1 };
+
+        CHECK(!KeyframeIndex::LoadOrBuild(videoPath, source, cacheDirectory));
+
+        CHECK(WriteWholeFile(videoPath, MakeMovie(MakeVideoTables())));
+        std::shared_ptr<KeyframeIndex> built = KeyframeIndex::LoadOrBuild(videoPath, source, cacheDirectory);
+        CHECK(built);
+        if (built)
+        {
+            CheckQueries(*built);
+        }
+
+        // The sidecar answers without the video while the source matches
+        remove(videoPath.c_str());
+        std::shared_ptr<KeyframeIndex> loaded = KeyframeIndex::LoadOrBuild(videoPath, source, cacheDirectory);
+        CHECK(loaded);
+        if (loaded)
+        {
+            CheckQueries(*loaded);
+        }
+        KeyframeIndex::Source changed = { 1000, 2 };
+        CHECK(!KeyframeIndex::LoadOrBuild(videoPath, changed, cacheDirectory));
+
+        // A changed video is parsed again, and its sidecar replaced
+        CHECK(WriteWholeFile(videoPath, MakeMovie(MakeVideoTables(false))));
+        std::shared_ptr<KeyframeIndex> rebuilt = KeyframeIndex::LoadOrBuild(videoPath, changed, cacheDirectory);
+        CHECK(rebuilt && rebuilt->GetKeyframeCount() == 90);
+        remove(videoPath.c_str());
+        rebuilt = KeyframeIndex::LoadOrBuild(videoPath, changed, cacheDirectory);
+        CHECK(rebuilt && rebuilt->GetKeyframeCount() == 90);
+    }
+}
+
+int main()
+{
+    TestParse();
+    TestParseRejects();
+    TestSidecar();
+    TestLoadOrBuild();
+    return VuforiaMediaTest::TestResult("KeyframeIndexTest");
+}
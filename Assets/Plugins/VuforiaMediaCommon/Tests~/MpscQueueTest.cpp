@@ -0,0 +1,126 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "MpscQueue.h"
+#include "TestUtils.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // A command as the players queue them, with a string long enough to live
+    // on the heap so that moves and frees are exercised
+    struct Command
+    {
+        int producer;
+        int sequence;
+        std::string payload;
+    };
+
+    void TestFifo()
+    {
+        MpscQueue<int> queue;
+        int value = -1;
+        CHECK(queue.IsEmpty());
+        CHECK(!queue.Pop(value));
+
+        for (int i = 0; i < 10; ++i)
+        {
+            queue.Push(i);
+        }
+        CHECK(!queue.IsEmpty());
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(queue.Pop(value));
+            CHECK(value == i);
+        }
+        CHECK(!queue.Pop(value));
+        CHECK(queue.IsEmpty());
+    }
+
+    // Producers racing one consumer: every value arrives once, in the order
+    // its producer pushed it
+    void TestStress(int producerCount, int pushesPerProducer)
+    {
+        MpscQueue<Command> queue;
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producerCount; ++p)
+        {
+            producers.push_back(std::thread([&, p]()
+            {
+                for (int i = 0; i < pushesPerProducer; ++i)
+                {
+                    Command command;
+                    command.producer = p;
+                    command.sequence = i;
+                    if (i % 7 == 0)
+                    {
+                        command.payload = "a payload too long for the small string buffer";
+                    }
+                    queue.Push(command);
+                }
+            }));
+        }
+
+        std::vector<int> nextSequence(producerCount, 0);
+        long outOfOrder = 0;
+        long badPayloads = 0;
+        long total = 0;
+        const long expected = (long)producerCount * pushesPerProducer;
+        while (total < expected)
+        {
+            Command command;
+            if (!queue.Pop(command))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (command.sequence != nextSequence[command.producer])
+            {
+                ++outOfOrder;
+            }
+            if ((command.sequence % 7 == 0) == command.payload.empty())
+            {
+                ++badPayloads;
+            }
+            nextSequence[command.producer] = command.sequence + 1;
+            ++total;
+        }
+
+        for (size_t p = 0; p < producers.size(); ++p)
+        {
+            producers[p].join();
+        }
+
+        Command extra;
+        CHECK(outOfOrder == 0);
+        CHECK(badPayloads == 0);
+        CHECK(!queue.Pop(extra));
+        CHECK(queue.IsEmpty());
+
+        // Values left in the queue are freed with it
+        queue.Push(extra);
+        queue.Push(extra);
+    }
+}
+
+int main()
+{
+    TestFifo();
+    for (int round = 0; round < 3; ++round)
+    {
+        TestStress(8, 100000);
+    }
+    TestStress(1, 100000);
+    return VuforiaMediaTest::TestResult("MpscQueueTest");
+}
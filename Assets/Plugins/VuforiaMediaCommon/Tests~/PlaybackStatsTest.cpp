@@ -0,0 +1,184 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "PlaybackStats.h"
+#include "TestUtils.h"
+
+#include <thread>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const double FRAME_30 = 1.0 / 30.0;
+
+    void TestLateHistogram()
+    {
+        for (int bucket = 0; bucket < PLAYBACK_LATE_BUCKET_COUNT - 1; ++bucket)
+        {
+            CHECK(PlaybackStatsCounters::GetLateBucketLimit(bucket) > 0.0);
+            if (bucket > 0)
+            {
+                CHECK(PlaybackStatsCounters::GetLateBucketLimit(bucket) >
+                    PlaybackStatsCounters::GetLateBucketLimit(bucket - 1));
+            }
+        }
+        CHECK(PlaybackStatsCounters::GetLateBucketLimit(PLAYBACK_LATE_BUCKET_COUNT - 1) < 0.0);
+        CHECK(PlaybackStatsCounters::GetLateBucketLimit(-1) < 0.0);
+
+        // Each bucket holds the frames up to its limit, early ones go first
+        PlaybackStatsCounters counters;
+        double displayTime = 0.0;
+        counters.AddPresented(-0.010, displayTime);
+        for (int bucket = 0; bucket < PLAYBACK_LATE_BUCKET_COUNT - 1; ++bucket)
+        {
+            displayTime += FRAME_30;
+            counters.AddPresented(PlaybackStatsCounters::GetLateBucketLimit(bucket), displayTime);
+        }
+        displayTime += FRAME_30;
+        counters.AddPresented(2.0, displayTime);
+
+        PlaybackStats stats = counters.GetSnapshot();
+        CHECK(stats.presented == PLAYBACK_LATE_BUCKET_COUNT + 1);
+        CHECK(stats.late[0] == 2);
+        for (int bucket = 1; bucket < PLAYBACK_LATE_BUCKET_COUNT; ++bucket)
+        {
+            CHECK(stats.late[bucket] == 1);
+        }
+    }
+
+    void TestStalls()
+    {
+        PlaybackStatsCounters counters;
+        double displayTime = 0.0;
+        for (int i = 0; i < 100; ++i)
+        {
+            counters.AddDecoded(1);
+            counters.AddPresented(i % 4 == 0 ? 0.002 : 0.010, displayTime);
+            displayTime += FRAME_30;
+        }
+        PlaybackStats stats = counters.GetSnapshot();
+        CHECK(stats.decoded == 100);
+        CHECK(stats.presented == 100);
+        CHECK(stats.stalls == 0);
+        CHECK(stats.late[0] == 25);
+        CHECK(stats.late[2] == 75);
+
+        // The video freezes for half a second
+        displayTime += 0.5;
+        counters.AddPresented(0.5, displayTime);
+        displayTime += FRAME_30;
+        counters.AddPresented(0.0, displayTime);
+        stats = counters.GetSnapshot();
+        CHECK(stats.stalls == 1);
+        CHECK_NEAR(stats.stallTime, 0.5 + FRAME_30, 1e-4);
+        CHECK(stats.late[PLAYBACK_LATE_BUCKET_COUNT - 1] == 1);
+
+        // Pausing then resuming is not a stall
+        displayTime += 10.0;
+        counters.OnPlaybackStarted();
+        counters.AddPresented(0.0, displayTime);
+        displayTime += FRAME_30;
+        counters.AddPresented(0.0, displayTime);
+        CHECK(counters.GetSnapshot().stalls == 1);
+
+        // 24 fps frames, with one render hitch of 80 ms, are not a stall either
+        for (int i = 0; i < 50; ++i)
+        {
+            counters.AddPresented(0.0, displayTime);
+            displayTime += (i == 20) ? 0.08 : 1.0 / 24.0;
+        }
+        CHECK(counters.GetSnapshot().stalls == 1);
+
+        // Reset starts the stall detection over
+        counters.Reset();
+        displayTime += 5.0;
+        counters.AddPresented(0.0, displayTime);
+        stats = counters.GetSnapshot();
+        CHECK(stats.stalls == 0);
+        CHECK(stats.stallTime == 0.0f);
+    }
+
+    void TestCopyTimeAndReset()
+    {
+        PlaybackStatsCounters counters;
+        counters.AddCopyTime(0.001);
+        counters.AddCopyTime(0.003);
+        counters.AddCopyTime(0.002);
+        counters.AddCopyTime(-0.001);
+        counters.AddDropped(2);
+
+        PlaybackStats stats = counters.GetSnapshot();
+        CHECK_NEAR(stats.copyTime, 0.006, 1e-6);
+        CHECK_NEAR(stats.maxCopyTime, 0.003, 1e-6);
+        CHECK(stats.dropped == 2);
+
+        counters.AddPresented(0.0, 0.0);
+        counters.Reset();
+        stats = counters.GetSnapshot();
+        CHECK(stats.decoded == 0 && stats.presented == 0 && stats.dropped == 0 && stats.stalls == 0);
+        CHECK(stats.late[0] == 0);
+        CHECK(stats.copyTime == 0.0f && stats.maxCopyTime == 0.0f);
+    }
+
+    // The decoder and renderer count while another thread takes snapshots
+    void TestConcurrentCounting()
+    {
+        PlaybackStatsCounters counters;
+        std::thread decoder([&]()
+        {
+            for (int i = 0; i < 200000; ++i)
+            {
+                counters.AddDecoded(1);
+            }
+        });
+        std::thread renderer([&]()
+        {
+            double displayTime = 0.0;
+            for (int i = 0; i < 100000; ++i)
+            {
+                counters.AddPresented(0.001, displayTime);
+                counters.AddDropped(1);
+                counters.AddCopyTime(1e-6);
+                displayTime += 1.0 / 60.0;
+            }
+        });
+
+        uint32_t lastPresented = 0;
+        uint32_t lastDecoded = 0;
+        int wentBack = 0;
+        for (int i = 0; i < 10000; ++i)
+        {
+            PlaybackStats stats = counters.GetSnapshot();
+            if (stats.presented < lastPresented || stats.decoded < lastDecoded)
+            {
+                ++wentBack;
+            }
+            lastPresented = stats.presented;
+            lastDecoded = stats.decoded;
+        }
+        decoder.join();
+        renderer.join();
+
+        PlaybackStats stats = counters.GetSnapshot();
+        CHECK(wentBack == 0);
+        CHECK(stats.decoded == 200000);
+        CHECK(stats.presented == 100000);
+        CHECK(stats.dropped == 100000);
+        CHECK(stats.late[0] == 100000);
+        CHECK(stats.stalls == 0);
+        CHECK_NEAR(stats.copyTime, 0.1, 1e-3);
+    }
+}
+
+int main()
+{
+    TestLateHistogram();
+    TestStalls();
+    TestCopyTimeAndReset();
+    TestConcurrentCounting();
+    return VuforiaMediaTest::TestResult("PlaybackStatsTest");
+}
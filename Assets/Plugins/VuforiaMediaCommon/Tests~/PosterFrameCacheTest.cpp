@@ -0,0 +1,323 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "PosterFrameCache.h"
+#include "TestUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    enum Pattern
+    {
+        PATTERN_GRADIENT,
+        PATTERN_SOLID,
+        PATTERN_NOISE
+    };
+
+    std::shared_ptr<PosterFrame> MakeFrame(int width, int height, Pattern pattern, uint32_t seed = 1)
+    {
+        std::shared_ptr<PosterFrame> frame = std::make_shared<PosterFrame>();
+        frame->width = width;
+        frame->height = height;
+        frame->pixels.resize((size_t)width * height * 4);
+        uint32_t random = seed;
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t* pixel = &frame->pixels[((size_t)y * width + x) * 4];
+                for (int c = 0; c < 4; ++c)
+                {
+                    random = random * 1664525u + 1013904223u;
+                    switch (pattern)
+                    {
+                    case PATTERN_GRADIENT: pixel[c] = (uint8_t)(x * (c + 1) + y + seed); break;
+                    case PATTERN_SOLID: pixel[c] = (uint8_t)(seed + c * 40); break;
+                    case PATTERN_NOISE: pixel[c] = (uint8_t)(random >> 24); break;
+                    }
+                }
+            }
+        }
+        return frame;
+    }
+
+    PosterFrameKey MakeKey(const std::string& path, int64_t modifiedTime = 1000, float position = 0.0f)
+    {
+        PosterFrameKey key;
+        key.path = path;
+        key.modifiedTime = modifiedTime;
+        key.position = position;
+        return key;
+    }
+
+    bool ReadWholeFile(const std::string& path, std::vector<uint8_t>& data)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        data.clear();
+        uint8_t buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + read);
+        }
+        fclose(file);
+        return true;
+    }
+
+    bool WriteWholeFile(const std::string& path, const std::vector<uint8_t>& data)
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = data.empty() || fwrite(&data[0], 1, data.size(), file) == data.size();
+        return fclose(file) == 0 && written;
+    }
+
+    bool RoundTrips(const PosterFrame& frame, size_t* encodedSize = nullptr)
+    {
+        std::vector<uint8_t> encoded;
+        PosterFrameCache::Encode(frame, encoded);
+        if (encodedSize != nullptr)
+        {
+            *encodedSize = encoded.size();
+        }
+
+        PosterFrame decoded;
+        return PosterFrameCache::Decode(encoded.data(), encoded.size(), frame.width, frame.height, decoded) &&
+               decoded.width == frame.width && decoded.height == frame.height &&
+               decoded.pixels == frame.pixels;
+    }
+
+    void TestRoundTrip()
+    {
+        // Odd sizes, literal runs past the 15 + 255 length extension, long matches
+        CHECK(RoundTrips(*MakeFrame(1, 1, PATTERN_NOISE)));
+        CHECK(RoundTrips(*MakeFrame(3, 2, PATTERN_GRADIENT)));
+        CHECK(RoundTrips(*MakeFrame(641, 359, PATTERN_GRADIENT)));
+        CHECK(RoundTrips(*MakeFrame(640, 360, PATTERN_NOISE)));
+        CHECK(RoundTrips(*MakeFrame(67, 33, PATTERN_NOISE, 7)));
+
+        // The delta filter turns gradients and flat areas into repeats
+        size_t encodedSize = 0;
+        CHECK(RoundTrips(*MakeFrame(640, 360, PATTERN_SOLID), &encodedSize));
+        CHECK(encodedSize < 640 * 360 * 4 / 100);
+        CHECK(RoundTrips(*MakeFrame(640, 360, PATTERN_GRADIENT), &encodedSize));
+        CHECK(encodedSize < 640 * 360 * 4 / 10);
+    }
+
+    void TestDecodeRejects()
+    {
+        std::shared_ptr<PosterFrame> frame = MakeFrame(31, 17, PATTERN_GRADIENT);
+        std::vector<uint8_t> encoded;
+        PosterFrameCache::Encode(*frame, encoded);
+
+        PosterFrame decoded;
+        CHECK(!PosterFrameCache::Decode(encoded.data(), encoded.size(), 31, 18, decoded));
+        CHECK(!PosterFrameCache::Decode(encoded.data(), encoded.size(), 30, 17, decoded));
+        CHECK(!PosterFrameCache::Decode(encoded.data(), encoded.size(), 0, 17, decoded));
+        CHECK(!PosterFrameCache::Decode(encoded.data(), encoded.size(), 9000, 1, decoded));
+        CHECK(!PosterFrameCache::Decode(encoded.data(), 0, 31, 17, decoded));
+
+        // Every truncation is detected
+        int acceptedTruncations = 0;
+        for (size_t size = 0; size < encoded.size(); ++size)
+        {
+            std::vector<uint8_t> truncated(encoded.begin(), encoded.begin() + size);
+            acceptedTruncations += PosterFrameCache::Decode(truncated.data(), truncated.size(), 31, 17, decoded) ? 1 : 0;
+        }
+        CHECK(acceptedTruncations == 0);
+
+        // Corrupted bytes either fail to decode or decode to a frame of the
+        // right size; they never read or write out of bounds (see SANITIZE)
+        uint32_t random = 12345;
+        for (int i = 0; i < 2000; ++i)
+        {
+            std::vector<uint8_t> corrupted = encoded;
+            for (int j = 0; j < 1 + i % 4; ++j)
+            {
+                random = random * 1664525u + 1013904223u;
+                corrupted[(random >> 8) % corrupted.size()] ^= (uint8_t)(1 + (random >> 24) % 255);
+            }
+            if (PosterFrameCache::Decode(corrupted.data(), corrupted.size(), 31, 17, decoded))
+            {
+                CHECK(decoded.pixels.size() == 31 * 17 * 4);
+            }
+        }
+    }
+
+    void TestStoreAndFind()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::string cacheDirectory = directory.GetPath() + "/posters";
+        std::shared_ptr<PosterFrame> frame = MakeFrame(64, 36, PATTERN_GRADIENT);
+        PosterFrameKey key = MakeKey("videos/clip.mp4");
+
+        {
+            PosterFrameCache cache(cacheDirectory);
+            CHECK(!cache.Find(key));
+            CHECK(cache.Store(key, frame));
+            CHECK(cache.Find(key) == frame);
+        }
+
+        std::vector<uint8_t> file;
+        CHECK(ReadWholeFile(cacheDirectory + "/" + key.GetFileName(), file));
+        CHECK(file.size() > 24 && memcmp(file.data(), "VMPF", 4) == 0);
+
+        // A new cache reads it back from the file
+        PosterFrameCache cache(cacheDirectory);
+        std::shared_ptr<const PosterFrame> found = cache.Find(key);
+        CHECK(found && found != frame);
+        CHECK(found && found->width == 64 && found->height == 36 && found->pixels == frame->pixels);
+        CHECK(cache.Find(key) == found);
+
+        // Positions are compared to the millisecond
+        CHECK(cache.Find(MakeKey("videos/clip.mp4", 1000, 0.0002f)) == found);
+        CHECK(!cache.Find(MakeKey("videos/clip.mp4", 1000, 0.002f)));
+        CHECK(!cache.Find(MakeKey("videos/clip.mp4", 1001)));
+        CHECK(!cache.Find(MakeKey("videos/other.mp4")));
+
+        // Invalid frames are not stored
+        std::shared_ptr<PosterFrame> invalid = MakeFrame(4, 4, PATTERN_SOLID);
+        invalid->pixels.pop_back();
+        CHECK(!cache.Store(MakeKey("invalid.mp4"), invalid));
+        CHECK(!cache.Store(MakeKey("invalid.mp4"), std::shared_ptr<PosterFrame>()));
+        CHECK(!cache.Find(MakeKey("invalid.mp4")));
+    }
+
+    void TestDamagedFiles()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::shared_ptr<PosterFrame> frame = MakeFrame(40, 30, PATTERN_GRADIENT);
+        PosterFrameKey key = MakeKey("clip.mp4");
+        std::string path = directory.GetPath() + "/" + key.GetFileName();
+
+        {
+            PosterFrameCache cache(directory.GetPath());
+            CHECK(cache.Store(key, frame));
+        }
+        std::vector<uint8_t> original;
+        CHECK(ReadWholeFile(path, original));
+        CHECK(!original.empty());
+
+        // Each damaged file is read by a new cache, so that memory does not hide it
+        size_t cuts[] = { 0, 3, 23, 24, 30, original.size() / 2, original.size() - 1 };
+        for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); ++i)
+        {
+            CHECK(WriteWholeFile(path, std::vector<uint8_t>(original.begin(), original.begin() + cuts[i])));
+            CHECK(!PosterFrameCache(directory.GetPath()).Find(key));
+        }
+
+        std::vector<uint8_t> damaged = original;
+        damaged.push_back(0);
+        CHECK(WriteWholeFile(path, damaged));
+        CHECK(!PosterFrameCache(directory.GetPath()).Find(key));
+
+        // Header fields: magic, version, width, height, key length, encoded size
+        for (size_t offset = 0; offset < 24; offset += 4)
+        {
+            damaged = original;
+            damaged[offset] ^= 0x01;
+            CHECK(WriteWholeFile(path, damaged));
+            CHECK(!PosterFrameCache(directory.GetPath()).Find(key));
+        }
+
+        CHECK(WriteWholeFile(path, original));
+        std::shared_ptr<const PosterFrame> found = PosterFrameCache(directory.GetPath()).Find(key);
+        CHECK(found && found->pixels == frame->pixels);
+    }
+
+    // The file name is a hash of the key; the file holds the full key
+    void TestKeyMismatch()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        PosterFrameKey key = MakeKey("first.mp4");
+        PosterFrameKey otherKey = MakeKey("second.mp4");
+        {
+            PosterFrameCache cache(directory.GetPath());
+            CHECK(cache.Store(key, MakeFrame(8, 8, PATTERN_NOISE)));
+        }
+
+        // As if the names of the two keys collided
+        std::vector<uint8_t> file;
+        CHECK(ReadWholeFile(directory.GetPath() + "/" + key.GetFileName(), file));
+        CHECK(WriteWholeFile(directory.GetPath() + "/" + otherKey.GetFileName(), file));
+
+        PosterFrameCache cache(directory.GetPath());
+        CHECK(!cache.Find(otherKey));
+        CHECK(cache.Find(key));
+    }
+
+    void TestMemoryLimit()
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        const size_t FRAME_BYTES = 16 * 16 * 4;
+        PosterFrameCache cache(directory.GetPath(), 3 * FRAME_BYTES);
+
+        PosterFrameKey keys[5];
+        for (int i = 0; i < 5; ++i)
+        {
+            char path[32];
+            snprintf(path, sizeof(path), "clip%d.mp4", i);
+            keys[i] = MakeKey(path);
+        }
+
+        // Without the files only the frames kept in memory are found
+        CHECK(cache.Store(keys[0], MakeFrame(16, 16, PATTERN_SOLID, 0)));
+        CHECK(cache.Store(keys[1], MakeFrame(16, 16, PATTERN_SOLID, 1)));
+        CHECK(cache.Store(keys[2], MakeFrame(16, 16, PATTERN_SOLID, 2)));
+        for (int i = 0; i < 5; ++i)
+        {
+            remove((directory.GetPath() + "/" + keys[i].GetFileName()).c_str());
+        }
+        CHECK(cache.Find(keys[0]) && cache.Find(keys[1]) && cache.Find(keys[2]));
+
+        // keys[0] was used last: keys[1] is evicted
+        CHECK(cache.Find(keys[0]));
+        CHECK(cache.Store(keys[3], MakeFrame(16, 16, PATTERN_SOLID, 3)));
+        remove((directory.GetPath() + "/" + keys[3].GetFileName()).c_str());
+        CHECK(cache.Find(keys[0]));
+        CHECK(!cache.Find(keys[1]));
+        CHECK(cache.Find(keys[2]));
+        CHECK(cache.Find(keys[3]));
+
+        // Storing a key again replaces its frame without growing
+        std::shared_ptr<PosterFrame> replacement = MakeFrame(16, 16, PATTERN_SOLID, 9);
+        CHECK(cache.Store(keys[3], replacement));
+        remove((directory.GetPath() + "/" + keys[3].GetFileName()).c_str());
+        CHECK(cache.Find(keys[3]) == replacement);
+        CHECK(cache.Find(keys[0]) && cache.Find(keys[2]));
+
+        // A frame larger than the budget is written but not kept
+        CHECK(cache.Store(keys[4], MakeFrame(32, 32, PATTERN_SOLID, 4)));
+        CHECK(cache.Find(keys[0]) && cache.Find(keys[2]) && cache.Find(keys[3]));
+        remove((directory.GetPath() + "/" + keys[4].GetFileName()).c_str());
+        CHECK(!cache.Find(keys[4]));
+
+        cache.ClearMemory();
+        CHECK(!cache.Find(keys[0]));
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestDecodeRejects();
+    TestStoreAndFind();
+    TestDamagedFiles();
+    TestKeyMismatch();
+    TestMemoryLimit();
+    return VuforiaMediaTest::TestResult("PosterFrameCacheTest");
+}
@@ -0,0 +1,222 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "PlayerStatusBlock.h"
+#include "SeqLock.h"
+#include "TestUtils.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const int WRITES_PER_WRITER = 200000;
+
+    // Every word is derived from the same counter, so a copy mixing two
+    // writes shows as words that disagree
+    struct Sample
+    {
+        uint32_t words[8];
+    };
+
+    Sample MakeSample(uint32_t counter)
+    {
+        Sample sample;
+        for (int i = 0; i < 8; ++i)
+        {
+            sample.words[i] = counter * (uint32_t)(i + 1) ^ (0x9e3779b9u >> i);
+        }
+        return sample;
+    }
+
+    bool IsConsistent(const Sample& sample)
+    {
+        Sample expected = MakeSample(sample.words[0] ^ 0x9e3779b9u);
+        for (int i = 0; i < 8; ++i)
+        {
+            if (sample.words[i] != expected.words[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t GetCounter(const Sample& sample)
+    {
+        return sample.words[0] ^ 0x9e3779b9u;
+    }
+
+    void TestReadBack()
+    {
+        SeqLock<Sample> seqLock;
+        CHECK(seqLock.GetSequence() == 0);
+
+        seqLock.Write(MakeSample(42));
+        CHECK(seqLock.GetSequence() == 2);
+
+        Sample sample;
+        CHECK(seqLock.TryRead(sample));
+        CHECK(IsConsistent(sample));
+        CHECK(GetCounter(sample) == 42);
+    }
+
+    // Readers racing writers never see a torn value
+    void TestNoTornReads(int writerCount, int readerCount)
+    {
+        SeqLock<Sample> seqLock;
+        seqLock.Write(MakeSample(0));
+
+        std::atomic<bool> writing(true);
+        std::atomic<long> tornReads(0);
+        std::atomic<long> backwardReads(0);
+        std::atomic<long> reads(0);
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < readerCount; ++r)
+        {
+            readers.push_back(std::thread([&]()
+            {
+                uint32_t lastCounter = 0;
+                long readCount = 0;
+                while (writing.load())
+                {
+                    Sample sample = seqLock.Read();
+                    ++readCount;
+                    if (!IsConsistent(sample))
+                    {
+                        ++tornReads;
+                    }
+                    else if (writerCount == 1 && GetCounter(sample) < lastCounter)
+                    {
+                        // With one writer, the values only move forward
+                        ++backwardReads;
+                    }
+                    lastCounter = GetCounter(sample);
+                }
+                reads += readCount;
+            }));
+        }
+
+        std::vector<std::thread> writers;
+        for (int w = 0; w < writerCount; ++w)
+        {
+            writers.push_back(std::thread([&, w]()
+            {
+                for (int i = 1; i <= WRITES_PER_WRITER; ++i)
+                {
+                    seqLock.Write(MakeSample((uint32_t)(i * writerCount + w)));
+                }
+            }));
+        }
+
+        for (size_t w = 0; w < writers.size(); ++w)
+        {
+            writers[w].join();
+        }
+        writing = false;
+        for (size_t r = 0; r < readers.size(); ++r)
+        {
+            readers[r].join();
+        }
+
+        CHECK(tornReads == 0);
+        CHECK(backwardReads == 0);
+        CHECK(reads > 0);
+        CHECK(seqLock.GetSequence() == 2 + 2 * (uint32_t)(WRITES_PER_WRITER * writerCount));
+    }
+
+    void TestStatusBlockSlots()
+    {
+        PlayerStatusBlock& statusBlock = PlayerStatusBlock::Instance();
+        CHECK(statusBlock.GetSlotStride() == CACHE_LINE_SIZE);
+
+        int first = statusBlock.AcquireSlot();
+        int second = statusBlock.AcquireSlot();
+        CHECK(first >= 0 && second >= 0 && first != second);
+
+        // A released slot reads as not ready until it is published again
+        PlayerStatus status = PlayerStatus();
+        status.state = 3;
+        statusBlock.Publish(first, status);
+        statusBlock.ReleaseSlot(first);
+        int reused = statusBlock.AcquireSlot();
+        CHECK(reused == first);
+        CHECK(statusBlock.Read(reused, status));
+        CHECK(status.state == PLAYER_STATUS_NOT_READY);
+
+        statusBlock.ReleaseSlot(reused);
+        statusBlock.ReleaseSlot(second);
+    }
+
+    // The status of a player published from several threads reads whole
+    void TestStatusBlockConcurrentPublish()
+    {
+        PlayerStatusBlock& statusBlock = PlayerStatusBlock::Instance();
+        int slot = statusBlock.AcquireSlot();
+        CHECK(slot >= 0);
+
+        std::atomic<bool> publishing(true);
+        std::atomic<long> tornReads(0);
+
+        std::thread reader([&]()
+        {
+            while (publishing.load())
+            {
+                PlayerStatus status;
+                if (statusBlock.Read(slot, status) &&
+                    (status.frameCounter != (uint32_t)status.width ||
+                     status.width != status.height ||
+                     status.position != status.duration))
+                {
+                    ++tornReads;
+                }
+            }
+        });
+
+        std::vector<std::thread> publishers;
+        for (int p = 0; p < 3; ++p)
+        {
+            publishers.push_back(std::thread([&, p]()
+            {
+                for (int i = 0; i < WRITES_PER_WRITER / 2; ++i)
+                {
+                    PlayerStatus status = PlayerStatus();
+                    status.state = p;
+                    status.position = (float)(i % 1000);
+                    status.duration = status.position;
+                    status.frameCounter = (uint32_t)i;
+                    status.width = i;
+                    status.height = i;
+                    statusBlock.Publish(slot, status);
+                }
+            }));
+        }
+
+        for (size_t p = 0; p < publishers.size(); ++p)
+        {
+            publishers[p].join();
+        }
+        publishing = false;
+        reader.join();
+
+        CHECK(tornReads == 0);
+        statusBlock.ReleaseSlot(slot);
+    }
+}
+
+int main()
+{
+    TestReadBack();
+    TestNoTornReads(1, 2);
+    TestNoTornReads(2, 2);
+    TestStatusBlockSlots();
+    TestStatusBlockConcurrentPublish();
+    return VuforiaMediaTest::TestResult("SeqLockTest");
+}
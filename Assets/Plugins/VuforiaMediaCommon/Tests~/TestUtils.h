@@ -0,0 +1,97 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_TEST_UTILS_H_
+#define _VUFORIA_MEDIA_TEST_UTILS_H_
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+
+namespace VuforiaMediaTest
+{
+    inline int& FailureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    // Exit status of a test program
+    inline int TestResult(const char* name)
+    {
+        if (FailureCount() == 0)
+        {
+            printf("%s: passed\n", name);
+            return 0;
+        }
+        printf("%s: %d check(s) failed\n", name, FailureCount());
+        return 1;
+    }
+
+    // Fresh directory under /tmp, removed with its contents on destruction
+    class TempDirectory
+    {
+    public:
+        TempDirectory()
+        {
+            char path[] = "/tmp/VuforiaMediaTest.XXXXXX";
+            if (mkdtemp(path) != nullptr)
+            {
+                m_path = path;
+            }
+        }
+
+        ~TempDirectory()
+        {
+            if (!m_path.empty())
+            {
+                nftw(m_path.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+            }
+        }
+
+        const std::string& GetPath() const { return m_path; }
+
+    private:
+        TempDirectory(const TempDirectory&);
+        TempDirectory& operator=(const TempDirectory&);
+
+        static int RemoveEntry(const char* path, const struct stat*, int, struct FTW*)
+        {
+            remove(path);
+            return 0;
+        }
+
+        std::string m_path;
+    };
+}
+
+// Reports a failed condition and carries on, so that one run lists them all
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++VuforiaMediaTest::FailureCount(); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance) \
+    do \
+    { \
+        double checkValue = (double)(value); \
+        double checkExpected = (double)(expected); \
+        if (checkValue < checkExpected - (tolerance) || checkValue > checkExpected + (tolerance)) \
+        { \
+            printf("%s:%d: check failed: %s = %g, expected %g\n", __FILE__, __LINE__, #value, \
+                checkValue, checkExpected); \
+            ++VuforiaMediaTest::FailureCount(); \
+        } \
+    } while (0)
+
+#endif // _VUFORIA_MEDIA_TEST_UTILS_H_
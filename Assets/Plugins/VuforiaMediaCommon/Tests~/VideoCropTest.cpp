@@ -0,0 +1,95 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "VideoCrop.h"
+#include "TestUtils.h"
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    VideoCrop MakeCrop(float x, float y, float width, float height)
+    {
+        VideoCrop crop = { x, y, width, height };
+        return crop;
+    }
+
+    void TestClamp()
+    {
+        VideoCrop crop = MakeCrop(0.25f, 0.5f, 0.5f, 0.25f);
+        CHECK(ClampVideoCrop(crop));
+        CHECK_NEAR(crop.x, 0.25, 1e-6);
+        CHECK_NEAR(crop.y, 0.5, 1e-6);
+        CHECK_NEAR(crop.width, 0.5, 1e-6);
+        CHECK_NEAR(crop.height, 0.25, 1e-6);
+
+        // Partly outside the frame: only the part inside is kept
+        crop = MakeCrop(-0.25f, 0.75f, 0.5f, 0.5f);
+        CHECK(ClampVideoCrop(crop));
+        CHECK_NEAR(crop.x, 0.0, 1e-6);
+        CHECK_NEAR(crop.y, 0.75, 1e-6);
+        CHECK_NEAR(crop.width, 0.25, 1e-6);
+        CHECK_NEAR(crop.height, 0.25, 1e-6);
+
+        crop = MakeCrop(-1.0f, -1.0f, 3.0f, 3.0f);
+        CHECK(ClampVideoCrop(crop));
+        CHECK(IsFullFrameCrop(crop));
+
+        // Nothing left: the crop is rejected and left as it was
+        crop = MakeCrop(1.0f, 0.0f, 0.5f, 1.0f);
+        CHECK(!ClampVideoCrop(crop));
+        CHECK_NEAR(crop.x, 1.0, 1e-6);
+        crop = MakeCrop(0.5f, 0.5f, 0.0f, 0.5f);
+        CHECK(!ClampVideoCrop(crop));
+        crop = MakeCrop(0.5f, 0.5f, 0.25f, -0.25f);
+        CHECK(!ClampVideoCrop(crop));
+    }
+
+    void TestFullFrame()
+    {
+        CHECK(IsFullFrameCrop(GetFullFrameCrop()));
+        CHECK(IsFullFrameCrop(MakeCrop(-0.1f, 0.0f, 1.2f, 1.0f)));
+        CHECK(!IsFullFrameCrop(MakeCrop(0.0f, 0.0f, 1.0f, 0.99f)));
+        CHECK(!IsFullFrameCrop(MakeCrop(0.01f, 0.0f, 0.99f, 1.0f)));
+    }
+
+    void TestPixels()
+    {
+        VideoCropPixels pixels = GetVideoCropPixels(GetFullFrameCrop(), 640, 360);
+        CHECK(pixels.left == 0 && pixels.top == 0 && pixels.right == 640 && pixels.bottom == 360);
+
+        // Snapped to the nearest pixel edges
+        pixels = GetVideoCropPixels(MakeCrop(0.25f, 0.5f, 0.5f, 0.25f), 641, 359);
+        CHECK(pixels.left == 160);
+        CHECK(pixels.top == 180);
+        CHECK(pixels.right == 481);
+        CHECK(pixels.bottom == 269);
+
+        // A crop thinner than a pixel keeps one
+        pixels = GetVideoCropPixels(MakeCrop(0.5f, 0.5f, 0.0001f, 0.0001f), 640, 360);
+        CHECK(pixels.right - pixels.left == 1);
+        CHECK(pixels.bottom - pixels.top == 1);
+
+        // So does a crop on the last pixel row and column
+        pixels = GetVideoCropPixels(MakeCrop(1.0f, 1.0f, 0.0f, 0.0f), 640, 360);
+        CHECK(pixels.left == 639 && pixels.right == 640);
+        CHECK(pixels.top == 359 && pixels.bottom == 360);
+
+        // Crops of the same size in pixels stay so when moved
+        VideoCropPixels first = GetVideoCropPixels(MakeCrop(0.1f, 0.2f, 0.3f, 0.3f), 1920, 1080);
+        VideoCropPixels moved = GetVideoCropPixels(MakeCrop(0.4f, 0.6f, 0.3f, 0.3f), 1920, 1080);
+        CHECK(first.right - first.left == moved.right - moved.left);
+        CHECK(first.bottom - first.top == moved.bottom - moved.top);
+    }
+}
+
+int main()
+{
+    TestClamp();
+    TestFullFrame();
+    TestPixels();
+    return VuforiaMediaTest::TestResult("VideoCropTest");
+}
@@ -0,0 +1,229 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "WarmPool.h"
+#include "TestUtils.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // Stands for a decoder prepared for a video; counts the live instances so
+    // that leaks and double disposals show up
+    class FakePlayer
+    {
+    public:
+        explicit FakePlayer(const std::string& filename) : m_filename(filename)
+        {
+            ++LiveCount();
+        }
+
+        ~FakePlayer()
+        {
+            --LiveCount();
+        }
+
+        const std::string& GetFilename() const { return m_filename; }
+
+        static std::atomic<int>& LiveCount()
+        {
+            static std::atomic<int> count(0);
+            return count;
+        }
+
+    private:
+        std::string m_filename;
+    };
+
+    typedef WarmPool<FakePlayer> FakePool;
+
+    struct Disposals
+    {
+        std::vector<std::string> filenames;
+
+        FakePool::DisposeFunc Func()
+        {
+            return [this](FakePlayer* player)
+            {
+                filenames.push_back(player->GetFilename());
+                delete player;
+            };
+        }
+    };
+
+    void TestPutTake()
+    {
+        Disposals disposals;
+        {
+            FakePool pool(2, disposals.Func());
+            CHECK(pool.GetMaxEntries() == 2);
+            CHECK(pool.Take("a.mp4") == nullptr);
+
+            CHECK(pool.Put("a.mp4", new FakePlayer("a.mp4")));
+            CHECK(pool.Contains("a.mp4"));
+            CHECK(pool.GetSize() == 1);
+
+            // A video already warm keeps its player; the new one is disposed
+            CHECK(!pool.Put("a.mp4", new FakePlayer("a.mp4 again")));
+            CHECK(disposals.filenames.size() == 1 && disposals.filenames[0] == "a.mp4 again");
+            CHECK(pool.GetSize() == 1);
+
+            FakePlayer* player = pool.Take("a.mp4");
+            CHECK(player != nullptr && player->GetFilename() == "a.mp4");
+            CHECK(!pool.Contains("a.mp4"));
+            CHECK(pool.Take("a.mp4") == nullptr);
+            delete player;
+
+            CHECK(pool.Put("b.mp4", new FakePlayer("b.mp4")));
+        }
+        // The pool disposes what it still holds
+        CHECK(disposals.filenames.size() == 2 && disposals.filenames[1] == "b.mp4");
+        CHECK(FakePlayer::LiveCount().load() == 0);
+    }
+
+    void TestLeastRecentlyUsedEviction()
+    {
+        Disposals disposals;
+        FakePool pool(3, disposals.Func());
+        pool.Put("a.mp4", new FakePlayer("a.mp4"));
+        pool.Put("b.mp4", new FakePlayer("b.mp4"));
+        pool.Put("c.mp4", new FakePlayer("c.mp4"));
+
+        // a is touched, so b is now the least recently used
+        CHECK(pool.Touch("a.mp4"));
+        CHECK(!pool.Touch("z.mp4"));
+        pool.Put("d.mp4", new FakePlayer("d.mp4"));
+        CHECK(disposals.filenames.size() == 1 && disposals.filenames[0] == "b.mp4");
+        CHECK(pool.Contains("a.mp4") && pool.Contains("c.mp4") && pool.Contains("d.mp4"));
+
+        // Shrinking evicts from the least recently used on
+        pool.SetMaxEntries(1);
+        CHECK(disposals.filenames.size() == 3 && disposals.filenames[1] == "c.mp4" && disposals.filenames[2] == "a.mp4");
+        CHECK(pool.GetSize() == 1 && pool.Contains("d.mp4"));
+
+        // No capacity: nothing is kept
+        pool.SetMaxEntries(-1);
+        CHECK(pool.GetMaxEntries() == 0);
+        CHECK(pool.GetSize() == 0);
+        CHECK(!pool.Put("e.mp4", new FakePlayer("e.mp4")));
+        CHECK(disposals.filenames.size() == 5 && disposals.filenames[4] == "e.mp4");
+
+        pool.SetMaxEntries(2);
+        pool.Put("f.mp4", new FakePlayer("f.mp4"));
+        pool.Put("g.mp4", new FakePlayer("g.mp4"));
+        pool.Clear();
+        CHECK(pool.GetSize() == 0);
+        CHECK(disposals.filenames.size() == 7);
+        CHECK(FakePlayer::LiveCount().load() == 0);
+    }
+
+    // Drops the most recently added player instead
+    struct EvictMostRecentlyUsed
+    {
+        template <typename TEntry>
+        static typename std::list<TEntry>::iterator SelectVictim(std::list<TEntry>& entries)
+        {
+            return entries.begin();
+        }
+    };
+
+    void TestEvictionPolicy()
+    {
+        Disposals disposals;
+        WarmPool<FakePlayer, EvictMostRecentlyUsed> pool(1, disposals.Func());
+        pool.Put("a.mp4", new FakePlayer("a.mp4"));
+        CHECK(pool.Put("b.mp4", new FakePlayer("b.mp4")));
+        CHECK(disposals.filenames.size() == 1 && disposals.filenames[0] == "b.mp4");
+        CHECK(pool.Contains("a.mp4"));
+        pool.Clear();
+        CHECK(FakePlayer::LiveCount().load() == 0);
+    }
+
+    // Disposing a player may take a while (shutting a decoder down) or use the
+    // pool again, so it happens outside of the pool lock
+    void TestDisposeOutsideLock()
+    {
+        FakePool* pool = nullptr;
+        int sizesSeen = 0;
+        FakePool reentrant(1, [&](FakePlayer* player)
+        {
+            sizesSeen += pool->GetSize() >= 0 ? 1 : 0;
+            pool->Contains(player->GetFilename());
+            delete player;
+        });
+        pool = &reentrant;
+
+        reentrant.Put("a.mp4", new FakePlayer("a.mp4"));
+        reentrant.Put("b.mp4", new FakePlayer("b.mp4"));
+        reentrant.SetMaxEntries(0);
+        CHECK(sizesSeen == 2);
+        CHECK(FakePlayer::LiveCount().load() == 0);
+    }
+
+    // Prewarming from one thread while videos are loaded from another
+    void TestConcurrentUse()
+    {
+        std::atomic<int> disposed(0);
+        std::atomic<int> taken(0);
+        {
+            FakePool pool(4, [&](FakePlayer* player)
+            {
+                ++disposed;
+                delete player;
+            });
+
+            const int videoCount = 16;
+            const int rounds = 20000;
+            std::thread prewarmer([&]()
+            {
+                for (int i = 0; i < rounds; ++i)
+                {
+                    std::string filename = std::to_string(i % videoCount) + ".mp4";
+                    if (!pool.Touch(filename))
+                    {
+                        pool.Put(filename, new FakePlayer(filename));
+                    }
+                }
+            });
+            std::thread loader([&]()
+            {
+                for (int i = 0; i < rounds; ++i)
+                {
+                    FakePlayer* player = pool.Take(std::to_string((i * 7) % videoCount) + ".mp4");
+                    if (player != nullptr)
+                    {
+                        ++taken;
+                        delete player;
+                    }
+                    if (i % 1000 == 0)
+                    {
+                        pool.SetMaxEntries(2 + (i / 1000) % 3);
+                    }
+                }
+            });
+            prewarmer.join();
+            loader.join();
+            CHECK(pool.GetSize() <= pool.GetMaxEntries());
+        }
+        CHECK(taken.load() > 0);
+        CHECK(FakePlayer::LiveCount().load() == 0);
+    }
+}
+
+int main()
+{
+    TestPutTake();
+    TestLeastRecentlyUsedEviction();
+    TestEvictionPolicy();
+    TestDisposeOutsideLock();
+    TestConcurrentUse();
+    return VuforiaMediaTest::TestResult("WarmPoolTest");
+}
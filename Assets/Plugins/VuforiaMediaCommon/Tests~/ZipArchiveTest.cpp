@@ -0,0 +1,371 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "ZipArchive.h"
+#include "TestUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    typedef std::vector<uint8_t> Bytes;
+
+    const uint16_t METHOD_STORED = 0;
+    const uint16_t METHOD_DEFLATED = 8;
+    const uint16_t FLAG_ENCRYPTED = 0x0001;
+
+    enum Alignment
+    {
+        ALIGNED,        // padded like zipalign does
+        MISALIGNED
+    };
+
+    struct TestEntry
+    {
+        std::string name;
+        Bytes data;             // for deflated entries, stands for the compressed data, never read
+        uint16_t method;
+        uint16_t flags;
+        Alignment alignment;
+    };
+
+    void AppendLE16(Bytes& out, uint32_t value)
+    {
+        out.push_back((uint8_t)value);
+        out.push_back((uint8_t)(value >> 8));
+    }
+
+    void AppendLE32(Bytes& out, uint32_t value)
+    {
+        AppendLE16(out, value & 0xFFFF);
+        AppendLE16(out, value >> 16);
+    }
+
+    void AppendString(Bytes& out, const std::string& text)
+    {
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+    Bytes MakeData(size_t size, uint8_t seed)
+    {
+        Bytes data(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            data[i] = (uint8_t)(i * 7 + seed);
+        }
+        return data;
+    }
+
+    TestEntry MakeEntry(const std::string& name, const Bytes& data, uint16_t method = METHOD_STORED,
+                        Alignment alignment = ALIGNED, uint16_t flags = 0)
+    {
+        TestEntry entry = { name, data, method, flags, alignment };
+        return entry;
+    }
+
+    // Writes the local headers and data, the central directory, and the end of
+    // central directory record followed by the comment, then the trailing data
+    Bytes BuildArchive(const std::vector<TestEntry>& entries, const std::string& comment = std::string(),
+                       const Bytes& trailing = Bytes())
+    {
+        Bytes archive;
+        std::vector<uint32_t> localOffsets;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const TestEntry& entry = entries[i];
+            localOffsets.push_back((uint32_t)archive.size());
+
+            size_t dataOffset = archive.size() + 30 + entry.name.size();
+            size_t padding = (4 - dataOffset % 4) % 4;
+            if (entry.alignment == MISALIGNED)
+            {
+                padding = (padding + 1) % 4;
+            }
+
+            AppendLE32(archive, 0x04034b50);
+            AppendLE16(archive, 20);
+            AppendLE16(archive, entry.flags);
+            AppendLE16(archive, entry.method);
+            AppendLE32(archive, 0);                     // time, date
+            AppendLE32(archive, 0);                     // CRC-32, not checked
+            AppendLE32(archive, (uint32_t)entry.data.size());
+            AppendLE32(archive, (uint32_t)entry.data.size() * (entry.method == METHOD_STORED ? 1 : 3));
+            AppendLE16(archive, (uint32_t)entry.name.size());
+            AppendLE16(archive, (uint32_t)padding);
+            AppendString(archive, entry.name);
+            archive.resize(archive.size() + padding, 0);
+            archive.insert(archive.end(), entry.data.begin(), entry.data.end());
+        }
+
+        uint32_t directoryOffset = (uint32_t)archive.size();
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const TestEntry& entry = entries[i];
+            AppendLE32(archive, 0x02014b50);
+            AppendLE16(archive, 20);
+            AppendLE16(archive, 20);
+            AppendLE16(archive, entry.flags);
+            AppendLE16(archive, entry.method);
+            AppendLE32(archive, 0);
+            AppendLE32(archive, 0);
+            AppendLE32(archive, (uint32_t)entry.data.size());
+            AppendLE32(archive, (uint32_t)entry.data.size() * (entry.method == METHOD_STORED ? 1 : 3));
+            AppendLE16(archive, (uint32_t)entry.name.size());
+            AppendLE16(archive, 0);                     // extra field
+            AppendLE16(archive, 0);                     // comment
+            AppendLE16(archive, 0);                     // disk
+            AppendLE16(archive, 0);                     // internal attributes
+            AppendLE32(archive, 0);                     // external attributes
+            AppendLE32(archive, localOffsets[i]);
+            AppendString(archive, entry.name);
+        }
+        uint32_t directorySize = (uint32_t)archive.size() - directoryOffset;
+
+        AppendLE32(archive, 0x06054b50);
+        AppendLE32(archive, 0);                         // disk numbers
+        AppendLE16(archive, (uint32_t)entries.size());
+        AppendLE16(archive, (uint32_t)entries.size());
+        AppendLE32(archive, directorySize);
+        AppendLE32(archive, directoryOffset);
+        AppendLE16(archive, (uint32_t)comment.size());
+        AppendString(archive, comment);
+
+        archive.insert(archive.end(), trailing.begin(), trailing.end());
+        return archive;
+    }
+
+    std::vector<TestEntry> MakeEntries()
+    {
+        std::vector<TestEntry> entries;
+        entries.push_back(MakeEntry("assets/video.mp4", MakeData(5000, 1)));
+        entries.push_back(MakeEntry("assets/odd", MakeData(333, 2)));
+        entries.push_back(MakeEntry("assets/deflated.txt", MakeData(100, 3), METHOD_DEFLATED));
+        entries.push_back(MakeEntry("assets/misaligned.mp4", MakeData(64, 4), METHOD_STORED, MISALIGNED));
+        entries.push_back(MakeEntry("assets/secret.mp4", MakeData(64, 5), METHOD_STORED, ALIGNED, FLAG_ENCRYPTED));
+        entries.push_back(MakeEntry("assets/empty", Bytes()));
+        return entries;
+    }
+
+    bool WriteWholeFile(const std::string& path, const Bytes& data)
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = data.empty() || fwrite(data.data(), 1, data.size(), file) == data.size();
+        return fclose(file) == 0 && written;
+    }
+
+    bool MapsTo(const ZipArchive& archive, const std::string& name, const Bytes& expected)
+    {
+        MappedFile file;
+        return archive.MapEntry(name, file) == ZIP_ENTRY_FOUND && file.GetSize() == expected.size() &&
+               memcmp(file.GetData(), expected.data(), expected.size()) == 0;
+    }
+
+    void CheckEntries(const ZipArchive& archive, const std::vector<TestEntry>& entries)
+    {
+        CHECK(archive.GetEntryCount() == entries.size());
+        for (size_t i = 0; i < archive.GetEntryCount() && i < entries.size(); ++i)
+        {
+            CHECK(archive.GetEntryInfo(i).name == entries[i].name);
+            CHECK(archive.GetEntryInfo(i).method == entries[i].method);
+        }
+
+        ZipEntry entry;
+        CHECK(archive.FindEntry("assets/video.mp4", entry) == ZIP_ENTRY_FOUND);
+        CHECK(entry.size == 5000 && entry.dataOffset % ZipArchive::DATA_ALIGNMENT == 0);
+        CHECK(archive.FindEntry("assets/odd", entry) == ZIP_ENTRY_FOUND && entry.size == 333);
+        CHECK(archive.FindEntry("assets/deflated.txt", entry) == ZIP_ENTRY_COMPRESSED);
+        CHECK(archive.FindEntry("assets/misaligned.mp4", entry) == ZIP_ENTRY_MISALIGNED);
+        CHECK(archive.FindEntry("assets/secret.mp4", entry) == ZIP_ENTRY_INVALID);
+        CHECK(archive.FindEntry("assets/empty", entry) == ZIP_ENTRY_FOUND && entry.size == 0);
+        CHECK(archive.FindEntry("assets/missing.mp4", entry) == ZIP_ENTRY_MISSING);
+        CHECK(archive.FindEntry("video.mp4", entry) == ZIP_ENTRY_MISSING);
+    }
+
+    void CheckFileArchive(const Bytes& data, const std::vector<TestEntry>& entries)
+    {
+        VuforiaMediaTest::TempDirectory directory;
+        std::string path = directory.GetPath() + "/test.apk";
+        CHECK(WriteWholeFile(path, data));
+
+        ZipArchive archive;
+        CHECK(archive.Open(path));
+        CHECK(archive.GetPath() == path);
+        CheckEntries(archive, entries);
+
+        // Data is mapped at any offset, not only page aligned ones
+        CHECK(MapsTo(archive, "assets/video.mp4", entries[0].data));
+        CHECK(MapsTo(archive, "assets/odd", entries[1].data));
+
+        MappedFile file;
+        CHECK(archive.MapEntry("assets/deflated.txt", file) == ZIP_ENTRY_COMPRESSED);
+        CHECK(archive.MapEntry("assets/misaligned.mp4", file) == ZIP_ENTRY_MISALIGNED);
+        CHECK(archive.MapEntry("assets/missing.mp4", file) == ZIP_ENTRY_MISSING);
+        CHECK(archive.MapEntry("assets/empty", file) == ZIP_ENTRY_INVALID);
+
+        // Only archives in memory hand out pointers
+        const uint8_t* entryData = nullptr;
+        size_t entrySize = 0;
+        CHECK(archive.GetEntryData("assets/video.mp4", entryData, entrySize) == ZIP_ENTRY_INVALID);
+
+        archive.Close();
+        CHECK(archive.GetEntryCount() == 0);
+        CHECK(archive.MapEntry("assets/video.mp4", file) == ZIP_ENTRY_MISSING);
+    }
+
+    void CheckMemoryArchive(const Bytes& data, const std::vector<TestEntry>& entries)
+    {
+        ZipArchive archive;
+        CHECK(archive.Open(data.data(), data.size()));
+        CHECK(archive.GetPath().empty());
+        CheckEntries(archive, entries);
+
+        const uint8_t* entryData = nullptr;
+        size_t entrySize = 0;
+        CHECK(archive.GetEntryData("assets/odd", entryData, entrySize) == ZIP_ENTRY_FOUND);
+        CHECK(entrySize == 333 && entryData >= data.data() && entryData + entrySize <= data.data() + data.size());
+        CHECK(entrySize == 333 && memcmp(entryData, entries[1].data.data(), entrySize) == 0);
+        CHECK(archive.GetEntryData("assets/deflated.txt", entryData, entrySize) == ZIP_ENTRY_COMPRESSED);
+        CHECK(archive.GetEntryData("assets/missing.mp4", entryData, entrySize) == ZIP_ENTRY_MISSING);
+
+        MappedFile file;
+        CHECK(archive.MapEntry("assets/video.mp4", file) == ZIP_ENTRY_INVALID);
+    }
+
+    void TestArchive()
+    {
+        std::vector<TestEntry> entries = MakeEntries();
+        Bytes data = BuildArchive(entries);
+        CheckFileArchive(data, entries);
+        CheckMemoryArchive(data, entries);
+    }
+
+    // A comment, itself holding a stray end of central directory signature
+    void TestComment()
+    {
+        std::vector<TestEntry> entries = MakeEntries();
+        std::string comment = "built by a test PK\x05\x06 with a fake record";
+        comment.resize(1000, '-');
+        Bytes data = BuildArchive(entries, comment);
+        CheckFileArchive(data, entries);
+        CheckMemoryArchive(data, entries);
+
+        std::string longest(0xFFFF, 'c');
+        data = BuildArchive(entries, longest);
+        CheckMemoryArchive(data, entries);
+    }
+
+    // Data after the archive, like the .dat files of the target databases
+    void TestTrailingData()
+    {
+        std::vector<TestEntry> entries = MakeEntries();
+        Bytes trailing = MakeData(700, 9);
+        Bytes fakeRecord = BuildArchive(std::vector<TestEntry>());
+        trailing.insert(trailing.begin() + 100, fakeRecord.begin(), fakeRecord.end());
+        Bytes data = BuildArchive(entries, "comment", trailing);
+        CheckFileArchive(data, entries);
+        CheckMemoryArchive(data, entries);
+    }
+
+    // An archive stored in another one is read in place
+    void TestNestedArchive()
+    {
+        std::vector<TestEntry> innerEntries = MakeEntries();
+        Bytes inner = BuildArchive(innerEntries);
+
+        std::vector<TestEntry> outerEntries;
+        outerEntries.push_back(MakeEntry("main.obb", inner));
+        Bytes outer = BuildArchive(outerEntries);
+
+        VuforiaMediaTest::TempDirectory directory;
+        std::string path = directory.GetPath() + "/outer.zip";
+        CHECK(WriteWholeFile(path, outer));
+
+        ZipArchive outerArchive;
+        CHECK(outerArchive.Open(path));
+        MappedFile innerFile;
+        CHECK(outerArchive.MapEntry("main.obb", innerFile) == ZIP_ENTRY_FOUND);
+
+        ZipArchive innerArchive;
+        CHECK(innerArchive.Open(innerFile.GetData(), innerFile.GetSize()));
+        CheckEntries(innerArchive, innerEntries);
+    }
+
+    void TestInvalid()
+    {
+        ZipArchive archive;
+        CHECK(!archive.Open(nullptr, 0));
+        CHECK(!archive.Open("/nonexistent/archive.zip"));
+
+        Bytes empty = BuildArchive(std::vector<TestEntry>());
+        CHECK(archive.Open(empty.data(), empty.size()));
+        CHECK(archive.GetEntryCount() == 0);
+
+        Bytes notZip = MakeData(4096, 0);
+        CHECK(!archive.Open(notZip.data(), notZip.size()));
+
+        // A local header offset pointing elsewhere
+        std::vector<TestEntry> entries = MakeEntries();
+        Bytes data = BuildArchive(entries);
+        Bytes moved = data;
+        size_t directoryOffset = moved.size() - 22;
+        directoryOffset = moved[directoryOffset + 16] | (moved[directoryOffset + 17] << 8);
+        moved[directoryOffset + 42] += 1;
+        CHECK(archive.Open(moved.data(), moved.size()));
+        ZipEntry entry;
+        CHECK(archive.FindEntry("assets/video.mp4", entry) == ZIP_ENTRY_INVALID);
+
+        // Truncated archives only lose their directory (see SANITIZE for bounds)
+        int opened = 0;
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            ZipArchive truncated;
+            opened += truncated.Open(data.data(), size) ? 1 : 0;
+        }
+        CHECK(opened == 0);
+
+        // Damaged bytes in the directory and its record
+        uint32_t random = 77;
+        for (int i = 0; i < 2000; ++i)
+        {
+            Bytes damaged = data;
+            random = random * 1664525u + 1013904223u;
+            size_t offset = directoryOffset + (random >> 8) % (damaged.size() - directoryOffset);
+            damaged[offset] ^= (uint8_t)(1 + (random >> 24) % 255);
+            ZipArchive damagedArchive;
+            if (damagedArchive.Open(damaged.data(), damaged.size()))
+            {
+                for (size_t j = 0; j < damagedArchive.GetEntryCount(); ++j)
+                {
+                    const uint8_t* entryData;
+                    size_t entrySize;
+                    if (damagedArchive.GetEntryData(damagedArchive.GetEntryInfo(j).name, entryData, entrySize) ==
+                        ZIP_ENTRY_FOUND)
+                    {
+                        CHECK(entryData >= damaged.data() && entrySize <= damaged.size() &&
+                              (size_t)(entryData - damaged.data()) <= damaged.size() - entrySize);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    TestArchive();
+    TestComment();
+    TestTrailingData();
+    TestNestedArchive();
+    TestInvalid();
+    return VuforiaMediaTest::TestResult("ZipArchiveTest");
+}
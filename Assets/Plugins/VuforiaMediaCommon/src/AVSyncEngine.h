@@ -0,0 +1,315 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_AV_SYNC_ENGINE_H_
+#define _VUFORIA_MEDIA_AV_SYNC_ENGINE_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+
+namespace VuforiaMedia
+{
+    // Master clock of the playback, in seconds on the media timeline
+    class MasterClock
+    {
+    public:
+        virtual ~MasterClock() {}
+        virtual double Now() const = 0;
+    };
+
+    // Clock driven from outside: the audio position reported by the platform
+    // player, or a fake time in tests
+    class ExternalClock : public MasterClock
+    {
+    public:
+        ExternalClock() : m_time(0.0) {}
+
+        void SetTime(double time) { m_time = time; }
+        virtual double Now() const { return m_time; }
+
+    private:
+        double m_time;
+    };
+
+    // Monotonic wall clock, for videos without audio
+    class WallClock : public MasterClock
+    {
+    public:
+        WallClock() : m_running(false), m_position(0.0) {}
+
+        // Starts (or restarts) the clock at the given media position
+        void Start(double position)
+        {
+            m_position = position;
+            m_start = std::chrono::steady_clock::now();
+            m_running = true;
+        }
+
+        void Pause()
+        {
+            m_position = Now();
+            m_running = false;
+        }
+
+        virtual double Now() const
+        {
+            if (!m_running)
+            {
+                return m_position;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+            return m_position + elapsed.count();
+        }
+
+    private:
+        bool m_running;
+        double m_position;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    struct SyncPolicy
+    {
+        enum LateFramePolicy
+        {
+            PRESENT_LATE_FRAMES,    // show the newest decoded frame even if it is late
+            DROP_LATE_FRAMES        // never show a frame later than the tolerance
+        };
+
+        LateFramePolicy lateFramePolicy;
+
+        // A frame is due when its time is within this tolerance of the clock.
+        // 0 uses the frame duration.
+        double tolerance;
+
+        // Maximum number of frames decoded per tick, so that catching up after
+        // a stall is spread over several ticks instead of blocking one
+        int maxDecodesPerTick;
+
+        // When the video is behind the clock by more than this after a tick,
+        // the decoder should rather be repositioned. 0 never resyncs.
+        double resyncThreshold;
+
+        SyncPolicy() :
+            lateFramePolicy(PRESENT_LATE_FRAMES),
+            tolerance(0.0),
+            maxDecodesPerTick(4),
+            resyncThreshold(1.0)
+        {
+        }
+    };
+
+    struct SyncStats
+    {
+        uint32_t presented;     // frames handed over for display
+        uint32_t dropped;       // decoded frames never displayed
+        uint32_t late;          // frames displayed later than the tolerance
+        uint32_t duplicated;    // ticks on which the displayed frame outstayed its duration for lack of a due frame
+        uint32_t resyncs;       // decoder repositionings requested
+    };
+
+    // Decides, on each tick of the frame pump, which decoded video frame to
+    // display according to a master clock.
+    //
+    // Decoded frames are queued by presentation time. A tick decodes only the
+    // frames needed to reach the clock (bounded by the policy), drops the frames
+    // superseded by a newer due frame, and hands over the frame to display, if any.
+    //
+    // TFrame is opaque to the engine: frames it drops are handed to the release
+    // function, frames it returns belong to the caller. The engine is not
+    // thread-safe; it is meant to be owned by the frame pump thread.
+    template <typename TFrame>
+    class AVSyncEngine
+    {
+    public:
+        // Returns false when there are no more frames
+        typedef std::function<bool(double& presentationTime, TFrame& frame)> DecodeFunc;
+        typedef std::function<void(TFrame)> ReleaseFunc;
+
+        enum TickResult
+        {
+            TICK_NEW_FRAME,         // frame is the one to display now
+            TICK_SAME_FRAME,        // keep displaying the previous frame
+            TICK_RESYNC_NEEDED,     // too far behind: reposition the decoder at the clock time, then Flush()
+            TICK_END_OF_STREAM      // all the frames have been displayed
+        };
+
+        AVSyncEngine(const MasterClock& clock, ReleaseFunc release) :
+            m_clock(clock),
+            m_release(release),
+            m_frameDuration(1.0 / 30.0),
+            m_endOfStream(false),
+            m_hasPresented(false),
+            m_presentedTime(0.0)
+        {
+            ResetStats();
+        }
+
+        ~AVSyncEngine()
+        {
+            Flush();
+        }
+
+        void SetPolicy(const SyncPolicy& policy) { m_policy = policy; }
+        const SyncPolicy& GetPolicy() const { return m_policy; }
+
+        void SetFrameRate(double frameRate)
+        {
+            if (frameRate > 0.0)
+            {
+                m_frameDuration = 1.0 / frameRate;
+            }
+        }
+
+        // Releases the queued frames, after a seek or a resync
+        void Flush()
+        {
+            while (!m_frames.empty())
+            {
+                Release(m_frames.front().frame);
+                m_frames.pop_front();
+            }
+            m_endOfStream = false;
+        }
+
+        TickResult Tick(const DecodeFunc& decode, TFrame& frame)
+        {
+            const double now = m_clock.Now();
+            const double tolerance = GetTolerance();
+
+            // Decode until a frame is queued beyond the clock, so that the newest
+            // due frame is known
+            int decoded = 0;
+            while (!m_endOfStream && decoded < m_policy.maxDecodesPerTick &&
+                (m_frames.empty() || m_frames.back().presentationTime < now + tolerance))
+            {
+                QueuedFrame queued;
+                if (!decode(queued.presentationTime, queued.frame))
+                {
+                    m_endOfStream = true;
+                    break;
+                }
+                m_frames.push_back(queued);
+                ++decoded;
+            }
+
+            // Drop the frames superseded by a newer due frame
+            while (m_frames.size() >= 2 && m_frames[1].presentationTime < now + tolerance)
+            {
+                DropFront();
+            }
+
+            if (!m_frames.empty() && m_frames.front().presentationTime < now + tolerance)
+            {
+                double lateness = now - m_frames.front().presentationTime;
+
+                if (m_policy.resyncThreshold > 0.0 && lateness > m_policy.resyncThreshold && !m_endOfStream)
+                {
+                    ++m_stats.resyncs;
+                    return TICK_RESYNC_NEEDED;
+                }
+
+                if (lateness > tolerance)
+                {
+                    if (m_policy.lateFramePolicy == SyncPolicy::DROP_LATE_FRAMES)
+                    {
+                        DropFront();
+                        return NoNewFrame(now);
+                    }
+                    ++m_stats.late;
+                }
+
+                frame = m_frames.front().frame;
+                ++m_stats.presented;
+                m_hasPresented = true;
+                m_presentedTime = m_frames.front().presentationTime;
+                m_frames.pop_front();
+                return TICK_NEW_FRAME;
+            }
+
+            return NoNewFrame(now);
+        }
+
+        // Clock time at which the next queued frame becomes due, so that the
+        // frame pump can sleep until then. Returns false if no frame is queued.
+        bool GetNextDueTime(double& time) const
+        {
+            if (m_frames.empty())
+            {
+                return false;
+            }
+            time = m_frames.front().presentationTime - GetTolerance();
+            return true;
+        }
+
+        const SyncStats& GetStats() const { return m_stats; }
+
+        void ResetStats()
+        {
+            m_stats = SyncStats();
+            m_hasPresented = false;
+        }
+
+    private:
+        struct QueuedFrame
+        {
+            double presentationTime;
+            TFrame frame;
+        };
+
+        AVSyncEngine(const AVSyncEngine&);
+        AVSyncEngine& operator=(const AVSyncEngine&);
+
+        double GetTolerance() const
+        {
+            return m_policy.tolerance > 0.0 ? m_policy.tolerance : m_frameDuration;
+        }
+
+        // Ticks faster than the frame rate keep the displayed frame until the
+        // next one is due; it is only a duplicate once it outstays its duration
+        TickResult NoNewFrame(double now)
+        {
+            if (m_frames.empty() && m_endOfStream)
+            {
+                return TICK_END_OF_STREAM;
+            }
+            if (m_hasPresented && now >= m_presentedTime + m_frameDuration)
+            {
+                ++m_stats.duplicated;
+            }
+            return TICK_SAME_FRAME;
+        }
+
+        void DropFront()
+        {
+            Release(m_frames.front().frame);
+            m_frames.pop_front();
+            ++m_stats.dropped;
+        }
+
+        void Release(TFrame frame)
+        {
+            if (m_release)
+            {
+                m_release(frame);
+            }
+        }
+
+        const MasterClock& m_clock;
+        ReleaseFunc m_release;
+        SyncPolicy m_policy;
+        double m_frameDuration;
+
+        std::deque<QueuedFrame> m_frames;
+        bool m_endOfStream;
+        bool m_hasPresented;
+        double m_presentedTime;     // presentation time of the displayed frame
+        SyncStats m_stats;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_AV_SYNC_ENGINE_H_
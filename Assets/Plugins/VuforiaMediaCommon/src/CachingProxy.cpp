@@ -0,0 +1,599 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "CachingProxy.h"
+#include "FileUtils.h"
+#include "HttpClient.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // Last segment of the URL path, so that decoders guessing the container
+    // format from the extension still can
+    std::string GetFileName(const std::string& url)
+    {
+        size_t end = url.find_first_of("?#");
+        std::string path = url.substr(0, end);
+        size_t start = path.rfind('/');
+        std::string name = (start == std::string::npos) ? path : path.substr(start + 1);
+
+        for (size_t i = 0; i < name.size(); ++i)
+        {
+            char c = name[i];
+            if (!isalnum((unsigned char)c) && c != '.' && c != '-' && c != '_')
+            {
+                name[i] = '_';
+            }
+        }
+        return name.empty() ? "video" : name;
+    }
+
+    // Parses "bytes=<first>-<last>", "bytes=<first>-" or "bytes=-<suffix length>".
+    // Only the first range of a multi-range request is served.
+    bool ParseRange(const std::string& value, uint64_t size, uint64_t& start, uint64_t& end)
+    {
+        unsigned long long first = 0;
+        unsigned long long last = 0;
+        if (sscanf(value.c_str(), " bytes = -%llu", &last) == 1)
+        {
+            if (last == 0)
+            {
+                return false;
+            }
+            start = (last >= size) ? 0 : size - last;
+            end = size - 1;
+            return true;
+        }
+
+        int fields = sscanf(value.c_str(), " bytes = %llu - %llu", &first, &last);
+        if (fields < 1 || first >= size || (fields == 2 && last < first))
+        {
+            return false;
+        }
+        start = first;
+        end = (fields == 2 && last < size) ? last : size - 1;
+        return true;
+    }
+
+    std::string GetHeader(const std::string& request, const char* name)
+    {
+        size_t nameLength = strlen(name);
+        for (size_t lineStart = request.find("\r\n"); lineStart != std::string::npos;
+             lineStart = request.find("\r\n", lineStart + 2))
+        {
+            size_t start = lineStart + 2;
+            if (request.size() > start + nameLength && request[start + nameLength] == ':')
+            {
+                bool match = true;
+                for (size_t i = 0; i < nameLength && match; ++i)
+                {
+                    match = tolower((unsigned char)request[start + i]) == tolower((unsigned char)name[i]);
+                }
+                if (match)
+                {
+                    size_t end = request.find("\r\n", start);
+                    return request.substr(start + nameLength + 1, end - start - nameLength - 1);
+                }
+            }
+        }
+        return std::string();
+    }
+
+    bool SendStatus(SocketUtils::Socket socket, const char* status)
+    {
+        return SocketUtils::SendAll(socket, std::string("HTTP/1.1 ") + status + "\r\n"
+                                            "Content-Length: 0\r\n"
+                                            "Connection: close\r\n"
+                                            "\r\n");
+    }
+}
+
+
+CachingProxy& CachingProxy::Instance()
+{
+    static CachingProxy s_instance;
+    return s_instance;
+}
+
+CachingProxy::CachingProxy() :
+    m_running(false),
+    m_listener(SocketUtils::INVALID),
+    m_port(0)
+{
+}
+
+bool CachingProxy::Start(const std::string& cacheDirectory, uint64_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_running)
+    {
+        m_cache->SetMaxBytes(maxBytes);
+        return true;
+    }
+
+    if (!SocketUtils::Startup() || !FileUtils::MakeDirectory(cacheDirectory))
+    {
+        return false;
+    }
+
+    m_listener = SocketUtils::ListenLoopback(m_port);
+    if (m_listener == SocketUtils::INVALID)
+    {
+        return false;
+    }
+
+    m_cache.reset(new RangeCache(cacheDirectory, maxBytes));
+    m_running = true;
+    m_acceptThread = std::thread(&CachingProxy::AcceptLoop, this);
+    m_prefetchThread = std::thread(&CachingProxy::PrefetchLoop, this);
+    return true;
+}
+
+void CachingProxy::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+        {
+            return;
+        }
+        m_running = false;
+        m_prefetchQueue.clear();
+    }
+    m_prefetchCondition.notify_all();
+
+    // The accept loop polls m_running; then unblock the connections
+    m_acceptThread.join();
+    m_prefetchThread.join();
+    ReapConnections(true);
+
+    SocketUtils::Close(m_listener);
+    m_listener = SocketUtils::INVALID;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_urls.clear();
+    m_uncachedUrls.clear();
+    m_cache.reset();
+}
+
+std::string CachingProxy::GetLocalUrl(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_running || !HttpClient::IsSupportedUrl(url) || m_uncachedUrls.count(url) != 0)
+    {
+        return url;
+    }
+
+    char id[32];
+    snprintf(id, sizeof(id), "%016llx", (unsigned long long)FileUtils::HashString(url));
+    m_urls[id] = url;
+
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "http://127.0.0.1:%d/", m_port);
+    return prefix + std::string(id) + "/" + GetFileName(url);
+}
+
+void CachingProxy::Prefetch(const std::string& url, uint64_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_running || !HttpClient::IsSupportedUrl(url) || bytes == 0 || m_uncachedUrls.count(url) != 0)
+        {
+            return;
+        }
+        for (size_t i = 0; i < m_prefetchQueue.size(); ++i)
+        {
+            if (m_prefetchQueue[i].first == url)
+            {
+                m_prefetchQueue[i].second = std::max(m_prefetchQueue[i].second, bytes);
+                return;
+            }
+        }
+        m_prefetchQueue.push_back(std::make_pair(url, bytes));
+    }
+    m_prefetchCondition.notify_one();
+}
+
+uint64_t CachingProxy::GetCachedBytes()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cache ? m_cache->GetCachedBytes() : 0;
+}
+
+void CachingProxy::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cache)
+    {
+        m_cache->Clear();
+    }
+}
+
+void CachingProxy::AcceptLoop()
+{
+    while (m_running)
+    {
+        ReapConnections(false);
+
+        if (!SocketUtils::WaitReadable(m_listener, ACCEPT_POLL_MS))
+        {
+            continue;
+        }
+
+        SocketUtils::Socket socket = SocketUtils::Accept(m_listener, SOCKET_TIMEOUT_MS);
+        if (socket == SocketUtils::INVALID)
+        {
+            continue;
+        }
+
+        // One thread per connection: decoders open few connections at a time
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_connections.push_back(Connection());
+        Connection& connection = m_connections.back();
+        connection.socket = socket;
+        connection.done = std::make_shared<std::atomic<bool> >(false);
+        std::shared_ptr<std::atomic<bool> > done = connection.done;
+        connection.thread = std::thread([this, socket, done]()
+        {
+            HandleConnection(socket);
+            *done = true;
+        });
+    }
+}
+
+void CachingProxy::ReapConnections(bool all)
+{
+    std::list<Connection> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::list<Connection>::iterator it = m_connections.begin(); it != m_connections.end();)
+        {
+            std::list<Connection>::iterator current = it++;
+            if (all || *current->done)
+            {
+                finished.splice(finished.end(), m_connections, current);
+            }
+        }
+    }
+
+    // Sockets are only closed once their thread is done, so that they cannot be reused meanwhile
+    for (std::list<Connection>::iterator it = finished.begin(); it != finished.end(); ++it)
+    {
+        if (!*it->done)
+        {
+            SocketUtils::Shutdown(it->socket);
+        }
+        it->thread.join();
+        SocketUtils::Close(it->socket);
+    }
+}
+
+void CachingProxy::HandleConnection(SocketUtils::Socket socket)
+{
+    std::string request;
+    char buffer[2048];
+    while (request.find("\r\n\r\n") == std::string::npos)
+    {
+        int count = SocketUtils::Receive(socket, buffer, sizeof(buffer));
+        if (count <= 0 || request.size() > MAX_REQUEST_SIZE)
+        {
+            return;
+        }
+        request.append(buffer, (size_t)count);
+    }
+
+    // Request line: <method> /<id>/<name> HTTP/1.x
+    char method[16];
+    char target[1024];
+    if (sscanf(request.c_str(), "%15s %1023s", method, target) != 2)
+    {
+        SendStatus(socket, "400 Bad Request");
+        return;
+    }
+
+    bool isHead = strcmp(method, "HEAD") == 0;
+    if (!isHead && strcmp(method, "GET") != 0)
+    {
+        SendStatus(socket, "405 Method Not Allowed");
+        return;
+    }
+
+    std::string path = target;
+    size_t idEnd = path.find('/', 1);
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<std::string, std::string>::iterator it =
+            m_urls.find(path.substr(1, idEnd == std::string::npos ? std::string::npos : idEnd - 1));
+        if (it != m_urls.end())
+        {
+            url = it->second;
+        }
+    }
+    if (url.empty())
+    {
+        SendStatus(socket, "404 Not Found");
+        return;
+    }
+
+    RangeCache::Info info;
+    if (!GetInfo(url, info))
+    {
+        bool isUncached;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            isUncached = m_uncachedUrls.count(url) != 0;
+        }
+
+        // Without a size nothing can be cached or served by range: the
+        // decoder plays from the server
+        if (isUncached)
+        {
+            SendStatus(socket, ("307 Temporary Redirect\r\nLocation: " + url).c_str());
+        }
+        else
+        {
+            SendStatus(socket, "502 Bad Gateway");
+        }
+        return;
+    }
+
+    uint64_t start = 0;
+    uint64_t end = info.size - 1;
+    std::string range = GetHeader(request, "Range");
+    bool isRange = !range.empty();
+    if (isRange && !ParseRange(range, info.size, start, end))
+    {
+        char status[128];
+        snprintf(status, sizeof(status), "416 Range Not Satisfiable\r\nContent-Range: bytes */%llu",
+                 (unsigned long long)info.size);
+        SendStatus(socket, status);
+        return;
+    }
+
+    char headers[512];
+    int length;
+    if (isRange)
+    {
+        length = snprintf(headers, sizeof(headers),
+                          "HTTP/1.1 206 Partial Content\r\n"
+                          "Content-Range: bytes %llu-%llu/%llu\r\n",
+                          (unsigned long long)start, (unsigned long long)end, (unsigned long long)info.size);
+    }
+    else
+    {
+        length = snprintf(headers, sizeof(headers), "HTTP/1.1 200 OK\r\n");
+    }
+    snprintf(headers + length, sizeof(headers) - length,
+             "Content-Length: %llu\r\n"
+             "Content-Type: %s\r\n"
+             "Accept-Ranges: bytes\r\n"
+             "Connection: close\r\n"
+             "\r\n",
+             (unsigned long long)(end - start + 1),
+             info.contentType.empty() ? "application/octet-stream" : info.contentType.c_str());
+
+    if (!SocketUtils::SendAll(socket, headers, strlen(headers)) || isHead)
+    {
+        return;
+    }
+    StreamRange(url, start, end, socket);
+}
+
+bool CachingProxy::StreamRange(const std::string& url, uint64_t start, uint64_t end, SocketUtils::Socket socket)
+{
+    const uint64_t chunkSize = RangeCache::CHUNK_SIZE;
+    std::vector<uint8_t> buffer;
+    uint64_t position = start;
+
+    while (position <= end)
+    {
+        if (!m_running)
+        {
+            return false;
+        }
+
+        uint64_t chunk = position / chunkSize;
+        uint64_t readEnd = std::min((chunk + 1) * chunkSize, end + 1);
+        buffer.resize((size_t)(readEnd - position));
+        if (m_cache->HasChunk(url, chunk) && m_cache->Read(url, position, &buffer[0], buffer.size()))
+        {
+            if (!SocketUtils::SendAll(socket, &buffer[0], buffer.size()))
+            {
+                return false;
+            }
+            position = readEnd;
+            continue;
+        }
+
+        // Download the run of missing chunks, forwarding each one as it arrives
+        uint64_t lastChunk = chunk;
+        uint64_t endChunk = end / chunkSize;
+        while (lastChunk < endChunk && lastChunk - chunk + 1 < MAX_FETCH_CHUNKS &&
+               !m_cache->HasChunk(url, lastChunk + 1))
+        {
+            ++lastChunk;
+        }
+
+        bool forwarded = FetchChunks(url, chunk, lastChunk,
+            [&position, end, socket](uint64_t offset, const uint8_t* data, size_t size)
+        {
+            uint64_t from = std::max(offset, position);
+            uint64_t to = std::min(offset + size, end + 1);
+            if (from >= to)
+            {
+                return true;
+            }
+            position = to;
+            return SocketUtils::SendAll(socket, data + (from - offset), (size_t)(to - from));
+        });
+        if (!forwarded)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CachingProxy::GetInfo(const std::string& url, RangeCache::Info& info)
+{
+    if (m_cache->GetInfo(url, info))
+    {
+        return true;
+    }
+
+    // Unknown resource: its size comes with its first chunk, which the decoder reads first anyway
+    return FetchChunks(url, 0, 0, ChunkSink()) && m_cache->GetInfo(url, info);
+}
+
+bool CachingProxy::FetchChunks(const std::string& url, uint64_t firstChunk, uint64_t lastChunk, const ChunkSink& sink)
+{
+    const uint64_t chunkSize = RangeCache::CHUNK_SIZE;
+
+    RangeCache::Info info;
+    bool isKnown = m_cache->GetInfo(url, info);
+
+    uint64_t start = firstChunk * chunkSize;
+    uint64_t end = (lastChunk + 1) * chunkSize;
+    if (isKnown)
+    {
+        if (start >= info.size)
+        {
+            return false;
+        }
+        end = std::min(end, info.size);
+    }
+
+    HttpClient client;
+    if (!client.Get(url, start, (int64_t)end - 1))
+    {
+        return false;
+    }
+
+    if (!isKnown || (client.GetTotalSize() != 0 && client.GetTotalSize() != info.size))
+    {
+        // First download, or the resource changed on the server
+        info.size = client.GetTotalSize();
+        info.contentType = client.GetContentType();
+        m_cache->SetInfo(url, info);
+        if (info.size == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_uncachedUrls.insert(url);
+        }
+        if (info.size == 0 || isKnown)
+        {
+            // Unknown size: nothing can be cached. Changed size: the decoder has to start over.
+            return false;
+        }
+        end = std::min(end, info.size);
+    }
+
+    // The server may have ignored the range and sent the resource from the start
+    uint64_t offset = client.GetBodyOffset();
+    std::vector<uint8_t> data((size_t)chunkSize);
+    while (offset < start)
+    {
+        int count = client.Read(&data[0], (size_t)std::min(start - offset, chunkSize));
+        if (count <= 0)
+        {
+            return false;
+        }
+        offset += (uint64_t)count;
+    }
+    if (offset != start)
+    {
+        return false;
+    }
+
+    for (uint64_t chunk = firstChunk; chunk * chunkSize < end; ++chunk)
+    {
+        size_t size = (size_t)std::min(chunkSize, info.size - chunk * chunkSize);
+        for (size_t received = 0; received < size;)
+        {
+            if (!m_running)
+            {
+                return false;
+            }
+            int count = client.Read(&data[received], size - received);
+            if (count <= 0)
+            {
+                return false;
+            }
+            received += (size_t)count;
+        }
+
+        // Forwarded even if it could not be stored
+        m_cache->WriteChunk(url, chunk, &data[0], size);
+        if (sink && !sink(chunk * chunkSize, &data[0], size))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CachingProxy::PrefetchLoop()
+{
+    while (true)
+    {
+        std::pair<std::string, uint64_t> request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_prefetchCondition.wait(lock, [this]() { return !m_running || !m_prefetchQueue.empty(); });
+            if (!m_running)
+            {
+                return;
+            }
+            request = m_prefetchQueue.front();
+            m_prefetchQueue.pop_front();
+        }
+
+        PrefetchHead(request.first, request.second);
+    }
+}
+
+void CachingProxy::PrefetchHead(const std::string& url, uint64_t bytes)
+{
+    const uint64_t chunkSize = RangeCache::CHUNK_SIZE;
+
+    RangeCache::Info info;
+    if (!GetInfo(url, info))
+    {
+        return;
+    }
+
+    uint64_t endChunk = (std::min(bytes, info.size) - 1) / chunkSize;
+    for (uint64_t chunk = 0; chunk <= endChunk && m_running; ++chunk)
+    {
+        if (m_cache->HasChunk(url, chunk))
+        {
+            continue;
+        }
+
+        uint64_t lastChunk = chunk;
+        while (lastChunk < endChunk && !m_cache->HasChunk(url, lastChunk + 1))
+        {
+            ++lastChunk;
+        }
+        if (!FetchChunks(url, chunk, lastChunk, ChunkSink()))
+        {
+            return;
+        }
+        chunk = lastChunk;
+    }
+}
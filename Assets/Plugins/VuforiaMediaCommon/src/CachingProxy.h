@@ -0,0 +1,113 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_CACHING_PROXY_H_
+#define _VUFORIA_MEDIA_CACHING_PROXY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "RangeCache.h"
+#include "SocketUtils.h"
+
+namespace VuforiaMedia
+{
+    // HTTP server on the loopback interface standing between the platform
+    // decoders and the servers of remote videos.
+    //
+    // A remote URL is replaced by a local one before it is given to the decoder.
+    // The byte ranges requested by the decoder are served from a RangeCache,
+    // and the missing chunks are downloaded from the remote server, stored and
+    // forwarded as they arrive. A video plays from the cache once it has been
+    // watched, and the head of videos likely to be played next can be
+    // prefetched, so that playback starts without buffering.
+    //
+    // Only http:// URLs are proxied; others are played directly by the decoder,
+    // and so are resources whose server does not tell their size: the local URL
+    // redirects to them.
+    class CachingProxy
+    {
+    public:
+        static const uint64_t DEFAULT_PREFETCH_BYTES = 2 * 1024 * 1024;
+
+        static CachingProxy& Instance();
+
+        // Starts the server, or changes the cache budget if it is already running
+        bool Start(const std::string& cacheDirectory, uint64_t maxBytes);
+        void Stop();
+
+        // Returns the URL to give to the decoder to play url through the cache,
+        // url itself if it cannot be proxied
+        std::string GetLocalUrl(const std::string& url);
+
+        // Downloads the first bytes of the video in the background, if not cached
+        void Prefetch(const std::string& url, uint64_t bytes);
+
+        uint64_t GetCachedBytes();
+        void ClearCache();
+
+    private:
+        static const int SOCKET_TIMEOUT_MS = 15000;
+        static const int ACCEPT_POLL_MS = 250;
+        static const size_t MAX_REQUEST_SIZE = 16 * 1024;
+
+        // Missing chunks downloaded with one request to the remote server
+        static const uint64_t MAX_FETCH_CHUNKS = 16;
+
+        // Receives each downloaded chunk: its offset in the resource, its bytes.
+        // Returning false cancels the download.
+        typedef std::function<bool(uint64_t, const uint8_t*, size_t)> ChunkSink;
+
+        struct Connection
+        {
+            SocketUtils::Socket socket;
+            std::thread thread;
+            std::shared_ptr<std::atomic<bool> > done;
+        };
+
+        CachingProxy();
+        CachingProxy(const CachingProxy&);
+        CachingProxy& operator=(const CachingProxy&);
+
+        void AcceptLoop();
+        void ReapConnections(bool all);
+        void HandleConnection(SocketUtils::Socket socket);
+        bool StreamRange(const std::string& url, uint64_t start, uint64_t end, SocketUtils::Socket socket);
+
+        bool GetInfo(const std::string& url, RangeCache::Info& info);
+        bool FetchChunks(const std::string& url, uint64_t firstChunk, uint64_t lastChunk, const ChunkSink& sink);
+
+        void PrefetchLoop();
+        void PrefetchHead(const std::string& url, uint64_t bytes);
+
+        std::mutex m_mutex;
+        std::condition_variable m_prefetchCondition;
+        std::unique_ptr<RangeCache> m_cache;
+        std::atomic<bool> m_running;
+        SocketUtils::Socket m_listener;
+        int m_port;
+        std::thread m_acceptThread;
+        std::thread m_prefetchThread;
+        std::list<Connection> m_connections;
+        std::map<std::string, std::string> m_urls;      // remote URL by local path
+        std::set<std::string> m_uncachedUrls;           // served without a size, cannot be cached
+        std::deque<std::pair<std::string, uint64_t> > m_prefetchQueue;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_CACHING_PROXY_H_
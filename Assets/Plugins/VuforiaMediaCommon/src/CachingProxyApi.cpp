@@ -0,0 +1,65 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "CachingProxy.h"
+
+#include <string.h>
+
+// Plugin interface of the caching proxy of remote videos, the same on every platform.
+// On Windows the functions are exported through VuforiaMedia.def.
+#if defined(_WIN32)
+#define CACHING_PROXY_API extern "C"
+#else
+#define CACHING_PROXY_API extern "C" __attribute__((visibility("default")))
+#endif
+
+using namespace VuforiaMedia;
+
+CACHING_PROXY_API bool cachingProxyStart(const char* cacheDirectory, int64_t maxBytes)
+{
+    return cacheDirectory != nullptr && maxBytes > 0 &&
+           CachingProxy::Instance().Start(cacheDirectory, (uint64_t)maxBytes);
+}
+
+CACHING_PROXY_API void cachingProxyStop()
+{
+    CachingProxy::Instance().Stop();
+}
+
+// Copies the URL to play url through the cache, and returns its length.
+// Nothing is copied if the buffer is too small; url is returned as is if it cannot be proxied.
+CACHING_PROXY_API int cachingProxyGetLocalUrl(const char* url, char* localUrl, int capacity)
+{
+    if (url == nullptr)
+    {
+        return 0;
+    }
+
+    std::string result = CachingProxy::Instance().GetLocalUrl(url);
+    if (localUrl != nullptr && capacity > 0 && (size_t)capacity > result.size())
+    {
+        memcpy(localUrl, result.c_str(), result.size() + 1);
+    }
+    return (int)result.size();
+}
+
+CACHING_PROXY_API void cachingProxyPrefetch(const char* url, int64_t bytes)
+{
+    if (url != nullptr && bytes > 0)
+    {
+        CachingProxy::Instance().Prefetch(url, (uint64_t)bytes);
+    }
+}
+
+CACHING_PROXY_API int64_t cachingProxyGetCachedBytes()
+{
+    return (int64_t)CachingProxy::Instance().GetCachedBytes();
+}
+
+CACHING_PROXY_API void cachingProxyClearCache()
+{
+    CachingProxy::Instance().ClearCache();
+}
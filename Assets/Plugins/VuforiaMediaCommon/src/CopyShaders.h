@@ -0,0 +1,319 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_COPY_SHADERS_H_
+#define _VUFORIA_MEDIA_COPY_SHADERS_H_
+
+#include <stddef.h>
+
+namespace VuforiaMedia
+{
+    // Texture the decoded frame is read from
+    enum CopySampler
+    {
+        COPY_SAMPLER_EXTERNAL_OES,      // SurfaceTexture / EGLImage (texSampler2D)
+        COPY_SAMPLER_2D,                // RGBA texture (texSampler2D)
+        COPY_SAMPLER_YUV_PLANES,        // Y plane in .r (texSamplerY), interleaved UV plane in .ra (texSamplerUV)
+        COPY_SAMPLER_COUNT
+    };
+
+    // How the quad texture coordinates are mapped to the frame, combined as
+    // flags: flipped first, then cropped to cropRect (x, y, width, height in
+    // the frame), then transformed by textureMatrix
+    enum CopyGeometry
+    {
+        COPY_GEOMETRY_NONE              = 0,
+        COPY_GEOMETRY_FLIP_X            = 1,
+        COPY_GEOMETRY_FLIP_Y            = 2,
+        COPY_GEOMETRY_CROP              = 4,
+        COPY_GEOMETRY_TEXTURE_MATRIX    = 8,
+        COPY_GEOMETRY_COUNT             = 16
+    };
+
+    // Conversion of YUV planes to RGB, from video range; required by and only
+    // allowed with COPY_SAMPLER_YUV_PLANES
+    enum CopyColor
+    {
+        COPY_COLOR_NONE,
+        COPY_COLOR_BT601,
+        COPY_COLOR_BT709,
+        COPY_COLOR_COUNT
+    };
+
+    enum CopyOutput
+    {
+        COPY_OUTPUT_RGBA,
+        COPY_OUTPUT_OPAQUE,             // alpha forced to 1
+        COPY_OUTPUT_BGRA,               // red and blue swapped
+        COPY_OUTPUT_PACKED_ALPHA,       // colour from the left half of the frame, alpha from the green of its right half
+        COPY_OUTPUT_COUNT
+    };
+
+    // GLSL of one variant of the copy program, split in parts to be passed as
+    // they are to glShaderSource; omitted parts are empty strings
+    struct CopyShaderSource
+    {
+        static const int VERTEX_PART_COUNT = 6;
+        static const int FRAGMENT_PART_COUNT = 6;
+
+        int index;                      // in the variant table
+        CopySampler sampler;
+        unsigned int geometry;
+        CopyColor color;
+        CopyOutput output;
+        const char* vertex[VERTEX_PART_COUNT];
+        const char* fragment[FRAGMENT_PART_COUNT];
+    };
+
+    namespace CopyShaderParts
+    {
+        // The sampler and colour conversion pairs that make sense, -1 otherwise
+        constexpr int GetInputIndex(CopySampler sampler, CopyColor color)
+        {
+            return sampler == COPY_SAMPLER_EXTERNAL_OES && color == COPY_COLOR_NONE ? 0 :
+                   sampler == COPY_SAMPLER_2D && color == COPY_COLOR_NONE ? 1 :
+                   sampler == COPY_SAMPLER_YUV_PLANES && color == COPY_COLOR_BT601 ? 2 :
+                   sampler == COPY_SAMPLER_YUV_PLANES && color == COPY_COLOR_BT709 ? 3 : -1;
+        }
+
+        static const int INPUT_COUNT = 4;
+
+        constexpr CopySampler GetInputSampler(int input)
+        {
+            return input == 0 ? COPY_SAMPLER_EXTERNAL_OES : input == 1 ? COPY_SAMPLER_2D : COPY_SAMPLER_YUV_PLANES;
+        }
+
+        constexpr CopyColor GetInputColor(int input)
+        {
+            return input == 2 ? COPY_COLOR_BT601 : input == 3 ? COPY_COLOR_BT709 : COPY_COLOR_NONE;
+        }
+
+        constexpr bool HasFlag(unsigned int geometry, CopyGeometry flag)
+        {
+            return (geometry & flag) != 0;
+        }
+
+        // Vertex shader
+
+        constexpr const char* VertexHeader(CopyOutput output)
+        {
+            return output == COPY_OUTPUT_PACKED_ALPHA ?
+                       "attribute vec4 vertexPosition;\n"
+                       "attribute vec2 vertexTexCoord;\n"
+                       "varying vec2 texCoord;\n"
+                       "varying vec2 alphaTexCoord;\n"
+                       "uniform mat4 modelViewProjectionMatrix;\n" :
+                       "attribute vec4 vertexPosition;\n"
+                       "attribute vec2 vertexTexCoord;\n"
+                       "varying vec2 texCoord;\n"
+                       "uniform mat4 modelViewProjectionMatrix;\n";
+        }
+
+        constexpr const char* VertexMatrixUniform(unsigned int geometry)
+        {
+            return HasFlag(geometry, COPY_GEOMETRY_TEXTURE_MATRIX) ? "uniform mat4 textureMatrix;\n" : "";
+        }
+
+        constexpr const char* VertexCropUniform(unsigned int geometry)
+        {
+            return HasFlag(geometry, COPY_GEOMETRY_CROP) ? "uniform vec4 cropRect;\n" : "";
+        }
+
+        constexpr const char* VertexFlip(unsigned int geometry)
+        {
+            return HasFlag(geometry, COPY_GEOMETRY_FLIP_X) && HasFlag(geometry, COPY_GEOMETRY_FLIP_Y) ?
+                       "void main()\n{\n"
+                       "    gl_Position = modelViewProjectionMatrix * vertexPosition;\n"
+                       "    vec2 uv = vec2(1.0) - vertexTexCoord;\n" :
+                   HasFlag(geometry, COPY_GEOMETRY_FLIP_X) ?
+                       "void main()\n{\n"
+                       "    gl_Position = modelViewProjectionMatrix * vertexPosition;\n"
+                       "    vec2 uv = vec2(1.0 - vertexTexCoord.x, vertexTexCoord.y);\n" :
+                   HasFlag(geometry, COPY_GEOMETRY_FLIP_Y) ?
+                       "void main()\n{\n"
+                       "    gl_Position = modelViewProjectionMatrix * vertexPosition;\n"
+                       "    vec2 uv = vec2(vertexTexCoord.x, 1.0 - vertexTexCoord.y);\n" :
+                       "void main()\n{\n"
+                       "    gl_Position = modelViewProjectionMatrix * vertexPosition;\n"
+                       "    vec2 uv = vertexTexCoord;\n";
+        }
+
+        constexpr const char* VertexCrop(unsigned int geometry)
+        {
+            return HasFlag(geometry, COPY_GEOMETRY_CROP) ? "    uv = cropRect.xy + uv * cropRect.zw;\n" : "";
+        }
+
+        // The halves of a packed frame are picked before the texture matrix,
+        // which applies to the whole frame
+        constexpr const char* VertexMatrix(unsigned int geometry, CopyOutput output)
+        {
+            return output == COPY_OUTPUT_PACKED_ALPHA && HasFlag(geometry, COPY_GEOMETRY_TEXTURE_MATRIX) ?
+                       "    texCoord = (textureMatrix * vec4(uv.x * 0.5, uv.y, 1.0, 1.0)).xy;\n"
+                       "    alphaTexCoord = (textureMatrix * vec4(uv.x * 0.5 + 0.5, uv.y, 1.0, 1.0)).xy;\n}\n" :
+                   output == COPY_OUTPUT_PACKED_ALPHA ?
+                       "    texCoord = vec2(uv.x * 0.5, uv.y);\n"
+                       "    alphaTexCoord = vec2(uv.x * 0.5 + 0.5, uv.y);\n}\n" :
+                   HasFlag(geometry, COPY_GEOMETRY_TEXTURE_MATRIX) ?
+                       "    texCoord = (textureMatrix * vec4(uv, 1.0, 1.0)).xy;\n}\n" :
+                       "    texCoord = uv;\n}\n";
+        }
+
+        // Fragment shader
+
+        constexpr const char* FragmentExtension(CopySampler sampler)
+        {
+            return sampler == COPY_SAMPLER_EXTERNAL_OES ? "#extension GL_OES_EGL_image_external : require\n" : "";
+        }
+
+        constexpr const char* FragmentHeader(CopyOutput output)
+        {
+            return output == COPY_OUTPUT_PACKED_ALPHA ?
+                       "precision mediump float;\n"
+                       "varying vec2 texCoord;\n"
+                       "varying vec2 alphaTexCoord;\n" :
+                       "precision mediump float;\n"
+                       "varying vec2 texCoord;\n";
+        }
+
+        constexpr const char* FragmentSamplers(CopySampler sampler)
+        {
+            return sampler == COPY_SAMPLER_EXTERNAL_OES ? "uniform samplerExternalOES texSampler2D;\n" :
+                   sampler == COPY_SAMPLER_2D ? "uniform sampler2D texSampler2D;\n" :
+                       "uniform sampler2D texSamplerY;\n"
+                       "uniform sampler2D texSamplerUV;\n";
+        }
+
+        constexpr const char* FragmentFetch(CopySampler sampler)
+        {
+            return sampler == COPY_SAMPLER_YUV_PLANES ?
+                       "void main()\n{\n"
+                       "    vec3 yuv = vec3(texture2D(texSamplerY, texCoord).r, texture2D(texSamplerUV, texCoord).ra)"
+                       " - vec3(0.0625, 0.5, 0.5);\n" :
+                       "void main()\n{\n"
+                       "    vec4 color = texture2D(texSampler2D, texCoord);\n";
+        }
+
+        // Column-major: the Y, U and V coefficients of R, G and B
+        constexpr const char* FragmentColor(CopyColor color)
+        {
+            return color == COPY_COLOR_BT601 ?
+                       "    vec4 color = vec4(mat3(1.164, 1.164, 1.164, 0.0, -0.392, 2.017, 1.596, -0.813, 0.0) * yuv, 1.0);\n" :
+                   color == COPY_COLOR_BT709 ?
+                       "    vec4 color = vec4(mat3(1.164, 1.164, 1.164, 0.0, -0.213, 2.112, 1.793, -0.533, 0.0) * yuv, 1.0);\n" :
+                       "";
+        }
+
+        // The alpha of YUV planes is the luma of the right half, from video range
+        constexpr const char* FragmentOutput(CopySampler sampler, CopyOutput output)
+        {
+            return output == COPY_OUTPUT_PACKED_ALPHA && sampler == COPY_SAMPLER_YUV_PLANES ?
+                       "    gl_FragColor = vec4(color.rgb,"
+                       " clamp((texture2D(texSamplerY, alphaTexCoord).r - 0.0625) * 1.164, 0.0, 1.0));\n}\n" :
+                   output == COPY_OUTPUT_PACKED_ALPHA ?
+                       "    gl_FragColor = vec4(color.rgb, texture2D(texSampler2D, alphaTexCoord).g);\n}\n" :
+                   output == COPY_OUTPUT_OPAQUE ? "    gl_FragColor = vec4(color.rgb, 1.0);\n}\n" :
+                   output == COPY_OUTPUT_BGRA ? "    gl_FragColor = color.bgra;\n}\n" :
+                       "    gl_FragColor = color;\n}\n";
+        }
+
+        constexpr CopyShaderSource MakeSource(int index, CopySampler sampler, unsigned int geometry,
+            CopyColor color, CopyOutput output)
+        {
+            return CopyShaderSource
+            {
+                index, sampler, geometry, color, output,
+                {
+                    VertexHeader(output), VertexMatrixUniform(geometry), VertexCropUniform(geometry),
+                    VertexFlip(geometry), VertexCrop(geometry), VertexMatrix(geometry, output)
+                },
+                {
+                    FragmentExtension(sampler), FragmentHeader(output), FragmentSamplers(sampler),
+                    FragmentFetch(sampler), FragmentColor(color), FragmentOutput(sampler, output)
+                }
+            };
+        }
+
+        // The table index is made of the input, the geometry flags and the output
+        constexpr CopyShaderSource MakeSource(int index)
+        {
+            return MakeSource(index,
+                GetInputSampler(index / (COPY_GEOMETRY_COUNT * COPY_OUTPUT_COUNT)),
+                (unsigned int)(index / COPY_OUTPUT_COUNT % COPY_GEOMETRY_COUNT),
+                GetInputColor(index / (COPY_GEOMETRY_COUNT * COPY_OUTPUT_COUNT)),
+                (CopyOutput)(index % COPY_OUTPUT_COUNT));
+        }
+
+        template <int... Indices>
+        struct IndexList
+        {
+        };
+
+        template <int Count, int... Indices>
+        struct MakeIndexList : MakeIndexList<Count - 1, Count - 1, Indices...>
+        {
+        };
+
+        template <int... Indices>
+        struct MakeIndexList<0, Indices...>
+        {
+            typedef IndexList<Indices...> Type;
+        };
+
+        // Every variant, built by the compiler
+        template <typename TIndexList>
+        struct Table;
+
+        template <int... Indices>
+        struct Table<IndexList<Indices...> >
+        {
+            static constexpr CopyShaderSource VARIANTS[sizeof...(Indices)] = { MakeSource(Indices)... };
+        };
+
+        template <int... Indices>
+        constexpr CopyShaderSource Table<IndexList<Indices...> >::VARIANTS[sizeof...(Indices)];
+    }
+
+    static const int COPY_SHADER_VARIANT_COUNT = CopyShaderParts::INPUT_COUNT * COPY_GEOMETRY_COUNT * COPY_OUTPUT_COUNT;
+
+    typedef CopyShaderParts::Table<CopyShaderParts::MakeIndexList<COPY_SHADER_VARIANT_COUNT>::Type> CopyShaderTable;
+
+    // Index of a variant in the table, -1 if there is none for these parameters
+    constexpr int GetCopyShaderIndex(CopySampler sampler, unsigned int geometry, CopyColor color, CopyOutput output)
+    {
+        return CopyShaderParts::GetInputIndex(sampler, color) < 0 || geometry >= COPY_GEOMETRY_COUNT ||
+                   output < COPY_OUTPUT_RGBA || output >= COPY_OUTPUT_COUNT ? -1 :
+               (CopyShaderParts::GetInputIndex(sampler, color) * COPY_GEOMETRY_COUNT + (int)geometry) *
+                   COPY_OUTPUT_COUNT + output;
+    }
+
+    // Looks a variant up when its parameters are only known at run time;
+    // nullptr if there is none
+    inline const CopyShaderSource* FindCopyShader(CopySampler sampler, unsigned int geometry, CopyColor color,
+        CopyOutput output)
+    {
+        const int index = GetCopyShaderIndex(sampler, geometry, color, output);
+        return index < 0 ? nullptr : &CopyShaderTable::VARIANTS[index];
+    }
+
+    // A variant chosen at compile time, e.g.
+    //     CopyShaderVariant<COPY_SAMPLER_2D, COPY_GEOMETRY_FLIP_Y, COPY_COLOR_NONE, COPY_OUTPUT_RGBA>::Get()
+    template <CopySampler Sampler, unsigned int Geometry, CopyColor Color, CopyOutput Output>
+    struct CopyShaderVariant
+    {
+        static_assert(CopyShaderParts::GetInputIndex(Sampler, Color) >= 0,
+            "colour conversion is required by, and only allowed with, YUV planes");
+        static_assert(Geometry < COPY_GEOMETRY_COUNT, "unknown geometry flags");
+
+        static const int INDEX = GetCopyShaderIndex(Sampler, Geometry, Color, Output);
+
+        static const CopyShaderSource& Get()
+        {
+            return CopyShaderTable::VARIANTS[INDEX];
+        }
+    };
+}
+
+#endif // _VUFORIA_MEDIA_COPY_SHADERS_H_
@@ -0,0 +1,642 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "DataSetIndex.h"
+#include "FileUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const uint32_t SIDECAR_MAGIC = 0x49444D56;      // "VMDI"
+    const uint32_t SIDECAR_VERSION = 1;
+
+    // magic, version, target count, string pool size, then the source hash (64-bit)
+    const size_t SIDECAR_HEADER_SIZE = 4 * sizeof(uint32_t) + sizeof(uint64_t);
+
+    const uint32_t MAX_TARGETS = 64 * 1024;
+    const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+
+    const char* const JAR_URL_PREFIX = "jar:file://";
+
+    // Minimal XML reader for the database descriptors: elements and their
+    // attributes. Text, comments, declarations and entities are skipped.
+    class XmlReader
+    {
+    public:
+        enum Token
+        {
+            TOKEN_START,        // <name ...> or <name .../>
+            TOKEN_END,          // </name>, also reported after a self-closing element
+            TOKEN_DONE,
+            TOKEN_ERROR
+        };
+
+        XmlReader(const char* data, size_t size) :
+            m_pos(data), m_end(data + size), m_pendingEnd(false)
+        {
+        }
+
+        Token Next()
+        {
+            m_attributes.clear();
+            if (m_pendingEnd)
+            {
+                m_pendingEnd = false;
+                return TOKEN_END;
+            }
+
+            for (;;)
+            {
+                m_pos = (const char*)memchr(m_pos, '<', m_end - m_pos);
+                if (m_pos == nullptr)
+                {
+                    m_pos = m_end;
+                    return TOKEN_DONE;
+                }
+                ++m_pos;
+
+                if (m_pos < m_end && (*m_pos == '?' || *m_pos == '!'))
+                {
+                    // Declaration or comment
+                    const char* close = (m_end - m_pos >= 3 && strncmp(m_pos, "!--", 3) == 0) ?
+                                        Find("-->") : Find(">");
+                    if (close == nullptr)
+                    {
+                        return TOKEN_ERROR;
+                    }
+                    m_pos = close;
+                    continue;
+                }
+
+                bool end = (m_pos < m_end && *m_pos == '/');
+                if (end)
+                {
+                    ++m_pos;
+                }
+                m_name = ReadName();
+                if (m_name.empty())
+                {
+                    return TOKEN_ERROR;
+                }
+
+                if (end)
+                {
+                    const char* close = Find(">");
+                    if (close == nullptr)
+                    {
+                        return TOKEN_ERROR;
+                    }
+                    m_pos = close;
+                    return TOKEN_END;
+                }
+                return ReadAttributes() ? TOKEN_START : TOKEN_ERROR;
+            }
+        }
+
+        const std::string& GetName() const { return m_name; }
+
+        const char* GetAttribute(const char* name) const
+        {
+            std::map<std::string, std::string>::const_iterator found = m_attributes.find(name);
+            return (found != m_attributes.end()) ? found->second.c_str() : nullptr;
+        }
+
+    private:
+        // Returns the position after the text, or nullptr
+        const char* Find(const char* text) const
+        {
+            size_t length = strlen(text);
+            for (const char* pos = m_pos; m_end - pos >= (ptrdiff_t)length; ++pos)
+            {
+                if (memcmp(pos, text, length) == 0)
+                {
+                    return pos + length;
+                }
+            }
+            return nullptr;
+        }
+
+        static bool IsNameChar(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '_' || c == '-' || c == '.' || c == ':';
+        }
+
+        void SkipSpaces()
+        {
+            while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n'))
+            {
+                ++m_pos;
+            }
+        }
+
+        std::string ReadName()
+        {
+            const char* start = m_pos;
+            while (m_pos < m_end && IsNameChar(*m_pos))
+            {
+                ++m_pos;
+            }
+            return std::string(start, m_pos);
+        }
+
+        bool ReadAttributes()
+        {
+            for (;;)
+            {
+                SkipSpaces();
+                if (m_pos >= m_end)
+                {
+                    return false;
+                }
+                if (*m_pos == '>')
+                {
+                    ++m_pos;
+                    return true;
+                }
+                if (*m_pos == '/')
+                {
+                    if (m_end - m_pos < 2 || m_pos[1] != '>')
+                    {
+                        return false;
+                    }
+                    m_pos += 2;
+                    m_pendingEnd = true;
+                    return true;
+                }
+
+                std::string name = ReadName();
+                SkipSpaces();
+                if (name.empty() || m_pos >= m_end || *m_pos != '=')
+                {
+                    return false;
+                }
+                ++m_pos;
+                SkipSpaces();
+                if (m_pos >= m_end || (*m_pos != '"' && *m_pos != '\''))
+                {
+                    return false;
+                }
+                char quote = *m_pos++;
+                const char* valueEnd = (const char*)memchr(m_pos, quote, m_end - m_pos);
+                if (valueEnd == nullptr)
+                {
+                    return false;
+                }
+                m_attributes[name] = std::string(m_pos, valueEnd);
+                m_pos = valueEnd + 1;
+            }
+        }
+
+        const char* m_pos;
+        const char* m_end;
+        bool m_pendingEnd;
+        std::string m_name;
+        std::map<std::string, std::string> m_attributes;
+    };
+
+    // Reads up to count space-separated floats, returns how many were read
+    int ParseFloats(const char* text, float* values, int count)
+    {
+        int parsed = 0;
+        while (text != nullptr && parsed < count)
+        {
+            char* end;
+            float value = strtof(text, &end);
+            if (end == text)
+            {
+                break;
+            }
+            values[parsed++] = value;
+            text = end;
+        }
+        return parsed;
+    }
+
+    float ParseFloat(const char* text)
+    {
+        float value = 0.0f;
+        ParseFloats(text, &value, 1);
+        return value;
+    }
+
+    bool GetTargetType(const std::string& element, int& type)
+    {
+        static const struct
+        {
+            const char* element;
+            DataSetTargetType type;
+        } s_targetTypes[] =
+        {
+            { "ImageTarget", DATA_SET_IMAGE_TARGET },
+            { "MultiTarget", DATA_SET_MULTI_TARGET },
+            { "CylinderTarget", DATA_SET_CYLINDER_TARGET },
+            { "ObjectTarget", DATA_SET_OBJECT_TARGET },
+            { "VuMark", DATA_SET_VUMARK }
+        };
+
+        for (size_t i = 0; i < sizeof(s_targetTypes) / sizeof(s_targetTypes[0]); ++i)
+        {
+            if (element == s_targetTypes[i].element)
+            {
+                type = s_targetTypes[i].type;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct ParsedTarget
+    {
+        std::string name;
+        int type;
+        float size[3];
+        std::vector<std::string> parts;     // targets a multi target is made of
+    };
+
+    void WriteUInt32(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    }
+
+    void WriteUInt64(std::vector<uint8_t>& buffer, uint64_t value)
+    {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    }
+
+    // Maps a file, or a stored entry of an APK given as jar:file://<apk>!/<entry>
+    bool MapStreamingAsset(const std::string& path, MappedFile& file)
+    {
+        size_t prefixLength = strlen(JAR_URL_PREFIX);
+        size_t separator = path.find("!/");
+        if (path.compare(0, prefixLength, JAR_URL_PREFIX) != 0 || separator == std::string::npos)
+        {
+            return file.Open(path);
+        }
+
+        ZipArchive apk;
+        return apk.Open(path.substr(prefixLength, separator - prefixLength)) &&
+               apk.MapEntry(path.substr(separator + 2), file) == ZIP_ENTRY_FOUND;
+    }
+}
+
+DataSetIndex::DataSetIndex() :
+    m_records(nullptr),
+    m_recordCount(0),
+    m_strings(nullptr),
+    m_stringsSize(0)
+{
+}
+
+std::shared_ptr<DataSetIndex> DataSetIndex::LoadOrBuild(const std::string& xmlPath, const std::string& datPath,
+                                                        const std::string& cacheDirectory)
+{
+    MappedFile xml;
+    MappedFile datFile;
+    if (!MapStreamingAsset(xmlPath, xml) || !MapStreamingAsset(datPath, datFile))
+    {
+        return std::shared_ptr<DataSetIndex>();
+    }
+
+    // The descriptor is small: hashing it is enough to detect a new version
+    // of the database, together with the size of the archive
+    std::string xmlText((const char*)xml.GetData(), xml.GetSize());
+    uint64_t sourceHash = FileUtils::HashString(xmlText) ^ ((uint64_t)datFile.GetSize() * 1099511628211ULL);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.targets", (unsigned long long)FileUtils::HashString(xmlPath));
+    std::string sidecarPath = cacheDirectory + "/" + name;
+
+    std::shared_ptr<DataSetIndex> index = std::make_shared<DataSetIndex>();
+    if (index->Load(sidecarPath, sourceHash))
+    {
+        return index;
+    }
+
+    ZipArchive dat;
+    if (!dat.Open(datFile.GetData(), datFile.GetSize()) || !index->Build(xml.GetData(), xml.GetSize(), dat))
+    {
+        return std::shared_ptr<DataSetIndex>();
+    }
+
+    if (FileUtils::MakeDirectory(cacheDirectory))
+    {
+        index->Save(sidecarPath, sourceHash);
+    }
+    return index;
+}
+
+bool DataSetIndex::Build(const uint8_t* xml, size_t xmlSize, const ZipArchive& dat)
+{
+    if (xml == nullptr)
+    {
+        return false;
+    }
+
+    // Targets are the children of <Tracking>; their own children (virtual
+    // buttons, multi target parts) only matter for multi targets
+    std::vector<ParsedTarget> targets;
+    XmlReader reader((const char*)xml, xmlSize);
+    int depth = 0;
+    int trackingDepth = -1;
+    bool done = false;
+    while (!done)
+    {
+        switch (reader.Next())
+        {
+        case XmlReader::TOKEN_START:
+        {
+            int type;
+            if (reader.GetName() == "Tracking" && trackingDepth < 0)
+            {
+                trackingDepth = depth;
+            }
+            else if (trackingDepth >= 0 && depth == trackingDepth + 1 && GetTargetType(reader.GetName(), type))
+            {
+                const char* targetName = reader.GetAttribute("name");
+                if (targetName == nullptr || *targetName == '\0' || targets.size() >= MAX_TARGETS)
+                {
+                    return false;
+                }
+
+                ParsedTarget target;
+                target.name = targetName;
+                target.type = type;
+                target.size[0] = target.size[1] = target.size[2] = 0.0f;
+                if (type == DATA_SET_CYLINDER_TARGET)
+                {
+                    target.size[0] = ParseFloat(reader.GetAttribute("sideLength"));
+                    target.size[1] = ParseFloat(reader.GetAttribute("topDiameter"));
+                    target.size[2] = ParseFloat(reader.GetAttribute("bottomDiameter"));
+                }
+                else if (type == DATA_SET_OBJECT_TARGET)
+                {
+                    float box[6];
+                    if (ParseFloats(reader.GetAttribute("bbox"), box, 6) == 6)
+                    {
+                        for (int i = 0; i < 3; ++i)
+                        {
+                            target.size[i] = box[i + 3] - box[i];
+                        }
+                    }
+                }
+                else
+                {
+                    ParseFloats(reader.GetAttribute("size"), target.size, 2);
+                }
+                targets.push_back(target);
+            }
+            else if (trackingDepth >= 0 && depth == trackingDepth + 2 && reader.GetName() == "Part" &&
+                     !targets.empty() && targets.back().type == DATA_SET_MULTI_TARGET)
+            {
+                const char* partName = reader.GetAttribute("name");
+                if (partName != nullptr)
+                {
+                    targets.back().parts.push_back(partName);
+                }
+            }
+            ++depth;
+            break;
+        }
+        case XmlReader::TOKEN_END:
+            if (--depth < 0)
+            {
+                return false;
+            }
+            if (depth == trackingDepth)
+            {
+                done = true;
+            }
+            break;
+        case XmlReader::TOKEN_DONE:
+            done = true;
+            break;
+        default:
+            return false;
+        }
+    }
+    if (targets.empty())
+    {
+        return false;
+    }
+
+    // Data entries of a target are named "<target>.<kind>", where target names
+    // can contain dots: entries go to the longest matching target name. The
+    // entries of a multi target are those of its parts.
+    std::map<std::string, std::vector<size_t> > entriesByTarget;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        entriesByTarget[targets[i].name];
+    }
+    for (size_t i = 0; i < dat.GetEntryCount(); ++i)
+    {
+        const std::string& entryName = dat.GetEntryInfo(i).name;
+        for (size_t dot = entryName.rfind('.'); dot != std::string::npos && dot > 0; dot = entryName.rfind('.', dot - 1))
+        {
+            std::map<std::string, std::vector<size_t> >::iterator owner = entriesByTarget.find(entryName.substr(0, dot));
+            if (owner != entriesByTarget.end())
+            {
+                owner->second.push_back(i);
+                break;
+            }
+        }
+    }
+
+    std::sort(targets.begin(), targets.end(),
+              [](const ParsedTarget& a, const ParsedTarget& b) { return a.name < b.name; });
+
+    std::vector<TargetRecord> records;
+    std::vector<char> strings;
+    records.reserve(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const ParsedTarget& target = targets[i];
+        if (i > 0 && target.name == targets[i - 1].name)
+        {
+            // Target names are unique within a database
+            return false;
+        }
+
+        TargetRecord record;
+        record.nameOffset = (uint32_t)strings.size();
+        record.nameLength = (uint32_t)target.name.size();
+        record.type = target.type;
+        memcpy(record.size, target.size, sizeof(record.size));
+        strings.insert(strings.end(), target.name.begin(), target.name.end());
+        strings.push_back('\0');
+
+        std::vector<std::string> dataNames(1, target.name);
+        dataNames.insert(dataNames.end(), target.parts.begin(), target.parts.end());
+
+        uint64_t dataStart = UINT64_MAX;
+        uint64_t dataSize = 0;
+        uint64_t memorySize = 0;
+        for (size_t n = 0; n < dataNames.size(); ++n)
+        {
+            const std::vector<size_t>& entries = entriesByTarget[dataNames[n]];
+            for (size_t e = 0; e < entries.size(); ++e)
+            {
+                const ZipEntryInfo& entry = dat.GetEntryInfo(entries[e]);
+                dataStart = std::min(dataStart, entry.localHeaderOffset);
+                dataSize += ZIP_LOCAL_HEADER_SIZE + entry.name.size() + entry.compressedSize;
+                memorySize += entry.uncompressedSize;
+            }
+        }
+        record.dataOffset = (dataStart != UINT64_MAX) ? (uint32_t)dataStart : 0;
+        record.dataSize = (uint32_t)std::min<uint64_t>(dataSize, UINT32_MAX);
+        record.memorySize = (uint32_t)std::min<uint64_t>(memorySize, UINT32_MAX);
+        records.push_back(record);
+    }
+
+    m_sidecar.Close();
+    m_ownedRecords.swap(records);
+    m_ownedStrings.swap(strings);
+    SetTables(&m_ownedRecords[0], m_ownedRecords.size(), &m_ownedStrings[0], m_ownedStrings.size());
+    return true;
+}
+
+bool DataSetIndex::Load(const std::string& path, uint64_t sourceHash)
+{
+    // The tables are used in place in the mapping
+    m_sidecar.Close();
+    SetTables(nullptr, 0, nullptr, 0);
+    m_ownedRecords.clear();
+    m_ownedStrings.clear();
+
+    if (!m_sidecar.Open(path) || m_sidecar.GetSize() < SIDECAR_HEADER_SIZE)
+    {
+        m_sidecar.Close();
+        return false;
+    }
+
+    const uint8_t* data = m_sidecar.GetData();
+    uint32_t header[4];
+    uint64_t hash;
+    memcpy(header, data, sizeof(header));
+    memcpy(&hash, data + sizeof(header), sizeof(hash));
+
+    uint32_t recordCount = header[2];
+    uint32_t stringsSize = header[3];
+    if (header[0] != SIDECAR_MAGIC || header[1] != SIDECAR_VERSION || hash != sourceHash ||
+        recordCount == 0 || recordCount > MAX_TARGETS || stringsSize == 0 ||
+        m_sidecar.GetSize() != SIDECAR_HEADER_SIZE + recordCount * sizeof(TargetRecord) + stringsSize)
+    {
+        m_sidecar.Close();
+        return false;
+    }
+
+    // Names must stay within the string pool
+    const TargetRecord* records = (const TargetRecord*)(data + SIDECAR_HEADER_SIZE);
+    const char* strings = (const char*)(records + recordCount);
+    for (uint32_t i = 0; i < recordCount; ++i)
+    {
+        if (records[i].nameOffset >= stringsSize || records[i].nameLength >= stringsSize - records[i].nameOffset ||
+            strings[records[i].nameOffset + records[i].nameLength] != '\0')
+        {
+            m_sidecar.Close();
+            return false;
+        }
+    }
+
+    // The header size keeps the records aligned
+    SetTables(records, recordCount, strings, stringsSize);
+    return true;
+}
+
+bool DataSetIndex::Save(const std::string& path, uint64_t sourceHash) const
+{
+    if (m_recordCount == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> header;
+    WriteUInt32(header, SIDECAR_MAGIC);
+    WriteUInt32(header, SIDECAR_VERSION);
+    WriteUInt32(header, (uint32_t)m_recordCount);
+    WriteUInt32(header, (uint32_t)m_stringsSize);
+    WriteUInt64(header, sourceHash);
+
+    // Write to a temporary file first, so that readers never map a partial file
+    std::string tempPath = path + ".tmp";
+    FILE* file = FileUtils::OpenForWriting(tempPath);
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written =
+        fwrite(&header[0], 1, header.size(), file) == header.size() &&
+        fwrite(m_records, sizeof(TargetRecord), m_recordCount, file) == m_recordCount &&
+        fwrite(m_strings, 1, m_stringsSize, file) == m_stringsSize;
+    written = (fclose(file) == 0) && written;
+
+    if (!written || !FileUtils::ReplaceFile(tempPath, path))
+    {
+        FileUtils::RemoveFile(tempPath);
+        return false;
+    }
+    return true;
+}
+
+bool DataSetIndex::GetTarget(size_t index, DataSetTarget& target) const
+{
+    if (index >= m_recordCount)
+    {
+        return false;
+    }
+
+    const TargetRecord& record = m_records[index];
+    target.name = m_strings + record.nameOffset;
+    target.type = record.type;
+    memcpy(target.size, record.size, sizeof(target.size));
+    target.dataOffset = record.dataOffset;
+    target.dataSize = record.dataSize;
+    target.memorySize = record.memorySize;
+    return true;
+}
+
+bool DataSetIndex::FindTarget(const std::string& name, DataSetTarget& target) const
+{
+    // Records are sorted by name
+    size_t low = 0;
+    size_t high = m_recordCount;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        const TargetRecord& record = m_records[middle];
+        int order = name.compare(0, std::string::npos, m_strings + record.nameOffset, record.nameLength);
+        if (order == 0)
+        {
+            return GetTarget(middle, target);
+        }
+        if (order < 0)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    return false;
+}
+
+void DataSetIndex::SetTables(const TargetRecord* records, size_t recordCount, const char* strings, size_t stringsSize)
+{
+    m_records = records;
+    m_recordCount = recordCount;
+    m_strings = strings;
+    m_stringsSize = stringsSize;
+}
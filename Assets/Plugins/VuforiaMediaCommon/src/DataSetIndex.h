@@ -0,0 +1,103 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_DATA_SET_INDEX_H_
+#define _VUFORIA_MEDIA_DATA_SET_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "ZipArchive.h"
+
+namespace VuforiaMedia
+{
+    enum DataSetTargetType
+    {
+        DATA_SET_IMAGE_TARGET,
+        DATA_SET_MULTI_TARGET,
+        DATA_SET_CYLINDER_TARGET,
+        DATA_SET_OBJECT_TARGET,
+        DATA_SET_VUMARK
+    };
+
+    // One target of a device database. Plain layout, also returned to the
+    // scripts through the plugin interface.
+    struct DataSetTarget
+    {
+        const char* name;       // points into the index, valid as long as the index
+        int type;               // DataSetTargetType
+        float size[3];          // image and VuMark: width, height
+                                // cylinder: side length, top and bottom diameters
+                                // object: bounding box extents
+        uint32_t dataOffset;    // first byte of the target's entries in the .dat file
+        uint32_t dataSize;      // bytes of the target's entries, compressed
+        uint32_t memorySize;    // bytes of the target's entries, uncompressed
+    };
+
+    // Index of the targets of a device database: the .xml descriptor and the
+    // .dat archive holding the target data.
+    //
+    // The descriptor is parsed once into a compact table of targets sorted by
+    // name, with the location of their data in the .dat archive, which is
+    // read through a memory mapping. The table is saved in a sidecar file,
+    // mapped in place by later loads, so that finding which database holds a
+    // target does not require loading any database.
+    class DataSetIndex
+    {
+    public:
+        DataSetIndex();
+
+        // Paths are UTF-8 files, or entries of an APK given as the Android
+        // streaming assets URL, jar:file://<apk>!/<entry>.
+        // Loads the sidecar if it matches the database, otherwise builds the
+        // index and writes the sidecar. Returns nullptr on failure.
+        static std::shared_ptr<DataSetIndex> LoadOrBuild(const std::string& xmlPath, const std::string& datPath,
+                                                         const std::string& cacheDirectory);
+
+        bool Build(const uint8_t* xml, size_t xmlSize, const ZipArchive& dat);
+
+        // sourceHash identifies the version of the database the index was built from
+        bool Load(const std::string& path, uint64_t sourceHash);
+        bool Save(const std::string& path, uint64_t sourceHash) const;
+
+        size_t GetTargetCount() const { return m_recordCount; }
+        bool GetTarget(size_t index, DataSetTarget& target) const;
+        bool FindTarget(const std::string& name, DataSetTarget& target) const;
+
+    private:
+        struct TargetRecord
+        {
+            uint32_t nameOffset;    // in the string pool, names are null-terminated
+            uint32_t nameLength;
+            int32_t type;
+            float size[3];
+            uint32_t dataOffset;
+            uint32_t dataSize;
+            uint32_t memorySize;
+        };
+
+        DataSetIndex(const DataSetIndex&);
+        DataSetIndex& operator=(const DataSetIndex&);
+
+        void SetTables(const TargetRecord* records, size_t recordCount, const char* strings, size_t stringsSize);
+
+        // Either point into m_sidecar, or into the owned tables after Build()
+        const TargetRecord* m_records;
+        size_t m_recordCount;
+        const char* m_strings;
+        size_t m_stringsSize;
+
+        std::vector<TargetRecord> m_ownedRecords;
+        std::vector<char> m_ownedStrings;
+        MappedFile m_sidecar;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_DATA_SET_INDEX_H_
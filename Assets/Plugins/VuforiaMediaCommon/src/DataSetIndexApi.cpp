@@ -0,0 +1,53 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "DataSetIndex.h"
+
+// Plugin interface of the device database index, the same on every platform.
+// On Windows the functions are exported through VuforiaMedia.def.
+#if defined(_WIN32)
+#define DATA_SET_INDEX_API extern "C"
+#else
+#define DATA_SET_INDEX_API extern "C" __attribute__((visibility("default")))
+#endif
+
+using namespace VuforiaMedia;
+
+typedef std::shared_ptr<DataSetIndex> DataSetIndexHandle;
+
+// Returns a handle to release with dataSetIndexClose(), or nullptr
+DATA_SET_INDEX_API void* dataSetIndexOpen(const char* xmlPath, const char* datPath, const char* cacheDirectory)
+{
+    if (xmlPath == nullptr || datPath == nullptr || cacheDirectory == nullptr)
+    {
+        return nullptr;
+    }
+
+    DataSetIndexHandle index = DataSetIndex::LoadOrBuild(xmlPath, datPath, cacheDirectory);
+    return index ? new DataSetIndexHandle(index) : nullptr;
+}
+
+DATA_SET_INDEX_API void dataSetIndexClose(void* index)
+{
+    delete (DataSetIndexHandle*)index;
+}
+
+DATA_SET_INDEX_API int dataSetIndexGetTargetCount(void* index)
+{
+    return (index != nullptr) ? (int)(*(DataSetIndexHandle*)index)->GetTargetCount() : 0;
+}
+
+DATA_SET_INDEX_API bool dataSetIndexGetTarget(void* index, int targetIndex, DataSetTarget* target)
+{
+    return index != nullptr && target != nullptr && targetIndex >= 0 &&
+           (*(DataSetIndexHandle*)index)->GetTarget((size_t)targetIndex, *target);
+}
+
+DATA_SET_INDEX_API bool dataSetIndexFindTarget(void* index, const char* name, DataSetTarget* target)
+{
+    return index != nullptr && name != nullptr && target != nullptr &&
+           (*(DataSetIndexHandle*)index)->FindTarget(name, *target);
+}
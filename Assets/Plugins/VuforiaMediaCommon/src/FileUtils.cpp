@@ -0,0 +1,182 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FileUtils.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#endif
+
+using namespace VuforiaMedia;
+
+uint64_t FileUtils::HashString(const std::string& text)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        hash ^= (uint8_t)text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+#if defined(_WIN32)
+std::wstring FileUtils::Utf8ToWide(const std::string& text)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), nullptr, 0);
+    std::wstring wide(length, L'\0');
+    if (length > 0)
+    {
+        MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), &wide[0], length);
+    }
+    return wide;
+}
+
+std::string FileUtils::WideToUtf8(const std::wstring& text)
+{
+    int length = WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), nullptr, 0, nullptr, nullptr);
+    std::string utf8(length, '\0');
+    if (length > 0)
+    {
+        WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), &utf8[0], length, nullptr, nullptr);
+    }
+    return utf8;
+}
+#endif
+
+FILE* FileUtils::OpenForWriting(const std::string& path)
+{
+#if defined(_WIN32)
+    FILE* file = nullptr;
+    _wfopen_s(&file, Utf8ToWide(path).c_str(), L"wb");
+    return file;
+#else
+    return fopen(path.c_str(), "wb");
+#endif
+}
+
+FILE* FileUtils::OpenForUpdate(const std::string& path)
+{
+#if defined(_WIN32)
+    std::wstring widePath = Utf8ToWide(path);
+    FILE* file = nullptr;
+    if (_wfopen_s(&file, widePath.c_str(), L"r+b") != 0)
+    {
+        _wfopen_s(&file, widePath.c_str(), L"w+b");
+    }
+    return file;
+#else
+    FILE* file = fopen(path.c_str(), "r+b");
+    if (file == nullptr)
+    {
+        file = fopen(path.c_str(), "w+b");
+    }
+    return file;
+#endif
+}
+
+bool FileUtils::Seek(FILE* file, uint64_t offset)
+{
+#if defined(_WIN32)
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+bool FileUtils::GetFileSize(const std::string& path, uint64_t& size)
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExW(Utf8ToWide(path).c_str(), GetFileExInfoStandard, &attributes))
+    {
+        return false;
+    }
+    size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+    return true;
+#else
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0)
+    {
+        return false;
+    }
+    size = (uint64_t)fileStat.st_size;
+    return true;
+#endif
+}
+
+bool FileUtils::MakeDirectory(const std::string& path)
+{
+#if defined(_WIN32)
+    return CreateDirectoryW(Utf8ToWide(path).c_str(), nullptr) ||
+           GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path.c_str(), 0700) == 0 || errno == EEXIST;
+#endif
+}
+
+bool FileUtils::ReplaceFile(const std::string& from, const std::string& to)
+{
+#if defined(_WIN32)
+    std::wstring wideTo = Utf8ToWide(to);
+    _wremove(wideTo.c_str());
+    return _wrename(Utf8ToWide(from).c_str(), wideTo.c_str()) == 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+void FileUtils::RemoveFile(const std::string& path)
+{
+#if defined(_WIN32)
+    _wremove(Utf8ToWide(path).c_str());
+#else
+    remove(path.c_str());
+#endif
+}
+
+void FileUtils::ListFiles(const std::string& directory, const std::string& suffix, std::vector<std::string>& names)
+{
+    names.clear();
+
+#if defined(_WIN32)
+    WIN32_FIND_DATAW findData;
+    HANDLE find = FindFirstFileExW(Utf8ToWide(directory + "\\*" + suffix).c_str(), FindExInfoBasic,
+                                   &findData, FindExSearchNameMatch, nullptr, 0);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    do
+    {
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+        {
+            names.push_back(WideToUtf8(findData.cFileName));
+        }
+    } while (FindNextFileW(find, &findData));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+        {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+#endif
+}
@@ -0,0 +1,52 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FILE_UTILS_H_
+#define _VUFORIA_MEDIA_FILE_UTILS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace VuforiaMedia
+{
+    // File helpers shared by the caches. Paths are UTF-8 encoded.
+    namespace FileUtils
+    {
+        // FNV-1a, used to derive cache file names
+        uint64_t HashString(const std::string& text);
+
+#if defined(_WIN32)
+        std::wstring Utf8ToWide(const std::string& text);
+        std::string WideToUtf8(const std::wstring& text);
+#endif
+
+        FILE* OpenForWriting(const std::string& path);
+
+        // Opens for reading and writing at any offset, creating the file if needed
+        FILE* OpenForUpdate(const std::string& path);
+
+        // 64-bit fseek(SEEK_SET)
+        bool Seek(FILE* file, uint64_t offset);
+
+        bool GetFileSize(const std::string& path, uint64_t& size);
+
+        // Succeeds if the directory already exists
+        bool MakeDirectory(const std::string& path);
+
+        // Replaces 'to' by 'from'. Writing a temporary file and replacing the
+        // target with it ensures readers never map a partial file.
+        bool ReplaceFile(const std::string& from, const std::string& to);
+
+        void RemoveFile(const std::string& path);
+
+        // Names of the files of the directory ending with the suffix
+        void ListFiles(const std::string& directory, const std::string& suffix, std::vector<std::string>& names);
+    }
+}
+
+#endif // _VUFORIA_MEDIA_FILE_UTILS_H_
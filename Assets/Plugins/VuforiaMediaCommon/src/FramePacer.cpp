@@ -0,0 +1,134 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const double DEFAULT_FRAME_RATE = 30.0;
+    const double DEFAULT_REFRESH_RATE = 60.0;
+}
+
+
+FramePacer::FramePacer(const MasterClock& clock) :
+    m_clock(clock),
+    m_frameDuration(1.0 / DEFAULT_FRAME_RATE),
+    m_refreshInterval(1.0 / DEFAULT_REFRESH_RATE)
+{
+}
+
+void FramePacer::SetFrameRate(double frameRate)
+{
+    if (frameRate > 0.0)
+    {
+        m_frameDuration = 1.0 / frameRate;
+    }
+}
+
+void FramePacer::SetDisplayRefreshRate(double refreshRate)
+{
+    if (refreshRate > 0.0)
+    {
+        m_refreshInterval = 1.0 / refreshRate;
+    }
+}
+
+double FramePacer::GetWaitTime(bool hasNextFrame, double nextDueTime) const
+{
+    if (!hasNextFrame)
+    {
+        return m_refreshInterval;
+    }
+
+    double wait = nextDueTime - m_clock.Now();
+    if (wait < m_refreshInterval * 0.5)
+    {
+        return 0.0;
+    }
+    return std::min(wait, m_frameDuration);
+}
+
+
+FramePumpThread::FramePumpThread() :
+    m_running(false),
+    m_stopRequested(false)
+{
+}
+
+FramePumpThread::~FramePumpThread()
+{
+    Stop();
+}
+
+bool FramePumpThread::Start(TickFunc tick)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_running)
+    {
+        return false;
+    }
+
+    // The previous pump may have ended by itself, its thread is done
+    if (m_thread.joinable())
+    {
+        lock.unlock();
+        m_thread.join();
+        lock.lock();
+    }
+
+    m_running = true;
+    m_stopRequested = false;
+    m_thread = std::thread(&FramePumpThread::Run, this, tick);
+    return true;
+}
+
+void FramePumpThread::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool FramePumpThread::IsRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+void FramePumpThread::Run(TickFunc tick)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopRequested)
+    {
+        lock.unlock();
+        double wait = tick();
+        lock.lock();
+
+        if (wait < 0.0)
+        {
+            break;
+        }
+
+        // Deadline on the monotonic clock, so that a spurious wakeup sleeps
+        // again for the remaining time only
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(wait));
+        m_wake.wait_until(lock, deadline, [this]() { return m_stopRequested; });
+    }
+    m_running = false;
+}
@@ -0,0 +1,85 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FRAME_PACER_H_
+#define _VUFORIA_MEDIA_FRAME_PACER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "AVSyncEngine.h"
+
+namespace VuforiaMedia
+{
+    // Decides how long the frame pump sleeps between two ticks: until the next
+    // decoded frame becomes due on the master clock.
+    //
+    // A frame due less than half a display refresh away is displayed on the
+    // same refresh as if it were due now, so the pump does not sleep for it.
+    // Sleeps are bounded by a frame duration, so that a master clock which
+    // jumps or stalls (audio seek, buffering) is followed within a frame, and
+    // the pump polls at the display refresh while no frame is queued.
+    class FramePacer
+    {
+    public:
+        explicit FramePacer(const MasterClock& clock);
+
+        void SetFrameRate(double frameRate);
+        void SetDisplayRefreshRate(double refreshRate);
+
+        // Seconds to sleep before the next tick, given the due time returned
+        // by AVSyncEngine::GetNextDueTime
+        double GetWaitTime(bool hasNextFrame, double nextDueTime) const;
+
+    private:
+        FramePacer(const FramePacer&);
+        FramePacer& operator=(const FramePacer&);
+
+        const MasterClock& m_clock;
+        double m_frameDuration;
+        double m_refreshInterval;
+    };
+
+    // Thread running the frame pump: ticks, then sleeps until the deadline
+    // returned by the tick.
+    //
+    // Stopping wakes the thread from its sleep, so it only waits for a tick
+    // in progress, if any. A tick may end the pump itself (end of stream).
+    class FramePumpThread
+    {
+    public:
+        // Returns the seconds to sleep before the next tick, or a negative
+        // value to end the pump
+        typedef std::function<double()> TickFunc;
+
+        FramePumpThread();
+        ~FramePumpThread();
+
+        // Returns false if the pump is already running
+        bool Start(TickFunc tick);
+
+        // Ends the pump and waits for its thread; not to be called from a tick
+        void Stop();
+
+        bool IsRunning() const;
+
+    private:
+        FramePumpThread(const FramePumpThread&);
+        FramePumpThread& operator=(const FramePumpThread&);
+
+        void Run(TickFunc tick);
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::thread m_thread;
+        bool m_running;
+        bool m_stopRequested;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_FRAME_PACER_H_
@@ -0,0 +1,189 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FRAME_QUEUE_H_
+#define _VUFORIA_MEDIA_FRAME_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+
+namespace VuforiaMedia
+{
+    struct FrameQueueStats
+    {
+        uint32_t depth;         // frames queued now
+        uint32_t maxDepth;      // most frames ever queued at once
+        uint32_t pushed;        // frames queued by the decoder
+        uint32_t popped;        // frames taken by the renderer
+        uint32_t overwritten;   // frames dropped because the queue was full
+    };
+
+    // Bounded single producer, single consumer queue of decoded frames, between
+    // the decoding thread and the rendering thread.
+    //
+    // Neither side ever waits: when the queue is full, pushing a frame drops the
+    // oldest queued one, which is handed to the release function. The slots are
+    // allocated once and recycled; the indices only grow, and a frame belongs to
+    // the side that moves the read index past it (the consumer popping it, or the
+    // producer overwriting it), so each frame is released exactly once.
+    //
+    // TFrame must be trivially copyable (a handle such as CMSampleBufferRef);
+    // frames still queued on destruction are released.
+    template <typename TFrame, size_t Capacity>
+    class FrameQueue
+    {
+    public:
+        typedef std::function<void(TFrame)> ReleaseFunc;
+
+        explicit FrameQueue(ReleaseFunc release) :
+            m_release(release),
+            m_read(0),
+            m_write(0),
+            m_maxDepth(0),
+            m_pushed(0),
+            m_popped(0),
+            m_overwritten(0)
+        {
+        }
+
+        ~FrameQueue()
+        {
+            Clear();
+        }
+
+        // Producer thread only. Returns false if the oldest frame was overwritten.
+        bool Push(TFrame frame)
+        {
+            const uint64_t write = m_write.load(std::memory_order_relaxed);
+            bool overwrote = false;
+
+            uint64_t read = m_read.load(std::memory_order_acquire);
+            while (write - read >= Capacity)
+            {
+                // Full: take the oldest frame, unless the consumer pops it first
+                TFrame oldest = m_slots[read % SLOT_COUNT].load(std::memory_order_relaxed);
+                if (m_read.compare_exchange_weak(read, read + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    m_release(oldest);
+                    m_overwritten.fetch_add(1, std::memory_order_relaxed);
+                    overwrote = true;
+                    read = read + 1;
+                }
+            }
+
+            // With one more slot than the capacity, the slot written is never
+            // one a consumer can still claim
+            m_slots[write % SLOT_COUNT].store(frame, std::memory_order_relaxed);
+            m_write.store(write + 1, std::memory_order_release);
+
+            m_pushed.fetch_add(1, std::memory_order_relaxed);
+            uint32_t depth = (uint32_t)(write + 1 - read);
+            if (depth > m_maxDepth.load(std::memory_order_relaxed))
+            {
+                m_maxDepth.store(depth, std::memory_order_relaxed);
+            }
+            return !overwrote;
+        }
+
+        // Consumer thread only. Takes the oldest queued frame.
+        bool Pop(TFrame& frame)
+        {
+            uint64_t read = m_read.load(std::memory_order_acquire);
+            while (true)
+            {
+                if (read == m_write.load(std::memory_order_acquire))
+                {
+                    return false;
+                }
+
+                // The value is only kept if the producer did not overwrite it meanwhile
+                TFrame candidate = m_slots[read % SLOT_COUNT].load(std::memory_order_relaxed);
+                if (m_read.compare_exchange_weak(read, read + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    frame = candidate;
+                    m_popped.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+
+        // Consumer thread only. Takes the newest queued frame and releases the
+        // older ones, which were superseded before they could be displayed.
+        bool PopLatest(TFrame& frame)
+        {
+            TFrame latest;
+            if (!Pop(latest))
+            {
+                return false;
+            }
+
+            TFrame newer;
+            while (Pop(newer))
+            {
+                m_release(latest);
+                latest = newer;
+            }
+            frame = latest;
+            return true;
+        }
+
+        // Releases the queued frames; like Pop, safe against a concurrent Push
+        void Clear()
+        {
+            TFrame frame;
+            while (Pop(frame))
+            {
+                m_release(frame);
+            }
+        }
+
+        size_t GetDepth() const
+        {
+            const uint64_t read = m_read.load(std::memory_order_acquire);
+            const uint64_t write = m_write.load(std::memory_order_acquire);
+            return write > read ? (size_t)(write - read) : 0;
+        }
+
+        FrameQueueStats GetStats() const
+        {
+            FrameQueueStats stats;
+            stats.depth = (uint32_t)GetDepth();
+            stats.maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+            stats.pushed = m_pushed.load(std::memory_order_relaxed);
+            stats.popped = m_popped.load(std::memory_order_relaxed);
+            stats.overwritten = m_overwritten.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        void ResetStats()
+        {
+            m_maxDepth.store(0, std::memory_order_relaxed);
+            m_pushed.store(0, std::memory_order_relaxed);
+            m_popped.store(0, std::memory_order_relaxed);
+            m_overwritten.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static const size_t SLOT_COUNT = Capacity + 1;
+
+        FrameQueue(const FrameQueue&);
+        FrameQueue& operator=(const FrameQueue&);
+
+        ReleaseFunc m_release;
+        std::atomic<TFrame> m_slots[SLOT_COUNT];
+        std::atomic<uint64_t> m_read;       // next frame to pop, moved by both sides
+        std::atomic<uint64_t> m_write;      // next slot to fill, moved by the producer only
+
+        std::atomic<uint32_t> m_maxDepth;
+        std::atomic<uint32_t> m_pushed;
+        std::atomic<uint32_t> m_popped;
+        std::atomic<uint32_t> m_overwritten;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_FRAME_QUEUE_H_
@@ -0,0 +1,137 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FrameSelector.h"
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // Gaps between renders, and judder, beyond which playback stalled or
+    // jumped rather than juddered
+    const double MAX_REFRESH_GAP = 0.25;
+    const double MAX_JUDDER = 0.25;
+
+    // Weight of each new render in the average interval between renders
+    const double REFRESH_INTERVAL_SMOOTHING = 0.125;
+}
+
+
+JudderMeter::JudderMeter() :
+    m_resetRequested(false),
+    m_stats(),
+    m_judderSum(0.0),
+    m_judderCount(0),
+    m_hasRefresh(false),
+    m_refreshTime(0.0),
+    m_refreshInterval(0.0),
+    m_hasFrame(false),
+    m_frameDisplayTime(0.0),
+    m_framePresentationTime(0.0)
+{
+}
+
+void JudderMeter::OnRefresh(double displayTime, bool newFrame, double presentationTime)
+{
+    ApplyResetRequest();
+
+    double gap = displayTime - m_refreshTime;
+    if (m_hasRefresh && gap > 0.0 && gap < MAX_REFRESH_GAP)
+    {
+        m_refreshInterval = (m_refreshInterval > 0.0) ?
+            m_refreshInterval + (gap - m_refreshInterval) * REFRESH_INTERVAL_SMOOTHING : gap;
+    }
+    else if (m_hasRefresh)
+    {
+        m_hasFrame = false;
+    }
+    m_hasRefresh = true;
+    m_refreshTime = displayTime;
+    ++m_stats.refreshes;
+
+    if (!newFrame)
+    {
+        if (m_hasFrame)
+        {
+            ++m_stats.repeated;
+        }
+        Publish();
+        return;
+    }
+
+    if (m_hasFrame)
+    {
+        double onScreen = displayTime - m_frameDisplayTime;
+        double duration = presentationTime - m_framePresentationTime;
+        double judder = fabs(onScreen - duration);
+        if (duration > 0.0 && judder < MAX_JUDDER)
+        {
+            m_judderSum += judder;
+            ++m_judderCount;
+            if (judder > m_stats.maxJudder)
+            {
+                m_stats.maxJudder = (float)judder;
+            }
+        }
+    }
+
+    m_hasFrame = true;
+    m_frameDisplayTime = displayTime;
+    m_framePresentationTime = presentationTime;
+    ++m_stats.frames;
+    Publish();
+}
+
+void JudderMeter::OnSkipped(uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    ApplyResetRequest();
+    m_stats.skipped += count;
+    Publish();
+}
+
+void JudderMeter::OnDiscontinuity()
+{
+    m_hasFrame = false;
+}
+
+JudderStats JudderMeter::GetStats() const
+{
+    return m_published.Read();
+}
+
+void JudderMeter::ResetStats()
+{
+    m_resetRequested.store(true, std::memory_order_release);
+
+    // Readers see the reset at once, even if nothing is rendered any more
+    JudderStats stats = m_published.Read();
+    JudderStats reset = JudderStats();
+    reset.refreshInterval = stats.refreshInterval;
+    m_published.Write(reset);
+}
+
+// [Always called from the measuring thread]
+void JudderMeter::ApplyResetRequest()
+{
+    if (m_resetRequested.exchange(false, std::memory_order_acquire))
+    {
+        m_stats = JudderStats();
+        m_judderSum = 0.0;
+        m_judderCount = 0;
+    }
+}
+
+void JudderMeter::Publish()
+{
+    m_stats.judder = m_judderCount > 0 ? (float)(m_judderSum / m_judderCount) : 0.0f;
+    m_stats.refreshInterval = (float)m_refreshInterval;
+    m_published.Write(m_stats);
+}
@@ -0,0 +1,276 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FRAME_SELECTOR_H_
+#define _VUFORIA_MEDIA_FRAME_SELECTOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <atomic>
+#include <functional>
+
+#include "SeqLock.h"
+
+namespace VuforiaMedia
+{
+    // Display cadence of a player's frames.
+    // The layout must match VideoPlayerHelper.JudderStats on the C# side.
+    struct JudderStats
+    {
+        uint32_t refreshes;         // renders measured
+        uint32_t frames;            // new frames displayed
+        uint32_t repeated;          // renders that kept the previous frame on screen
+        uint32_t skipped;           // decoded frames passed over without being displayed
+        float judder;               // mean difference between the time a frame stays on screen and its duration, in seconds
+        float maxJudder;            // largest such difference, in seconds
+        float refreshInterval;      // measured interval between renders, in seconds
+    };
+
+    // Measures how regularly the frames of a video reach the screen.
+    //
+    // On every render, the owner reports when the rendered image is displayed
+    // and, if it shows a new frame, that frame's presentation time. The time a
+    // frame stays on screen is compared to its duration, the gap to the next
+    // frame: with 30 fps on 60 Hz every frame stays two refreshes (no judder),
+    // 24 fps on 60 Hz alternates three and two (8 ms), and a frame latched one
+    // render too early or too late adds a whole refresh. Only differences are
+    // used, so each time may be on any timeline. A difference larger than a
+    // stall (pause, seek, new playlist item) starts the measure over.
+    //
+    // The measure is updated by one thread; the stats can be read and reset
+    // from any thread.
+    class JudderMeter
+    {
+    public:
+        JudderMeter();
+
+        void OnRefresh(double displayTime, bool newFrame, double presentationTime);
+        void OnSkipped(uint32_t count);
+
+        // The next frame does not follow the displayed one
+        void OnDiscontinuity();
+
+        // Average interval between renders, or 0 until measured
+        double GetRefreshInterval() const { return m_refreshInterval; }
+
+        JudderStats GetStats() const;
+
+        // Takes effect on the next render
+        void ResetStats();
+
+    private:
+        JudderMeter(const JudderMeter&);
+        JudderMeter& operator=(const JudderMeter&);
+
+        void ApplyResetRequest();
+        void Publish();
+
+        SeqLock<JudderStats> m_published;
+        std::atomic<bool> m_resetRequested;
+
+        JudderStats m_stats;
+        double m_judderSum;
+        uint32_t m_judderCount;
+
+        bool m_hasRefresh;
+        double m_refreshTime;
+        double m_refreshInterval;
+
+        bool m_hasFrame;
+        double m_frameDisplayTime;
+        double m_framePresentationTime;
+    };
+
+    // Chooses, on each render, the decoded frame to display according to the
+    // time the render reaches the screen, rather than the newest decoded frame.
+    //
+    // The frame displayed is the one being presented in the middle of the
+    // refresh interval that starts at the display time. When that middle is
+    // close to the start of the next frame, a display time predicted with some
+    // jitter would alternate between the two frames from one refresh to the
+    // next; the cadence decides instead, keeping the displayed frame on screen
+    // for the number of refreshes closest to its duration.
+    //
+    // Frames are queued in presentation order; a frame earlier than the queued
+    // ones (seek, loop) discards them. Frames passed over are handed to the
+    // release function, frames returned belong to the caller. Like the sync
+    // engine, the selector is not thread-safe: it belongs to the rendering
+    // thread, only its stats may be read from another thread.
+    template <typename TFrame, size_t Capacity>
+    class FrameSelector
+    {
+    public:
+        typedef std::function<void(TFrame)> ReleaseFunc;
+
+        explicit FrameSelector(ReleaseFunc release) :
+            m_release(release),
+            m_count(0),
+            m_defaultRefreshInterval(1.0 / 60.0),
+            m_hasCurrent(false),
+            m_currentPresentationTime(0.0),
+            m_currentRefreshes(0)
+        {
+        }
+
+        ~FrameSelector()
+        {
+            Flush();
+        }
+
+        // Refresh rate assumed until the interval between renders is measured
+        void SetDisplayRefreshRate(double refreshRate)
+        {
+            if (refreshRate > 0.0)
+            {
+                m_defaultRefreshInterval = 1.0 / refreshRate;
+            }
+        }
+
+        double GetRefreshInterval() const
+        {
+            double measured = m_meter.GetRefreshInterval();
+            return measured > 0.0 ? measured : m_defaultRefreshInterval;
+        }
+
+        void Push(double presentationTime, TFrame frame)
+        {
+            if ((m_count > 0 && presentationTime < m_frames[m_count - 1].presentationTime) ||
+                (m_count == 0 && m_hasCurrent && presentationTime < m_currentPresentationTime))
+            {
+                Flush();
+            }
+
+            if (m_count == Capacity)
+            {
+                Release(m_frames[0].frame);
+                RemoveFront(1);
+                m_meter.OnSkipped(1);
+            }
+
+            m_frames[m_count].presentationTime = presentationTime;
+            m_frames[m_count].frame = frame;
+            ++m_count;
+        }
+
+        // Returns true with the frame to display from displayTime on, false
+        // to keep the previous frame on screen
+        bool Select(double displayTime, TFrame& frame)
+        {
+            const double refreshInterval = GetRefreshInterval();
+            const double middle = displayTime + refreshInterval * 0.5;
+
+            // Newest queued frame started by the middle of the refresh (-1 for
+            // the displayed frame)
+            int selected = -1;
+            for (size_t i = 0; i < m_count && m_frames[i].presentationTime <= middle; ++i)
+            {
+                selected = (int)i;
+            }
+
+            if (m_hasCurrent && m_count > 0 && selected <= 0 &&
+                fabs(middle - m_frames[0].presentationTime) < refreshInterval * CADENCE_WINDOW)
+            {
+                double duration = m_frames[0].presentationTime - m_currentPresentationTime;
+                double replacedError = fabs(m_currentRefreshes * refreshInterval - duration);
+                double keptError = fabs((m_currentRefreshes + 1) * refreshInterval - duration);
+                selected = replacedError < keptError ? 0 : -1;
+            }
+
+            // Nothing on screen yet: an early frame is better than none
+            if (!m_hasCurrent && m_count > 0 && selected < 0)
+            {
+                selected = 0;
+            }
+
+            if (selected < 0)
+            {
+                if (m_hasCurrent)
+                {
+                    ++m_currentRefreshes;
+                }
+                m_meter.OnRefresh(displayTime, false, 0.0);
+                return false;
+            }
+
+            for (int i = 0; i < selected; ++i)
+            {
+                Release(m_frames[i].frame);
+            }
+            m_meter.OnSkipped((uint32_t)selected);
+
+            frame = m_frames[selected].frame;
+            m_hasCurrent = true;
+            m_currentPresentationTime = m_frames[selected].presentationTime;
+            m_currentRefreshes = 1;
+            RemoveFront((size_t)selected + 1);
+
+            m_meter.OnRefresh(displayTime, true, m_currentPresentationTime);
+            return true;
+        }
+
+        // Releases the queued frames and forgets the displayed one
+        void Flush()
+        {
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                Release(m_frames[i].frame);
+            }
+            m_count = 0;
+            m_hasCurrent = false;
+            m_meter.OnDiscontinuity();
+        }
+
+        size_t GetQueuedCount() const { return m_count; }
+
+        JudderStats GetStats() const { return m_meter.GetStats(); }
+        void ResetStats() { m_meter.ResetStats(); }
+
+    private:
+        // Fraction of a refresh around the start of the next frame within which
+        // the cadence decides
+        static constexpr double CADENCE_WINDOW = 0.125;
+
+        struct QueuedFrame
+        {
+            double presentationTime;
+            TFrame frame;
+        };
+
+        FrameSelector(const FrameSelector&);
+        FrameSelector& operator=(const FrameSelector&);
+
+        void RemoveFront(size_t count)
+        {
+            for (size_t i = count; i < m_count; ++i)
+            {
+                m_frames[i - count] = m_frames[i];
+            }
+            m_count -= count;
+        }
+
+        void Release(TFrame frame)
+        {
+            if (m_release)
+            {
+                m_release(frame);
+            }
+        }
+
+        ReleaseFunc m_release;
+        QueuedFrame m_frames[Capacity];
+        size_t m_count;
+        double m_defaultRefreshInterval;
+
+        bool m_hasCurrent;
+        double m_currentPresentationTime;
+        int m_currentRefreshes;
+
+        JudderMeter m_meter;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_FRAME_SELECTOR_H_
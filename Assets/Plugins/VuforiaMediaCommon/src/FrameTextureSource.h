@@ -0,0 +1,127 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FRAME_TEXTURE_SOURCE_H_
+#define _VUFORIA_MEDIA_FRAME_TEXTURE_SOURCE_H_
+
+namespace VuforiaMedia
+{
+    // Turns decoded video frames into textures the renderer samples directly,
+    // without copying their pixels. Frames and textures are native handles:
+    // on iOS a CVPixelBufferRef, and an OpenGL ES texture name or id<MTLTexture>.
+    //
+    // Must be used on the rendering thread.
+    class FrameTextureSource
+    {
+    public:
+        virtual ~FrameTextureSource() {}
+
+        // Makes frame the current texture; returns false if it cannot be wrapped
+        virtual bool SetFrame(void* frame) = 0;
+
+        // Texture of the current frame, nullptr before the first frame
+        virtual void* GetTexturePtr() const = 0;
+
+        // Releases all the frames, when the video is unloaded
+        virtual void Clear() = 0;
+    };
+
+    // Frame texture source keeping the textures of the last frames alive while
+    // the GPU may still be sampling them: a texture is released once
+    // IN_FLIGHT_FRAMES newer frames were set.
+    //
+    // TBackend wraps a native frame as a texture:
+    //     typedef ... Texture;                     // owns a wrapped frame, default constructed empty
+    //     bool Wrap(void* frame, Texture& texture);
+    //     void* GetTexturePtr(const Texture& texture) const;
+    //     void Release(Texture& texture);
+    //     void Flush();                            // recycles the released textures
+    // The backend is opaque to the source, so it can be exercised with a fake one.
+    template <typename TBackend>
+    class WrappedFrameTextureSource : public FrameTextureSource
+    {
+    public:
+        static const int IN_FLIGHT_FRAMES = 3;
+
+        explicit WrappedFrameTextureSource(TBackend* backend) :
+            m_backend(backend),
+            m_current(-1)
+        {
+            for (int i = 0; i < IN_FLIGHT_FRAMES; ++i)
+            {
+                m_frames[i] = nullptr;
+            }
+        }
+
+        virtual ~WrappedFrameTextureSource()
+        {
+            Clear();
+            delete m_backend;
+        }
+
+        virtual bool SetFrame(void* frame)
+        {
+            if (frame == nullptr)
+            {
+                return false;
+            }
+
+            // The same frame is set again until the decoder has a new one
+            if (m_current >= 0 && m_frames[m_current] == frame)
+            {
+                return true;
+            }
+
+            // Reuse the oldest entry
+            int next = (m_current + 1) % IN_FLIGHT_FRAMES;
+            if (m_frames[next] != nullptr)
+            {
+                m_backend->Release(m_textures[next]);
+                m_frames[next] = nullptr;
+            }
+            m_backend->Flush();
+
+            if (!m_backend->Wrap(frame, m_textures[next]))
+            {
+                return false;
+            }
+
+            m_frames[next] = frame;
+            m_current = next;
+            return true;
+        }
+
+        virtual void* GetTexturePtr() const
+        {
+            return m_current >= 0 ? m_backend->GetTexturePtr(m_textures[m_current]) : nullptr;
+        }
+
+        virtual void Clear()
+        {
+            for (int i = 0; i < IN_FLIGHT_FRAMES; ++i)
+            {
+                if (m_frames[i] != nullptr)
+                {
+                    m_backend->Release(m_textures[i]);
+                    m_frames[i] = nullptr;
+                }
+            }
+            m_backend->Flush();
+            m_current = -1;
+        }
+
+    private:
+        WrappedFrameTextureSource(const WrappedFrameTextureSource&);
+        WrappedFrameTextureSource& operator=(const WrappedFrameTextureSource&);
+
+        TBackend* m_backend;
+        typename TBackend::Texture m_textures[IN_FLIGHT_FRAMES];
+        void* m_frames[IN_FLIGHT_FRAMES];       // frame wrapped by each texture, nullptr if none
+        int m_current;                          // entry of the current frame, -1 if none
+    };
+}
+
+#endif // _VUFORIA_MEDIA_FRAME_TEXTURE_SOURCE_H_
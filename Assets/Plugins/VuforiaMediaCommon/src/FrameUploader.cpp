@@ -0,0 +1,157 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "FrameUploader.h"
+
+#include <string.h>
+
+#if defined(__APPLE__)
+#include <OpenGLES/ES3/gl.h>
+#include <OpenGLES/ES3/glext.h>
+#else
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#endif
+
+using namespace VuforiaMedia;
+
+#if defined(__APPLE__)
+// APPLE_texture_format_BGRA8888: BGRA data is uploaded to RGBA storage
+static const GLenum STORAGE_FORMAT = GL_RGBA8;
+static const GLenum INTERNAL_FORMAT = GL_RGBA;
+#else
+// EXT_texture_format_BGRA8888: the storage is BGRA as well
+static const GLenum STORAGE_FORMAT = GL_BGRA8_EXT;
+static const GLenum INTERNAL_FORMAT = GL_BGRA_EXT;
+#endif
+static const GLenum PIXEL_FORMAT = GL_BGRA_EXT;
+
+
+FrameUploader::FrameUploader() :
+    m_texture(0),
+    m_width(0),
+    m_height(0),
+    m_capabilitiesDetected(false),
+    m_hasTexStorage(false),
+    m_hasRowLength(false)
+{
+}
+
+bool FrameUploader::Upload(unsigned int texture, const void* pixels, int width, int height, size_t bytesPerRow)
+{
+    const size_t rowSize = (size_t)width * BYTES_PER_TEXEL;
+    if (texture == 0 || pixels == nullptr || width <= 0 || height <= 0 || bytesPerRow < rowSize)
+    {
+        return false;
+    }
+
+    if (!m_capabilitiesDetected)
+    {
+        DetectCapabilities();
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    if (texture != m_texture || width != m_width || height != m_height)
+    {
+        m_texture = texture;
+        if (!AllocateStorage(width, height))
+        {
+            Reset();
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return false;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, BYTES_PER_TEXEL);
+
+    if (bytesPerRow == rowSize)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, PIXEL_FORMAT, GL_UNSIGNED_BYTE, pixels);
+    }
+    else if (m_hasRowLength && bytesPerRow % BYTES_PER_TEXEL == 0)
+    {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(bytesPerRow / BYTES_PER_TEXEL));
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, PIXEL_FORMAT, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    else
+    {
+        // Drop the padding on the CPU, then upload the frame at once
+        m_packedRows.resize(rowSize * height);
+        const unsigned char* source = (const unsigned char*)pixels;
+        for (int row = 0; row < height; ++row)
+        {
+            memcpy(&m_packedRows[row * rowSize], source + row * bytesPerRow, rowSize);
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, PIXEL_FORMAT, GL_UNSIGNED_BYTE, &m_packedRows[0]);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void FrameUploader::Reset()
+{
+    m_texture = 0;
+    m_width = 0;
+    m_height = 0;
+}
+
+void FrameUploader::DetectCapabilities()
+{
+    // "OpenGL ES <major>.<minor> ..."
+    const char* version = (const char*)glGetString(GL_VERSION);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    bool isES3 = version != nullptr && strncmp(version, "OpenGL ES ", 10) == 0 && version[10] >= '3';
+
+    m_hasTexStorage = isES3;
+    m_hasRowLength = isES3 || (extensions != nullptr && strstr(extensions, "GL_EXT_unpack_subimage") != nullptr);
+    m_capabilitiesDetected = true;
+}
+
+bool FrameUploader::AllocateStorage(int width, int height)
+{
+    // Clear previous errors, so that the allocation can be checked
+    while (glGetError() != GL_NO_ERROR)
+    {
+    }
+
+    GLint immutable = GL_FALSE;
+    if (m_hasTexStorage)
+    {
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+        if (immutable == GL_FALSE)
+        {
+            glTexStorage2D(GL_TEXTURE_2D, 1, STORAGE_FORMAT, width, height);
+            if (glGetError() == GL_NO_ERROR)
+            {
+                m_width = width;
+                m_height = height;
+                return true;
+            }
+        }
+    }
+
+    if (immutable != GL_FALSE)
+    {
+        // The storage can only be set once: the texture must have been created
+        // with the size of the frames
+        m_width = width;
+        m_height = height;
+        return true;
+    }
+
+    glTexImage2D(GL_TEXTURE_2D, 0, INTERNAL_FORMAT, width, height, 0, PIXEL_FORMAT, GL_UNSIGNED_BYTE, nullptr);
+    if (glGetError() != GL_NO_ERROR)
+    {
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
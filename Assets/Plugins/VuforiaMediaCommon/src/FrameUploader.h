@@ -0,0 +1,57 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FRAME_UPLOADER_H_
+#define _VUFORIA_MEDIA_FRAME_UPLOADER_H_
+
+#include <stddef.h>
+#include <vector>
+
+namespace VuforiaMedia
+{
+    // Uploads decoded BGRA frames to an OpenGL ES texture, one call per frame.
+    //
+    // The storage of the texture is allocated once per texture and frame size,
+    // immutable where glTexStorage2D is available, and each frame is then a single
+    // glTexSubImage2D. Padded rows are skipped with GL_UNPACK_ROW_LENGTH on OpenGL
+    // ES 3 (or EXT_unpack_subimage); otherwise they are first packed into a staging
+    // buffer, which is still far cheaper than one upload call per row.
+    //
+    // Must be used on the thread owning the OpenGL ES context.
+    class FrameUploader
+    {
+    public:
+        static const int BYTES_PER_TEXEL = 4;
+
+        FrameUploader();
+
+        // pixels holds height rows of width BGRA texels, bytesPerRow apart.
+        // The texture is unbound on return.
+        bool Upload(unsigned int texture, const void* pixels, int width, int height, size_t bytesPerRow);
+
+        // Forgets the allocated storage, when the texture was deleted outside of the uploader
+        void Reset();
+
+    private:
+        FrameUploader(const FrameUploader&);
+        FrameUploader& operator=(const FrameUploader&);
+
+        void DetectCapabilities();
+        bool AllocateStorage(int width, int height);
+
+        unsigned int m_texture;             // texture whose storage was allocated
+        int m_width;
+        int m_height;
+
+        bool m_capabilitiesDetected;
+        bool m_hasTexStorage;
+        bool m_hasRowLength;
+
+        std::vector<unsigned char> m_packedRows;    // staging buffer without GL_UNPACK_ROW_LENGTH
+    };
+}
+
+#endif // _VUFORIA_MEDIA_FRAME_UPLOADER_H_
@@ -0,0 +1,155 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "GpuMemoryBudget.h"
+
+#include <string.h>
+#include <algorithm>
+
+using namespace VuforiaMedia;
+
+
+GpuMemoryBudget& GpuMemoryBudget::Instance()
+{
+    static GpuMemoryBudget s_instance;
+    return s_instance;
+}
+
+GpuMemoryBudget::GpuMemoryBudget() :
+    m_totalBytes(0),
+    m_cap(0),
+    m_frame(1)
+{
+    memset(m_players, 0, sizeof(m_players));
+}
+
+uint64_t GpuMemoryBudget::GetTextureSize(int width, int height, int bytesPerPixel)
+{
+    if (width <= 0 || height <= 0 || bytesPerPixel <= 0)
+    {
+        return 0;
+    }
+    return (uint64_t)width * (uint64_t)height * (uint64_t)bytesPerPixel;
+}
+
+void GpuMemoryBudget::SetAllocation(int player, GpuMemoryKind kind, uint64_t bytes)
+{
+    if (player < 0 || player >= PLAYER_COUNT || kind < 0 || kind >= GPU_MEMORY_KIND_COUNT)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    PlayerUsage& usage = m_players[player];
+    m_totalBytes = m_totalBytes - usage.bytes[kind] + bytes;
+    usage.bytes[kind] = bytes;
+
+    // A player allocating is being shown: it must not be picked before the next frame
+    usage.lastVisibleFrame = m_frame;
+}
+
+void GpuMemoryBudget::ReleasePlayer(int player)
+{
+    if (player < 0 || player >= PLAYER_COUNT)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_totalBytes -= GetPlayerBytesLocked(m_players[player]);
+    memset(&m_players[player], 0, sizeof(PlayerUsage));
+}
+
+void GpuMemoryBudget::SetCap(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cap = bytes;
+}
+
+uint64_t GpuMemoryBudget::GetCap() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cap;
+}
+
+uint64_t GpuMemoryBudget::GetTotalBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalBytes;
+}
+
+uint64_t GpuMemoryBudget::GetPlayerBytes(int player) const
+{
+    if (player < 0 || player >= PLAYER_COUNT)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetPlayerBytesLocked(m_players[player]);
+}
+
+void GpuMemoryBudget::MarkVisible(const int* players, size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_frame;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (players[i] >= 0 && players[i] < PLAYER_COUNT)
+        {
+            m_players[players[i]].lastVisibleFrame = m_frame;
+        }
+    }
+}
+
+size_t GpuMemoryBudget::SelectPlayersToHibernate(int* players, size_t maxCount) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_cap == 0 || m_totalBytes <= m_cap)
+    {
+        return 0;
+    }
+
+    // Candidates: players holding memory that were not visible in the last frame
+    int candidates[PLAYER_COUNT];
+    size_t candidateCount = 0;
+    for (int player = 0; player < PLAYER_COUNT; ++player)
+    {
+        if (m_players[player].lastVisibleFrame != m_frame && GetPlayerBytesLocked(m_players[player]) > 0)
+        {
+            candidates[candidateCount++] = player;
+        }
+    }
+
+    // Least recently visible first
+    std::sort(candidates, candidates + candidateCount, [this](int a, int b)
+    {
+        return m_players[a].lastVisibleFrame < m_players[b].lastVisibleFrame;
+    });
+
+    uint64_t totalBytes = m_totalBytes;
+    size_t count = 0;
+    for (size_t i = 0; i < candidateCount && count < maxCount && totalBytes > m_cap; ++i)
+    {
+        players[count++] = candidates[i];
+        totalBytes -= GetPlayerBytesLocked(m_players[candidates[i]]);
+    }
+    return count;
+}
+
+uint64_t GpuMemoryBudget::GetPlayerBytesLocked(const PlayerUsage& usage)
+{
+    uint64_t bytes = 0;
+    for (int kind = 0; kind < GPU_MEMORY_KIND_COUNT; ++kind)
+    {
+        bytes += usage.bytes[kind];
+    }
+    return bytes;
+}
@@ -0,0 +1,81 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_GPU_MEMORY_BUDGET_H_
+#define _VUFORIA_MEDIA_GPU_MEMORY_BUDGET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+
+#include "PlayerStatusBlock.h"
+
+namespace VuforiaMedia
+{
+    enum GpuMemoryKind
+    {
+        GPU_MEMORY_VIDEO_TEXTURE,   // texture displayed by Unity (render target of the Android FBO)
+        GPU_MEMORY_FRAME_BUFFER,    // decoder output: WSA frame texture, Android SurfaceTexture buffers
+        GPU_MEMORY_STAGING_BUFFER,  // transient read back buffers
+        GPU_MEMORY_KIND_COUNT
+    };
+
+    // Accounts the GPU memory allocated by every video player, identified by its
+    // slot in the PlayerStatusBlock, against a process-wide cap.
+    //
+    // Players report their allocations when they create or release textures.
+    // Managed code marks the players visible each frame; when the total exceeds
+    // the cap, the players to hibernate are selected least recently visible
+    // first, never among the players visible in the last frame.
+    class GpuMemoryBudget
+    {
+    public:
+        static const int PLAYER_COUNT = PlayerStatusBlock::SLOT_COUNT;
+
+        static GpuMemoryBudget& Instance();
+
+        static uint64_t GetTextureSize(int width, int height, int bytesPerPixel);
+
+        // bytes replaces the previous allocation of that kind, 0 releases it
+        void SetAllocation(int player, GpuMemoryKind kind, uint64_t bytes);
+        void ReleasePlayer(int player);
+
+        // 0 means no cap
+        void SetCap(uint64_t bytes);
+        uint64_t GetCap() const;
+
+        uint64_t GetTotalBytes() const;
+        uint64_t GetPlayerBytes(int player) const;
+
+        // Starts a new frame, in which the given players are visible
+        void MarkVisible(const int* players, size_t count);
+
+        // Fills players with the players to hibernate to get back under the cap,
+        // and returns their number (0 when within the cap)
+        size_t SelectPlayersToHibernate(int* players, size_t maxCount) const;
+
+    private:
+        struct PlayerUsage
+        {
+            uint64_t bytes[GPU_MEMORY_KIND_COUNT];
+            uint64_t lastVisibleFrame;
+        };
+
+        GpuMemoryBudget();
+        GpuMemoryBudget(const GpuMemoryBudget&);
+        GpuMemoryBudget& operator=(const GpuMemoryBudget&);
+
+        static uint64_t GetPlayerBytesLocked(const PlayerUsage& usage);
+
+        mutable std::mutex m_mutex;
+        PlayerUsage m_players[PLAYER_COUNT];
+        uint64_t m_totalBytes;
+        uint64_t m_cap;
+        uint64_t m_frame;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_GPU_MEMORY_BUDGET_H_
@@ -0,0 +1,53 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "GpuMemoryBudget.h"
+
+// Plugin interface of the GPU memory budget, the same on every platform.
+// On Windows the functions are exported through VuforiaMedia.def.
+#if defined(_WIN32)
+#define GPU_MEMORY_BUDGET_API extern "C"
+#else
+#define GPU_MEMORY_BUDGET_API extern "C" __attribute__((visibility("default")))
+#endif
+
+using namespace VuforiaMedia;
+
+GPU_MEMORY_BUDGET_API void gpuMemoryBudgetSetCap(int64_t bytes)
+{
+    GpuMemoryBudget::Instance().SetCap(bytes > 0 ? (uint64_t)bytes : 0);
+}
+
+GPU_MEMORY_BUDGET_API int64_t gpuMemoryBudgetGetCap()
+{
+    return (int64_t)GpuMemoryBudget::Instance().GetCap();
+}
+
+GPU_MEMORY_BUDGET_API int64_t gpuMemoryBudgetGetTotalBytes()
+{
+    return (int64_t)GpuMemoryBudget::Instance().GetTotalBytes();
+}
+
+GPU_MEMORY_BUDGET_API int64_t gpuMemoryBudgetGetPlayerBytes(int player)
+{
+    return (int64_t)GpuMemoryBudget::Instance().GetPlayerBytes(player);
+}
+
+// Called once per frame with the players currently rendered; returns the number
+// of players to hibernate written to playersToHibernate
+GPU_MEMORY_BUDGET_API int gpuMemoryBudgetUpdate(const int* visiblePlayers, int visibleCount,
+                                                int* playersToHibernate, int maxCount)
+{
+    GpuMemoryBudget& budget = GpuMemoryBudget::Instance();
+
+    budget.MarkVisible(visiblePlayers, (visiblePlayers != nullptr && visibleCount > 0) ? (size_t)visibleCount : 0);
+
+    if (playersToHibernate == nullptr || maxCount <= 0)
+    {
+        return 0;
+    }
+    return (int)budget.SelectPlayersToHibernate(playersToHibernate, (size_t)maxCount);
+}
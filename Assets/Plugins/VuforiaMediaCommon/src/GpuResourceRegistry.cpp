@@ -0,0 +1,318 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "GpuResourceRegistry.h"
+
+#include <string.h>
+
+#if defined(__APPLE__)
+#include <OpenGLES/ES2/gl.h>
+#include <OpenGLES/ES2/glext.h>
+#else
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#endif
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    GLuint CompileShader(GLenum type, const char* const* parts, GLsizei partCount)
+    {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, partCount, parts, nullptr);
+        glCompileShader(shader);
+
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (compiled == GL_FALSE)
+        {
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    GLuint LinkProgram(const CopyShaderSource& source)
+    {
+        GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, source.vertex, CopyShaderSource::VERTEX_PART_COUNT);
+        GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, source.fragment,
+            CopyShaderSource::FRAGMENT_PART_COUNT);
+        if (vertexShader == 0 || fragmentShader == 0)
+        {
+            glDeleteShader(vertexShader);
+            glDeleteShader(fragmentShader);
+            return 0;
+        }
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+
+        // The shaders go with the program
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+}
+
+
+GpuResourceRegistry& GpuResourceRegistry::Instance()
+{
+    static GpuResourceRegistry s_instance;
+    return s_instance;
+}
+
+GpuResourceRegistry::GpuResourceRegistry() :
+    m_context(nullptr),
+    m_restoreCount(0)
+{
+    memset(m_players, 0, sizeof(m_players));
+    memset(m_copyPrograms, 0, sizeof(m_copyPrograms));
+}
+
+unsigned int GpuResourceRegistry::GetCopyProgram(const CopyShaderSource& shader)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetCopyProgramLocked(shader);
+}
+
+unsigned int GpuResourceRegistry::CreateMediaTexture(int player)
+{
+    if (!IsValidPlayer(player))
+    {
+        return NewMediaTexture();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    GpuResources& resources = m_players[player].resources;
+    if (resources.mediaTexture != 0)
+    {
+        glDeleteTextures(1, &resources.mediaTexture);
+    }
+    resources.mediaTexture = NewMediaTexture();
+    return resources.mediaTexture;
+}
+
+unsigned int GpuResourceRegistry::CreateFrameBuffer(int player, unsigned int destTexture, int width, int height,
+    const GpuTextureFormat& format)
+{
+    if (destTexture == 0 || width <= 0 || height <= 0)
+    {
+        return 0;
+    }
+    if (!IsValidPlayer(player))
+    {
+        return NewFrameBuffer(destTexture, width, height, format);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    PlayerRecord& record = m_players[player];
+    if (record.resources.frameBuffer != 0)
+    {
+        glDeleteFramebuffers(1, &record.resources.frameBuffer);
+    }
+
+    record.resources.destTexture = destTexture;
+    record.resources.width = width;
+    record.resources.height = height;
+    record.format = format;
+    record.resources.frameBuffer = NewFrameBuffer(destTexture, width, height, format);
+    return record.resources.frameBuffer;
+}
+
+void GpuResourceRegistry::ReleaseFrameBuffer(int player, unsigned int frameBuffer)
+{
+    if (frameBuffer == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    glDeleteFramebuffers(1, &frameBuffer);
+    if (IsValidPlayer(player) && m_players[player].resources.frameBuffer == frameBuffer)
+    {
+        m_players[player].resources.frameBuffer = 0;
+        m_players[player].resources.destTexture = 0;
+    }
+}
+
+void GpuResourceRegistry::ReleasePlayer(int player)
+{
+    if (!IsValidPlayer(player))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memset(&m_players[player], 0, sizeof(m_players[player]));
+}
+
+bool GpuResourceRegistry::GetResources(int player, GpuResources& resources) const
+{
+    if (!IsValidPlayer(player))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    resources = m_players[player].resources;
+    return true;
+}
+
+bool GpuResourceRegistry::RestoreIfLost(const void* context)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_context == nullptr)
+    {
+        m_context = context;
+        return false;
+    }
+    if (!IsLostLocked(context))
+    {
+        return false;
+    }
+
+    // One pass over every player: the programs in use first, then the objects
+    // in the order they depend on each other
+    m_context = context;
+    for (int i = 0; i < COPY_SHADER_VARIANT_COUNT; ++i)
+    {
+        if (m_copyPrograms[i] != 0)
+        {
+            m_copyPrograms[i] = 0;
+            GetCopyProgramLocked(CopyShaderTable::VARIANTS[i]);
+        }
+    }
+
+    for (int i = 0; i < PLAYER_COUNT; ++i)
+    {
+        PlayerRecord& record = m_players[i];
+        GpuResources& resources = record.resources;
+        if (resources.mediaTexture == 0 && resources.frameBuffer == 0)
+        {
+            continue;
+        }
+
+        if (resources.mediaTexture != 0)
+        {
+            resources.mediaTexture = NewMediaTexture();
+        }
+        if (resources.frameBuffer != 0)
+        {
+            resources.frameBuffer = NewFrameBuffer(resources.destTexture, resources.width, resources.height,
+                record.format);
+        }
+        record.restored = true;
+    }
+
+    ++m_restoreCount;
+    return true;
+}
+
+bool GpuResourceRegistry::TakeRestored(int player, GpuResources& resources)
+{
+    if (!IsValidPlayer(player))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    PlayerRecord& record = m_players[player];
+    if (!record.restored)
+    {
+        return false;
+    }
+    record.restored = false;
+    resources = record.resources;
+    return true;
+}
+
+uint32_t GpuResourceRegistry::GetRestoreCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_restoreCount;
+}
+
+bool GpuResourceRegistry::IsValidPlayer(int player)
+{
+    return player >= 0 && player < PLAYER_COUNT;
+}
+
+unsigned int GpuResourceRegistry::NewMediaTexture()
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture);
+    glTexParameterf(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
+    return texture;
+}
+
+unsigned int GpuResourceRegistry::NewFrameBuffer(unsigned int destTexture, int width, int height,
+    const GpuTextureFormat& format)
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, destTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.format, format.type, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint frameBuffer;
+    glGenFramebuffers(1, &frameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, destTexture, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return frameBuffer;
+}
+
+unsigned int GpuResourceRegistry::GetCopyProgramLocked(const CopyShaderSource& shader)
+{
+    if (shader.index < 0 || shader.index >= COPY_SHADER_VARIANT_COUNT)
+    {
+        return 0;
+    }
+
+    unsigned int& program = m_copyPrograms[shader.index];
+    if (program == 0)
+    {
+        program = LinkProgram(shader);
+    }
+    return program;
+}
+
+bool GpuResourceRegistry::IsLostLocked(const void* context) const
+{
+    if (context != m_context)
+    {
+        return true;
+    }
+
+    // A new context may reuse the handle of the lost one, but not know its programs
+    for (int i = 0; i < COPY_SHADER_VARIANT_COUNT; ++i)
+    {
+        if (m_copyPrograms[i] != 0)
+        {
+            return glIsProgram(m_copyPrograms[i]) == GL_FALSE;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,112 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_GPU_RESOURCE_REGISTRY_H_
+#define _VUFORIA_MEDIA_GPU_RESOURCE_REGISTRY_H_
+
+#include <stdint.h>
+#include <mutex>
+
+#include "CopyShaders.h"
+#include "PlayerStatusBlock.h"
+
+namespace VuforiaMedia
+{
+    // Storage given to the video texture (OpenGL ES enums)
+    struct GpuTextureFormat
+    {
+        unsigned int internalFormat;
+        unsigned int format;
+        unsigned int type;
+    };
+
+    // OpenGL ES objects of a player, as last created or restored
+    struct GpuResources
+    {
+        unsigned int mediaTexture;      // external texture the decoder renders to, 0 if none
+        unsigned int destTexture;       // video texture displayed by Unity, 0 if none
+        unsigned int frameBuffer;       // renders to destTexture, 0 if none
+        int width;
+        int height;
+    };
+
+    // Creates the OpenGL ES objects of every player, identified by its slot in
+    // the PlayerStatusBlock, and records how they were made, so that they can
+    // all be rebuilt in a single pass when the context is lost (Android destroys
+    // the EGL context of an application sent to the background) instead of
+    // reloading the videos. The players then go on decoding from where they were.
+    //
+    // Contexts are opaque handles (EGLContext): the context is lost when the
+    // current one is not the one the objects were created in, or no longer
+    // knows the copy programs. Objects of a lost context are never deleted, they
+    // went with it. Objects created for an invalid player (without a status
+    // slot) are not recorded, and thus not restored. Must be used on the thread
+    // owning the OpenGL ES context, except ReleasePlayer.
+    class GpuResourceRegistry
+    {
+    public:
+        static const int PLAYER_COUNT = PlayerStatusBlock::SLOT_COUNT;
+
+        static GpuResourceRegistry& Instance();
+
+        // Program copying a frame to the video texture with the given
+        // variant, shared by the players; built on first use in each
+        // context, 0 if it does not compile
+        unsigned int GetCopyProgram(const CopyShaderSource& shader);
+
+        unsigned int CreateMediaTexture(int player);
+
+        // Gives the video texture the storage of the video and creates a frame
+        // buffer rendering to it, replacing the previous one of the player
+        unsigned int CreateFrameBuffer(int player, unsigned int destTexture, int width, int height,
+            const GpuTextureFormat& format);
+        void ReleaseFrameBuffer(int player, unsigned int frameBuffer);
+
+        // Forgets the objects of the player; callable from any thread, as
+        // nothing is deleted
+        void ReleasePlayer(int player);
+
+        bool GetResources(int player, GpuResources& resources) const;
+
+        // Rebuilds the objects of all the players if context is not the one
+        // they were created in; returns true if they were rebuilt
+        bool RestoreIfLost(const void* context);
+
+        // Returns true once after the objects of the player were rebuilt, with
+        // their new names
+        bool TakeRestored(int player, GpuResources& resources);
+
+        uint32_t GetRestoreCount() const;
+
+    private:
+        struct PlayerRecord
+        {
+            GpuResources resources;
+            GpuTextureFormat format;
+            bool restored;
+        };
+
+        GpuResourceRegistry();
+        GpuResourceRegistry(const GpuResourceRegistry&);
+        GpuResourceRegistry& operator=(const GpuResourceRegistry&);
+
+        static bool IsValidPlayer(int player);
+        static unsigned int NewMediaTexture();
+        static unsigned int NewFrameBuffer(unsigned int destTexture, int width, int height,
+            const GpuTextureFormat& format);
+
+        unsigned int GetCopyProgramLocked(const CopyShaderSource& shader);
+        bool IsLostLocked(const void* context) const;
+
+        mutable std::mutex m_mutex;
+        PlayerRecord m_players[PLAYER_COUNT];
+        unsigned int m_copyPrograms[COPY_SHADER_VARIANT_COUNT];    // by variant index, 0 if not built
+        const void* m_context;          // context the objects were created in, null before the first
+        uint32_t m_restoreCount;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_GPU_RESOURCE_REGISTRY_H_
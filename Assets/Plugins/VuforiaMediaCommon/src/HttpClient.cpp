@@ -0,0 +1,337 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "HttpClient.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const char HTTP_PREFIX[] = "http://";
+    const size_t HTTP_PREFIX_LENGTH = sizeof(HTTP_PREFIX) - 1;
+
+    bool StartsWithNoCase(const std::string& text, const char* prefix)
+    {
+        size_t length = strlen(prefix);
+        if (text.size() < length)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (tolower((unsigned char)text[i]) != tolower((unsigned char)prefix[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string Trim(const std::string& text)
+    {
+        size_t begin = 0;
+        size_t end = text.size();
+        while (begin < end && isspace((unsigned char)text[begin]))
+        {
+            ++begin;
+        }
+        while (end > begin && isspace((unsigned char)text[end - 1]))
+        {
+            --end;
+        }
+        return text.substr(begin, end - begin);
+    }
+}
+
+
+HttpClient::HttpClient() :
+    m_socket(SocketUtils::INVALID),
+    m_bufferedOffset(0),
+    m_bodyOffset(0),
+    m_bodyRemaining(0),
+    m_totalSize(0)
+{
+}
+
+HttpClient::~HttpClient()
+{
+    Close();
+}
+
+bool HttpClient::IsSupportedUrl(const std::string& url)
+{
+    std::string host;
+    std::string path;
+    int port;
+    return ParseUrl(url, host, port, path);
+}
+
+bool HttpClient::Get(const std::string& url, uint64_t rangeStart, int64_t rangeEnd)
+{
+    std::string currentUrl = url;
+
+    for (int redirect = 0; redirect <= MAX_REDIRECTS; ++redirect)
+    {
+        Close();
+        if (!SendRequest(currentUrl, rangeStart, rangeEnd))
+        {
+            return false;
+        }
+
+        int status = 0;
+        std::string location;
+        if (!ReadHeaders(status, location))
+        {
+            Close();
+            return false;
+        }
+
+        if (status == 200 || status == 206)
+        {
+            if (status == 200)
+            {
+                // The range was ignored, the body is the whole resource
+                m_bodyOffset = 0;
+                m_totalSize = m_bodyRemaining != UINT64_MAX ? m_bodyRemaining : 0;
+            }
+            return true;
+        }
+
+        bool isRedirect = status == 301 || status == 302 || status == 303 || status == 307 || status == 308;
+        if (!isRedirect || location.empty())
+        {
+            Close();
+            return false;
+        }
+
+        if (location[0] == '/')
+        {
+            // Relative to the host of the current URL
+            size_t pathStart = currentUrl.find('/', HTTP_PREFIX_LENGTH);
+            location = currentUrl.substr(0, pathStart) + location;
+        }
+        currentUrl = location;
+    }
+
+    Close();
+    return false;
+}
+
+int HttpClient::Read(uint8_t* buffer, size_t size)
+{
+    if (m_socket == SocketUtils::INVALID)
+    {
+        return -1;
+    }
+    if (m_bodyRemaining == 0 || size == 0)
+    {
+        return 0;
+    }
+    if (size > m_bodyRemaining)
+    {
+        size = (size_t)m_bodyRemaining;
+    }
+
+    int count;
+    if (m_bufferedOffset < m_buffered.size())
+    {
+        count = (int)std::min(size, m_buffered.size() - m_bufferedOffset);
+        memcpy(buffer, m_buffered.data() + m_bufferedOffset, (size_t)count);
+        m_bufferedOffset += (size_t)count;
+    }
+    else
+    {
+        count = SocketUtils::Receive(m_socket, buffer, size);
+        if (count < 0 || (count == 0 && m_bodyRemaining != UINT64_MAX))
+        {
+            // Error, or connection closed before the announced end of the body
+            return -1;
+        }
+    }
+
+    if (m_bodyRemaining != UINT64_MAX)
+    {
+        m_bodyRemaining -= (uint64_t)count;
+    }
+    return count;
+}
+
+void HttpClient::Close()
+{
+    if (m_socket != SocketUtils::INVALID)
+    {
+        SocketUtils::Close(m_socket);
+        m_socket = SocketUtils::INVALID;
+    }
+    m_buffered.clear();
+    m_bufferedOffset = 0;
+    m_bodyOffset = 0;
+    m_bodyRemaining = 0;
+    m_totalSize = 0;
+    m_contentType.clear();
+}
+
+bool HttpClient::ParseUrl(const std::string& url, std::string& host, int& port, std::string& path)
+{
+    if (!StartsWithNoCase(url, HTTP_PREFIX))
+    {
+        return false;
+    }
+
+    size_t pathStart = url.find('/', HTTP_PREFIX_LENGTH);
+    std::string authority = url.substr(HTTP_PREFIX_LENGTH,
+        pathStart == std::string::npos ? std::string::npos : pathStart - HTTP_PREFIX_LENGTH);
+    path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+
+    // Credentials are not supported
+    if (authority.empty() || authority.find('@') != std::string::npos)
+    {
+        return false;
+    }
+
+    port = 80;
+    size_t portStart = authority.rfind(':');
+    if (portStart != std::string::npos && authority.find(']', portStart) == std::string::npos)
+    {
+        port = atoi(authority.c_str() + portStart + 1);
+        authority.resize(portStart);
+    }
+
+    // IPv6 literal
+    if (authority.size() > 2 && authority[0] == '[' && authority[authority.size() - 1] == ']')
+    {
+        authority = authority.substr(1, authority.size() - 2);
+    }
+
+    host = authority;
+    return !host.empty() && port > 0 && port < 65536;
+}
+
+bool HttpClient::SendRequest(const std::string& url, uint64_t rangeStart, int64_t rangeEnd)
+{
+    std::string host;
+    std::string path;
+    int port;
+    if (!ParseUrl(url, host, port, path) || !SocketUtils::Startup())
+    {
+        return false;
+    }
+
+    m_socket = SocketUtils::Connect(host, port, TIMEOUT_MS);
+    if (m_socket == SocketUtils::INVALID)
+    {
+        return false;
+    }
+
+    char range[64];
+    if (rangeEnd >= 0)
+    {
+        snprintf(range, sizeof(range), "bytes=%llu-%lld", (unsigned long long)rangeStart, (long long)rangeEnd);
+    }
+    else
+    {
+        snprintf(range, sizeof(range), "bytes=%llu-", (unsigned long long)rangeStart);
+    }
+
+    std::string hostHeader = host.find(':') != std::string::npos ? "[" + host + "]" : host;
+    if (port != 80)
+    {
+        hostHeader += ":" + std::to_string(port);
+    }
+
+    std::string request =
+        "GET " + path + " HTTP/1.0\r\n"
+        "Host: " + hostHeader + "\r\n"
+        "Range: " + range + "\r\n"
+        "Accept-Encoding: identity\r\n"
+        "User-Agent: VuforiaMedia\r\n"
+        "\r\n";
+    return SocketUtils::SendAll(m_socket, request);
+}
+
+bool HttpClient::ReadHeaders(int& status, std::string& location)
+{
+    std::string headers;
+    size_t headersEnd;
+    char buffer[4096];
+    while ((headersEnd = headers.find("\r\n\r\n")) == std::string::npos)
+    {
+        if (headers.size() > MAX_HEADER_SIZE)
+        {
+            return false;
+        }
+        int count = SocketUtils::Receive(m_socket, buffer, sizeof(buffer));
+        if (count <= 0)
+        {
+            return false;
+        }
+        headers.append(buffer, (size_t)count);
+    }
+
+    m_buffered = headers.substr(headersEnd + 4);
+    m_bufferedOffset = 0;
+    headers.resize(headersEnd + 2);
+
+    // Status line: HTTP/1.x <status> <reason>
+    size_t lineEnd = headers.find("\r\n");
+    if (!StartsWithNoCase(headers, "HTTP/") || sscanf(headers.c_str(), "HTTP/%*s %d", &status) != 1)
+    {
+        return false;
+    }
+
+    m_bodyRemaining = UINT64_MAX;
+    m_bodyOffset = 0;
+    m_totalSize = 0;
+
+    for (size_t lineStart = lineEnd + 2; lineStart < headers.size(); lineStart = lineEnd + 2)
+    {
+        lineEnd = headers.find("\r\n", lineStart);
+        std::string line = headers.substr(lineStart, lineEnd - lineStart);
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+        {
+            continue;
+        }
+        std::string value = Trim(line.substr(colon + 1));
+        line.resize(colon);
+
+        if (StartsWithNoCase(line, "Content-Length") && line.size() == 14)
+        {
+            m_bodyRemaining = strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (StartsWithNoCase(line, "Content-Range") && line.size() == 13)
+        {
+            // bytes <first>-<last>/<total or *>
+            unsigned long long first = 0;
+            unsigned long long last = 0;
+            unsigned long long total = 0;
+            int fields = sscanf(value.c_str(), "bytes %llu-%llu/%llu", &first, &last, &total);
+            if (fields >= 2)
+            {
+                m_bodyOffset = first;
+            }
+            if (fields == 3)
+            {
+                m_totalSize = total;
+            }
+        }
+        else if (StartsWithNoCase(line, "Content-Type") && line.size() == 12)
+        {
+            m_contentType = value;
+        }
+        else if (StartsWithNoCase(line, "Location") && line.size() == 8)
+        {
+            location = value;
+        }
+    }
+    return true;
+}
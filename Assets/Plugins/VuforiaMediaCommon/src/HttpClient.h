@@ -0,0 +1,74 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_HTTP_CLIENT_H_
+#define _VUFORIA_MEDIA_HTTP_CLIENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "SocketUtils.h"
+
+namespace VuforiaMedia
+{
+    // Minimal HTTP client downloading byte ranges of a resource.
+    //
+    // Only plain http:// URLs are supported. Requests are sent as HTTP/1.0 so that
+    // responses are never chunk encoded; the body ends with the connection.
+    class HttpClient
+    {
+    public:
+        static const int TIMEOUT_MS = 15000;
+
+        HttpClient();
+        ~HttpClient();
+
+        static bool IsSupportedUrl(const std::string& url);
+
+        // Sends the request and reads the response headers, following redirects.
+        // rangeEnd is inclusive, a negative value requests the rest of the resource.
+        // Returns false if the server could not be reached or did not answer 200 or 206.
+        bool Get(const std::string& url, uint64_t rangeStart, int64_t rangeEnd);
+
+        // Reads the body, returns the number of bytes read, 0 at the end of the
+        // body and -1 on error
+        int Read(uint8_t* buffer, size_t size);
+
+        void Close();
+
+        // Offset of the first byte of the body: the requested start for a 206
+        // response, 0 if the server ignored the range
+        uint64_t GetBodyOffset() const { return m_bodyOffset; }
+
+        // Size of the whole resource, 0 if unknown
+        uint64_t GetTotalSize() const { return m_totalSize; }
+
+        const std::string& GetContentType() const { return m_contentType; }
+
+    private:
+        static const int MAX_REDIRECTS = 5;
+        static const size_t MAX_HEADER_SIZE = 16 * 1024;
+
+        HttpClient(const HttpClient&);
+        HttpClient& operator=(const HttpClient&);
+
+        static bool ParseUrl(const std::string& url, std::string& host, int& port, std::string& path);
+
+        bool SendRequest(const std::string& url, uint64_t rangeStart, int64_t rangeEnd);
+        bool ReadHeaders(int& status, std::string& location);
+
+        SocketUtils::Socket m_socket;
+        std::string m_buffered;     // body bytes received together with the headers
+        size_t m_bufferedOffset;
+        uint64_t m_bodyOffset;
+        uint64_t m_bodyRemaining;   // UINT64_MAX if the body size is unknown
+        uint64_t m_totalSize;
+        std::string m_contentType;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_HTTP_CLIENT_H_
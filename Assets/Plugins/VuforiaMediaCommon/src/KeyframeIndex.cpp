@@ -0,0 +1,573 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "KeyframeIndex.h"
+#include "FileUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace VuforiaMedia;
+
+const double KeyframeIndex::DEFAULT_MAX_PREROLL = 0.5;
+
+namespace
+{
+    const uint32_t SIDECAR_MAGIC = 0x494B4D56;      // "VMKI"
+    const uint32_t SIDECAR_VERSION = 1;
+
+    // magic, version, timescale, keyframe count, time-to-sample count, frame count,
+    // then source size, source modified time, duration and time offset (64-bit)
+    const size_t SIDECAR_HEADER_SIZE = 6 * sizeof(uint32_t) + 4 * sizeof(int64_t);
+
+    // Bound on table sizes, so that corrupted files cannot require huge allocations
+    const uint32_t MAX_TABLE_ENTRIES = 16 * 1024 * 1024;
+
+    uint32_t FourCC(const char* code)
+    {
+        return ((uint32_t)(uint8_t)code[0] << 24) | ((uint32_t)(uint8_t)code[1] << 16) |
+               ((uint32_t)(uint8_t)code[2] << 8) | (uint32_t)(uint8_t)code[3];
+    }
+
+    uint32_t ReadBE32(const uint8_t* data)
+    {
+        return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+               ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+    }
+
+    uint64_t ReadBE64(const uint8_t* data)
+    {
+        return ((uint64_t)ReadBE32(data) << 32) | ReadBE32(data + 4);
+    }
+
+    struct Box
+    {
+        uint32_t type;
+        const uint8_t* payload;
+        size_t size;
+    };
+
+    // Iterates the boxes of an ISO base media file container
+    class BoxReader
+    {
+    public:
+        BoxReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_pos(0) {}
+
+        bool Next(Box& box)
+        {
+            if (m_size - m_pos < 8)
+            {
+                return false;
+            }
+            const uint8_t* header = m_data + m_pos;
+            uint64_t boxSize = ReadBE32(header);
+            size_t headerSize = 8;
+            box.type = ReadBE32(header + 4);
+
+            if (boxSize == 1)
+            {
+                if (m_size - m_pos < 16)
+                {
+                    return false;
+                }
+                boxSize = ReadBE64(header + 8);
+                headerSize = 16;
+            }
+            else if (boxSize == 0)
+            {
+                // The box extends to the end of its container
+                boxSize = m_size - m_pos;
+            }
+
+            if (boxSize < headerSize || boxSize > m_size - m_pos)
+            {
+                return false;
+            }
+
+            box.payload = header + headerSize;
+            box.size = (size_t)boxSize - headerSize;
+            m_pos += (size_t)boxSize;
+            return true;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_pos;
+    };
+
+    bool FindChild(const uint8_t* data, size_t size, const char* type, Box& child)
+    {
+        BoxReader reader(data, size);
+        while (reader.Next(child))
+        {
+            if (child.type == FourCC(type))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool FindChild(const Box& parent, const char* type, Box& child)
+    {
+        return FindChild(parent.payload, parent.size, type, child);
+    }
+
+    // Full box tables: version and flags, entry count, then entries of entrySize bytes
+    bool GetTable(const Box& box, size_t entrySize, const uint8_t*& entries, uint32_t& count)
+    {
+        if (box.size < 8)
+        {
+            return false;
+        }
+        count = ReadBE32(box.payload + 4);
+        entries = box.payload + 8;
+        return count <= MAX_TABLE_ENTRIES && count <= (box.size - 8) / entrySize;
+    }
+
+    // Walks the samples in decode order, tracking their decode and presentation times
+    class SampleCursor
+    {
+    public:
+        SampleCursor(const uint8_t* stts, uint32_t sttsCount, const uint8_t* ctts, uint32_t cttsCount) :
+            m_stts(stts), m_sttsCount(sttsCount), m_sttsIndex(0), m_sttsLeft(0),
+            m_ctts(ctts), m_cttsCount(cttsCount), m_cttsIndex(0), m_cttsLeft(0),
+            m_sample(1), m_decodeTime(0)
+        {
+            m_sttsLeft = (m_sttsCount > 0) ? ReadBE32(m_stts) : 0;
+            m_cttsLeft = (m_cttsCount > 0) ? ReadBE32(m_ctts) : 0;
+        }
+
+        // Moves to the given 1-based sample number. Returns false past the last sample.
+        bool MoveTo(uint64_t sample)
+        {
+            while (m_sample < sample)
+            {
+                while (m_sttsLeft == 0)
+                {
+                    if (++m_sttsIndex >= m_sttsCount)
+                    {
+                        return false;
+                    }
+                    m_sttsLeft = ReadBE32(m_stts + m_sttsIndex * 8);
+                }
+
+                uint64_t step = std::min<uint64_t>(sample - m_sample, m_sttsLeft);
+                m_decodeTime += (int64_t)step * ReadBE32(m_stts + m_sttsIndex * 8 + 4);
+                m_sttsLeft -= (uint32_t)step;
+                m_sample += step;
+
+                SkipCompositionOffsets(step);
+            }
+            return m_sttsIndex < m_sttsCount;
+        }
+
+        int64_t GetPresentationTime() const
+        {
+            int64_t offset = 0;
+            if (m_cttsIndex < m_cttsCount)
+            {
+                offset = (int32_t)ReadBE32(m_ctts + m_cttsIndex * 8 + 4);
+            }
+            return m_decodeTime + offset;
+        }
+
+    private:
+        void SkipCompositionOffsets(uint64_t count)
+        {
+            while (count > 0 && m_cttsIndex < m_cttsCount)
+            {
+                uint64_t step = std::min<uint64_t>(count, m_cttsLeft);
+                m_cttsLeft -= (uint32_t)step;
+                count -= step;
+                while (m_cttsLeft == 0 && ++m_cttsIndex < m_cttsCount)
+                {
+                    m_cttsLeft = ReadBE32(m_ctts + m_cttsIndex * 8);
+                }
+            }
+        }
+
+        const uint8_t* m_stts;
+        uint32_t m_sttsCount;
+        uint32_t m_sttsIndex;
+        uint32_t m_sttsLeft;
+        const uint8_t* m_ctts;
+        uint32_t m_cttsCount;
+        uint32_t m_cttsIndex;
+        uint32_t m_cttsLeft;
+        uint64_t m_sample;
+        int64_t m_decodeTime;
+    };
+
+    // Media time at which the presentation starts, from the first non-empty edit
+    int64_t GetEditListStart(const Box& trak)
+    {
+        Box edts, elst;
+        if (!FindChild(trak, "edts", edts) || !FindChild(edts, "elst", elst) || elst.size < 8)
+        {
+            return 0;
+        }
+
+        int version = elst.payload[0];
+        size_t entrySize = (version == 1) ? 20 : 12;
+        const uint8_t* entries;
+        uint32_t count;
+        if (!GetTable(elst, entrySize, entries, count))
+        {
+            return 0;
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint8_t* entry = entries + i * entrySize;
+            int64_t mediaTime = (version == 1) ? (int64_t)ReadBE64(entry + 8) : (int32_t)ReadBE32(entry + 4);
+            if (mediaTime >= 0)
+            {
+                return mediaTime;
+            }
+        }
+        return 0;
+    }
+
+    void WriteUInt32(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    }
+
+    void WriteInt64(std::vector<uint8_t>& buffer, int64_t value)
+    {
+        const uint8_t* bytes = (const uint8_t*)&value;
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    }
+}
+
+
+KeyframeIndex::KeyframeIndex() :
+    m_timescale(0),
+    m_duration(0),
+    m_timeOffset(0),
+    m_frameCount(0),
+    m_keyframeTimes(nullptr),
+    m_keyframeCount(0),
+    m_timeToSample(nullptr),
+    m_timeToSampleCount(0)
+{
+}
+
+std::shared_ptr<KeyframeIndex> KeyframeIndex::LoadOrBuild(const std::string& videoPath, const Source& source,
+                                                          const std::string& cacheDirectory)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.keyframes", (unsigned long long)FileUtils::HashString(videoPath));
+    std::string sidecarPath = cacheDirectory + "/" + name;
+
+    std::shared_ptr<KeyframeIndex> index = std::make_shared<KeyframeIndex>();
+    if (index->Load(sidecarPath, source))
+    {
+        return index;
+    }
+
+    MappedFile video;
+    if (!video.Open(videoPath) || !index->Parse(video.GetData(), video.GetSize()))
+    {
+        return std::shared_ptr<KeyframeIndex>();
+    }
+
+    if (FileUtils::MakeDirectory(cacheDirectory))
+    {
+        index->Save(sidecarPath, source);
+    }
+    return index;
+}
+
+bool KeyframeIndex::Parse(const uint8_t* data, size_t size)
+{
+    Box moov;
+    if (data == nullptr || !FindChild(data, size, "moov", moov))
+    {
+        return false;
+    }
+
+    // Use the first video track
+    BoxReader tracks(moov.payload, moov.size);
+    Box trak;
+    while (tracks.Next(trak))
+    {
+        Box mdia, hdlr, mdhd, minf, stbl, stts;
+        if (trak.type != FourCC("trak") ||
+            !FindChild(trak, "mdia", mdia) ||
+            !FindChild(mdia, "hdlr", hdlr) || hdlr.size < 12 ||
+            ReadBE32(hdlr.payload + 8) != FourCC("vide") ||
+            !FindChild(mdia, "mdhd", mdhd) ||
+            !FindChild(mdia, "minf", minf) ||
+            !FindChild(minf, "stbl", stbl) ||
+            !FindChild(stbl, "stts", stts))
+        {
+            continue;
+        }
+
+        // Media header: the timescale follows the creation and modification
+        // times, which are 64-bit in version 1
+        uint32_t timescale;
+        int64_t duration;
+        if (mdhd.size >= 32 && mdhd.payload[0] == 1)
+        {
+            timescale = ReadBE32(mdhd.payload + 20);
+            duration = (int64_t)ReadBE64(mdhd.payload + 24);
+        }
+        else if (mdhd.size >= 20)
+        {
+            timescale = ReadBE32(mdhd.payload + 12);
+            duration = ReadBE32(mdhd.payload + 16);
+        }
+        else
+        {
+            return false;
+        }
+
+        const uint8_t* sttsEntries;
+        uint32_t sttsCount;
+        if (timescale == 0 || !GetTable(stts, 8, sttsEntries, sttsCount) || sttsCount == 0)
+        {
+            return false;
+        }
+
+        const uint8_t* cttsEntries = nullptr;
+        uint32_t cttsCount = 0;
+        Box ctts;
+        if (FindChild(stbl, "ctts", ctts) && !GetTable(ctts, 8, cttsEntries, cttsCount))
+        {
+            return false;
+        }
+
+        // Time-to-sample runs, in native byte order for the sidecar
+        std::vector<uint32_t> timeToSample;
+        timeToSample.reserve(sttsCount * 2);
+        uint64_t frameCount = 0;
+        for (uint32_t i = 0; i < sttsCount; ++i)
+        {
+            uint32_t count = ReadBE32(sttsEntries + i * 8);
+            timeToSample.push_back(count);
+            timeToSample.push_back(ReadBE32(sttsEntries + i * 8 + 4));
+            frameCount += count;
+        }
+        if (frameCount == 0 || frameCount > MAX_TABLE_ENTRIES)
+        {
+            return false;
+        }
+
+        // Sync samples; without a sync sample table every sample is a keyframe
+        const uint8_t* stssEntries = nullptr;
+        uint32_t stssCount = 0;
+        Box stss;
+        bool allKeyframes = !FindChild(stbl, "stss", stss);
+        if (!allKeyframes && (!GetTable(stss, 4, stssEntries, stssCount) || stssCount == 0))
+        {
+            return false;
+        }
+
+        int64_t presentationStart = GetEditListStart(trak);
+
+        std::vector<int64_t> keyframeTimes;
+        keyframeTimes.reserve(allKeyframes ? (size_t)frameCount : stssCount);
+        SampleCursor cursor(sttsEntries, sttsCount, cttsEntries, cttsCount);
+        uint64_t keyframeCount = allKeyframes ? frameCount : stssCount;
+        uint64_t previousSample = 0;
+        for (uint64_t i = 0; i < keyframeCount; ++i)
+        {
+            uint64_t sample = allKeyframes ? i + 1 : ReadBE32(stssEntries + i * 4);
+            if (sample <= previousSample || sample > frameCount || !cursor.MoveTo(sample))
+            {
+                // Sample numbers must be increasing and within the track
+                return false;
+            }
+            previousSample = sample;
+            keyframeTimes.push_back(cursor.GetPresentationTime() - presentationStart);
+        }
+        std::sort(keyframeTimes.begin(), keyframeTimes.end());
+
+        // Frame start times are computed on the decode time grid, shifted by
+        // the presentation time of the first sample
+        SampleCursor first(sttsEntries, sttsCount, cttsEntries, cttsCount);
+
+        m_sidecar.Close();
+        m_timescale = timescale;
+        m_duration = duration;
+        m_timeOffset = first.GetPresentationTime() - presentationStart;
+        m_frameCount = (size_t)frameCount;
+        m_ownedKeyframeTimes.swap(keyframeTimes);
+        m_ownedTimeToSample.swap(timeToSample);
+        SetTables(&m_ownedKeyframeTimes[0], m_ownedKeyframeTimes.size(),
+                  &m_ownedTimeToSample[0], m_ownedTimeToSample.size() / 2);
+        return true;
+    }
+
+    return false;
+}
+
+bool KeyframeIndex::Load(const std::string& path, const Source& source)
+{
+    // The tables are used in place in the mapping
+    m_sidecar.Close();
+    SetTables(nullptr, 0, nullptr, 0);
+    m_ownedKeyframeTimes.clear();
+    m_ownedTimeToSample.clear();
+
+    if (!m_sidecar.Open(path) || m_sidecar.GetSize() < SIDECAR_HEADER_SIZE)
+    {
+        m_sidecar.Close();
+        return false;
+    }
+
+    const uint8_t* data = m_sidecar.GetData();
+    uint32_t header[6];
+    int64_t header64[4];
+    memcpy(header, data, sizeof(header));
+    memcpy(header64, data + sizeof(header), sizeof(header64));
+
+    uint32_t keyframeCount = header[3];
+    uint32_t timeToSampleCount = header[4];
+    if (header[0] != SIDECAR_MAGIC || header[1] != SIDECAR_VERSION || header[2] == 0 ||
+        keyframeCount == 0 || keyframeCount > MAX_TABLE_ENTRIES ||
+        timeToSampleCount == 0 || timeToSampleCount > MAX_TABLE_ENTRIES ||
+        (uint64_t)header64[0] != source.size || header64[1] != source.modifiedTime ||
+        m_sidecar.GetSize() != SIDECAR_HEADER_SIZE + keyframeCount * sizeof(int64_t) +
+                               timeToSampleCount * 2 * sizeof(uint32_t))
+    {
+        m_sidecar.Close();
+        return false;
+    }
+
+    m_timescale = header[2];
+    m_frameCount = header[5];
+    m_duration = header64[2];
+    m_timeOffset = header64[3];
+
+    // The header size keeps the tables aligned
+    const uint8_t* tables = data + SIDECAR_HEADER_SIZE;
+    SetTables((const int64_t*)tables, keyframeCount,
+              (const uint32_t*)(tables + keyframeCount * sizeof(int64_t)), timeToSampleCount);
+    return true;
+}
+
+bool KeyframeIndex::Save(const std::string& path, const Source& source) const
+{
+    if (m_keyframeCount == 0 || m_timeToSampleCount == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> header;
+    WriteUInt32(header, SIDECAR_MAGIC);
+    WriteUInt32(header, SIDECAR_VERSION);
+    WriteUInt32(header, m_timescale);
+    WriteUInt32(header, (uint32_t)m_keyframeCount);
+    WriteUInt32(header, (uint32_t)m_timeToSampleCount);
+    WriteUInt32(header, (uint32_t)m_frameCount);
+    WriteInt64(header, (int64_t)source.size);
+    WriteInt64(header, source.modifiedTime);
+    WriteInt64(header, m_duration);
+    WriteInt64(header, m_timeOffset);
+
+    // Write to a temporary file first, so that readers never map a partial file
+    std::string tempPath = path + ".tmp";
+    FILE* file = FileUtils::OpenForWriting(tempPath);
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written =
+        fwrite(&header[0], 1, header.size(), file) == header.size() &&
+        fwrite(m_keyframeTimes, sizeof(int64_t), m_keyframeCount, file) == m_keyframeCount &&
+        fwrite(m_timeToSample, 2 * sizeof(uint32_t), m_timeToSampleCount, file) == m_timeToSampleCount;
+    written = (fclose(file) == 0) && written;
+
+    if (!written || !FileUtils::ReplaceFile(tempPath, path))
+    {
+        FileUtils::RemoveFile(tempPath);
+        return false;
+    }
+    return true;
+}
+
+double KeyframeIndex::GetDuration() const
+{
+    return (m_timescale > 0) ? (double)m_duration / m_timescale : 0.0;
+}
+
+double KeyframeIndex::FindKeyframe(double time) const
+{
+    if (m_keyframeCount == 0)
+    {
+        return 0.0;
+    }
+
+    int64_t ticks = (int64_t)(time * m_timescale + 0.5);
+    const int64_t* end = m_keyframeTimes + m_keyframeCount;
+    const int64_t* next = std::upper_bound(m_keyframeTimes, end, ticks);
+    int64_t keyframe = (next == m_keyframeTimes) ? m_keyframeTimes[0] : *(next - 1);
+    return (double)keyframe / m_timescale;
+}
+
+double KeyframeIndex::FindFrame(double time) const
+{
+    if (m_timeToSampleCount == 0)
+    {
+        return time;
+    }
+
+    int64_t ticks = (int64_t)(time * m_timescale + 0.5) - m_timeOffset;
+    int64_t runStart = 0;
+    int64_t frameStart = 0;
+    for (size_t i = 0; i < m_timeToSampleCount; ++i)
+    {
+        uint32_t count = m_timeToSample[i * 2];
+        uint32_t delta = m_timeToSample[i * 2 + 1];
+        int64_t runDuration = (int64_t)count * delta;
+
+        if (count > 0)
+        {
+            if (ticks < runStart + runDuration || i + 1 == m_timeToSampleCount)
+            {
+                int64_t frame = (delta > 0 && ticks > runStart) ? (ticks - runStart) / delta : 0;
+                frameStart = runStart + std::min<int64_t>(frame, count - 1) * delta;
+                break;
+            }
+            frameStart = runStart + (int64_t)(count - 1) * delta;
+        }
+        runStart += runDuration;
+    }
+    return (double)(frameStart + m_timeOffset) / m_timescale;
+}
+
+SeekPlan KeyframeIndex::PlanSeek(double time, double maxPreroll) const
+{
+    SeekPlan plan;
+    plan.keyframeTime = FindKeyframe(time);
+    plan.targetTime = std::max(FindFrame(time), plan.keyframeTime);
+    plan.snapped = false;
+
+    // Decoding from the keyframe up to the requested frame would take too
+    // long: show the keyframe instead
+    if (plan.targetTime - plan.keyframeTime > maxPreroll)
+    {
+        plan.targetTime = plan.keyframeTime;
+        plan.snapped = true;
+    }
+    return plan;
+}
+
+void KeyframeIndex::SetTables(const int64_t* keyframeTimes, size_t keyframeCount,
+                              const uint32_t* timeToSample, size_t timeToSampleCount)
+{
+    m_keyframeTimes = keyframeTimes;
+    m_keyframeCount = keyframeCount;
+    m_timeToSample = timeToSample;
+    m_timeToSampleCount = timeToSampleCount;
+}
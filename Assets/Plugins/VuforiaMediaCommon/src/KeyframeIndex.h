@@ -0,0 +1,99 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_KEYFRAME_INDEX_H_
+#define _VUFORIA_MEDIA_KEYFRAME_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace VuforiaMedia
+{
+    // Where to seek for a requested position
+    struct SeekPlan
+    {
+        double keyframeTime;    // the decoder starts from this keyframe
+        double targetTime;      // first frame to display
+        bool snapped;           // targetTime was moved to the keyframe to bound the pre-roll
+    };
+
+    // Keyframe and frame timestamp index of the first video track of an
+    // MP4/MOV file, built from its sample tables (stts, ctts, stss).
+    //
+    // The index is persisted in a small sidecar file, so that later loads only
+    // have to map it. Times are kept in the track timescale: keyframe
+    // presentation times, and the (sample count, sample duration) runs of the
+    // time-to-sample table for frame-accurate positions.
+    class KeyframeIndex
+    {
+    public:
+        // Seeks needing more decoding than this before the requested frame are
+        // snapped to the keyframe
+        static const double DEFAULT_MAX_PREROLL;
+
+        KeyframeIndex();
+
+        // Identity of the video the index was built from; a sidecar built
+        // from another version of the file is rejected
+        struct Source
+        {
+            uint64_t size;
+            int64_t modifiedTime;   // platform file time, only compared for equality
+        };
+
+        // Loads the sidecar if it matches the video, otherwise parses the video
+        // and writes the sidecar. Returns nullptr if the video cannot be parsed.
+        static std::shared_ptr<KeyframeIndex> LoadOrBuild(const std::string& videoPath, const Source& source,
+                                                          const std::string& cacheDirectory);
+
+        // Parses the sample tables of an MP4/MOV file in memory
+        bool Parse(const uint8_t* data, size_t size);
+
+        bool Load(const std::string& path, const Source& source);
+        bool Save(const std::string& path, const Source& source) const;
+
+        double GetDuration() const;
+        size_t GetKeyframeCount() const { return m_keyframeCount; }
+        size_t GetFrameCount() const { return m_frameCount; }
+
+        // Presentation time of the last keyframe at or before time
+        double FindKeyframe(double time) const;
+
+        // Start time of the frame displayed at time
+        double FindFrame(double time) const;
+
+        SeekPlan PlanSeek(double time, double maxPreroll = DEFAULT_MAX_PREROLL) const;
+
+    private:
+        KeyframeIndex(const KeyframeIndex&);
+        KeyframeIndex& operator=(const KeyframeIndex&);
+
+        void SetTables(const int64_t* keyframeTimes, size_t keyframeCount,
+                       const uint32_t* timeToSample, size_t timeToSampleCount);
+
+        uint32_t m_timescale;
+        int64_t m_duration;
+        int64_t m_timeOffset;       // presentation time of the first frame
+        size_t m_frameCount;
+
+        // Either point into m_sidecar, or into the owned vectors after Parse()
+        const int64_t* m_keyframeTimes;
+        size_t m_keyframeCount;
+        const uint32_t* m_timeToSample;     // (sample count, sample duration) pairs
+        size_t m_timeToSampleCount;
+
+        std::vector<int64_t> m_ownedKeyframeTimes;
+        std::vector<uint32_t> m_ownedTimeToSample;
+        MappedFile m_sidecar;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_KEYFRAME_INDEX_H_
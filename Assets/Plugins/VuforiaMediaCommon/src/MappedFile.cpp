@@ -0,0 +1,211 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "MappedFile.h"
+#include "FileUtils.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace VuforiaMedia;
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile() :
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr),
+    m_view(nullptr),
+    m_viewSize(0),
+    m_data(nullptr),
+    m_size(0)
+{
+}
+
+bool MappedFile::OpenFile(const std::string& path, uint64_t& fileSize)
+{
+    Close();
+
+    std::wstring widePath = FileUtils::Utf8ToWide(path);
+    HANDLE file = CreateFile2(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+    {
+        Close();
+        return false;
+    }
+    fileSize = (uint64_t)size.QuadPart;
+
+    m_mapping = CreateFileMappingFromApp(file, nullptr, PAGE_READONLY, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MappedFile::MapView(uint64_t offset, size_t size)
+{
+    // Views have to start on the allocation granularity
+    SYSTEM_INFO systemInfo;
+    GetNativeSystemInfo(&systemInfo);
+    uint64_t viewOffset = offset - offset % systemInfo.dwAllocationGranularity;
+    size_t delta = (size_t)(offset - viewOffset);
+
+    m_view = MapViewOfFileFromApp(m_mapping, FILE_MAP_READ, viewOffset, delta + size);
+    if (m_view == nullptr)
+    {
+        Close();
+        return false;
+    }
+    m_viewSize = delta + size;
+    m_data = (const uint8_t*)m_view + delta;
+    m_size = size;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_view != nullptr)
+    {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_viewSize = 0;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#else // !_WIN32
+
+MappedFile::MappedFile() :
+    m_fd(-1),
+    m_view(nullptr),
+    m_viewSize(0),
+    m_data(nullptr),
+    m_size(0)
+{
+}
+
+bool MappedFile::OpenFile(const std::string& path, uint64_t& fileSize)
+{
+    Close();
+
+    m_fd = open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        Close();
+        return false;
+    }
+    fileSize = (uint64_t)fileStat.st_size;
+
+    return true;
+}
+
+bool MappedFile::MapView(uint64_t offset, size_t size)
+{
+    // mmap() offsets have to be page aligned
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t viewOffset = offset - offset % pageSize;
+    size_t delta = (size_t)(offset - viewOffset);
+
+    void* view = mmap(nullptr, delta + size, PROT_READ, MAP_PRIVATE, m_fd, (off_t)viewOffset);
+    if (view == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    m_view = view;
+    m_viewSize = delta + size;
+    m_data = (const uint8_t*)view + delta;
+    m_size = size;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (m_view != nullptr)
+    {
+        munmap(m_view, m_viewSize);
+        m_view = nullptr;
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_viewSize = 0;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif // !_WIN32
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    uint64_t fileSize;
+    if (!OpenFile(path, fileSize))
+    {
+        return false;
+    }
+    if (fileSize > (size_t)-1)
+    {
+        Close();
+        return false;
+    }
+    return MapView(0, (size_t)fileSize);
+}
+
+bool MappedFile::Open(const std::string& path, uint64_t offset, size_t size)
+{
+    uint64_t fileSize;
+    if (!OpenFile(path, fileSize))
+    {
+        return false;
+    }
+    if (size == 0 || offset > fileSize || size > fileSize - offset)
+    {
+        Close();
+        return false;
+    }
+    return MapView(offset, size);
+}
@@ -0,0 +1,57 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_MAPPED_FILE_H_
+#define _VUFORIA_MEDIA_MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace VuforiaMedia
+{
+    // Read-only memory mapping of a whole file, or of a byte range of it.
+    // Uses the app-container safe mapping functions on Windows and mmap() elsewhere.
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // path is UTF-8 encoded. Empty files cannot be mapped.
+        bool Open(const std::string& path);
+
+        // Maps size bytes from offset, which needs no particular alignment:
+        // GetData() points at offset within the view.
+        bool Open(const std::string& path, uint64_t offset, size_t size);
+
+        void Close();
+
+        bool IsOpen() const { return m_data != nullptr; }
+        const uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
+
+        bool OpenFile(const std::string& path, uint64_t& fileSize);
+        bool MapView(uint64_t offset, size_t size);
+
+#if defined(_WIN32)
+        void* m_file;
+        void* m_mapping;
+#else
+        int m_fd;
+#endif
+        void* m_view;           // start of the view, aligned down from m_data
+        size_t m_viewSize;
+        const uint8_t* m_data;
+        size_t m_size;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_MAPPED_FILE_H_
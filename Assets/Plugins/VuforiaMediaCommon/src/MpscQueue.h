@@ -0,0 +1,90 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_MPSC_QUEUE_H_
+#define _VUFORIA_MEDIA_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+namespace VuforiaMedia
+{
+    // Unbounded multiple producer, single consumer FIFO queue.
+    //
+    // Any thread may push: a push is a single atomic exchange on the head of
+    // the list followed by a store linking the previous node, so producers
+    // never wait for each other nor for the consumer. Only one thread may pop.
+    //
+    // A pop racing with a push may miss the value being linked and report the
+    // queue as empty; producers are expected to signal the consumer after
+    // pushing, so the value is picked up on the next pass.
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+        MpscQueue() : m_tail(new Node())
+        {
+            m_head.store(m_tail, std::memory_order_relaxed);
+        }
+
+        ~MpscQueue()
+        {
+            T value;
+            while (Pop(value))
+            {
+            }
+            delete m_tail;
+        }
+
+        void Push(const T& value)
+        {
+            Node* node = new Node(value);
+            Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        // Consumer thread only
+        bool Pop(T& value)
+        {
+            Node* tail = m_tail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr)
+            {
+                return false;
+            }
+
+            // The next node becomes the new stub, its value is moved out
+            value = std::move(next->value);
+            m_tail = next;
+            delete tail;
+            return true;
+        }
+
+        // Consumer thread only
+        bool IsEmpty() const
+        {
+            return m_tail->next.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        struct Node
+        {
+            Node() : next(nullptr), value() {}
+            explicit Node(const T& v) : next(nullptr), value(v) {}
+
+            std::atomic<Node*> next;
+            T value;
+        };
+
+        MpscQueue(const MpscQueue&);
+        MpscQueue& operator=(const MpscQueue&);
+
+        std::atomic<Node*> m_head;      // last pushed node, shared by the producers
+        Node* m_tail;                   // stub node before the next value, owned by the consumer
+    };
+}
+
+#endif // _VUFORIA_MEDIA_MPSC_QUEUE_H_
@@ -0,0 +1,162 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "PlaybackStats.h"
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    // Upper limits of the late buckets, in seconds: within a 240 Hz refresh,
+    // then doubling up to a quarter of a second
+    const double LATE_BUCKET_LIMITS[PLAYBACK_LATE_BUCKET_COUNT - 1] =
+    {
+        0.004, 0.008, 0.016, 0.033, 0.066, 0.133, 0.266
+    };
+
+    // A gap between frames is a stall past this many usual frame intervals,
+    // and at least this long
+    const double STALL_FRAME_INTERVALS = 4.0;
+    const double MIN_STALL_TIME = 0.1;
+
+    // Gaps too long to be a frame interval (slideshows aside), which do not
+    // set the usual interval
+    const double MAX_FRAME_INTERVAL = 1.0;
+
+    // Weight of each new gap in the usual interval between frames
+    const double FRAME_INTERVAL_SMOOTHING = 0.125;
+
+    uint64_t ToNanoseconds(double seconds)
+    {
+        return seconds > 0.0 ? (uint64_t)(seconds * 1e9) : 0;
+    }
+
+    float ToSeconds(uint64_t nanoseconds)
+    {
+        return (float)(nanoseconds / 1e9);
+    }
+}
+
+
+PlaybackStatsCounters::PlaybackStatsCounters() :
+    m_restarted(false),
+    m_hasPresented(false),
+    m_presentTime(0.0),
+    m_presentInterval(0.0)
+{
+    Reset();
+}
+
+double PlaybackStatsCounters::GetLateBucketLimit(int bucket)
+{
+    if (bucket < 0 || bucket >= PLAYBACK_LATE_BUCKET_COUNT - 1)
+    {
+        return -1.0;
+    }
+    return LATE_BUCKET_LIMITS[bucket];
+}
+
+void PlaybackStatsCounters::AddDecoded(uint32_t count)
+{
+    m_decoded.fetch_add(count, std::memory_order_relaxed);
+}
+
+void PlaybackStatsCounters::AddDropped(uint32_t count)
+{
+    m_dropped.fetch_add(count, std::memory_order_relaxed);
+}
+
+void PlaybackStatsCounters::AddPresented(double lateness, double displayTime)
+{
+    m_presented.fetch_add(1, std::memory_order_relaxed);
+
+    int bucket = 0;
+    while (bucket < PLAYBACK_LATE_BUCKET_COUNT - 1 && lateness > LATE_BUCKET_LIMITS[bucket])
+    {
+        ++bucket;
+    }
+    m_late[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    if (m_restarted.exchange(false, std::memory_order_acquire))
+    {
+        m_hasPresented = false;
+    }
+
+    double gap = displayTime - m_presentTime;
+    if (m_hasPresented && gap > 0.0)
+    {
+        double stallTime = m_presentInterval * STALL_FRAME_INTERVALS;
+        if (stallTime < MIN_STALL_TIME)
+        {
+            stallTime = MIN_STALL_TIME;
+        }
+
+        if (m_presentInterval > 0.0 && gap > stallTime)
+        {
+            m_stalls.fetch_add(1, std::memory_order_relaxed);
+            m_stallTimeNs.fetch_add(ToNanoseconds(gap), std::memory_order_relaxed);
+        }
+        else if (gap < MAX_FRAME_INTERVAL)
+        {
+            m_presentInterval = (m_presentInterval > 0.0) ?
+                m_presentInterval + (gap - m_presentInterval) * FRAME_INTERVAL_SMOOTHING : gap;
+        }
+    }
+    m_hasPresented = true;
+    m_presentTime = displayTime;
+}
+
+void PlaybackStatsCounters::AddCopyTime(double seconds)
+{
+    uint64_t copyTime = ToNanoseconds(seconds);
+    m_copyTimeNs.fetch_add(copyTime, std::memory_order_relaxed);
+
+    uint64_t maxCopyTime = m_maxCopyTimeNs.load(std::memory_order_relaxed);
+    while (copyTime > maxCopyTime &&
+        !m_maxCopyTimeNs.compare_exchange_weak(maxCopyTime, copyTime, std::memory_order_relaxed))
+    {
+    }
+}
+
+void PlaybackStatsCounters::OnPlaybackStarted()
+{
+    m_restarted.store(true, std::memory_order_release);
+}
+
+PlaybackStats PlaybackStatsCounters::GetSnapshot() const
+{
+    PlaybackStats stats;
+    stats.decoded = m_decoded.load(std::memory_order_relaxed);
+    stats.presented = m_presented.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.stalls = m_stalls.load(std::memory_order_relaxed);
+    for (int i = 0; i < PLAYBACK_LATE_BUCKET_COUNT; ++i)
+    {
+        stats.late[i] = m_late[i].load(std::memory_order_relaxed);
+    }
+    stats.copyTime = ToSeconds(m_copyTimeNs.load(std::memory_order_relaxed));
+    stats.maxCopyTime = ToSeconds(m_maxCopyTimeNs.load(std::memory_order_relaxed));
+    stats.stallTime = ToSeconds(m_stallTimeNs.load(std::memory_order_relaxed));
+    return stats;
+}
+
+// The frame interval learnt so far is kept: a new video plays at the same
+// display rate more often than not
+void PlaybackStatsCounters::Reset()
+{
+    m_decoded.store(0, std::memory_order_relaxed);
+    m_presented.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_stalls.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < PLAYBACK_LATE_BUCKET_COUNT; ++i)
+    {
+        m_late[i].store(0, std::memory_order_relaxed);
+    }
+    m_copyTimeNs.store(0, std::memory_order_relaxed);
+    m_maxCopyTimeNs.store(0, std::memory_order_relaxed);
+    m_stallTimeNs.store(0, std::memory_order_relaxed);
+    OnPlaybackStarted();
+}
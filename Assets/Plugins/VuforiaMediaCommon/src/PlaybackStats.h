@@ -0,0 +1,90 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_PLAYBACK_STATS_H_
+#define _VUFORIA_MEDIA_PLAYBACK_STATS_H_
+
+#include <stdint.h>
+#include <atomic>
+
+namespace VuforiaMedia
+{
+    static const int PLAYBACK_LATE_BUCKET_COUNT = 8;
+
+    // Playback quality of a player since it loaded its video.
+    // The layout must match VideoPlayerHelper.PlaybackStats on the C# side.
+    struct PlaybackStats
+    {
+        uint32_t decoded;       // frames produced by the decoder
+        uint32_t presented;     // frames displayed
+        uint32_t dropped;       // decoded frames never displayed
+        uint32_t stalls;        // times the video froze while playing
+
+        // Displayed frames by how late they reached the screen after their
+        // presentation time (see PlaybackStatsCounters::GetLateBucketLimit)
+        uint32_t late[PLAYBACK_LATE_BUCKET_COUNT];
+
+        float copyTime;         // time spent copying frames to the video texture, in seconds
+        float maxCopyTime;      // longest copy of a frame, in seconds
+        float stallTime;        // time the video stayed frozen, in seconds
+    };
+
+    // Counters behind PlaybackStats, updated by the threads of a player as the
+    // frames go through it.
+    //
+    // Each counter is a separate atomic, so that the decoding and rendering
+    // threads count without locking, and GetSnapshot is a handful of loads from
+    // any thread (the counters are each exact, not taken at one instant).
+    //
+    // A stall is a gap between two displayed frames of several times their
+    // usual interval; it is counted when the video moves again. Starting or
+    // resuming the playback is not a stall, the owner reports it.
+    class PlaybackStatsCounters
+    {
+    public:
+        PlaybackStatsCounters();
+
+        // Upper limit of a bucket of the late histogram, in seconds; the last
+        // bucket has none
+        static double GetLateBucketLimit(int bucket);
+
+        void AddDecoded(uint32_t count);
+        void AddDropped(uint32_t count);
+
+        // A frame reached the screen lateness seconds after its presentation
+        // time (negative if early); displayTime is the time of its render, on
+        // any clock. Always called from the rendering thread.
+        void AddPresented(double lateness, double displayTime);
+
+        void AddCopyTime(double seconds);
+
+        void OnPlaybackStarted();
+
+        PlaybackStats GetSnapshot() const;
+        void Reset();
+
+    private:
+        PlaybackStatsCounters(const PlaybackStatsCounters&);
+        PlaybackStatsCounters& operator=(const PlaybackStatsCounters&);
+
+        std::atomic<uint32_t> m_decoded;
+        std::atomic<uint32_t> m_presented;
+        std::atomic<uint32_t> m_dropped;
+        std::atomic<uint32_t> m_stalls;
+        std::atomic<uint32_t> m_late[PLAYBACK_LATE_BUCKET_COUNT];
+        std::atomic<uint64_t> m_copyTimeNs;
+        std::atomic<uint64_t> m_maxCopyTimeNs;
+        std::atomic<uint64_t> m_stallTimeNs;
+
+        // Stall detection, on the rendering thread
+        std::atomic<bool> m_restarted;
+        bool m_hasPresented;
+        double m_presentTime;
+        double m_presentInterval;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_PLAYBACK_STATS_H_
@@ -0,0 +1,80 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "PlayerStatusBlock.h"
+
+using namespace VuforiaMedia;
+
+static_assert(sizeof(PlayerStatusSlot) == CACHE_LINE_SIZE, "PlayerStatusSlot must fill exactly one cache line");
+
+
+PlayerStatusBlock& PlayerStatusBlock::Instance()
+{
+    static PlayerStatusBlock s_instance;
+    return s_instance;
+}
+
+PlayerStatusBlock::PlayerStatusBlock()
+{
+    PlayerStatus status;
+    memset(&status, 0, sizeof(PlayerStatus));
+    status.state = PLAYER_STATUS_NOT_READY;
+
+    for (int slot = 0; slot < SLOT_COUNT; ++slot)
+    {
+        m_slots[slot].status.Write(status);
+        m_slotInUse[slot].store(false);
+    }
+}
+
+int PlayerStatusBlock::AcquireSlot()
+{
+    for (int slot = 0; slot < SLOT_COUNT; ++slot)
+    {
+        bool expected = false;
+        if (m_slotInUse[slot].compare_exchange_strong(expected, true))
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+void PlayerStatusBlock::ReleaseSlot(int slot)
+{
+    if (slot < 0 || slot >= SLOT_COUNT)
+    {
+        return;
+    }
+
+    // Leave a NOT_READY record behind for readers still holding the slot index
+    PlayerStatus status;
+    memset(&status, 0, sizeof(PlayerStatus));
+    status.state = PLAYER_STATUS_NOT_READY;
+    m_slots[slot].status.Write(status);
+
+    m_slotInUse[slot].store(false);
+}
+
+void PlayerStatusBlock::Publish(int slot, const PlayerStatus& status)
+{
+    if (slot < 0 || slot >= SLOT_COUNT)
+    {
+        return;
+    }
+
+    m_slots[slot].status.Write(status);
+}
+
+bool PlayerStatusBlock::Read(int slot, PlayerStatus& status) const
+{
+    if (slot < 0 || slot >= SLOT_COUNT)
+    {
+        return false;
+    }
+
+    return m_slots[slot].status.TryRead(status);
+}
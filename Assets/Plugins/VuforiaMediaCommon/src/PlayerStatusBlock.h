@@ -0,0 +1,77 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_PLAYER_STATUS_BLOCK_H_
+#define _VUFORIA_MEDIA_PLAYER_STATUS_BLOCK_H_
+
+#include "SeqLock.h"
+
+namespace VuforiaMedia
+{
+    // Media state reported for a slot that has no player bound to it
+    // (NOT_READY has the same value on all platforms)
+    static const int32_t PLAYER_STATUS_NOT_READY = 5;
+
+    // Status of one player as published by the native side.
+    // The layout must match VideoPlayerHelper.PlayerStatus on the C# side.
+    struct PlayerStatus
+    {
+        int32_t  state;                 // media state (same values on all platforms)
+        float    position;              // current position in seconds
+        float    duration;              // video length in seconds
+        int32_t  bufferingPercentage;
+        uint32_t frameCounter;          // incremented for every frame copied to the texture
+        int32_t  width;
+        int32_t  height;
+        int32_t  playlistIndex;         // playlist item being played, 0 without a playlist
+    };
+
+    // One cache line per player, so that publishing the status of one player
+    // never invalidates the line a reader is polling for another player.
+    struct PlayerStatusSlot
+    {
+        SeqLock<PlayerStatus> status;
+        char padding[CACHE_LINE_SIZE - sizeof(SeqLock<PlayerStatus>)];
+    };
+
+    // Process-wide array of player status slots.
+    //
+    // Native code publishes into the slot of a player whenever its status
+    // changes; managed code maps the array once (GetData) and reads it each
+    // frame with the SeqLock protocol, without any call into the plugin.
+    class PlayerStatusBlock
+    {
+    public:
+        static const int SLOT_COUNT = 64;
+
+        static PlayerStatusBlock& Instance();
+
+        // Claims a free slot, or returns -1 if all the slots are in use
+        int AcquireSlot();
+        void ReleaseSlot(int slot);
+
+        void Publish(int slot, const PlayerStatus& status);
+        bool Read(int slot, PlayerStatus& status) const;
+
+        const void* GetData() const { return m_slots; }
+        int GetSlotStride() const { return (int)sizeof(PlayerStatusSlot); }
+        int GetSlotCount() const { return SLOT_COUNT; }
+
+    private:
+        PlayerStatusBlock();
+        PlayerStatusBlock(const PlayerStatusBlock&);
+        PlayerStatusBlock& operator=(const PlayerStatusBlock&);
+
+#if defined(_MSC_VER)
+        __declspec(align(64)) PlayerStatusSlot m_slots[SLOT_COUNT];
+#else
+        PlayerStatusSlot m_slots[SLOT_COUNT] __attribute__((aligned(64)));
+#endif
+        std::atomic<bool> m_slotInUse[SLOT_COUNT];
+    };
+}
+
+#endif // _VUFORIA_MEDIA_PLAYER_STATUS_BLOCK_H_
@@ -0,0 +1,141 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "Playlist.h"
+
+using namespace VuforiaMedia;
+
+// Long enough to open the next file and decode its first frame
+const double Playlist::PREROLL_LEAD_SECONDS = 2.0;
+
+
+Playlist::Playlist() :
+    m_currentIndex(0),
+    m_looping(false),
+    m_prerollRequested(false)
+{
+}
+
+void Playlist::SetItems(const std::vector<std::string>& items)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string current;
+    if (m_currentIndex < (int)m_items.size())
+    {
+        current = m_items[m_currentIndex];
+    }
+
+    m_items = items;
+    m_currentIndex = 0;
+    for (size_t i = 0; i < m_items.size(); ++i)
+    {
+        if (m_items[i] == current)
+        {
+            m_currentIndex = (int)i;
+            break;
+        }
+    }
+
+    // The item after the current one may have changed
+    m_prerollRequested = false;
+}
+
+void Playlist::SetLooping(bool looping)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_looping = looping;
+    m_prerollRequested = false;
+}
+
+bool Playlist::IsLooping() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_looping;
+}
+
+size_t Playlist::GetItemCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_items.size();
+}
+
+std::string Playlist::GetItem(int index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index < 0 || index >= (int)m_items.size())
+    {
+        return std::string();
+    }
+    return m_items[index];
+}
+
+int Playlist::GetCurrentIndex() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_currentIndex;
+}
+
+int Playlist::GetNextIndex() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return GetNextIndexLocked();
+}
+
+bool Playlist::LoopsSingleItem() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_looping && m_items.size() <= 1;
+}
+
+bool Playlist::ShouldPreroll(double position, double duration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_prerollRequested || duration <= 0 || GetNextIndexLocked() < 0 ||
+        position + PREROLL_LEAD_SECONDS < duration)
+    {
+        return false;
+    }
+
+    m_prerollRequested = true;
+    return true;
+}
+
+int Playlist::Advance()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int next = GetNextIndexLocked();
+    if (next >= 0)
+    {
+        m_currentIndex = next;
+        m_prerollRequested = false;
+    }
+    return next;
+}
+
+void Playlist::Rewind()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_currentIndex = 0;
+    m_prerollRequested = false;
+}
+
+int Playlist::GetNextIndexLocked() const
+{
+    int count = (int)m_items.size();
+    if (count <= 1)
+    {
+        return -1;
+    }
+
+    if (m_currentIndex + 1 < count)
+    {
+        return m_currentIndex + 1;
+    }
+    return m_looping ? 0 : -1;
+}
@@ -0,0 +1,69 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_PLAYLIST_H_
+#define _VUFORIA_MEDIA_PLAYLIST_H_
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VuforiaMedia
+{
+    // Sequence of videos played one after the other by a single player.
+    //
+    // Item 0 is the video the player was loaded with. The player pre-rolls the
+    // next item once the current one gets within PREROLL_LEAD_SECONDS of its end,
+    // and switches to it when the current one ends instead of reporting
+    // REACHED_END, keeping its video texture when the sizes match.
+    // With looping on, the last item is followed by the first one; a single
+    // looping item is left to the loop mode of the platform decoder, which
+    // restarts it without any switch.
+    class Playlist
+    {
+    public:
+        static const double PREROLL_LEAD_SECONDS;
+
+        Playlist();
+
+        // Replaces the items; the current item is kept if it is still in the list
+        void SetItems(const std::vector<std::string>& items);
+        void SetLooping(bool looping);
+        bool IsLooping() const;
+
+        size_t GetItemCount() const;
+        std::string GetItem(int index) const;
+        int GetCurrentIndex() const;
+
+        // Item played after the current one, -1 at the end of a non-looping playlist
+        // and when a single item loops
+        int GetNextIndex() const;
+
+        // True if the current item is the only one and loops
+        bool LoopsSingleItem() const;
+
+        // Returns true once per item, when the position gets close enough to
+        // the duration for the next item to be pre-rolled
+        bool ShouldPreroll(double position, double duration);
+
+        // Moves to the next item and returns its index, or -1 at the end
+        int Advance();
+
+        // Back to the item the player was loaded with
+        void Rewind();
+
+    private:
+        int GetNextIndexLocked() const;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::string> m_items;
+        int m_currentIndex;
+        bool m_looping;
+        bool m_prerollRequested;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_PLAYLIST_H_
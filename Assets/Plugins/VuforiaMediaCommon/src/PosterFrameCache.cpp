@@ -0,0 +1,426 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "PosterFrameCache.h"
+#include "FileUtils.h"
+#include "MappedFile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const uint32_t FILE_MAGIC = 0x46504D56;    // "VMPF"
+    const uint32_t FILE_VERSION = 1;
+    const size_t FILE_HEADER_SIZE = 6 * sizeof(uint32_t);
+    const int BYTES_PER_PIXEL = 4;
+    const int MAX_FRAME_SIZE = 8192;
+
+    // LZ77 block format: a token byte holding the literal length (high nibble)
+    // and the match length minus MIN_MATCH (low nibble), each extended with
+    // 255-valued bytes when the nibble is 15, then the literals, then a 16-bit
+    // little-endian match offset. The last sequence only has literals.
+    const size_t MIN_MATCH = 4;
+    const size_t MAX_OFFSET = 65535;
+    const int HASH_BITS = 16;
+
+    void WriteUInt32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out.push_back((uint8_t)(value >> (8 * i)));
+        }
+    }
+
+    uint32_t ReadUInt32(const uint8_t* data)
+    {
+        return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+               ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+
+    void WriteLength(std::vector<uint8_t>& out, size_t length)
+    {
+        while (length >= 255)
+        {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back((uint8_t)length);
+    }
+
+    bool ReadLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (in >= end)
+            {
+                return false;
+            }
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    void EmitSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength,
+                      size_t offset, size_t matchLength)
+    {
+        bool hasMatch = matchLength >= MIN_MATCH;
+        size_t matchCode = hasMatch ? matchLength - MIN_MATCH : 0;
+
+        uint8_t token = (uint8_t)(((literalLength < 15 ? literalLength : 15) << 4) |
+                                  (matchCode < 15 ? matchCode : 15));
+        out.push_back(token);
+        if (literalLength >= 15)
+        {
+            WriteLength(out, literalLength - 15);
+        }
+        out.insert(out.end(), literals, literals + literalLength);
+
+        if (hasMatch)
+        {
+            out.push_back((uint8_t)(offset & 0xFF));
+            out.push_back((uint8_t)(offset >> 8));
+            if (matchCode >= 15)
+            {
+                WriteLength(out, matchCode - 15);
+            }
+        }
+    }
+
+    void Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+    {
+        const uint32_t NO_POSITION = 0xFFFFFFFF;
+        std::vector<uint32_t> table((size_t)1 << HASH_BITS, NO_POSITION);
+
+        size_t anchor = 0;
+        size_t pos = 0;
+        while (pos + MIN_MATCH <= size)
+        {
+            uint32_t sequence;
+            memcpy(&sequence, src + pos, sizeof(uint32_t));
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            uint32_t candidate = table[hash];
+            table[hash] = (uint32_t)pos;
+
+            if (candidate != NO_POSITION && pos - candidate <= MAX_OFFSET &&
+                memcmp(src + candidate, src + pos, MIN_MATCH) == 0)
+            {
+                size_t matchLength = MIN_MATCH;
+                while (pos + matchLength < size && src[candidate + matchLength] == src[pos + matchLength])
+                {
+                    ++matchLength;
+                }
+
+                EmitSequence(out, src + anchor, pos - anchor, pos - candidate, matchLength);
+                pos += matchLength;
+                anchor = pos;
+            }
+            else
+            {
+                ++pos;
+            }
+        }
+
+        EmitSequence(out, src + anchor, size - anchor, 0, 0);
+    }
+
+    bool Decompress(const uint8_t* in, size_t size, uint8_t* dst, size_t dstSize)
+    {
+        const uint8_t* end = in + size;
+        size_t pos = 0;
+        bool lastSequence = false;
+
+        while (in < end)
+        {
+            uint8_t token = *in++;
+
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !ReadLength(in, end, literalLength))
+            {
+                return false;
+            }
+            if (literalLength > (size_t)(end - in) || literalLength > dstSize - pos)
+            {
+                return false;
+            }
+            memcpy(dst + pos, in, literalLength);
+            in += literalLength;
+            pos += literalLength;
+
+            if (in == end)
+            {
+                lastSequence = true;
+                break;
+            }
+
+            if (end - in < 2)
+            {
+                return false;
+            }
+            size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+            in += 2;
+
+            size_t matchLength = token & 0x0F;
+            if (matchLength == 15 && !ReadLength(in, end, matchLength))
+            {
+                return false;
+            }
+            matchLength += MIN_MATCH;
+
+            if (offset == 0 || offset > pos || matchLength > dstSize - pos)
+            {
+                return false;
+            }
+
+            // Byte by byte, as the match may overlap the bytes being written
+            const uint8_t* match = dst + pos - offset;
+            for (size_t i = 0; i < matchLength; ++i)
+            {
+                dst[pos + i] = match[i];
+            }
+            pos += matchLength;
+        }
+
+        // A stream cut right after a match would otherwise pass for complete
+        return lastSequence && pos == dstSize;
+    }
+}
+
+std::string PosterFrameKey::ToString() const
+{
+    // Positions are compared at millisecond precision
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), "|%lld|%d",
+             (long long)modifiedTime, (int)(position * 1000.0f + 0.5f));
+    return path + suffix;
+}
+
+std::string PosterFrameKey::GetFileName() const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.poster", (unsigned long long)FileUtils::HashString(ToString()));
+    return name;
+}
+
+
+PosterFrameCache::PosterFrameCache(const std::string& directory, size_t memoryBudget) :
+    m_directory(directory),
+    m_memoryBudget(memoryBudget),
+    m_memoryUsed(0)
+{
+}
+
+std::shared_ptr<const PosterFrame> PosterFrameCache::Find(const PosterFrameKey& key)
+{
+    std::string name = key.GetFileName();
+
+    std::shared_ptr<const PosterFrame> frame = FindInMemory(name);
+    if (frame)
+    {
+        return frame;
+    }
+
+    frame = ReadFile(key, m_directory + "/" + name);
+    if (frame)
+    {
+        AddToMemory(name, frame);
+    }
+    return frame;
+}
+
+bool PosterFrameCache::Store(const PosterFrameKey& key, const std::shared_ptr<const PosterFrame>& frame)
+{
+    if (!frame || frame->width <= 0 || frame->height <= 0 ||
+        frame->width > MAX_FRAME_SIZE || frame->height > MAX_FRAME_SIZE ||
+        frame->pixels.size() != (size_t)frame->width * frame->height * BYTES_PER_PIXEL)
+    {
+        return false;
+    }
+
+    std::string name = key.GetFileName();
+    std::string keyText = key.ToString();
+
+    std::vector<uint8_t> encoded;
+    Encode(*frame, encoded);
+
+    std::vector<uint8_t> header;
+    WriteUInt32(header, FILE_MAGIC);
+    WriteUInt32(header, FILE_VERSION);
+    WriteUInt32(header, (uint32_t)frame->width);
+    WriteUInt32(header, (uint32_t)frame->height);
+    WriteUInt32(header, (uint32_t)keyText.size());
+    WriteUInt32(header, (uint32_t)encoded.size());
+
+    if (!FileUtils::MakeDirectory(m_directory))
+    {
+        return false;
+    }
+
+    // Write to a temporary file first, so that readers never map a partial file
+    std::string path = m_directory + "/" + name;
+    std::string tempPath = path + ".tmp";
+    FILE* file = FileUtils::OpenForWriting(tempPath);
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written =
+        fwrite(&header[0], 1, header.size(), file) == header.size() &&
+        fwrite(keyText.data(), 1, keyText.size(), file) == keyText.size() &&
+        fwrite(&encoded[0], 1, encoded.size(), file) == encoded.size();
+    written = (fclose(file) == 0) && written;
+
+    if (!written || !FileUtils::ReplaceFile(tempPath, path))
+    {
+        FileUtils::RemoveFile(tempPath);
+        return false;
+    }
+
+    AddToMemory(name, frame);
+    return true;
+}
+
+void PosterFrameCache::ClearMemory()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryEntries.clear();
+    m_memoryUsed = 0;
+}
+
+void PosterFrameCache::Encode(const PosterFrame& frame, std::vector<uint8_t>& encoded)
+{
+    // Replace every byte by its difference with the same channel of the previous
+    // pixel: neighbouring pixels are similar, so this produces many repeated values
+    size_t rowSize = (size_t)frame.width * BYTES_PER_PIXEL;
+    std::vector<uint8_t> filtered(frame.pixels.size());
+    for (int y = 0; y < frame.height; ++y)
+    {
+        const uint8_t* src = &frame.pixels[y * rowSize];
+        uint8_t* dst = &filtered[y * rowSize];
+        for (size_t i = 0; i < rowSize; ++i)
+        {
+            dst[i] = (uint8_t)(src[i] - (i >= BYTES_PER_PIXEL ? src[i - BYTES_PER_PIXEL] : 0));
+        }
+    }
+
+    encoded.clear();
+    encoded.reserve(filtered.size() / 2);
+    Compress(filtered.empty() ? nullptr : &filtered[0], filtered.size(), encoded);
+}
+
+bool PosterFrameCache::Decode(const uint8_t* data, size_t size, int width, int height, PosterFrame& frame)
+{
+    if (width <= 0 || height <= 0 || width > MAX_FRAME_SIZE || height > MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+
+    size_t rowSize = (size_t)width * BYTES_PER_PIXEL;
+    frame.width = width;
+    frame.height = height;
+    frame.pixels.resize(rowSize * height);
+
+    if (!Decompress(data, size, &frame.pixels[0], frame.pixels.size()))
+    {
+        return false;
+    }
+
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t* row = &frame.pixels[y * rowSize];
+        for (size_t i = BYTES_PER_PIXEL; i < rowSize; ++i)
+        {
+            row[i] = (uint8_t)(row[i] + row[i - BYTES_PER_PIXEL]);
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const PosterFrame> PosterFrameCache::FindInMemory(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::list<MemoryEntry>::iterator it = m_memoryEntries.begin(); it != m_memoryEntries.end(); ++it)
+    {
+        if (it->first == name)
+        {
+            m_memoryEntries.splice(m_memoryEntries.begin(), m_memoryEntries, it);
+            return m_memoryEntries.front().second;
+        }
+    }
+    return std::shared_ptr<const PosterFrame>();
+}
+
+void PosterFrameCache::AddToMemory(const std::string& name, const std::shared_ptr<const PosterFrame>& frame)
+{
+    size_t frameSize = frame->pixels.size();
+    if (frameSize > m_memoryBudget)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::list<MemoryEntry>::iterator it = m_memoryEntries.begin(); it != m_memoryEntries.end(); ++it)
+    {
+        if (it->first == name)
+        {
+            m_memoryUsed -= it->second->pixels.size();
+            m_memoryEntries.erase(it);
+            break;
+        }
+    }
+
+    m_memoryEntries.push_front(MemoryEntry(name, frame));
+    m_memoryUsed += frameSize;
+
+    while (m_memoryUsed > m_memoryBudget)
+    {
+        m_memoryUsed -= m_memoryEntries.back().second->pixels.size();
+        m_memoryEntries.pop_back();
+    }
+}
+
+std::shared_ptr<const PosterFrame> PosterFrameCache::ReadFile(const PosterFrameKey& key, const std::string& path)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.GetSize() < FILE_HEADER_SIZE)
+    {
+        return std::shared_ptr<const PosterFrame>();
+    }
+
+    const uint8_t* data = file.GetData();
+    uint32_t magic = ReadUInt32(data);
+    uint32_t version = ReadUInt32(data + 4);
+    uint32_t width = ReadUInt32(data + 8);
+    uint32_t height = ReadUInt32(data + 12);
+    uint32_t keyLength = ReadUInt32(data + 16);
+    uint32_t encodedSize = ReadUInt32(data + 20);
+
+    if (magic != FILE_MAGIC || version != FILE_VERSION ||
+        keyLength > file.GetSize() - FILE_HEADER_SIZE ||
+        encodedSize != file.GetSize() - FILE_HEADER_SIZE - keyLength)
+    {
+        return std::shared_ptr<const PosterFrame>();
+    }
+
+    // The file name is a hash: check the full key to rule out collisions
+    std::string keyText = key.ToString();
+    if (keyLength != keyText.size() ||
+        memcmp(data + FILE_HEADER_SIZE, keyText.data(), keyLength) != 0)
+    {
+        return std::shared_ptr<const PosterFrame>();
+    }
+
+    std::shared_ptr<PosterFrame> frame = std::make_shared<PosterFrame>();
+    if (!Decode(data + FILE_HEADER_SIZE + keyLength, encodedSize, (int)width, (int)height, *frame))
+    {
+        return std::shared_ptr<const PosterFrame>();
+    }
+    return frame;
+}
@@ -0,0 +1,89 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_POSTER_FRAME_CACHE_H_
+#define _VUFORIA_MEDIA_POSTER_FRAME_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace VuforiaMedia
+{
+    // One decoded video frame, 4 bytes per pixel (same layout as the video
+    // texture it is uploaded to), rows tightly packed, top row first.
+    struct PosterFrame
+    {
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+    };
+
+    // Identifies the frame of a given version of a video at a given position
+    struct PosterFrameKey
+    {
+        std::string path;               // UTF-8
+        int64_t modifiedTime;           // platform file time, only compared for equality
+        float position;                 // seconds
+
+        // Name of the cache file holding this frame
+        std::string GetFileName() const;
+        std::string ToString() const;
+    };
+
+    // Cache of the first displayed frame of videos, so that a video quad can show
+    // the right picture as soon as the video is loaded, before its decoder
+    // produces anything.
+    //
+    // Frames are stored compressed, one file per key, in the cache directory;
+    // files are memory-mapped when read back. Decoded frames are kept in an
+    // in-memory LRU bounded by a byte budget.
+    class PosterFrameCache
+    {
+    public:
+        static const size_t DEFAULT_MEMORY_BUDGET = 32 * 1024 * 1024;
+
+        PosterFrameCache(const std::string& directory, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+        // Returns the cached frame, or nullptr if there is none
+        std::shared_ptr<const PosterFrame> Find(const PosterFrameKey& key);
+
+        // Compresses the frame and writes it to the cache directory.
+        // Can be slow: call it from a worker thread.
+        bool Store(const PosterFrameKey& key, const std::shared_ptr<const PosterFrame>& frame);
+
+        void ClearMemory();
+
+        // Frame compression: per-row delta filter followed by LZ77 compression.
+        // Decode() validates its input, so damaged cache files are rejected.
+        static void Encode(const PosterFrame& frame, std::vector<uint8_t>& encoded);
+        static bool Decode(const uint8_t* data, size_t size, int width, int height, PosterFrame& frame);
+
+    private:
+        typedef std::pair<std::string, std::shared_ptr<const PosterFrame> > MemoryEntry;
+
+        PosterFrameCache(const PosterFrameCache&);
+        PosterFrameCache& operator=(const PosterFrameCache&);
+
+        std::shared_ptr<const PosterFrame> FindInMemory(const std::string& name);
+        void AddToMemory(const std::string& name, const std::shared_ptr<const PosterFrame>& frame);
+        std::shared_ptr<const PosterFrame> ReadFile(const PosterFrameKey& key, const std::string& path);
+
+        std::string m_directory;
+        size_t m_memoryBudget;
+
+        std::mutex m_mutex;
+        std::list<MemoryEntry> m_memoryEntries;     // most recently used first
+        size_t m_memoryUsed;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_POSTER_FRAME_CACHE_H_
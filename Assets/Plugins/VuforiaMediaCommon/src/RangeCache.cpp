@@ -0,0 +1,399 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "RangeCache.h"
+#include "FileUtils.h"
+#include "MappedFile.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const uint32_t FILE_MAGIC = 0x43524D56;    // "VMRC"
+    const uint32_t FILE_VERSION = 1;
+    const size_t FILE_HEADER_SIZE = 9 * sizeof(uint32_t);
+    const char DATA_SUFFIX[] = ".data";
+    const char INDEX_SUFFIX[] = ".index";
+
+    // Resources larger than this are not cached
+    const uint64_t MAX_RESOURCE_SIZE = 1ULL << 40;
+
+    void WriteUInt32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out.push_back((uint8_t)(value >> (8 * i)));
+        }
+    }
+
+    void WriteUInt64(std::vector<uint8_t>& out, uint64_t value)
+    {
+        WriteUInt32(out, (uint32_t)value);
+        WriteUInt32(out, (uint32_t)(value >> 32));
+    }
+
+    uint32_t ReadUInt32(const uint8_t* data)
+    {
+        return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+               ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+
+    uint64_t ReadUInt64(const uint8_t* data)
+    {
+        return (uint64_t)ReadUInt32(data) | ((uint64_t)ReadUInt32(data + 4) << 32);
+    }
+
+    uint64_t Now()
+    {
+        return (uint64_t)time(nullptr);
+    }
+}
+
+
+RangeCache::RangeCache(const std::string& directory, uint64_t maxBytes) :
+    m_directory(directory),
+    m_maxBytes(maxBytes),
+    m_cachedBytes(0),
+    m_loaded(false)
+{
+}
+
+bool RangeCache::GetInfo(const std::string& url, Info& info)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry* entry = FindEntry(GetName(url), url);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    info = entry->info;
+    return true;
+}
+
+void RangeCache::SetInfo(const std::string& url, const Info& info)
+{
+    if (info.size == 0 || info.size > MAX_RESOURCE_SIZE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string name = GetName(url);
+    Entry* entry = FindEntry(name, url);
+    if (entry != nullptr && entry->info.size == info.size)
+    {
+        entry->info.contentType = info.contentType;
+        return;
+    }
+
+    // New resource, or the resource changed on the server
+    RemoveEntry(name);
+
+    Entry& newEntry = m_entries[name];
+    newEntry.url = url;
+    newEntry.info = info;
+    newEntry.chunks.assign((size_t)((info.size + CHUNK_SIZE - 1) / CHUNK_SIZE), false);
+    newEntry.cachedBytes = 0;
+    newEntry.lastAccess = Now();
+    newEntry.touched = true;
+
+    if (FileUtils::MakeDirectory(m_directory))
+    {
+        WriteIndex(name, newEntry);
+    }
+}
+
+bool RangeCache::HasChunk(const std::string& url, uint64_t chunk)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry* entry = FindEntry(GetName(url), url);
+    return entry != nullptr && chunk < entry->chunks.size() && entry->chunks[(size_t)chunk];
+}
+
+bool RangeCache::Read(const std::string& url, uint64_t offset, uint8_t* buffer, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string name = GetName(url);
+    Entry* entry = FindEntry(name, url);
+    uint64_t chunk = offset / CHUNK_SIZE;
+    if (entry == nullptr || size == 0 || chunk >= entry->chunks.size() || !entry->chunks[(size_t)chunk] ||
+        (offset + size - 1) / CHUNK_SIZE != chunk || offset + size > entry->info.size)
+    {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.Open(m_directory + "/" + name + DATA_SUFFIX, offset, size) || file.GetSize() != size)
+    {
+        return false;
+    }
+    memcpy(buffer, file.GetData(), size);
+
+    // Save the access time once per session, for the eviction order of the next ones
+    entry->lastAccess = Now();
+    if (!entry->touched)
+    {
+        entry->touched = true;
+        WriteIndex(name, *entry);
+    }
+    return true;
+}
+
+bool RangeCache::WriteChunk(const std::string& url, uint64_t chunk, const uint8_t* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string name = GetName(url);
+    Entry* entry = FindEntry(name, url);
+    if (entry == nullptr || chunk >= entry->chunks.size() || size != GetChunkSize(*entry, chunk))
+    {
+        return false;
+    }
+    if (entry->chunks[(size_t)chunk])
+    {
+        return true;
+    }
+
+    FILE* file = FileUtils::OpenForUpdate(m_directory + "/" + name + DATA_SUFFIX);
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written = FileUtils::Seek(file, chunk * CHUNK_SIZE) && fwrite(data, 1, size, file) == size;
+    written = (fclose(file) == 0) && written;
+    if (!written)
+    {
+        return false;
+    }
+
+    entry->chunks[(size_t)chunk] = true;
+    entry->cachedBytes += size;
+    entry->lastAccess = Now();
+    m_cachedBytes += size;
+    WriteIndex(name, *entry);
+
+    Evict(name);
+    return true;
+}
+
+uint64_t RangeCache::GetCachedBytes()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    LoadIndices();
+    return m_cachedBytes;
+}
+
+void RangeCache::SetMaxBytes(uint64_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    LoadIndices();
+    m_maxBytes = maxBytes;
+    Evict(std::string());
+}
+
+void RangeCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    LoadIndices();
+    while (!m_entries.empty())
+    {
+        RemoveEntry(m_entries.begin()->first);
+    }
+}
+
+void RangeCache::LoadIndices()
+{
+    if (m_loaded)
+    {
+        return;
+    }
+    m_loaded = true;
+
+    std::vector<std::string> names;
+    FileUtils::ListFiles(m_directory, INDEX_SUFFIX, names);
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        std::string name = names[i].substr(0, names[i].size() - (sizeof(INDEX_SUFFIX) - 1));
+
+        Entry entry;
+        if (!ReadIndex(m_directory + "/" + names[i], entry) || GetName(entry.url) != name)
+        {
+            // Damaged or from another version: start over
+            FileUtils::RemoveFile(m_directory + "/" + name + INDEX_SUFFIX);
+            FileUtils::RemoveFile(m_directory + "/" + name + DATA_SUFFIX);
+            continue;
+        }
+
+        m_cachedBytes += entry.cachedBytes;
+        m_entries[name] = entry;
+    }
+
+    Evict(std::string());
+}
+
+bool RangeCache::ReadIndex(const std::string& path, Entry& entry)
+{
+    MappedFile file;
+    if (!file.Open(path) || file.GetSize() < FILE_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    const uint8_t* data = file.GetData();
+    uint32_t magic = ReadUInt32(data);
+    uint32_t version = ReadUInt32(data + 4);
+    uint64_t size = ReadUInt64(data + 8);
+    uint64_t lastAccess = ReadUInt64(data + 16);
+    uint32_t urlLength = ReadUInt32(data + 24);
+    uint32_t typeLength = ReadUInt32(data + 28);
+    uint32_t chunkCount = ReadUInt32(data + 32);
+
+    if (magic != FILE_MAGIC || version != FILE_VERSION ||
+        size == 0 || size > MAX_RESOURCE_SIZE || chunkCount != (size + CHUNK_SIZE - 1) / CHUNK_SIZE ||
+        (uint64_t)FILE_HEADER_SIZE + urlLength + typeLength + (chunkCount + 7) / 8 != file.GetSize())
+    {
+        return false;
+    }
+
+    const uint8_t* strings = data + FILE_HEADER_SIZE;
+    const uint8_t* bitmap = strings + urlLength + typeLength;
+
+    entry.url.assign((const char*)strings, urlLength);
+    entry.info.size = size;
+    entry.info.contentType.assign((const char*)strings + urlLength, typeLength);
+    entry.chunks.assign(chunkCount, false);
+    entry.cachedBytes = 0;
+    entry.lastAccess = lastAccess;
+    entry.touched = false;
+
+    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        if (bitmap[chunk / 8] & (1 << (chunk % 8)))
+        {
+            entry.chunks[chunk] = true;
+            entry.cachedBytes += GetChunkSize(entry, chunk);
+        }
+    }
+    return true;
+}
+
+bool RangeCache::WriteIndex(const std::string& name, const Entry& entry)
+{
+    std::vector<uint8_t> index;
+    WriteUInt32(index, FILE_MAGIC);
+    WriteUInt32(index, FILE_VERSION);
+    WriteUInt64(index, entry.info.size);
+    WriteUInt64(index, entry.lastAccess);
+    WriteUInt32(index, (uint32_t)entry.url.size());
+    WriteUInt32(index, (uint32_t)entry.info.contentType.size());
+    WriteUInt32(index, (uint32_t)entry.chunks.size());
+    index.insert(index.end(), entry.url.begin(), entry.url.end());
+    index.insert(index.end(), entry.info.contentType.begin(), entry.info.contentType.end());
+
+    size_t bitmapStart = index.size();
+    index.resize(bitmapStart + (entry.chunks.size() + 7) / 8, 0);
+    for (size_t chunk = 0; chunk < entry.chunks.size(); ++chunk)
+    {
+        if (entry.chunks[chunk])
+        {
+            index[bitmapStart + chunk / 8] |= (uint8_t)(1 << (chunk % 8));
+        }
+    }
+
+    // Write to a temporary file first, so that a crash never leaves a partial index
+    std::string path = m_directory + "/" + name + INDEX_SUFFIX;
+    std::string tempPath = path + ".tmp";
+    FILE* file = FileUtils::OpenForWriting(tempPath);
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written = fwrite(&index[0], 1, index.size(), file) == index.size();
+    written = (fclose(file) == 0) && written;
+
+    if (!written || !FileUtils::ReplaceFile(tempPath, path))
+    {
+        FileUtils::RemoveFile(tempPath);
+        return false;
+    }
+    return true;
+}
+
+RangeCache::Entry* RangeCache::FindEntry(const std::string& name, const std::string& url)
+{
+    LoadIndices();
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(name);
+    // The file name is a hash: check the full URL to rule out collisions
+    if (it == m_entries.end() || it->second.url != url)
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void RangeCache::RemoveEntry(const std::string& name)
+{
+    // name may be the key of the entry erased below
+    std::string path = m_directory + "/" + name;
+    FileUtils::RemoveFile(path + INDEX_SUFFIX);
+    FileUtils::RemoveFile(path + DATA_SUFFIX);
+
+    std::map<std::string, Entry>::iterator it = m_entries.find(name);
+    if (it != m_entries.end())
+    {
+        m_cachedBytes -= it->second.cachedBytes;
+        m_entries.erase(it);
+    }
+}
+
+void RangeCache::Evict(const std::string& keepName)
+{
+    while (m_cachedBytes > m_maxBytes)
+    {
+        std::map<std::string, Entry>::iterator oldest = m_entries.end();
+        for (std::map<std::string, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->first != keepName && it->second.cachedBytes > 0 &&
+                (oldest == m_entries.end() || it->second.lastAccess < oldest->second.lastAccess))
+            {
+                oldest = it;
+            }
+        }
+
+        if (oldest == m_entries.end())
+        {
+            // Only the resource being written is left
+            return;
+        }
+        RemoveEntry(oldest->first);
+    }
+}
+
+std::string RangeCache::GetName(const std::string& url)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)FileUtils::HashString(url));
+    return name;
+}
+
+uint64_t RangeCache::GetChunkSize(const Entry& entry, uint64_t chunk)
+{
+    uint64_t start = chunk * CHUNK_SIZE;
+    return start + CHUNK_SIZE <= entry.info.size ? CHUNK_SIZE : entry.info.size - start;
+}
@@ -0,0 +1,94 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_RANGE_CACHE_H_
+#define _VUFORIA_MEDIA_RANGE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VuforiaMedia
+{
+    // Bounded on-disk cache of byte ranges of remote resources.
+    //
+    // Each resource is split into fixed-size chunks, stored at their offset in a
+    // sparse data file; an index file next to it records the size and content type
+    // of the resource and which chunks are present. A chunk is only marked present
+    // once its data is written, so an interrupted write leaves it missing.
+    //
+    // When the cached bytes exceed the budget, whole resources are evicted, least
+    // recently used first.
+    class RangeCache
+    {
+    public:
+        static const uint32_t CHUNK_SIZE = 256 * 1024;
+
+        struct Info
+        {
+            uint64_t size;
+            std::string contentType;
+        };
+
+        RangeCache(const std::string& directory, uint64_t maxBytes);
+
+        // Returns false if the size of the resource is not known yet
+        bool GetInfo(const std::string& url, Info& info);
+
+        // Creates the entry of the resource; a different size discards the cached chunks
+        void SetInfo(const std::string& url, const Info& info);
+
+        bool HasChunk(const std::string& url, uint64_t chunk);
+
+        // Reads size bytes at offset, which must all be within one present chunk
+        bool Read(const std::string& url, uint64_t offset, uint8_t* buffer, size_t size);
+
+        // Stores a whole chunk (the last chunk of the resource may be shorter)
+        bool WriteChunk(const std::string& url, uint64_t chunk, const uint8_t* data, size_t size);
+
+        uint64_t GetCachedBytes();
+        void SetMaxBytes(uint64_t maxBytes);
+
+        // Removes every resource from the disk
+        void Clear();
+
+    private:
+        struct Entry
+        {
+            std::string url;
+            Info info;
+            std::vector<bool> chunks;
+            uint64_t cachedBytes;
+            uint64_t lastAccess;    // seconds since the epoch
+            bool touched;           // lastAccess saved during this session
+        };
+
+        RangeCache(const RangeCache&);
+        RangeCache& operator=(const RangeCache&);
+
+        void LoadIndices();
+        bool ReadIndex(const std::string& path, Entry& entry);
+        bool WriteIndex(const std::string& name, const Entry& entry);
+        Entry* FindEntry(const std::string& name, const std::string& url);
+        void RemoveEntry(const std::string& name);
+        void Evict(const std::string& keepName);
+
+        static std::string GetName(const std::string& url);
+        static uint64_t GetChunkSize(const Entry& entry, uint64_t chunk);
+
+        std::mutex m_mutex;
+        std::string m_directory;
+        uint64_t m_maxBytes;
+        uint64_t m_cachedBytes;
+        bool m_loaded;
+        std::map<std::string, Entry> m_entries;     // by file name
+    };
+}
+
+#endif // _VUFORIA_MEDIA_RANGE_CACHE_H_
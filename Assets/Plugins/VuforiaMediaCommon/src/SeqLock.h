@@ -0,0 +1,122 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_SEQ_LOCK_H_
+#define _VUFORIA_MEDIA_SEQ_LOCK_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace VuforiaMedia
+{
+    static const int CACHE_LINE_SIZE = 64;
+
+    // Sequence lock protecting a small plain value.
+    //
+    // Readers never block writers: a reader copies the value and retries if the
+    // sequence number changed (or was odd, i.e. a write was in progress) while
+    // it was copying. Writers are serialised by briefly spinning on the odd
+    // sequence number, so any thread may publish.
+    //
+    // The sequence number is at offset 0 and is followed by the value words, so
+    // the memory layout can be read directly by code outside of this module
+    // (e.g. managed code mapping the array), following the same protocol:
+    // read sequence, read value, read sequence again, retry if odd or different.
+    template <typename T>
+    class SeqLock
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+        static_assert(sizeof(T) % sizeof(uint32_t) == 0, "SeqLock value size must be a multiple of 4 bytes");
+
+    public:
+        static const int WORD_COUNT = sizeof(T) / sizeof(uint32_t);
+
+        SeqLock() : m_sequence(0)
+        {
+            for (int i = 0; i < WORD_COUNT; ++i)
+            {
+                m_words[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void Write(const T& value)
+        {
+            uint32_t words[WORD_COUNT];
+            memcpy(words, &value, sizeof(T));
+
+            // Acquire the write side by moving the sequence from even to odd
+            uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                if ((sequence & 1) == 0 &&
+                    m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire))
+                {
+                    break;
+                }
+                sequence = m_sequence.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (int i = 0; i < WORD_COUNT; ++i)
+            {
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            }
+
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Returns false if no consistent copy could be taken within maxAttempts
+        bool TryRead(T& value, int maxAttempts = 1000) const
+        {
+            uint32_t words[WORD_COUNT];
+
+            for (int attempt = 0; attempt < maxAttempts; ++attempt)
+            {
+                uint32_t before = m_sequence.load(std::memory_order_acquire);
+                if (before & 1)
+                {
+                    continue;
+                }
+
+                for (int i = 0; i < WORD_COUNT; ++i)
+                {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before)
+                {
+                    memcpy(&value, words, sizeof(T));
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        T Read() const
+        {
+            T value;
+            while (!TryRead(value))
+            {
+            }
+            return value;
+        }
+
+        uint32_t GetSequence() const { return m_sequence.load(std::memory_order_acquire); }
+
+    private:
+        SeqLock(const SeqLock&);
+        SeqLock& operator=(const SeqLock&);
+
+        std::atomic<uint32_t> m_sequence;
+        std::atomic<uint32_t> m_words[WORD_COUNT];
+    };
+}
+
+#endif // _VUFORIA_MEDIA_SEQ_LOCK_H_
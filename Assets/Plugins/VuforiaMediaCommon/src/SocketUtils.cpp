@@ -0,0 +1,213 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "SocketUtils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    void SetTimeout(SocketUtils::Socket socket, int timeoutMs)
+    {
+#if defined(_WIN32)
+        DWORD timeout = (DWORD)timeoutMs;
+#else
+        struct timeval timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+    }
+
+    void DisableSigPipe(SocketUtils::Socket socket)
+    {
+#if defined(SO_NOSIGPIPE)
+        // A peer closing the connection must not kill the application (Apple platforms)
+        int on = 1;
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#else
+        (void)socket;
+#endif
+    }
+}
+
+
+bool SocketUtils::Startup()
+{
+#if defined(_WIN32)
+    static bool s_started = false;
+    if (!s_started)
+    {
+        WSADATA data;
+        s_started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+    return s_started;
+#else
+    return true;
+#endif
+}
+
+SocketUtils::Socket SocketUtils::Connect(const std::string& host, int port, int timeoutMs)
+{
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), service, &hints, &addresses) != 0)
+    {
+        return INVALID;
+    }
+
+    Socket result = INVALID;
+    for (struct addrinfo* address = addresses; address != nullptr; address = address->ai_next)
+    {
+        Socket candidate = (Socket)socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (candidate == INVALID)
+        {
+            continue;
+        }
+
+        SetTimeout(candidate, timeoutMs);
+        DisableSigPipe(candidate);
+        if (connect(candidate, address->ai_addr, (int)address->ai_addrlen) == 0)
+        {
+            result = candidate;
+            break;
+        }
+        Close(candidate);
+    }
+
+    freeaddrinfo(addresses);
+    return result;
+}
+
+SocketUtils::Socket SocketUtils::ListenLoopback(int& port)
+{
+    Socket listener = (Socket)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID)
+    {
+        return INVALID;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    socklen_t length = sizeof(address);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listener, 16) != 0 ||
+        getsockname(listener, (struct sockaddr*)&address, &length) != 0)
+    {
+        Close(listener);
+        return INVALID;
+    }
+
+    port = ntohs(address.sin_port);
+    return listener;
+}
+
+bool SocketUtils::WaitReadable(Socket socket, int timeoutMs)
+{
+    fd_set sockets;
+    FD_ZERO(&sockets);
+    FD_SET(socket, &sockets);
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    return select((int)socket + 1, &sockets, nullptr, nullptr, &timeout) > 0;
+}
+
+SocketUtils::Socket SocketUtils::Accept(Socket listener, int timeoutMs)
+{
+    Socket connection = (Socket)accept(listener, nullptr, nullptr);
+    if (connection != INVALID)
+    {
+        SetTimeout(connection, timeoutMs);
+        DisableSigPipe(connection);
+
+        // Responses are written in large blocks, send them right away
+        int on = 1;
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+    }
+    return connection;
+}
+
+bool SocketUtils::SendAll(Socket socket, const void* data, size_t size)
+{
+#if defined(MSG_NOSIGNAL)
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    const char* bytes = (const char*)data;
+    while (size > 0)
+    {
+        int sent = (int)send(socket, bytes, (int)size, flags);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+bool SocketUtils::SendAll(Socket socket, const std::string& text)
+{
+    return SendAll(socket, text.data(), text.size());
+}
+
+int SocketUtils::Receive(Socket socket, void* buffer, size_t size)
+{
+    int received = (int)recv(socket, (char*)buffer, (int)size, 0);
+    return received < 0 ? -1 : received;
+}
+
+void SocketUtils::Shutdown(Socket socket)
+{
+#if defined(_WIN32)
+    shutdown(socket, SD_BOTH);
+#else
+    shutdown(socket, SHUT_RDWR);
+#endif
+}
+
+void SocketUtils::Close(Socket socket)
+{
+#if defined(_WIN32)
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
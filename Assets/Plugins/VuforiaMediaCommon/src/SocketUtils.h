@@ -0,0 +1,54 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_SOCKET_UTILS_H_
+#define _VUFORIA_MEDIA_SOCKET_UTILS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace VuforiaMedia
+{
+    // Blocking TCP sockets, Winsock or BSD sockets depending on the platform
+    namespace SocketUtils
+    {
+#if defined(_WIN32)
+        typedef uintptr_t Socket;
+#else
+        typedef int Socket;
+#endif
+        const Socket INVALID = (Socket)-1;
+
+        // Initializes Winsock on Windows; can be called any number of times
+        bool Startup();
+
+        // Connects to host:port, reads and writes time out after timeoutMs
+        Socket Connect(const std::string& host, int port, int timeoutMs);
+
+        // Listens on 127.0.0.1, on a port chosen by the system
+        Socket ListenLoopback(int& port);
+
+        // Returns true once data, or a connection on a listening socket, is
+        // waiting; false after timeoutMs
+        bool WaitReadable(Socket socket, int timeoutMs);
+
+        // Reads and writes of the accepted connection time out after timeoutMs
+        Socket Accept(Socket listener, int timeoutMs);
+
+        bool SendAll(Socket socket, const void* data, size_t size);
+        bool SendAll(Socket socket, const std::string& text);
+
+        // Returns the number of bytes received, 0 once the peer closed the connection, -1 on error
+        int Receive(Socket socket, void* buffer, size_t size);
+
+        // Unblocks the threads waiting on the socket
+        void Shutdown(Socket socket);
+        void Close(Socket socket);
+    }
+}
+
+#endif // _VUFORIA_MEDIA_SOCKET_UTILS_H_
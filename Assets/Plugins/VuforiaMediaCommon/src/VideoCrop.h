@@ -0,0 +1,93 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_VIDEO_CROP_H_
+#define _VUFORIA_MEDIA_VIDEO_CROP_H_
+
+#include <math.h>
+
+namespace VuforiaMedia
+{
+    // Region of the video frame copied to the video texture, normalised to
+    // the frame size, from its top left corner
+    struct VideoCrop
+    {
+        float x;
+        float y;
+        float width;
+        float height;
+    };
+
+    // The crop in whole pixels of a frame, from its top left corner
+    struct VideoCropPixels
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+    };
+
+    inline VideoCrop GetFullFrameCrop()
+    {
+        VideoCrop crop = { 0.0f, 0.0f, 1.0f, 1.0f };
+        return crop;
+    }
+
+    // Clamps the crop to the frame; returns false if nothing is left of it
+    inline bool ClampVideoCrop(VideoCrop& crop)
+    {
+        float left = crop.x > 0.0f ? crop.x : 0.0f;
+        float top = crop.y > 0.0f ? crop.y : 0.0f;
+        float right = crop.x + crop.width < 1.0f ? crop.x + crop.width : 1.0f;
+        float bottom = crop.y + crop.height < 1.0f ? crop.y + crop.height : 1.0f;
+        if (!(right > left && bottom > top))
+        {
+            return false;
+        }
+
+        crop.x = left;
+        crop.y = top;
+        crop.width = right - left;
+        crop.height = bottom - top;
+        return true;
+    }
+
+    inline bool IsFullFrameCrop(const VideoCrop& crop)
+    {
+        return crop.x <= 0.0f && crop.y <= 0.0f && crop.x + crop.width >= 1.0f && crop.y + crop.height >= 1.0f;
+    }
+
+    // Snaps the crop to the pixels of a frame, so that it is copied one to one;
+    // it keeps at least one pixel
+    inline VideoCropPixels GetVideoCropPixels(const VideoCrop& crop, int frameWidth, int frameHeight)
+    {
+        VideoCropPixels pixels;
+        pixels.left = (int)floorf(crop.x * frameWidth + 0.5f);
+        pixels.top = (int)floorf(crop.y * frameHeight + 0.5f);
+        pixels.right = (int)floorf((crop.x + crop.width) * frameWidth + 0.5f);
+        pixels.bottom = (int)floorf((crop.y + crop.height) * frameHeight + 0.5f);
+
+        if (pixels.left > frameWidth - 1)
+        {
+            pixels.left = frameWidth - 1;
+        }
+        if (pixels.top > frameHeight - 1)
+        {
+            pixels.top = frameHeight - 1;
+        }
+        if (pixels.right <= pixels.left)
+        {
+            pixels.right = pixels.left + 1;
+        }
+        if (pixels.bottom <= pixels.top)
+        {
+            pixels.bottom = pixels.top + 1;
+        }
+        return pixels;
+    }
+}
+
+#endif // _VUFORIA_MEDIA_VIDEO_CROP_H_
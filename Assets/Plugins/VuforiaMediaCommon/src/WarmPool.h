@@ -0,0 +1,214 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_WARM_POOL_H_
+#define _VUFORIA_MEDIA_WARM_POOL_H_
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VuforiaMedia
+{
+    // Default eviction policy: drops the player that was least recently
+    // prewarmed or touched. Entries are kept most recently used first.
+    struct EvictLeastRecentlyUsed
+    {
+        template <typename TEntry>
+        static typename std::list<TEntry>::iterator SelectVictim(std::list<TEntry>& entries)
+        {
+            return --entries.end();
+        }
+    };
+
+    // Bounded pool of prepared (loaded, not yet bound) players, keyed by file name.
+    //
+    // Players are prepared ahead of time for the videos likely to be needed next
+    // and handed over by Take() when the video is actually loaded, so activation
+    // only has to bind a texture. The pool owns the players it holds: evicted
+    // players are handed to the dispose function, always outside of the pool lock.
+    //
+    // TPlayer is opaque to the pool, so it can be exercised with a fake decoder.
+    template <typename TPlayer, typename TEvictionPolicy = EvictLeastRecentlyUsed>
+    class WarmPool
+    {
+    public:
+        typedef std::function<void(TPlayer*)> DisposeFunc;
+
+        WarmPool(int maxEntries, DisposeFunc dispose) :
+            m_maxEntries(maxEntries < 0 ? 0 : maxEntries),
+            m_dispose(dispose)
+        {
+        }
+
+        ~WarmPool()
+        {
+            Clear();
+        }
+
+        bool Contains(const std::string& key) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return Find(key) != m_entries.end();
+        }
+
+        // Adds a prepared player. Returns false and disposes the player if the
+        // key is already warm or the pool has no capacity.
+        bool Put(const std::string& key, TPlayer* player)
+        {
+            std::vector<TPlayer*> evicted;
+            bool added = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_maxEntries > 0 && Find(key) == m_entries.end())
+                {
+                    m_entries.push_front(Entry(key, player));
+                    EvictLocked(evicted);
+                    added = true;
+                }
+            }
+
+            if (!added)
+            {
+                evicted.push_back(player);
+            }
+            Dispose(evicted);
+            return added;
+        }
+
+        // Removes the player prepared for key and hands its ownership to the
+        // caller, or returns nullptr if the video is not warm.
+        TPlayer* Take(const std::string& key)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            typename std::list<Entry>::iterator it = Find(key);
+            if (it == m_entries.end())
+            {
+                return nullptr;
+            }
+            TPlayer* player = it->player;
+            m_entries.erase(it);
+            return player;
+        }
+
+        // Marks the video as likely to be needed soon, protecting it from eviction
+        bool Touch(const std::string& key)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            typename std::list<Entry>::iterator it = Find(key);
+            if (it == m_entries.end())
+            {
+                return false;
+            }
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return true;
+        }
+
+        void SetMaxEntries(int maxEntries)
+        {
+            std::vector<TPlayer*> evicted;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_maxEntries = maxEntries < 0 ? 0 : maxEntries;
+                EvictLocked(evicted);
+            }
+            Dispose(evicted);
+        }
+
+        void Clear()
+        {
+            std::vector<TPlayer*> evicted;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (typename std::list<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+                {
+                    evicted.push_back(it->player);
+                }
+                m_entries.clear();
+            }
+            Dispose(evicted);
+        }
+
+        int GetSize() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return (int)m_entries.size();
+        }
+
+        int GetMaxEntries() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_maxEntries;
+        }
+
+    private:
+        struct Entry
+        {
+            Entry(const std::string& k, TPlayer* p) : key(k), player(p) {}
+
+            std::string key;
+            TPlayer* player;
+        };
+
+        WarmPool(const WarmPool&);
+        WarmPool& operator=(const WarmPool&);
+
+        typename std::list<Entry>::iterator Find(const std::string& key)
+        {
+            for (typename std::list<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+            {
+                if (it->key == key)
+                {
+                    return it;
+                }
+            }
+            return m_entries.end();
+        }
+
+        typename std::list<Entry>::const_iterator Find(const std::string& key) const
+        {
+            for (typename std::list<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+            {
+                if (it->key == key)
+                {
+                    return it;
+                }
+            }
+            return m_entries.end();
+        }
+
+        // [Always called with m_mutex locked]
+        void EvictLocked(std::vector<TPlayer*>& evicted)
+        {
+            while ((int)m_entries.size() > m_maxEntries)
+            {
+                typename std::list<Entry>::iterator victim = TEvictionPolicy::SelectVictim(m_entries);
+                evicted.push_back(victim->player);
+                m_entries.erase(victim);
+            }
+        }
+
+        void Dispose(const std::vector<TPlayer*>& players)
+        {
+            for (size_t i = 0; i < players.size(); ++i)
+            {
+                if (m_dispose)
+                {
+                    m_dispose(players[i]);
+                }
+            }
+        }
+
+        mutable std::mutex m_mutex;
+        std::list<Entry> m_entries;
+        int m_maxEntries;
+        DisposeFunc m_dispose;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_WARM_POOL_H_
@@ -0,0 +1,278 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "ZipArchive.h"
+#include "FileUtils.h"
+
+#include <algorithm>
+
+using namespace VuforiaMedia;
+
+namespace
+{
+    const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+    const uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+
+    const size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+    const size_t CENTRAL_HEADER_SIZE = 46;
+    const size_t LOCAL_HEADER_SIZE = 30;
+    const size_t MAX_COMMENT_SIZE = 0xFFFF;
+
+    const uint16_t METHOD_STORED = 0;
+    const uint16_t FLAG_ENCRYPTED = 0x0001;
+
+    uint16_t ReadLE16(const uint8_t* data)
+    {
+        return (uint16_t)(data[0] | (data[1] << 8));
+    }
+
+    uint32_t ReadLE32(const uint8_t* data)
+    {
+        return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+               ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+}
+
+ZipArchive::ZipArchive() :
+    m_data(nullptr),
+    m_size(0)
+{
+}
+
+bool ZipArchive::Open(const std::string& path)
+{
+    Close();
+
+    uint64_t size;
+    if (!FileUtils::GetFileSize(path, size) || !ReadDirectory(path, size))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool ZipArchive::Open(const uint8_t* data, size_t size)
+{
+    Close();
+
+    m_data = data;
+    if (data == nullptr || !ReadDirectory(std::string(), size))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool ZipArchive::ReadDirectory(const std::string& path, uint64_t size)
+{
+    m_path = path;
+    m_size = size;
+
+    if (size < END_OF_CENTRAL_DIRECTORY_SIZE)
+    {
+        return false;
+    }
+
+    // The end of central directory record is followed by the archive comment,
+    // and by trailing data in some archives (the .dat files of the databases):
+    // the record is the last one right after the central directory it describes
+    size_t tailSize = (size_t)std::min<uint64_t>(size, END_OF_CENTRAL_DIRECTORY_SIZE + MAX_COMMENT_SIZE);
+    uint64_t tailOffset = size - tailSize;
+    MappedFile tailView;
+    const uint8_t* tail = GetRange(tailOffset, tailSize, tailView);
+    if (tail == nullptr)
+    {
+        return false;
+    }
+
+    const uint8_t* end = nullptr;
+    for (size_t pos = tailSize - END_OF_CENTRAL_DIRECTORY_SIZE + 1; pos-- > 0;)
+    {
+        const uint8_t* record = tail + pos;
+        if (ReadLE32(record) == END_OF_CENTRAL_DIRECTORY_SIGNATURE &&
+            pos + END_OF_CENTRAL_DIRECTORY_SIZE + ReadLE16(record + 20) <= tailSize &&
+            (uint64_t)ReadLE32(record + 16) + ReadLE32(record + 12) == tailOffset + pos)
+        {
+            end = record;
+            break;
+        }
+    }
+    if (end == nullptr)
+    {
+        return false;
+    }
+
+    uint16_t diskNumber = ReadLE16(end + 4);
+    uint16_t entryCount = ReadLE16(end + 10);
+    uint32_t directorySize = ReadLE32(end + 12);
+    uint32_t directoryOffset = ReadLE32(end + 16);
+
+    // Multi-disk and zip64 archives are not supported; APKs are neither
+    if (diskNumber != 0 || entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF)
+    {
+        return false;
+    }
+
+    if (entryCount == 0)
+    {
+        return true;
+    }
+
+    MappedFile directoryView;
+    const uint8_t* directory = GetRange(directoryOffset, directorySize, directoryView);
+    return directory != nullptr && ReadCentralDirectory(directory, directorySize, entryCount);
+}
+
+bool ZipArchive::ReadCentralDirectory(const uint8_t* data, size_t size, uint32_t entryCount)
+{
+    m_entries.reserve(entryCount);
+
+    size_t pos = 0;
+    for (uint32_t i = 0; i < entryCount; ++i)
+    {
+        if (size - pos < CENTRAL_HEADER_SIZE)
+        {
+            return false;
+        }
+        const uint8_t* header = data + pos;
+        if (ReadLE32(header) != CENTRAL_HEADER_SIGNATURE)
+        {
+            return false;
+        }
+
+        size_t nameLength = ReadLE16(header + 28);
+        size_t extraLength = ReadLE16(header + 30);
+        size_t commentLength = ReadLE16(header + 32);
+        if (size - pos - CENTRAL_HEADER_SIZE < nameLength + extraLength + commentLength)
+        {
+            return false;
+        }
+
+        ZipEntryInfo entry;
+        entry.name.assign((const char*)header + CENTRAL_HEADER_SIZE, nameLength);
+        entry.flags = ReadLE16(header + 8);
+        entry.method = ReadLE16(header + 10);
+        entry.compressedSize = ReadLE32(header + 20);
+        entry.uncompressedSize = ReadLE32(header + 24);
+        entry.localHeaderOffset = ReadLE32(header + 42);
+
+        m_entryIndices[entry.name] = m_entries.size();
+        m_entries.push_back(entry);
+
+        pos += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+    }
+
+    return true;
+}
+
+void ZipArchive::Close()
+{
+    m_path.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_entries.clear();
+    m_entryIndices.clear();
+}
+
+const uint8_t* ZipArchive::GetRange(uint64_t offset, size_t size, MappedFile& view) const
+{
+    if (offset > m_size || size > m_size - offset)
+    {
+        return nullptr;
+    }
+    if (m_data != nullptr)
+    {
+        return m_data + offset;
+    }
+    return view.Open(m_path, offset, size) ? view.GetData() : nullptr;
+}
+
+ZipEntryStatus ZipArchive::FindEntry(const std::string& name, ZipEntry& entry) const
+{
+    std::unordered_map<std::string, size_t>::const_iterator found = m_entryIndices.find(name);
+    if (found == m_entryIndices.end())
+    {
+        return ZIP_ENTRY_MISSING;
+    }
+
+    const ZipEntryInfo& central = m_entries[found->second];
+    if ((central.flags & FLAG_ENCRYPTED) != 0 || central.compressedSize == 0xFFFFFFFF ||
+        central.localHeaderOffset == 0xFFFFFFFF)
+    {
+        return ZIP_ENTRY_INVALID;
+    }
+    if (central.method != METHOD_STORED)
+    {
+        return ZIP_ENTRY_COMPRESSED;
+    }
+    if (central.compressedSize != central.uncompressedSize)
+    {
+        return ZIP_ENTRY_INVALID;
+    }
+
+    // The local header repeats the name but can have a different extra field
+    // (zipalign pads it), so the data offset can only be known from it
+    MappedFile localHeaderView;
+    const uint8_t* localHeader = GetRange(central.localHeaderOffset, LOCAL_HEADER_SIZE, localHeaderView);
+    if (localHeader == nullptr || ReadLE32(localHeader) != LOCAL_HEADER_SIGNATURE)
+    {
+        return ZIP_ENTRY_INVALID;
+    }
+
+    uint64_t dataOffset = central.localHeaderOffset + LOCAL_HEADER_SIZE +
+                          ReadLE16(localHeader + 26) + ReadLE16(localHeader + 28);
+    if (dataOffset > m_size || central.compressedSize > m_size - dataOffset)
+    {
+        return ZIP_ENTRY_INVALID;
+    }
+    if (dataOffset % DATA_ALIGNMENT != 0)
+    {
+        return ZIP_ENTRY_MISALIGNED;
+    }
+
+    entry.dataOffset = dataOffset;
+    entry.size = central.compressedSize;
+    return ZIP_ENTRY_FOUND;
+}
+
+ZipEntryStatus ZipArchive::MapEntry(const std::string& name, MappedFile& file) const
+{
+    ZipEntry entry;
+    ZipEntryStatus status = FindEntry(name, entry);
+    if (status != ZIP_ENTRY_FOUND)
+    {
+        return status;
+    }
+
+    // Empty entries cannot be mapped
+    if (m_data != nullptr || entry.size == 0 || entry.size > (size_t)-1 ||
+        !file.Open(m_path, entry.dataOffset, (size_t)entry.size))
+    {
+        return ZIP_ENTRY_INVALID;
+    }
+    return ZIP_ENTRY_FOUND;
+}
+
+ZipEntryStatus ZipArchive::GetEntryData(const std::string& name, const uint8_t*& data, size_t& size) const
+{
+    ZipEntry entry;
+    ZipEntryStatus status = FindEntry(name, entry);
+    if (status != ZIP_ENTRY_FOUND)
+    {
+        return status;
+    }
+    if (m_data == nullptr)
+    {
+        return ZIP_ENTRY_INVALID;
+    }
+
+    data = m_data + entry.dataOffset;
+    size = (size_t)entry.size;
+    return ZIP_ENTRY_FOUND;
+}
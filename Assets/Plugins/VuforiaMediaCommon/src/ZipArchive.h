@@ -0,0 +1,101 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_ZIP_ARCHIVE_H_
+#define _VUFORIA_MEDIA_ZIP_ARCHIVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace VuforiaMedia
+{
+    // Location of the data of a zip entry in the archive file
+    struct ZipEntry
+    {
+        uint64_t dataOffset;
+        uint64_t size;
+    };
+
+    // Central directory record of an entry
+    struct ZipEntryInfo
+    {
+        std::string name;
+        uint64_t localHeaderOffset;
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+        uint16_t method;
+        uint16_t flags;
+    };
+
+    enum ZipEntryStatus
+    {
+        ZIP_ENTRY_FOUND,
+        ZIP_ENTRY_MISSING,
+        ZIP_ENTRY_COMPRESSED,   // only stored entries can be read in place
+        ZIP_ENTRY_MISALIGNED,   // the archive was not zipaligned
+        ZIP_ENTRY_INVALID       // damaged or unsupported (encrypted, zip64) entry
+    };
+
+    // Reads the entries of a zip archive (APK, OBB) in place.
+    //
+    // Only the central directory is parsed. Entries stored without compression
+    // can then be memory-mapped straight from the archive, so that videos
+    // packaged with the app reach the demuxer without being copied.
+    class ZipArchive
+    {
+    public:
+        // zipalign aligns the data of stored entries on 4 bytes
+        static const uint32_t DATA_ALIGNMENT = 4;
+
+        ZipArchive();
+
+        // path is UTF-8 encoded
+        bool Open(const std::string& path);
+
+        // Reads an archive already in memory, e.g. a stored entry of another
+        // archive. The data must outlive the ZipArchive.
+        bool Open(const uint8_t* data, size_t size);
+
+        void Close();
+
+        const std::string& GetPath() const { return m_path; }
+
+        size_t GetEntryCount() const { return m_entries.size(); }
+        const ZipEntryInfo& GetEntryInfo(size_t index) const { return m_entries[index]; }
+
+        // name is the full entry name, e.g. "assets/video.mp4"
+        ZipEntryStatus FindEntry(const std::string& name, ZipEntry& entry) const;
+
+        // Maps the data of a stored entry of an archive opened from a file
+        ZipEntryStatus MapEntry(const std::string& name, MappedFile& file) const;
+
+        // Data of a stored entry of an archive opened from memory
+        ZipEntryStatus GetEntryData(const std::string& name, const uint8_t*& data, size_t& size) const;
+
+    private:
+        ZipArchive(const ZipArchive&);
+        ZipArchive& operator=(const ZipArchive&);
+
+        bool ReadDirectory(const std::string& path, uint64_t size);
+        bool ReadCentralDirectory(const uint8_t* data, size_t size, uint32_t entryCount);
+
+        // Returns size bytes at offset, from memory or mapped into view
+        const uint8_t* GetRange(uint64_t offset, size_t size, MappedFile& view) const;
+
+        std::string m_path;
+        const uint8_t* m_data;      // set for archives opened from memory
+        uint64_t m_size;
+        std::vector<ZipEntryInfo> m_entries;
+        std::unordered_map<std::string, size_t> m_entryIndices;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_ZIP_ARCHIVE_H_
@@ -0,0 +1,273 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#include "MappedByteStream.h"
+
+#include <mfapi.h>
+#include <mferror.h>
+#include <string.h>
+
+using namespace Microsoft::WRL;
+using namespace VuforiaMedia;
+
+// Attribute carrying the byte count of an asynchronous read to EndRead()
+// {5B0E4D29-7C41-4C38-9D1F-2A6E8B3C9F14}
+static const GUID READ_BYTE_COUNT =
+    { 0x5b0e4d29, 0x7c41, 0x4c38, { 0x9d, 0x1f, 0x2a, 0x6e, 0x8b, 0x3c, 0x9f, 0x14 } };
+
+HRESULT MappedByteStream::Create(std::unique_ptr<MappedFile> file, IMFByteStream** byteStream)
+{
+    if (!file || !file->IsOpen() || byteStream == nullptr)
+    {
+        return E_INVALIDARG;
+    }
+
+    ComPtr<MappedByteStream> stream = Make<MappedByteStream>();
+    if (!stream)
+    {
+        return E_OUTOFMEMORY;
+    }
+    stream->m_file = std::move(file);
+
+    *byteStream = stream.Detach();
+    return S_OK;
+}
+
+MappedByteStream::MappedByteStream() :
+    m_position(0)
+{
+    InitializeCriticalSectionEx(&m_criticalSection, 0, 0);
+}
+
+MappedByteStream::~MappedByteStream()
+{
+    DeleteCriticalSection(&m_criticalSection);
+}
+
+STDMETHODIMP MappedByteStream::GetCapabilities(DWORD* capabilities)
+{
+    if (capabilities == nullptr)
+    {
+        return E_POINTER;
+    }
+    *capabilities = MFBYTESTREAM_IS_READABLE | MFBYTESTREAM_IS_SEEKABLE | MFBYTESTREAM_DOES_NOT_USE_NETWORK;
+    return S_OK;
+}
+
+STDMETHODIMP MappedByteStream::GetLength(QWORD* length)
+{
+    if (length == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+    HRESULT hres = m_file ? S_OK : MF_E_SHUTDOWN;
+    *length = m_file ? m_file->GetSize() : 0;
+    LeaveCriticalSection(&m_criticalSection);
+
+    return hres;
+}
+
+STDMETHODIMP MappedByteStream::SetLength(QWORD)
+{
+    return E_NOTIMPL;
+}
+
+STDMETHODIMP MappedByteStream::GetCurrentPosition(QWORD* position)
+{
+    if (position == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+    *position = m_position;
+    LeaveCriticalSection(&m_criticalSection);
+
+    return S_OK;
+}
+
+STDMETHODIMP MappedByteStream::SetCurrentPosition(QWORD position)
+{
+    EnterCriticalSection(&m_criticalSection);
+
+    HRESULT hres = S_OK;
+    if (!m_file)
+    {
+        hres = MF_E_SHUTDOWN;
+    }
+    else if (position > m_file->GetSize())
+    {
+        hres = E_INVALIDARG;
+    }
+    else
+    {
+        m_position = position;
+    }
+
+    LeaveCriticalSection(&m_criticalSection);
+
+    return hres;
+}
+
+STDMETHODIMP MappedByteStream::IsEndOfStream(BOOL* endOfStream)
+{
+    if (endOfStream == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+    *endOfStream = !m_file || m_position >= m_file->GetSize();
+    LeaveCriticalSection(&m_criticalSection);
+
+    return S_OK;
+}
+
+STDMETHODIMP MappedByteStream::Read(BYTE* buffer, ULONG size, ULONG* read)
+{
+    if (buffer == nullptr || read == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+
+    if (!m_file)
+    {
+        LeaveCriticalSection(&m_criticalSection);
+        return MF_E_SHUTDOWN;
+    }
+
+    QWORD available = m_file->GetSize() - m_position;
+    ULONG count = (available < size) ? (ULONG)available : size;
+    memcpy(buffer, m_file->GetData() + m_position, count);
+    m_position += count;
+    *read = count;
+
+    LeaveCriticalSection(&m_criticalSection);
+
+    return S_OK;
+}
+
+STDMETHODIMP MappedByteStream::BeginRead(BYTE* buffer, ULONG size, IMFAsyncCallback* callback, IUnknown* state)
+{
+    if (callback == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    ULONG read = 0;
+    HRESULT hres = Read(buffer, size, &read);
+    if (FAILED(hres))
+    {
+        return hres;
+    }
+
+    ComPtr<IMFAttributes> readResult;
+    hres = MFCreateAttributes(&readResult, 1);
+    if (SUCCEEDED(hres))
+    {
+        hres = readResult->SetUINT32(READ_BYTE_COUNT, read);
+    }
+
+    ComPtr<IMFAsyncResult> result;
+    if (SUCCEEDED(hres))
+    {
+        hres = MFCreateAsyncResult(readResult.Get(), callback, state, &result);
+    }
+    if (SUCCEEDED(hres))
+    {
+        hres = MFInvokeCallback(result.Get());
+    }
+
+    return hres;
+}
+
+STDMETHODIMP MappedByteStream::EndRead(IMFAsyncResult* result, ULONG* read)
+{
+    if (result == nullptr || read == nullptr)
+    {
+        return E_POINTER;
+    }
+
+    ComPtr<IUnknown> object;
+    ComPtr<IMFAttributes> readResult;
+    HRESULT hres = result->GetObject(&object);
+    if (SUCCEEDED(hres))
+    {
+        hres = object.As(&readResult);
+    }
+
+    UINT32 count = 0;
+    if (SUCCEEDED(hres))
+    {
+        hres = readResult->GetUINT32(READ_BYTE_COUNT, &count);
+    }
+    *read = count;
+
+    return SUCCEEDED(hres) ? result->GetStatus() : hres;
+}
+
+STDMETHODIMP MappedByteStream::Write(const BYTE*, ULONG, ULONG*)
+{
+    return E_ACCESSDENIED;
+}
+
+STDMETHODIMP MappedByteStream::BeginWrite(const BYTE*, ULONG, IMFAsyncCallback*, IUnknown*)
+{
+    return E_ACCESSDENIED;
+}
+
+STDMETHODIMP MappedByteStream::EndWrite(IMFAsyncResult*, ULONG*)
+{
+    return E_ACCESSDENIED;
+}
+
+STDMETHODIMP MappedByteStream::Seek(MFBYTESTREAM_SEEK_ORIGIN origin, LONGLONG offset, DWORD, QWORD* position)
+{
+    EnterCriticalSection(&m_criticalSection);
+
+    if (!m_file)
+    {
+        LeaveCriticalSection(&m_criticalSection);
+        return MF_E_SHUTDOWN;
+    }
+
+    LONGLONG base = (origin == msoCurrent) ? (LONGLONG)m_position : 0;
+    LONGLONG target = base + offset;
+    if (target < 0 || (QWORD)target > m_file->GetSize())
+    {
+        LeaveCriticalSection(&m_criticalSection);
+        return E_INVALIDARG;
+    }
+
+    m_position = (QWORD)target;
+    if (position != nullptr)
+    {
+        *position = m_position;
+    }
+
+    LeaveCriticalSection(&m_criticalSection);
+
+    return S_OK;
+}
+
+STDMETHODIMP MappedByteStream::Flush()
+{
+    return S_OK;
+}
+
+STDMETHODIMP MappedByteStream::Close()
+{
+    EnterCriticalSection(&m_criticalSection);
+    m_file.reset();
+    m_position = 0;
+    LeaveCriticalSection(&m_criticalSection);
+
+    return S_OK;
+}
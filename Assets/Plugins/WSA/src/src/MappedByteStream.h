@@ -0,0 +1,56 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_WSA_MAPPED_BYTE_STREAM_H_
+#define _VUFORIA_MEDIA_WSA_MAPPED_BYTE_STREAM_H_
+
+#include <wrl.h>
+#include <mfidl.h>
+#include <memory>
+
+#include "MappedFile.h"
+
+namespace VuforiaMedia
+{
+    // Read-only Media Foundation byte stream over a memory-mapped file.
+    //
+    // Reads are served straight from the mapping, instead of going through
+    // the WinRT stream and the buffers of MFCreateMFByteStreamOnStreamEx.
+    // Asynchronous reads complete before BeginRead returns.
+    class MappedByteStream :
+        public Microsoft::WRL::RuntimeClass<Microsoft::WRL::RuntimeClassFlags<Microsoft::WRL::ClassicCom>, IMFByteStream>
+    {
+    public:
+        static HRESULT Create(std::unique_ptr<MappedFile> file, IMFByteStream** byteStream);
+
+        MappedByteStream();
+        virtual ~MappedByteStream();
+
+        // IMFByteStream
+        STDMETHODIMP GetCapabilities(DWORD* capabilities);
+        STDMETHODIMP GetLength(QWORD* length);
+        STDMETHODIMP SetLength(QWORD length);
+        STDMETHODIMP GetCurrentPosition(QWORD* position);
+        STDMETHODIMP SetCurrentPosition(QWORD position);
+        STDMETHODIMP IsEndOfStream(BOOL* endOfStream);
+        STDMETHODIMP Read(BYTE* buffer, ULONG size, ULONG* read);
+        STDMETHODIMP BeginRead(BYTE* buffer, ULONG size, IMFAsyncCallback* callback, IUnknown* state);
+        STDMETHODIMP EndRead(IMFAsyncResult* result, ULONG* read);
+        STDMETHODIMP Write(const BYTE* buffer, ULONG size, ULONG* written);
+        STDMETHODIMP BeginWrite(const BYTE* buffer, ULONG size, IMFAsyncCallback* callback, IUnknown* state);
+        STDMETHODIMP EndWrite(IMFAsyncResult* result, ULONG* written);
+        STDMETHODIMP Seek(MFBYTESTREAM_SEEK_ORIGIN origin, LONGLONG offset, DWORD flags, QWORD* position);
+        STDMETHODIMP Flush();
+        STDMETHODIMP Close();
+
+    private:
+        std::unique_ptr<MappedFile> m_file;
+        QWORD m_position;
+        CRITICAL_SECTION m_criticalSection;
+    };
+}
+
+#endif // _VUFORIA_MEDIA_WSA_MAPPED_BYTE_STREAM_H_
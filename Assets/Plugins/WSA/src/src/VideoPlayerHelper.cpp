@@ -5,6 +5,7 @@ Vuforia is a trademark of PTC Inc., registered in the United States and other
 countries.
 ===============================================================================*/
 #include "VideoPlayerHelper.h"
+#include "MappedByteStream.h"
 
 using namespace Microsoft::WRL;
 using namespace Windows::Foundation;
@@ -13,12 +14,148 @@ using namespace Windows::UI::Core;
 using namespace Windows::Storage;
 using namespace Windows::Storage::Pickers;
 using namespace Windows::Storage::Streams;
+using namespace Windows::Storage::FileProperties;
 using namespace Windows::System::Threading;
 using namespace Concurrency;
 using namespace VuforiaMedia;
 
 #define MAX_FILENAME_LENGTH 256
 
+// A frame is captured as poster frame once playback has reached this close
+// to the requested position
+#define POSTER_FRAME_POSITION_TOLERANCE 0.05
+
+// Holds a critical section for the scope of a block, released on every exit
+class CriticalSectionLock
+{
+public:
+    explicit CriticalSectionLock(CRITICAL_SECTION* criticalSection) : m_criticalSection(criticalSection)
+    {
+        EnterCriticalSection(m_criticalSection);
+    }
+
+    ~CriticalSectionLock()
+    {
+        LeaveCriticalSection(m_criticalSection);
+    }
+
+private:
+    CriticalSectionLock(const CriticalSectionLock&);
+    CriticalSectionLock& operator=(const CriticalSectionLock&);
+
+    CRITICAL_SECTION* m_criticalSection;
+};
+
+// Time of the current render, in seconds: its image reaches the screen a
+// constant latency later, which the display cadence does not depend on
+static double GetRenderTime()
+{
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+// Frame counter of the media engine; it restarts with each source
+static bool GetEngineFrameCount(IMFMediaEngineEx* mediaEngineEx, MF_MEDIA_ENGINE_STATISTIC statistic, uint32_t& count)
+{
+    PROPVARIANT value;
+    PropVariantInit(&value);
+    bool valid = SUCCEEDED(mediaEngineEx->GetStatistics(statistic, &value));
+    if (valid && value.vt == VT_UI4)
+    {
+        count = value.ulVal;
+    }
+    else if (valid && value.vt == VT_UI8)
+    {
+        count = (uint32_t)value.uhVal.QuadPart;
+    }
+    else
+    {
+        valid = false;
+    }
+    PropVariantClear(&value);
+    return valid;
+}
+
+// Frames counted by the engine since the previous count, or since the start of
+// a new source
+static uint32_t GetEngineFrameDelta(uint32_t count, uint32_t& previousCount)
+{
+    uint32_t delta = (count >= previousCount) ? count - previousCount : count;
+    previousCount = count;
+    return delta;
+}
+
+static std::string ToUtf8(const wchar_t* text)
+{
+    int length = WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr);
+    if (length <= 1)
+    {
+        return std::string();
+    }
+    std::string utf8(length - 1, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text, -1, &utf8[0], length, nullptr, nullptr);
+    return utf8;
+}
+
+// Poster frames and keyframe indices are kept in the local cache folder
+// of the app, which the system may clear when it runs low on storage
+static std::string GetCacheDirectory()
+{
+    return ToUtf8(ApplicationData::Current->LocalCacheFolder->Path->Data());
+}
+
+static PosterFrameCache& GetPosterFrameCache()
+{
+    static PosterFrameCache* s_posterFrameCache = new PosterFrameCache(GetCacheDirectory() + "\\PosterFrames");
+    return *s_posterFrameCache;
+}
+
+static std::wstring ToWide(const std::string& text)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
+    if (length <= 1)
+    {
+        return std::wstring();
+    }
+    std::wstring wide(length - 1, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &wide[0], length);
+    return wide;
+}
+
+// Opens the file of a playlist item as Load() does: files of the app package are
+// memory-mapped, the others go through a WinRT stream. Waits for the file to be
+// opened, so it must not be called on the UI thread.
+static bool OpenSourceStream(const std::wstring& uri, ComPtr<IMFByteStream>& byteStream, std::wstring& path)
+{
+    try
+    {
+        StorageFile^ file = create_task(StorageFile::GetFileFromApplicationUriAsync(
+            ref new Uri(ref new Platform::String(uri.c_str())))).get();
+        if (!file)
+        {
+            return false;
+        }
+        path = file->Path->Data();
+
+        std::unique_ptr<MappedFile> mappedFile(new MappedFile());
+        if (mappedFile->Open(ToUtf8(path.c_str())) &&
+            SUCCEEDED(MappedByteStream::Create(std::move(mappedFile), byteStream.ReleaseAndGetAddressOf())))
+        {
+            return true;
+        }
+
+        IRandomAccessStream^ stream = create_task(file->OpenAsync(FileAccessMode::Read)).get();
+        return stream && SUCCEEDED(MFCreateMFByteStreamOnStreamEx((IUnknown*)stream, byteStream.ReleaseAndGetAddressOf()));
+    }
+    catch (Platform::Exception^)
+    {
+        return false;
+    }
+}
+
 // MediaEngineNotify: Implements the callback for Media Engine event notification.
 class MediaEngineNotify : public IMFMediaEngineNotify
 {
@@ -85,22 +222,43 @@ private:
 };
 
 
-bool VideoPlayerHelper::s_MediaFoundationStarted = false;
+// Number of players sharing Media Foundation, which is shut down with the last one
+std::mutex VideoPlayerHelper::s_MediaFoundationMutex;
+int VideoPlayerHelper::s_MediaFoundationUsers = 0;
 
 
 VideoPlayerHelper::VideoPlayerHelper(ID3D11Device *d3dDevice) :
     m_d3dDevice(d3dDevice),
+    m_crop(GetFullFrameCrop()),
+    m_frameWidth(0),
+    m_frameHeight(0),
     m_videoWidth(0),
     m_videoHeight(0),
     m_videoLengthSeconds(0),
     m_mediaState(NOT_READY),
+    m_renderSlot(-1),
+    m_usesMediaFoundation(false),
     m_mediaEngine(nullptr),
     m_mediaEngineEx(nullptr),
     m_sourceUrl(nullptr),
     m_videoTexture(nullptr),
     m_frameTexture(nullptr),
     m_frameTextureInitialized(false),
-    m_doUpdateVideoData(false)
+    m_doUpdateVideoData(false),
+    m_newFrameCopied(0),
+    m_frameCounter(0),
+    m_bufferingPercentage(0),
+    m_engineFramesRendered(0),
+    m_engineFramesDropped(0),
+    m_posterKeyValid(false),
+    m_posterCaptured(false),
+    m_posterUploadPending(false),
+    m_nextIndex(-1),
+    m_switchingItem(false),
+    m_pendingStart(false),
+    m_pendingPlay(false),
+    m_pendingSeekPosition(0),
+    m_commandEvent(nullptr)
 {
     OutputDebugString(L"VideoPlayer: Initializing...\n");
 
@@ -109,10 +267,17 @@ VideoPlayerHelper::VideoPlayerHelper(ID3D11Device *d3dDevice) :
     }
 
     memset(&m_bgColor, 0, sizeof(MFARGB));
+    memset(&m_targetRect, 0, sizeof(RECT));
+    memset(&m_sourceRect, 0, sizeof(MFVideoNormalizedRect));
 
     InitializeCriticalSectionEx(&m_criticalSection, 0, 0);
 
     Initialize();   
+
+    // Control calls are queued and run on this thread, so that the script thread
+    // never waits on the media engine, nor holds the lock the render thread takes
+    m_commandEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+    m_commandThread = std::thread(&VideoPlayerHelper::CommandLoop, this);
 }
 
 void VideoPlayerHelper::Initialize()
@@ -121,22 +286,26 @@ void VideoPlayerHelper::Initialize()
     ComPtr<IMFAttributes> mediaEngineAttributes;
     ComPtr<MediaEngineNotify> mediaEngineNotify;
 
-    if (!s_MediaFoundationStarted)
     {
-        OutputDebugString(L"VideoPlayer: Initializing Media Foundation...\n");
-
-        if (SUCCEEDED(MFStartup(MF_VERSION)))
+        std::lock_guard<std::mutex> lock(s_MediaFoundationMutex);
+        if (s_MediaFoundationUsers == 0)
         {
-            s_MediaFoundationStarted = true;
-            OutputDebugString(L"VideoPlayer: Successfully initialized Media Foundation.\n");
-        }
-        else
-        {
-            OutputDebugString(L"VideoPlayer Error: Media Foundation init error!\n");
-            m_mediaState = MEDIA_ERROR;
-            return;
+            OutputDebugString(L"VideoPlayer: Initializing Media Foundation...\n");
+
+            if (SUCCEEDED(MFStartup(MF_VERSION)))
+            {
+                OutputDebugString(L"VideoPlayer: Successfully initialized Media Foundation.\n");
+            }
+            else
+            {
+                OutputDebugString(L"VideoPlayer Error: Media Foundation init error!\n");
+                m_mediaState = MEDIA_ERROR;
+                return;
+            }
         }
+        ++s_MediaFoundationUsers;
     }
+    m_usesMediaFoundation = true;
     
 
     EnterCriticalSection(&m_criticalSection);
@@ -209,23 +378,39 @@ void VideoPlayerHelper::Initialize()
         return;
     }
 
-    if (FAILED(m_mediaEngine.Get()->QueryInterface(__uuidof(IMFMediaEngine), (void**)&m_mediaEngineEx))) {
+    if (FAILED(m_mediaEngine.Get()->QueryInterface(__uuidof(IMFMediaEngineEx), (void**)&m_mediaEngineEx))) {
         OutputDebugString(L"VideoPlayer Error: Failed to query Media Engine interface!\n");
         m_mediaState = MEDIA_ERROR;
         LeaveCriticalSection(&m_criticalSection);
         return;
     }
 
+    // Let the engine parse the metadata and decode up to the first frame as soon as
+    // the source is set, so that players prepared in the warm pool can start instantly
+    m_mediaEngine->SetPreload(MF_MEDIA_ENGINE_PRELOAD_AUTOMATIC);
+
     LeaveCriticalSection(&m_criticalSection);
 }
 
 VideoPlayerHelper::~VideoPlayerHelper()
 {
+    // Commands still queued are run before the thread exits
+    PostCommand(Command::QUIT);
+    m_commandThread.join();
+    CloseHandle(m_commandEvent);
+
     EnterCriticalSection(&m_criticalSection);
 
+    // The engine is missing if the player failed to initialize
     OutputDebugString(L"VideoPlayer: Shutting down Media Engine...\n");
-    m_mediaEngine->Shutdown();
-    m_mediaEngineEx->Shutdown();
+    if (m_mediaEngine)
+    {
+        m_mediaEngine->Shutdown();
+    }
+    if (m_mediaEngineEx)
+    {
+        m_mediaEngineEx->Shutdown();
+    }
 
     m_mediaEngine.Reset();
     m_mediaEngineEx.Reset();
@@ -240,12 +425,16 @@ VideoPlayerHelper::~VideoPlayerHelper()
     m_d3dDevice = nullptr;
     m_doUpdateVideoData = false;
 
-    if (s_MediaFoundationStarted)
+    if (m_usesMediaFoundation)
     {
-        s_MediaFoundationStarted = false;
-        OutputDebugString(L"VideoPlayer: Shutting down Media Foundation...\n");
-        MFShutdown();
+        std::lock_guard<std::mutex> lock(s_MediaFoundationMutex);
+        if (--s_MediaFoundationUsers == 0)
+        {
+            OutputDebugString(L"VideoPlayer: Shutting down Media Foundation...\n");
+            MFShutdown();
+        }
     }
+    m_usesMediaFoundation = false;
 }
 
 void VideoPlayerHelper::OnMediaEngineEvent(ULONG32 mediaEngineEvent)
@@ -256,7 +445,7 @@ void VideoPlayerHelper::OnMediaEngineEvent(ULONG32 mediaEngineEvent)
     {
         OutputDebugString(L"VideoPlayer: loaded metadata.\n");
         
-        EnterCriticalSection(&m_criticalSection);
+        CriticalSectionLock lock(&m_criticalSection);
 
         // Metadata have been loaded, 
         // so now we can get video width, height and length
@@ -269,30 +458,20 @@ void VideoPlayerHelper::OnMediaEngineEvent(ULONG32 mediaEngineEvent)
             break;
         }
 
-        m_videoWidth = (int)videoWidth;
-        m_videoHeight = (int)videoHeight;
+        m_frameWidth = (int)videoWidth;
+        m_frameHeight = (int)videoHeight;
         m_videoLengthSeconds = (float)m_mediaEngine->GetDuration();
-        
-        m_targetRect.left = 0;
-        m_targetRect.top = 0;
-        m_targetRect.right = m_videoWidth;
-        m_targetRect.bottom = m_videoHeight;
-
-        // Create the internal video frame texture
-        int rowPitch = m_videoWidth * 4;
-        int frameSize = rowPitch * m_videoHeight;
-        uint8_t *frameBytes = new (std::nothrow) uint8_t[frameSize];
-        memset(frameBytes, 0, frameSize);
-
-        D3D11_SUBRESOURCE_DATA initData;
-        initData.pSysMem = frameBytes;
-        initData.SysMemPitch = static_cast<UINT>(rowPitch);
-        initData.SysMemSlicePitch = static_cast<UINT>(frameSize);
+        m_bufferingPercentage = GetBufferingPercentageLocked();
 
+        // Describe the internal video frame texture, created on the first frame.
+        // Frames are only ever copied from its top level, so it has no mipmaps.
+        // Its size is the one of the crop, kept for the playlist items of that size.
+        UINT frameTexWidth = m_frameTexDesc.Width;
+        UINT frameTexHeight = m_frameTexDesc.Height;
         ZeroMemory(&m_frameTexDesc, sizeof(D3D11_TEXTURE2D_DESC));
-        m_frameTexDesc.Width = m_videoWidth;
-        m_frameTexDesc.Height = m_videoHeight;
-        m_frameTexDesc.MipLevels = 0;
+        m_frameTexDesc.Width = frameTexWidth;
+        m_frameTexDesc.Height = frameTexHeight;
+        m_frameTexDesc.MipLevels = 1;
         m_frameTexDesc.ArraySize = 1;
         m_frameTexDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
         m_frameTexDesc.SampleDesc.Count = 1;
@@ -300,33 +479,81 @@ void VideoPlayerHelper::OnMediaEngineEvent(ULONG32 mediaEngineEvent)
         m_frameTexDesc.Usage = D3D11_USAGE_DEFAULT;
         m_frameTexDesc.CPUAccessFlags = 0;
         m_frameTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-        m_frameTexDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+        m_frameTexDesc.MiscFlags = 0;
 
-        LeaveCriticalSection(&m_criticalSection);
+        UpdateCropLocked();
     }
     break;
     case MF_MEDIA_ENGINE_EVENT_CANPLAY:
     {
-        m_mediaState = READY;
+        // While switching to the next playlist item, the video keeps playing
+        if (!m_switchingItem)
+        {
+            m_mediaState = READY;
+        }
         OutputDebugString(L"VideoPlayer: Media ready to play.\n");
+
+        EnterCriticalSection(&m_criticalSection);
+        bool start = m_pendingStart;
+        bool play = m_pendingPlay;
+        float seekPosition = m_pendingSeekPosition;
+        m_pendingStart = false;
+        LeaveCriticalSection(&m_criticalSection);
+        if (start)
+        {
+            StartWhenReady(play, seekPosition);
+        }
     }
     break;
     case MF_MEDIA_ENGINE_EVENT_PLAY:
     {
         OutputDebugString(L"VideoPlayer: Media playing.\n");
+        m_switchingItem = false;
         m_mediaState = PLAYING;
+
+        // The time the video stood still is not a stall
+        m_playbackStats.OnPlaybackStarted();
     }
     break;
     case MF_MEDIA_ENGINE_EVENT_PAUSE:
     {
+        // The engine pauses at the end of an item, just before ENDED
         OutputDebugString(L"VideoPlayer: Media paused.\n");
-        m_mediaState = PAUSED;
+        if (!m_switchingItem && !(m_mediaEngine->IsEnded() && m_playlist.GetNextIndex() >= 0))
+        {
+            m_mediaState = PAUSED;
+        }
     }
     break;
     case MF_MEDIA_ENGINE_EVENT_ENDED:
     {
         OutputDebugString(L"VideoPlayer: Media reached end.\n");
-        m_mediaState = REACHED_END;
+        if (m_playlist.GetNextIndex() >= 0)
+        {
+            m_switchingItem = true;
+            PostCommand(Command::ADVANCE);
+        }
+        else
+        {
+            m_mediaState = REACHED_END;
+        }
+    }
+    break;
+    case MF_MEDIA_ENGINE_EVENT_PROGRESS:
+    case MF_MEDIA_ENGINE_EVENT_BUFFERINGSTARTED:
+    case MF_MEDIA_ENGINE_EVENT_BUFFERINGENDED:
+    {
+        CriticalSectionLock lock(&m_criticalSection);
+        m_bufferingPercentage = GetBufferingPercentageLocked();
+    }
+    break;
+    case MF_MEDIA_ENGINE_EVENT_TIMEUPDATE:
+    {
+        if (m_mediaState == PLAYING &&
+            m_playlist.ShouldPreroll(m_mediaEngine->GetCurrentTime(), m_videoLengthSeconds))
+        {
+            PostCommand(Command::PREROLL);
+        }
     }
     break;
     case MF_MEDIA_ENGINE_EVENT_ERROR:
@@ -342,6 +569,10 @@ void VideoPlayerHelper::OnMediaEngineEvent(ULONG32 mediaEngineEvent)
     }
     break;
     }
+
+    // State, position (MF_MEDIA_ENGINE_EVENT_TIMEUPDATE) or buffering
+    // (MF_MEDIA_ENGINE_EVENT_PROGRESS) may have changed
+    PublishStatus();
 }
 
 bool VideoPlayerHelper::SetVideoTexturePtr(ID3D11Texture2D* texturePtr)
@@ -349,12 +580,53 @@ bool VideoPlayerHelper::SetVideoTexturePtr(ID3D11Texture2D* texturePtr)
     EnterCriticalSection(&m_criticalSection);
 
     m_videoTexture = texturePtr;
+    ReportGpuMemory();
 
     LeaveCriticalSection(&m_criticalSection);
 
     return true;
 }
 
+// Binds the player to its render event and status block slot (-1 to unbind).
+// A player prepared in the warm pool is only bound when it is activated.
+// Its GPU memory is accounted under that slot.
+void VideoPlayerHelper::SetRenderSlot(int slot)
+{
+    EnterCriticalSection(&m_criticalSection);
+
+    GpuMemoryBudget::Instance().ReleasePlayer(m_renderSlot);
+    m_renderSlot = slot;
+    ReportGpuMemory();
+
+    LeaveCriticalSection(&m_criticalSection);
+
+    PublishStatus();
+}
+
+// Reports the textures of the player to the GPU memory budget
+// [Always called with m_criticalSection locked]
+void VideoPlayerHelper::ReportGpuMemory()
+{
+    if (m_renderSlot < 0)
+    {
+        return;
+    }
+
+    GpuMemoryBudget& budget = GpuMemoryBudget::Instance();
+
+    uint64_t videoTextureBytes = 0;
+    if (m_videoTexture != nullptr)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc;
+        m_videoTexture->GetDesc(&textureDesc);
+        videoTextureBytes = GpuMemoryBudget::GetTextureSize(textureDesc.Width, textureDesc.Height, 4);
+    }
+    budget.SetAllocation(m_renderSlot, GPU_MEMORY_VIDEO_TEXTURE, videoTextureBytes);
+
+    budget.SetAllocation(m_renderSlot, GPU_MEMORY_FRAME_BUFFER, m_frameTextureInitialized ?
+        GpuMemoryBudget::GetTextureSize(m_frameTexDesc.Width, m_frameTexDesc.Height, 4) : 0);
+}
+
 bool VideoPlayerHelper::IsPlayableOnTexture()
 {
     return true;
@@ -373,17 +645,61 @@ bool VideoPlayerHelper::Load(const char *filename, int requestType, bool playOnT
     OutputDebugString(filenameWChar);
     OutputDebugString(L"\n");
     
+    EnterCriticalSection(&m_criticalSection);
+    m_posterKeyValid = false;
+    m_posterCaptured = false;
+    m_posterUploadPending = false;
+    m_posterFrame.reset();
+    m_keyframeIndex.reset();
+    m_engineFramesRendered = 0;
+    m_engineFramesDropped = 0;
+    m_bufferingPercentage = 0;
+    m_pendingStart = false;
+    LeaveCriticalSection(&m_criticalSection);
+    m_judderMeter.ResetStats();
+    m_playbackStats.Reset();
+
     Uri^ uri = ref new Uri(ref new Platform::String(filenameWChar));
     task<StorageFile^> getFileTask(StorageFile::GetFileFromApplicationUriAsync(uri));
     
-    getFileTask.then([this](StorageFile^ file)
+    getFileTask.then([this, seekPosition](StorageFile^ file)
     {
         if (!file) {
             OutputDebugString(L"VideoPlayer: file loading failed!");
             throw ref new Platform::Exception(E_FAIL);
         }
 
-        task<IRandomAccessStream^> openFileTask(file->OpenAsync(Windows::Storage::FileAccessMode::Read));
+        // Look for the poster frame of this version of the file while it is being opened
+        Platform::String^ posterPath = file->Path;
+        create_task(file->GetBasicPropertiesAsync()).then([this, posterPath, seekPosition](BasicProperties^ properties)
+        {
+            PosterFrameKey key;
+            key.path = ToUtf8(posterPath->Data());
+            key.modifiedTime = properties->DateModified.UniversalTime;
+            key.position = seekPosition;
+            FindPosterFrame(key);
+
+            // Keyframe index for keyframe-aligned seeks, built on first load
+            KeyframeIndex::Source source;
+            source.size = properties->Size;
+            source.modifiedTime = properties->DateModified.UniversalTime;
+            std::shared_ptr<KeyframeIndex> keyframeIndex =
+                KeyframeIndex::LoadOrBuild(key.path, source, GetCacheDirectory() + "\\KeyframeIndex");
+
+            EnterCriticalSection(&m_criticalSection);
+            m_keyframeIndex = keyframeIndex;
+            LeaveCriticalSection(&m_criticalSection);
+        }).then([](task<void> previousTask)
+        {
+            try
+            {
+                previousTask.get();
+            }
+            catch (Platform::Exception^)
+            {
+                OutputDebugString(L"VideoPlayer: could not read file properties, no poster frame.\n");
+            }
+        });
 
         // Stor the file URL
         Platform::String^ filePath = file->Path;
@@ -396,6 +712,20 @@ bool VideoPlayerHelper::Load(const char *filename, int requestType, bool playOnT
         m_sourceUrl = (LPWSTR)::CoTaskMemAlloc(sizeof(WCHAR) * filePathStrLen);
         StringCchCopyW(m_sourceUrl, filePathStrLen, filePath->Data());
 
+        // Files of the app package (StreamingAssets) are memory-mapped and read
+        // in place; the others go through a WinRT stream
+        std::unique_ptr<MappedFile> mappedFile(new MappedFile());
+        if (mappedFile->Open(ToUtf8(filePath->Data())))
+        {
+            ComPtr<IMFByteStream> byteStream;
+            if (SUCCEEDED(MappedByteStream::Create(std::move(mappedFile), &byteStream)))
+            {
+                SetSourceByteStream(byteStream.Get());
+                return;
+            }
+        }
+
+        task<IRandomAccessStream^> openFileTask(file->OpenAsync(Windows::Storage::FileAccessMode::Read));
         openFileTask.then([this](IRandomAccessStream^ stream)
         {
             this->SetSourceStream(stream);
@@ -414,18 +744,24 @@ void VideoPlayerHelper::SetSourceStream(IRandomAccessStream^ stream)
 
     ComPtr<IMFByteStream> byteStream = nullptr;
 
-    EnterCriticalSection(&m_criticalSection);
-
     HRESULT hres;
     hres = MFCreateMFByteStreamOnStreamEx((IUnknown*)stream, &byteStream);    
     if (FAILED(hres)) {
         OutputDebugString(L"VideoPlayer Error: Failed to create Media byte stream!\n");
+        EnterCriticalSection(&m_criticalSection);
         m_mediaState = MEDIA_ERROR;
         LeaveCriticalSection(&m_criticalSection);
         return;
     }
 
-    hres = m_mediaEngineEx->SetSourceFromByteStream(byteStream.Get(), m_sourceUrl);
+    SetSourceByteStream(byteStream.Get());
+}
+
+void VideoPlayerHelper::SetSourceByteStream(IMFByteStream* byteStream)
+{
+    EnterCriticalSection(&m_criticalSection);
+
+    HRESULT hres = m_mediaEngineEx->SetSourceFromByteStream(byteStream, m_sourceUrl);
     if (FAILED(hres)) {
         OutputDebugString(L"VideoPlayer Error: Failed to set source from byte stream!\n");
         m_mediaState = MEDIA_ERROR;
@@ -436,60 +772,56 @@ void VideoPlayerHelper::SetSourceStream(IRandomAccessStream^ stream)
     LeaveCriticalSection(&m_criticalSection);
 }
 
-bool VideoPlayerHelper::Play(bool fullScreen, float seekPosition)
+// Seeks to seekPosition (if not 0) and plays if requested, now if the media is
+// ready to play, otherwise as soon as it is
+void VideoPlayerHelper::StartWhenReady(bool play, float seekPosition)
 {
-    if (m_mediaState == PLAYING)
+    EnterCriticalSection(&m_criticalSection);
+    bool ready = (m_mediaState != NOT_READY && m_mediaState != MEDIA_ERROR);
+    if (!ready)
     {
-        // already playing, skip
-        return true;
+        m_pendingStart = true;
+        m_pendingPlay = play;
+        m_pendingSeekPosition = seekPosition;
     }
+    LeaveCriticalSection(&m_criticalSection);
 
-    if (!m_mediaEngine || !m_mediaEngine->HasVideo())
+    if (ready)
     {
-        OutputDebugString(L"VideoPlayer: Play skipped: Media Engine not ready!\n");
-        return false;
+        if (seekPosition > 0)
+        {
+            PostCommand(Command::SEEK, seekPosition);
+        }
+        if (play)
+        {
+            PostCommand(Command::PLAY);
+        }
     }
+}
 
-    if (m_mediaState == REACHED_END)
+// Control calls return as soon as the command is queued; their outcome is
+// published through the status block by the command thread
+bool VideoPlayerHelper::Play(bool fullScreen, float seekPosition)
+{
+    if (!m_mediaEngine || !m_mediaEngine->HasVideo())
     {
-        SeekTo(0);
-        m_mediaState = READY;
+        OutputDebugString(L"VideoPlayer: Play skipped: Media Engine not ready!\n");
+        return false;
     }
 
-    EnterCriticalSection(&m_criticalSection);
-    HRESULT hres = m_mediaEngine->Play();
-    LeaveCriticalSection(&m_criticalSection);
-
-    if (SUCCEEDED(hres))
-    {
-        m_mediaState = PLAYING;
-        return true;
-    }
-    
-    return false;
+    PostCommand(Command::PLAY);
+    return true;
 }
 
 bool VideoPlayerHelper::Pause()
 {
-    EnterCriticalSection(&m_criticalSection);
-
-    bool success = false;
-    if (m_mediaEngine && m_mediaEngine->HasVideo())
-    {
-        success = SUCCEEDED(m_mediaEngine->Pause());
-    }
-
-    LeaveCriticalSection(&m_criticalSection);
-    
-    return success;
+    PostCommand(Command::PAUSE);
+    return true;
 }
 
 bool VideoPlayerHelper::Stop()
 {
-    if (m_mediaState == PLAYING) {
-        Pause();
-    }
-    m_mediaState = STOPPED;
+    PostCommand(Command::STOP);
     return true;
 }
 
@@ -500,20 +832,75 @@ void VideoPlayerHelper::OnPause()
 
 bool VideoPlayerHelper::Unload()
 {
-    if (m_mediaEngine)
+    if (!m_mediaEngine)
     {
-        if (m_mediaState == PLAYING) {
-            Pause();
-        }
-        
-        EnterCriticalSection(&m_criticalSection);
-        HRESULT hres = m_mediaEngine->Shutdown();
-        LeaveCriticalSection(&m_criticalSection);
-        return SUCCEEDED(hres);
+        return false;
     }
-    return false;
+
+    PostCommand(Command::UNLOAD);
+    return true;
 }
- 
+
+// Copies only this region of the frames, normalised from their top left
+// corner, to a video texture of its size. A crop of the same size in pixels
+// can be moved while playing; otherwise the video texture has to be created
+// again with the new size.
+bool VideoPlayerHelper::SetCrop(float x, float y, float width, float height)
+{
+    VideoCrop crop = { x, y, width, height };
+    if (!ClampVideoCrop(crop))
+    {
+        return false;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+    m_crop = crop;
+    UpdateCropLocked();
+    LeaveCriticalSection(&m_criticalSection);
+
+    PublishStatus();
+    return true;
+}
+
+// Sizes the frame texture and the reported video size to the crop, snapped
+// to the pixels of the frames
+// [Always called with m_criticalSection locked]
+void VideoPlayerHelper::UpdateCropLocked()
+{
+    if (m_frameWidth <= 0 || m_frameHeight <= 0)
+    {
+        return;
+    }
+
+    VideoCropPixels pixels = GetVideoCropPixels(m_crop, m_frameWidth, m_frameHeight);
+    int width = pixels.right - pixels.left;
+    int height = pixels.bottom - pixels.top;
+
+    // A crop (or playlist item) of the same size keeps the frame texture
+    if (m_frameTextureInitialized &&
+        (m_frameTexDesc.Width != (UINT)width || m_frameTexDesc.Height != (UINT)height))
+    {
+        m_frameTexture.Reset();
+        m_frameTextureInitialized = false;
+        ReportGpuMemory();
+    }
+
+    m_videoWidth = width;
+    m_videoHeight = height;
+    m_frameTexDesc.Width = width;
+    m_frameTexDesc.Height = height;
+
+    m_targetRect.left = 0;
+    m_targetRect.top = 0;
+    m_targetRect.right = width;
+    m_targetRect.bottom = height;
+
+    m_sourceRect.left = (float)pixels.left / m_frameWidth;
+    m_sourceRect.top = (float)pixels.top / m_frameHeight;
+    m_sourceRect.right = (float)pixels.right / m_frameWidth;
+    m_sourceRect.bottom = (float)pixels.bottom / m_frameHeight;
+}
+
 int VideoPlayerHelper::GetVideoWidth()
 {
     return m_videoWidth;
@@ -546,32 +933,272 @@ float VideoPlayerHelper::GetCurrentPosition()
 
 bool VideoPlayerHelper::SeekTo(float pos)
 {
-    EnterCriticalSection(&m_criticalSection);
+    PostCommand(Command::SEEK, pos);
+    return true;
+}
+
+bool VideoPlayerHelper::SetVolume(float volume)
+{
+    PostCommand(Command::SET_VOLUME, volume);
+    return true;
+}
+
+void VideoPlayerHelper::SetLooping(bool looping)
+{
+    m_playlist.SetLooping(looping);
+    PostCommand(Command::UPDATE_LOOP);
+}
+
+// items[0] is the video the player was loaded with
+void VideoPlayerHelper::SetPlaylist(const std::vector<std::string>& items)
+{
+    m_playlist.SetItems(items);
+    PostCommand(Command::UPDATE_LOOP);
+}
+
+void VideoPlayerHelper::PostCommand(Command::Type type, float value)
+{
+    Command command;
+    command.type = type;
+    command.value = value;
+    m_commands.Push(command);
+    SetEvent(m_commandEvent);
+}
 
+// Body of the command thread, the only consumer of the command queue
+void VideoPlayerHelper::CommandLoop()
+{
+    for (;;)
+    {
+        WaitForSingleObjectEx(m_commandEvent, INFINITE, FALSE);
+
+        Command command;
+        while (m_commands.Pop(command))
+        {
+            if (command.type == Command::QUIT)
+            {
+                return;
+            }
+            RunCommand(command);
+        }
+    }
+}
+
+void VideoPlayerHelper::RunCommand(const Command& command)
+{
     bool success = false;
-    if (m_mediaEngine && m_mediaEngine->HasVideo())
+    if (m_mediaEngine)
+    {
+        switch (command.type)
+        {
+        case Command::PLAY:         success = RunPlay(); break;
+        case Command::PAUSE:        success = RunPause(); break;
+        case Command::STOP:         success = RunStop(); break;
+        case Command::SEEK:         success = RunSeek(command.value); break;
+        case Command::SET_VOLUME:   success = RunSetVolume(command.value); break;
+        case Command::UNLOAD:       success = RunUnload(); break;
+        case Command::UPDATE_LOOP:  success = RunUpdateLoop(); break;
+        case Command::PREROLL:      success = RunPreroll(); break;
+        case Command::ADVANCE:      success = RunSwitchToItem(m_playlist.Advance()); break;
+        default:                    break;
+        }
+    }
+
+    if (!success)
+    {
+        OutputDebugString(L"VideoPlayer: Queued command failed.\n");
+    }
+
+    PublishStatus();
+}
+
+// The media engine is free-threaded: the Run* methods below call it without
+// holding m_criticalSection, which only guards the state of this player
+bool VideoPlayerHelper::RunPlay()
+{
+    if (m_mediaState == PLAYING)
+    {
+        // already playing, skip
+        return true;
+    }
+
+    if (!m_mediaEngine->HasVideo())
+    {
+        return false;
+    }
+
+    if (m_mediaState == REACHED_END)
+    {
+        // A playlist played to its end restarts from its first item
+        if (m_playlist.GetCurrentIndex() != 0)
+        {
+            m_playlist.Rewind();
+            return RunSwitchToItem(0);
+        }
+
+        RunSeek(0);
+        m_mediaState = READY;
+    }
+
+    if (FAILED(m_mediaEngine->Play()))
     {
-        success = SUCCEEDED(m_mediaEngine->SetCurrentTime(pos));
+        return false;
     }
 
+    m_mediaState = PLAYING;
+    return true;
+}
+
+bool VideoPlayerHelper::RunPause()
+{
+    return m_mediaEngine->HasVideo() && SUCCEEDED(m_mediaEngine->Pause());
+}
+
+bool VideoPlayerHelper::RunStop()
+{
+    if (m_mediaState == PLAYING) {
+        RunPause();
+    }
+    m_mediaState = STOPPED;
+    return true;
+}
+
+bool VideoPlayerHelper::RunSeek(float pos)
+{
+    if (!m_mediaEngine->HasVideo())
+    {
+        return false;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+    std::shared_ptr<KeyframeIndex> keyframeIndex = m_keyframeIndex;
     LeaveCriticalSection(&m_criticalSection);
 
-    return success;
+    // The video stands still until the engine reaches the new position
+    m_playbackStats.OnPlaybackStarted();
+
+    if (keyframeIndex)
+    {
+        // Positions needing too much decoding after their keyframe are
+        // snapped to it, which the engine can seek to directly
+        SeekPlan plan = keyframeIndex->PlanSeek(pos);
+        if (plan.snapped)
+        {
+            return SUCCEEDED(m_mediaEngineEx->SetCurrentTimeEx(plan.targetTime, MF_MEDIA_ENGINE_SEEK_MODE_APPROXIMATE));
+        }
+        return SUCCEEDED(m_mediaEngine->SetCurrentTime(plan.targetTime));
+    }
+
+    return SUCCEEDED(m_mediaEngine->SetCurrentTime(pos));
 }
 
-bool VideoPlayerHelper::SetVolume(float volume)
+bool VideoPlayerHelper::RunSetVolume(float volume)
+{
+    return m_mediaEngine->HasVideo() && SUCCEEDED(m_mediaEngine->SetVolume(volume));
+}
+
+bool VideoPlayerHelper::RunUnload()
 {
+    if (m_mediaState == PLAYING) {
+        RunPause();
+    }
+
     EnterCriticalSection(&m_criticalSection);
+    m_nextStream.Reset();
+    m_nextIndex = -1;
+    LeaveCriticalSection(&m_criticalSection);
 
-    bool success = false;
-    if (m_mediaEngine && m_mediaEngine->HasVideo())
+    return SUCCEEDED(m_mediaEngine->Shutdown());
+}
+
+// A single looping item is looped by the engine itself, without any switch
+bool VideoPlayerHelper::RunUpdateLoop()
+{
+    return SUCCEEDED(m_mediaEngine->SetLoop(m_playlist.LoopsSingleItem() ? TRUE : FALSE));
+}
+
+// Opens the next playlist item ahead of the end of the current one
+bool VideoPlayerHelper::RunPreroll()
+{
+    int index = m_playlist.GetNextIndex();
+    if (index < 0)
+    {
+        return true;
+    }
+
+    ComPtr<IMFByteStream> byteStream;
+    std::wstring path;
+    if (!OpenSourceStream(ToWide(m_playlist.GetItem(index)), byteStream, path))
+    {
+        return false;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+    m_nextStream = byteStream;
+    m_nextPath = path;
+    m_nextIndex = index;
+    LeaveCriticalSection(&m_criticalSection);
+
+    return true;
+}
+
+// Sets the given playlist item as the source of the engine and plays it.
+// The video texture keeps the last frame until the first one of the item
+// is copied, and the state stays PLAYING in between.
+bool VideoPlayerHelper::RunSwitchToItem(int index)
+{
+    if (index < 0)
+    {
+        m_switchingItem = false;
+        return false;
+    }
+
+    ComPtr<IMFByteStream> byteStream;
+    std::wstring path;
+
+    EnterCriticalSection(&m_criticalSection);
+    if (m_nextIndex == index)
+    {
+        byteStream = m_nextStream;
+        path = m_nextPath;
+    }
+    m_nextStream.Reset();
+    m_nextIndex = -1;
+    LeaveCriticalSection(&m_criticalSection);
+
+    // Not pre-rolled in time (or restarting the playlist)
+    if (!byteStream && !OpenSourceStream(ToWide(m_playlist.GetItem(index)), byteStream, path))
+    {
+        m_switchingItem = false;
+        m_mediaState = MEDIA_ERROR;
+        return false;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+
+    // Poster frames and keyframe indices are only kept for the loaded video
+    m_posterKeyValid = false;
+    m_posterFrame.reset();
+    m_keyframeIndex.reset();
+
+    if (m_sourceUrl != nullptr)
     {
-        success = SUCCEEDED(m_mediaEngine->SetVolume(volume));
+        ::CoTaskMemFree(m_sourceUrl);
     }
+    m_sourceUrl = (LPWSTR)::CoTaskMemAlloc(sizeof(WCHAR) * (path.size() + 1));
+    StringCchCopyW(m_sourceUrl, path.size() + 1, path.c_str());
 
     LeaveCriticalSection(&m_criticalSection);
 
-    return success;
+    m_switchingItem = true;
+    SetSourceByteStream(byteStream.Get());
+
+    if (FAILED(m_mediaEngine->Play()))
+    {
+        m_switchingItem = false;
+        return false;
+    }
+    return true;
 }
 
 // This method we are called from the Unity rendering thread
@@ -583,16 +1210,27 @@ void VideoPlayerHelper::CopyVideoTexture()
     if ((m_mediaState == PLAYING) && 
         m_d3dDevice && m_videoTexture)
     {
-        LONGLONG frameTime;
-        if (m_doUpdateVideoData && 
-            SUCCEEDED(m_mediaEngine->OnVideoStreamTick(&frameTime)))
+        LONGLONG frameTime = 0;
+        HRESULT tickResult = m_doUpdateVideoData ? m_mediaEngine->OnVideoStreamTick(&frameTime) : E_PENDING;
+        if (SUCCEEDED(tickResult))
         {
+            // S_OK when the engine moved to a new frame, S_FALSE when it is
+            // still on the previous one
+            double renderTime = GetRenderTime();
+            m_judderMeter.OnRefresh(renderTime, tickResult == S_OK, frameTime / 10000000.0);
+            if (tickResult == S_OK)
+            {
+                CountEngineFrames();
+                m_playbackStats.AddPresented(m_mediaEngine->GetCurrentTime() - frameTime / 10000000.0, renderTime);
+            }
+
             // Init frame texture if not yet initialized
             if (!m_frameTextureInitialized) 
             {
                 HRESULT hres = m_d3dDevice->CreateTexture2D(&m_frameTexDesc, nullptr, m_frameTexture.GetAddressOf());
                 if (SUCCEEDED(hres)) {
                     m_frameTextureInitialized = true;
+                    ReportGpuMemory();
                 }
                 else {
                     OutputDebugString(L"VideoPlayer Error: Failed to create internal frame texture!\n");
@@ -602,26 +1240,45 @@ void VideoPlayerHelper::CopyVideoTexture()
             // Transfer the video frame to the frame texture
             if (m_frameTextureInitialized) 
             {
-                HRESULT hres = m_mediaEngine->TransferVideoFrame(
-                    m_frameTexture.Get(), nullptr, &m_targetRect, &m_bgColor);
+                HRESULT hres = m_mediaEngine->TransferVideoFrame(m_frameTexture.Get(),
+                    IsFullFrameCrop(m_crop) ? nullptr : &m_sourceRect, &m_targetRect, &m_bgColor);
 
                 if (FAILED(hres)) {
                     OutputDebugString(L"VideoPlayer Error: video texture update error!\n");
                 }
+                else if (m_posterKeyValid && !m_posterCaptured && !m_posterFrame && IsFullFrameCrop(m_crop) &&
+                    m_mediaEngine->GetCurrentTime() + POSTER_FRAME_POSITION_TOLERANCE >= m_posterKey.position)
+                {
+                    m_posterCaptured = true;
+                    CapturePosterFrame();
+                }
             }
 
-            // Copy the frame textiure to the target video texture
+            // Copy the frame textiure to the target video texture; a crop resized
+            // while playing is clipped to the video texture until it is recreated
             ID3D11DeviceContext *context;
             m_d3dDevice->GetImmediateContext(&context);
             if (context != nullptr)
             {
+                D3D11_TEXTURE2D_DESC videoTexDesc;
+                m_videoTexture->GetDesc(&videoTexDesc);
+
+                D3D11_BOX copyBox = { 0, 0, 0,
+                    m_frameTexDesc.Width < videoTexDesc.Width ? m_frameTexDesc.Width : videoTexDesc.Width,
+                    m_frameTexDesc.Height < videoTexDesc.Height ? m_frameTexDesc.Height : videoTexDesc.Height, 1 };
                 context->CopySubresourceRegion(
                     m_videoTexture, 0, 0, 0, 0,
-                    m_frameTexture.Get(), 0, nullptr
+                    m_frameTexture.Get(), 0, &copyBox
                 );
             }
+            m_playbackStats.AddCopyTime(GetRenderTime() - renderTime);
 
             m_doUpdateVideoData = false;
+            m_posterUploadPending = false;
+            InterlockedExchange(&m_newFrameCopied, 1);
+
+            ++m_frameCounter;
+            PublishStatus();
         }
     }
 
@@ -639,16 +1296,243 @@ MediaState VideoPlayerHelper::UpdateVideoData()
     return m_mediaState;
 }
 
+// Fills all the status fields in a single pass under the lock,
+// and requests a video texture update as UpdateVideoData() does.
+void VideoPlayerHelper::UpdateSnapshot(VideoPlayerSnapshot* snapshot)
+{
+    UpdateVideoData();
+
+    EnterCriticalSection(&m_criticalSection);
+
+    bool hasVideo = m_mediaEngine && m_mediaEngine->HasVideo();
+
+    snapshot->valid = 1;
+    snapshot->state = (int32_t)m_mediaState;
+    snapshot->position = hasVideo ? (float)m_mediaEngine->GetCurrentTime() : 0;
+    snapshot->duration = m_videoLengthSeconds;
+    snapshot->bufferingPercentage = m_bufferingPercentage;
+    snapshot->width = m_videoWidth;
+    snapshot->height = m_videoHeight;
+    snapshot->newFrame = (int32_t)InterlockedExchange(&m_newFrameCopied, 0);
+
+    LeaveCriticalSection(&m_criticalSection);
+}
+
+// Publishes the current status into the shared status block,
+// where it can be read by managed code without any plugin call
+void VideoPlayerHelper::PublishStatus()
+{
+    if (m_renderSlot < 0)
+    {
+        return;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+
+    bool hasVideo = m_mediaEngine && m_mediaEngine->HasVideo();
+
+    PlayerStatus status;
+    status.state = (int32_t)m_mediaState;
+    status.position = hasVideo ? (float)m_mediaEngine->GetCurrentTime() : 0;
+    status.duration = m_videoLengthSeconds;
+    status.bufferingPercentage = m_bufferingPercentage;
+    status.frameCounter = m_frameCounter;
+    status.width = m_videoWidth;
+    status.height = m_videoHeight;
+    status.playlistIndex = m_playlist.GetCurrentIndex();
+
+    LeaveCriticalSection(&m_criticalSection);
+
+    PlayerStatusBlock::Instance().Publish(m_renderSlot, status);
+}
+
+void VideoPlayerHelper::GetJudderStats(JudderStats* stats)
+{
+    *stats = m_judderMeter.GetStats();
+}
+
+void VideoPlayerHelper::GetPlaybackStats(PlaybackStats* stats)
+{
+    *stats = m_playbackStats.GetSnapshot();
+}
+
+// The engine renders frames on its own; only the newest is transferred to the
+// video texture, the ones rendered since the previous transfer were never
+// displayed
+// [Always called from the rendering thread, with m_criticalSection held]
+void VideoPlayerHelper::CountEngineFrames()
+{
+    uint32_t rendered = 0;
+    uint32_t dropped = 0;
+    if (!GetEngineFrameCount(m_mediaEngineEx.Get(), MF_MEDIA_ENGINE_STATISTIC_FRAMES_RENDERED, rendered) ||
+        !GetEngineFrameCount(m_mediaEngineEx.Get(), MF_MEDIA_ENGINE_STATISTIC_FRAMES_DROPPED, dropped))
+    {
+        // Without the engine's statistics, the frame presented is all that is known
+        m_playbackStats.AddDecoded(1);
+        return;
+    }
+
+    uint32_t renderedDelta = GetEngineFrameDelta(rendered, m_engineFramesRendered);
+    uint32_t droppedDelta = GetEngineFrameDelta(dropped, m_engineFramesDropped);
+    if (renderedDelta == 0)
+    {
+        renderedDelta = 1;
+    }
+    m_playbackStats.AddDecoded(renderedDelta + droppedDelta);
+    m_playbackStats.AddDropped(renderedDelta - 1 + droppedDelta);
+}
+
+bool VideoPlayerHelper::HasPosterFrame()
+{
+    EnterCriticalSection(&m_criticalSection);
+    bool hasPosterFrame = (m_posterFrame != nullptr);
+    LeaveCriticalSection(&m_criticalSection);
+
+    return hasPosterFrame;
+}
+
+// Copies the cached poster frame to the video texture, so that the video shows
+// its first picture before the decoder has produced anything.
+// This method is called from the Unity rendering thread.
+void VideoPlayerHelper::UploadPosterFrame()
+{
+    if (!m_posterUploadPending)
+    {
+        return;
+    }
+
+    EnterCriticalSection(&m_criticalSection);
+
+    if (m_posterUploadPending && m_posterFrame && m_d3dDevice && m_videoTexture)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc;
+        m_videoTexture->GetDesc(&textureDesc);
+        if (textureDesc.Width == (UINT)m_posterFrame->width &&
+            textureDesc.Height == (UINT)m_posterFrame->height)
+        {
+            ComPtr<ID3D11DeviceContext> context;
+            m_d3dDevice->GetImmediateContext(&context);
+            context->UpdateSubresource(m_videoTexture, 0, nullptr,
+                &m_posterFrame->pixels[0], m_posterFrame->width * 4, 0);
+        }
+        m_posterUploadPending = false;
+    }
+
+    LeaveCriticalSection(&m_criticalSection);
+}
+
+// Called once the file properties are known, on a worker thread
+void VideoPlayerHelper::FindPosterFrame(const PosterFrameKey& key)
+{
+    std::shared_ptr<const PosterFrame> posterFrame = GetPosterFrameCache().Find(key);
+
+    EnterCriticalSection(&m_criticalSection);
+
+    // Poster frames are whole frames, they are not used for a crop
+    m_posterKey = key;
+    m_posterKeyValid = true;
+    if (posterFrame && IsFullFrameCrop(m_crop))
+    {
+        m_posterFrame = posterFrame;
+        m_posterUploadPending = true;
+
+        // The video texture can be created with the poster frame size
+        // before the metadata are loaded
+        if (m_videoWidth == 0 || m_videoHeight == 0)
+        {
+            m_videoWidth = posterFrame->width;
+            m_videoHeight = posterFrame->height;
+        }
+    }
+
+    LeaveCriticalSection(&m_criticalSection);
+
+    PublishStatus();
+}
+
+// Reads the frame texture back and stores it in the poster frame cache.
+// This is done once per video version, so the stall of the read back is acceptable;
+// the compression and the file write are done on a worker thread.
+// [Always called with m_criticalSection locked, from the Unity rendering thread]
+void VideoPlayerHelper::CapturePosterFrame()
+{
+    ComPtr<ID3D11DeviceContext> context;
+    m_d3dDevice->GetImmediateContext(&context);
+    if (!context)
+    {
+        return;
+    }
+
+    D3D11_TEXTURE2D_DESC stagingDesc = m_frameTexDesc;
+    stagingDesc.MipLevels = 1;
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+    stagingDesc.BindFlags = 0;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    stagingDesc.MiscFlags = 0;
+
+    ComPtr<ID3D11Texture2D> stagingTexture;
+    if (FAILED(m_d3dDevice->CreateTexture2D(&stagingDesc, nullptr, stagingTexture.GetAddressOf())))
+    {
+        OutputDebugString(L"VideoPlayer Error: Failed to create poster frame staging texture!\n");
+        return;
+    }
+
+    // The staging texture only lives for this call
+    GpuMemoryBudget::Instance().SetAllocation(m_renderSlot, GPU_MEMORY_STAGING_BUFFER,
+        GpuMemoryBudget::GetTextureSize(stagingDesc.Width, stagingDesc.Height, 4));
+
+    context->CopySubresourceRegion(stagingTexture.Get(), 0, 0, 0, 0, m_frameTexture.Get(), 0, nullptr);
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(context->Map(stagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mapped)))
+    {
+        OutputDebugString(L"VideoPlayer Error: Failed to read poster frame back!\n");
+        GpuMemoryBudget::Instance().SetAllocation(m_renderSlot, GPU_MEMORY_STAGING_BUFFER, 0);
+        return;
+    }
+
+    std::shared_ptr<PosterFrame> posterFrame = std::make_shared<PosterFrame>();
+    posterFrame->width = (int)stagingDesc.Width;
+    posterFrame->height = (int)stagingDesc.Height;
+
+    size_t rowSize = (size_t)posterFrame->width * 4;
+    posterFrame->pixels.resize(rowSize * posterFrame->height);
+    for (int y = 0; y < posterFrame->height; ++y)
+    {
+        memcpy(&posterFrame->pixels[y * rowSize], (const uint8_t*)mapped.pData + y * mapped.RowPitch, rowSize);
+    }
+
+    context->Unmap(stagingTexture.Get(), 0);
+    GpuMemoryBudget::Instance().SetAllocation(m_renderSlot, GPU_MEMORY_STAGING_BUFFER, 0);
+
+    PosterFrameKey key = m_posterKey;
+    create_task([key, posterFrame]()
+    {
+        GetPosterFrameCache().Store(key, posterFrame);
+    });
+}
+
 int VideoPlayerHelper::GetCurrentBufferingPercentage()
 {
     EnterCriticalSection(&m_criticalSection);
+    int percentage = m_bufferingPercentage;
+    LeaveCriticalSection(&m_criticalSection);
 
+    return percentage;
+}
+
+// Queries the seekable range of the engine, which allocates it; only done
+// when the engine reports a buffering change, the result is cached
+// [Always called with m_criticalSection locked]
+int VideoPlayerHelper::GetBufferingPercentageLocked()
+{
     double ratio = 0;
     if (m_mediaEngine && m_mediaEngine->HasVideo())
     {
-        IMFMediaTimeRange *seekableRange;
-        m_mediaEngine->GetSeekable(&seekableRange);
-        if (seekableRange->GetLength() > 0) {
+        ComPtr<IMFMediaTimeRange> seekableRange;
+        if (SUCCEEDED(m_mediaEngine->GetSeekable(&seekableRange)) &&
+            seekableRange->GetLength() > 0) 
+        {
             double end = 0;
             seekableRange->GetEnd(seekableRange->GetLength() - 1, &end);
             ratio = end / m_mediaEngine->GetDuration();
@@ -657,7 +1541,5 @@ int VideoPlayerHelper::GetCurrentBufferingPercentage()
         }
     }
 
-    LeaveCriticalSection(&m_criticalSection);
-
     return (int)(100 * ratio);
-}
+}
\ No newline at end of file
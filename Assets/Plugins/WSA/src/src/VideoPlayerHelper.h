@@ -18,6 +18,7 @@ countries.
 #include <DirectXColors.h>
 #include <DirectXMath.h>
 #include <memory>
+#include <mutex>
 #include <agile.h>
 #include <concrt.h>
 #include <collection.h>
@@ -25,6 +26,19 @@ countries.
 #include <Mfapi.h>
 #include <ppltasks.h>
 #include <Strsafe.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameSelector.h"
+#include "GpuMemoryBudget.h"
+#include "MpscQueue.h"
+#include "PlayerStatusBlock.h"
+#include "PlaybackStats.h"
+#include "Playlist.h"
+#include "PosterFrameCache.h"
+#include "KeyframeIndex.h"
+#include "VideoCrop.h"
 
 namespace VuforiaMedia
 {
@@ -38,6 +52,20 @@ namespace VuforiaMedia
         MEDIA_ERROR = 6
     };
 
+    // Plain status record of one player, filled by VideoPlayerSnapshotAllWSA().
+    // The layout must match VideoPlayerHelper.PlayerSnapshot on the C# side.
+    struct VideoPlayerSnapshot
+    {
+        int32_t valid;                  // 1 if a player is bound to this slot
+        int32_t state;                  // MediaState
+        float   position;               // current position in seconds
+        float   duration;               // video length in seconds
+        int32_t bufferingPercentage;
+        int32_t width;
+        int32_t height;
+        int32_t newFrame;               // 1 if a frame was copied since the last snapshot
+    };
+
     class MediaEngineCallback
     {
     public:
@@ -47,13 +75,12 @@ namespace VuforiaMedia
     class VideoPlayerHelper : public MediaEngineCallback
     {
     public:
-        static bool s_MediaFoundationStarted;
-
         VideoPlayerHelper(ID3D11Device* d3dDevice);
         virtual ~VideoPlayerHelper();
         
         bool SetVideoTexturePtr(ID3D11Texture2D* texturePtr);
         bool Load(const char* filename, int requestType, bool playOnTextureImmediately, float seekPosition);
+        void StartWhenReady(bool play, float seekPosition);
         bool Unload();
         bool Pause();
         bool Play(bool fullScreen, float seekPosition);
@@ -69,15 +96,54 @@ namespace VuforiaMedia
         float GetCurrentPosition();
         bool SeekTo(float pos);
         bool SetVolume(float volume);
+        void SetLooping(bool looping);
+        void SetPlaylist(const std::vector<std::string>& items);
+        bool SetCrop(float x, float y, float width, float height);
         MediaState UpdateVideoData();
+        void UpdateSnapshot(VideoPlayerSnapshot* snapshot);
         void CopyVideoTexture();
+        bool HasPosterFrame();
+        void GetJudderStats(JudderStats* stats);
+        void GetPlaybackStats(PlaybackStats* stats);
+        void UploadPosterFrame();
+        void SetRenderSlot(int slot);
+        int GetRenderSlot() const { return m_renderSlot; }
         
         // Media Engine notify callback interface
         virtual void OnMediaEngineEvent(ULONG32 mediaEngineEvent) override;
 
     private:
+        // Control call queued by the script thread, run on the command thread
+        struct Command
+        {
+            enum Type { PLAY, PAUSE, STOP, SEEK, SET_VOLUME, UNLOAD, UPDATE_LOOP, PREROLL, ADVANCE, QUIT };
+
+            Type type;
+            float value;
+        };
+
         void Initialize();
+        void PostCommand(Command::Type type, float value = 0);
+        void CommandLoop();
+        void RunCommand(const Command& command);
+        bool RunPlay();
+        bool RunPause();
+        bool RunStop();
+        bool RunSeek(float pos);
+        bool RunSetVolume(float volume);
+        bool RunUnload();
+        bool RunUpdateLoop();
+        bool RunPreroll();
+        bool RunSwitchToItem(int index);
         void SetSourceStream(Windows::Storage::Streams::IRandomAccessStream^ stream);
+        void SetSourceByteStream(IMFByteStream* byteStream);
+        int GetBufferingPercentageLocked();
+        void PublishStatus();
+        void ReportGpuMemory();
+        void CountEngineFrames();
+        void FindPosterFrame(const PosterFrameKey& key);
+        void CapturePosterFrame();
+        void UpdateCropLocked();
 
         inline void ThrowIfFailed(HRESULT hres)
         {
@@ -86,11 +152,19 @@ namespace VuforiaMedia
         }
 
         MediaState m_mediaState;
+        int m_renderSlot;
+        bool m_usesMediaFoundation;
         CRITICAL_SECTION m_criticalSection;
         BSTR   m_sourceUrl;
         MFARGB m_bgColor;
         RECT   m_targetRect;
+        MFVideoNormalizedRect m_sourceRect;
 
+        // Only the crop of the decoded frames is transferred; the video (and
+        // frame) texture has its size
+        VideoCrop m_crop;
+        int m_frameWidth;
+        int m_frameHeight;
         int m_videoWidth;
         int m_videoHeight;
         float m_videoLengthSeconds;
@@ -100,6 +174,49 @@ namespace VuforiaMedia
         D3D11_TEXTURE2D_DESC m_frameTexDesc;
         bool m_frameTextureInitialized;
         volatile bool m_doUpdateVideoData;
+        volatile LONG m_newFrameCopied;
+        uint32_t m_frameCounter;
+
+        // Updated on the engine's buffering events rather than on every
+        // published status, as querying it allocates
+        int m_bufferingPercentage;
+
+        // The media engine only hands over its current frame, so the frames
+        // cannot be chosen by display time here; their cadence is measured
+        JudderMeter m_judderMeter;
+
+        // Decoded and dropped frames come from the engine's statistics, taken
+        // as differences from the previous new frame
+        PlaybackStatsCounters m_playbackStats;
+        uint32_t m_engineFramesRendered;
+        uint32_t m_engineFramesDropped;
+
+        PosterFrameKey m_posterKey;
+        bool m_posterKeyValid;
+        bool m_posterCaptured;
+        volatile bool m_posterUploadPending;
+        std::shared_ptr<const PosterFrame> m_posterFrame;
+
+        std::shared_ptr<KeyframeIndex> m_keyframeIndex;
+
+        // The next playlist item is opened ahead of the end of the current one,
+        // then set as the source of the same engine when the current one ends
+        Playlist m_playlist;
+        Microsoft::WRL::ComPtr<IMFByteStream> m_nextStream;
+        std::wstring m_nextPath;
+        int m_nextIndex;
+        volatile bool m_switchingItem;
+
+        // Seek and play requested before the media was ready to play, applied
+        // when it is (a player adopted from the warm pool may still be preparing)
+        bool m_pendingStart;
+        bool m_pendingPlay;
+        float m_pendingSeekPosition;
+
+        // Media Foundation is started by the first player and shut down by the
+        // last one, on the script thread or while evicting warm players
+        static std::mutex s_MediaFoundationMutex;
+        static int s_MediaFoundationUsers;
        
         Microsoft::WRL::ComPtr<ID3D11Texture2D>       m_frameTexture;
         Microsoft::WRL::ComPtr<IMFMediaEngine>        m_mediaEngine;
@@ -107,6 +224,10 @@ namespace VuforiaMedia
         Microsoft::WRL::ComPtr<IMFDXGIDeviceManager>  m_DXGIManager;
         
         Windows::System::Threading::ThreadPoolTimer^  m_updateTimer;
+
+        MpscQueue<Command> m_commands;
+        HANDLE m_commandEvent;
+        std::thread m_commandThread;
     };
 }
 
@@ -10,8 +10,9 @@ countries.
 #include <d3d11.h>
 #include "IUnityGraphicsD3D11.h"
 
+#include <atomic>
 #include <string>
-#include <unordered_set>
+#include <thread>
 
 using namespace VuforiaMedia;
 
@@ -20,12 +21,129 @@ static IUnityGraphics* s_Graphics = NULL;
 static UnityGfxRenderer s_DeviceType = kUnityGfxRendererNull;
 static ID3D11Device* s_D3D11Device = NULL;
 
-static std::unordered_set<VideoPlayerHelper*> s_VideoPlayers;
+// Render event dispatch table: each player owns one slot for its whole lifetime.
+// Slots are claimed and released on the script thread and read lock-free on
+// the rendering thread.
+static std::atomic<VideoPlayerHelper*> s_VideoPlayerSlots[MAX_VIDEO_PLAYERS];
+
+// Readers currently using the player of each slot. A player taken out of its
+// slot is only freed once no reader is left that may have loaded it before.
+static std::atomic<int> s_VideoPlayerSlotReaders[MAX_VIDEO_PLAYERS];
+
+// Holds the player of a slot for the scope of a reader; the counter is raised
+// before the pointer is loaded, so that a concurrent removal either hides the
+// player or waits for this reader (both sides are sequentially consistent)
+class VideoPlayerSlotReference
+{
+public:
+    explicit VideoPlayerSlotReference(int slot) : m_slot(slot)
+    {
+        s_VideoPlayerSlotReaders[m_slot].fetch_add(1);
+        m_videoPlayer = s_VideoPlayerSlots[m_slot].load();
+    }
+
+    ~VideoPlayerSlotReference()
+    {
+        s_VideoPlayerSlotReaders[m_slot].fetch_sub(1, std::memory_order_release);
+    }
+
+    VideoPlayerHelper* Get() const { return m_videoPlayer; }
+
+private:
+    VideoPlayerSlotReference(const VideoPlayerSlotReference&);
+    VideoPlayerSlotReference& operator=(const VideoPlayerSlotReference&);
+
+    int m_slot;
+    VideoPlayerHelper* m_videoPlayer;
+};
+
+// Puts videoPlayer (or nullptr) in a slot, and returns once the readers that
+// may still use the previous player are done with it
+static void ReplaceVideoPlayerInSlot(int slot, VideoPlayerHelper* videoPlayer)
+{
+    s_VideoPlayerSlots[slot].store(videoPlayer);
+    while (s_VideoPlayerSlotReaders[slot].load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+static int AcquireVideoPlayerSlot(VideoPlayerHelper* videoPlayer)
+{
+    int slot = PlayerStatusBlock::Instance().AcquireSlot();
+    if (slot >= 0)
+    {
+        s_VideoPlayerSlots[slot].store(videoPlayer);
+    }
+    return slot;
+}
+
+static void ReleaseVideoPlayerSlot(VideoPlayerHelper* videoPlayer)
+{
+    int slot = videoPlayer->GetRenderSlot();
+    if (slot >= 0 && slot < MAX_VIDEO_PLAYERS)
+    {
+        ReplaceVideoPlayerInSlot(slot, nullptr);
+        PlayerStatusBlock::Instance().ReleaseSlot(slot);
+    }
+    videoPlayer->SetRenderSlot(-1);
+}
+
+// Every player is destroyed here, whether it is bound to a slot or held by the
+// warm pool, so that none is freed while the rendering thread may use it
+static void DestroyVideoPlayer(VideoPlayerHelper* videoPlayer)
+{
+    ReleaseVideoPlayerSlot(videoPlayer);
+    delete videoPlayer;
+}
+
+// Players prepared ahead of time for the videos likely to be loaded next.
+// Allocated once and never destroyed, so that no media engine is shut down
+// while the DLL is being unloaded.
+static WarmPool<VideoPlayerHelper>& GetWarmPool()
+{
+    static WarmPool<VideoPlayerHelper>* s_WarmPool = new WarmPool<VideoPlayerHelper>(
+        DEFAULT_WARM_POOL_SIZE, [](VideoPlayerHelper* videoPlayer) { DestroyVideoPlayer(videoPlayer); });
+    return *s_WarmPool;
+}
+
+// Player and group events are only issued for videos being rendered,
+// so they also request the video data update themselves
+static inline void CopyVideoTextureInSlot(int slot, bool requestUpdate)
+{
+    VideoPlayerSlotReference reference(slot);
+    VideoPlayerHelper* videoPlayer = reference.Get();
+    if (videoPlayer == nullptr)
+    {
+        return;
+    }
+
+    // Shows the cached poster frame until the first video frame is copied
+    videoPlayer->UploadPosterFrame();
+
+    if (videoPlayer->GetStatus() == PLAYING)
+    {
+        if (requestUpdate)
+        {
+            videoPlayer->UpdateVideoData();
+        }
+        videoPlayer->CopyVideoTexture();
+    }
+}
 
 extern "C" int64_t UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerInitWSA()
 {
     VideoPlayerHelper* videoPlayerHelper = new VideoPlayerHelper(s_D3D11Device);
-    s_VideoPlayers.insert(videoPlayerHelper);
+
+    int slot = AcquireVideoPlayerSlot(videoPlayerHelper);
+    if (slot < 0)
+    {
+        OutputDebugString(L"VuforiaMedia: too many video players!\n");
+        DestroyVideoPlayer(videoPlayerHelper);
+        return 0;
+    }
+    videoPlayerHelper->SetRenderSlot(slot);
+
     return (int64_t)videoPlayerHelper;
 }
 
@@ -35,9 +153,7 @@ extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerDeinitWSA(
     {
         return false;
     }
-    VideoPlayerHelper* vidPlayer = (VideoPlayerHelper*)dataSetPtr;
-    s_VideoPlayers.erase(vidPlayer);
-    delete vidPlayer;
+    DestroyVideoPlayer((VideoPlayerHelper*)dataSetPtr);
     return true;
 }
 
@@ -53,6 +169,86 @@ extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerLoadWSA(
     return vidPlayerHelper->Load(filename, requestType, playOnTextureImmediately, seekPosition);
 }
 
+// Starts preparing a video in the warm pool: the file is opened, its metadata
+// parsed and the first frame decoded, without binding the player to any slot.
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerPrewarmWSA(const char* filename)
+{
+    if (filename == nullptr)
+    {
+        return false;
+    }
+
+    WarmPool<VideoPlayerHelper>& warmPool = GetWarmPool();
+    if (warmPool.Touch(filename))
+    {
+        // Already warm
+        return true;
+    }
+    if (warmPool.GetMaxEntries() == 0)
+    {
+        return false;
+    }
+
+    VideoPlayerHelper* videoPlayerHelper = new VideoPlayerHelper(s_D3D11Device);
+    if (videoPlayerHelper->GetStatus() == MEDIA_ERROR ||
+        !videoPlayerHelper->Load(filename, 0, false, 0))
+    {
+        DestroyVideoPlayer(videoPlayerHelper);
+        return false;
+    }
+
+    return warmPool.Put(filename, videoPlayerHelper);
+}
+
+// Replaces a freshly initialized player by the one prepared for filename in the
+// warm pool, if any. The prepared player takes over the render slot of the
+// replaced one, which is destroyed, then seeks and plays as requested from the
+// load once it is ready. Returns the player to use from now on, or 0 if the
+// video is not warm (the caller then loads it as usual).
+extern "C" int64_t UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerLoadFromWarmPoolWSA(
+    void* dataSetPtr, const char* filename, bool playOnTextureImmediately, float seekPosition)
+{
+    if (dataSetPtr == nullptr || filename == nullptr)
+    {
+        return 0;
+    }
+
+    VideoPlayerHelper* warmPlayer = GetWarmPool().Take(filename);
+    if (warmPlayer == nullptr)
+    {
+        return 0;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    int slot = vidPlayerHelper->GetRenderSlot();
+    if (slot < 0)
+    {
+        // Not a valid player, keep the prepared one for later
+        GetWarmPool().Put(filename, warmPlayer);
+        return 0;
+    }
+
+    // The replaced player is freed once the rendering thread is done with it
+    vidPlayerHelper->SetRenderSlot(-1);
+    ReplaceVideoPlayerInSlot(slot, warmPlayer);
+    warmPlayer->SetRenderSlot(slot);
+    DestroyVideoPlayer(vidPlayerHelper);
+
+    warmPlayer->StartWhenReady(playOnTextureImmediately, seekPosition);
+
+    return (int64_t)warmPlayer;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerSetWarmPoolSizeWSA(int maxEntries)
+{
+    GetWarmPool().SetMaxEntries(maxEntries);
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerClearWarmPoolWSA()
+{
+    GetWarmPool().Clear();
+}
+
 extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerUnloadWSA(void* dataSetPtr)
 {
     if (dataSetPtr == nullptr)
@@ -220,6 +416,49 @@ extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerSetVolumeW
     return vidPlayerHelper->SetVolume(value);
 }
 
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerSetLoopingWSA(void* dataSetPtr, bool looping)
+{
+    if (dataSetPtr == nullptr)
+    {
+        return false;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    vidPlayerHelper->SetLooping(looping);
+    return true;
+}
+
+// items[0] is the video the player was loaded with, the others are played after it
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerSetPlaylistWSA(void* dataSetPtr, const char** items, int count)
+{
+    if (dataSetPtr == nullptr || (items == nullptr && count > 0))
+    {
+        return false;
+    }
+
+    std::vector<std::string> playlist;
+    for (int i = 0; i < count; ++i)
+    {
+        playlist.push_back(items[i] != nullptr ? items[i] : "");
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    vidPlayerHelper->SetPlaylist(playlist);
+    return true;
+}
+
+// Copies only this region of the video, normalised from its top left corner
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerSetCropWSA(void* dataSetPtr, float x, float y, float width, float height)
+{
+    if (dataSetPtr == nullptr)
+    {
+        return false;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    return vidPlayerHelper->SetCrop(x, y, width, height);
+}
+
 extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetCurrentBufferingPercentageWSA(void* dataSetPtr)
 {
     if (dataSetPtr == nullptr)
@@ -242,6 +481,131 @@ extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerOnPauseWSA
     vidPlayerHelper->OnPause();
 }
 
+// Returns true once a cached poster frame was found for the loaded video;
+// it is uploaded to the video texture by the next render event of the player
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerHasPosterFrameWSA(void* dataSetPtr)
+{
+    if (dataSetPtr == nullptr)
+    {
+        return false;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    return vidPlayerHelper->HasPosterFrame();
+}
+
+// stats points to a VuforiaMedia::JudderStats structure
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetJudderStatsWSA(void* dataSetPtr, void* stats)
+{
+    if (dataSetPtr == nullptr || stats == nullptr)
+    {
+        return false;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    vidPlayerHelper->GetJudderStats((JudderStats*)stats);
+    return true;
+}
+
+// stats points to a VuforiaMedia::PlaybackStats structure
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetPlaybackStatsWSA(void* dataSetPtr, void* stats)
+{
+    if (dataSetPtr == nullptr || stats == nullptr)
+    {
+        return false;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    vidPlayerHelper->GetPlaybackStats((PlaybackStats*)stats);
+    return true;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetSlotWSA(void* dataSetPtr)
+{
+    if (dataSetPtr == nullptr)
+    {
+        return -1;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    return vidPlayerHelper->GetRenderSlot();
+}
+
+// Fills one snapshot per player slot in a single call, replacing the
+// per-field status, position, buffering and update calls.
+// Returns the number of records written.
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerSnapshotAllWSA(
+    VideoPlayerSnapshot* snapshots, int count)
+{
+    if (snapshots == nullptr || count <= 0)
+    {
+        return 0;
+    }
+
+    if (count > MAX_VIDEO_PLAYERS)
+    {
+        count = MAX_VIDEO_PLAYERS;
+    }
+
+    for (int slot = 0; slot < count; ++slot)
+    {
+        VideoPlayerSlotReference reference(slot);
+        VideoPlayerHelper* videoPlayer = reference.Get();
+        if (videoPlayer != nullptr)
+        {
+            videoPlayer->UpdateSnapshot(&snapshots[slot]);
+        }
+        else
+        {
+            memset(&snapshots[slot], 0, sizeof(VideoPlayerSnapshot));
+        }
+    }
+
+    return count;
+}
+
+// Returns the shared status block, which managed code maps once and then
+// reads every frame without calling into the plugin (see PlayerStatusBlock.h)
+extern "C" const void* UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetStatusBlockWSA(
+    int* slotStride, int* slotCount)
+{
+    PlayerStatusBlock& statusBlock = PlayerStatusBlock::Instance();
+    if (slotStride != nullptr)
+    {
+        *slotStride = statusBlock.GetSlotStride();
+    }
+    if (slotCount != nullptr)
+    {
+        *slotCount = statusBlock.GetSlotCount();
+    }
+    return statusBlock.GetData();
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetRenderEventIDWSA(void* dataSetPtr)
+{
+    if (dataSetPtr == nullptr)
+    {
+        return RENDER_EVENT_ALL_PLAYERS;
+    }
+
+    VideoPlayerHelper* vidPlayerHelper = (VideoPlayerHelper*)dataSetPtr;
+    int slot = vidPlayerHelper->GetRenderSlot();
+    if (slot < 0)
+    {
+        return RENDER_EVENT_ALL_PLAYERS;
+    }
+    return RENDER_EVENT_PLAYER_BASE + slot;
+}
+
+extern "C" int UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API VideoPlayerGetRenderGroupEventIDWSA(int group)
+{
+    if (group < 0 || group >= RENDER_EVENT_GROUP_COUNT)
+    {
+        return RENDER_EVENT_ALL_PLAYERS;
+    }
+    return RENDER_EVENT_GROUP_BASE + group;
+}
+
 // -------------------------------------------------------------------------
 
 static void DoEventGraphicsDeviceD3D11(UnityGfxDeviceEventType eventType)
@@ -296,6 +660,8 @@ static void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType ev
 
 // This is called on the rendering thread
 // in response to a Unity GL.IssuePluginEvent() call.
+// The eventID selects which players are updated (see VideoPlayerWrapper.h),
+// so that the cost of the texture copies can be spread across the frame.
 static void UNITY_INTERFACE_API OnRenderEvent(int eventID)
 {
 	// Unknown graphics device type? Do nothing.
@@ -304,10 +670,25 @@ static void UNITY_INTERFACE_API OnRenderEvent(int eventID)
 
 	if (s_DeviceType == kUnityGfxRendererD3D11)
 	{
-        for (auto videoPlayer : s_VideoPlayers)
+        if (eventID >= RENDER_EVENT_PLAYER_BASE &&
+            eventID < RENDER_EVENT_PLAYER_BASE + MAX_VIDEO_PLAYERS)
+        {
+            CopyVideoTextureInSlot(eventID - RENDER_EVENT_PLAYER_BASE, true);
+        }
+        else if (eventID >= RENDER_EVENT_GROUP_BASE &&
+                 eventID < RENDER_EVENT_GROUP_BASE + RENDER_EVENT_GROUP_COUNT)
+        {
+            int firstSlot = (eventID - RENDER_EVENT_GROUP_BASE) * RENDER_EVENT_GROUP_SIZE;
+            for (int slot = firstSlot; slot < firstSlot + RENDER_EVENT_GROUP_SIZE; ++slot)
+            {
+                CopyVideoTextureInSlot(slot, true);
+            }
+        }
+        else if (eventID == RENDER_EVENT_ALL_PLAYERS)
         {
-            if (videoPlayer->GetStatus() == PLAYING) {
-                videoPlayer->CopyVideoTexture();
+            for (int slot = 0; slot < MAX_VIDEO_PLAYERS; ++slot)
+            {
+                CopyVideoTextureInSlot(slot, false);
             }
         }
 	}
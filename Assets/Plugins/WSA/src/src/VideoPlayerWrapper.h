@@ -9,6 +9,30 @@ countries.
 
 #include "IUnityInterface.h"
 #include "VideoPlayerHelper.h"
+#include "WarmPool.h"
+
+namespace VuforiaMedia
+{
+    // Maximum number of video players that can be alive at the same time.
+    // Each player is bound to a fixed slot, used both as its index in the
+    // render event dispatch table and in the shared status block.
+    static const int MAX_VIDEO_PLAYERS = PlayerStatusBlock::SLOT_COUNT;
+
+    // Render event IDs passed to GL.IssuePluginEvent():
+    //  - RENDER_EVENT_ALL_PLAYERS updates every playing video (legacy behaviour)
+    //  - RENDER_EVENT_PLAYER_BASE + slot updates only the player bound to slot
+    //  - RENDER_EVENT_GROUP_BASE + group updates the RENDER_EVENT_GROUP_SIZE
+    //    consecutive slots starting at group * RENDER_EVENT_GROUP_SIZE
+    static const int RENDER_EVENT_ALL_PLAYERS = 0;
+    static const int RENDER_EVENT_PLAYER_BASE = 0x100;
+    static const int RENDER_EVENT_GROUP_BASE = 0x200;
+    static const int RENDER_EVENT_GROUP_SIZE = 8;
+    static const int RENDER_EVENT_GROUP_COUNT = MAX_VIDEO_PLAYERS / RENDER_EVENT_GROUP_SIZE;
+
+    // Default number of prepared players kept in the warm pool
+    // (see VideoPlayerPrewarmWSA); each one holds a media engine and its decoder.
+    static const int DEFAULT_WARM_POOL_SIZE = 2;
+}
 
 #endif //_VUFORIA_MEDIA_WSA_VIDEO_PLAYER_WRAPPER_H_
 
@@ -0,0 +1,24 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+#ifndef _VUFORIA_MEDIA_FRAME_TEXTURE_CACHE_H_
+#define _VUFORIA_MEDIA_FRAME_TEXTURE_CACHE_H_
+
+#import <OpenGLES/EAGL.h>
+#import <Metal/Metal.h>
+
+#include "FrameTextureSource.h"
+
+namespace VuforiaMedia
+{
+    // Frame texture sources wrapping IOSurface backed BGRA CVPixelBuffers as
+    // textures through the CoreVideo texture caches. They return nullptr if the
+    // cache cannot be created for the context or device.
+    FrameTextureSource* CreateFrameTextureCacheGL(EAGLContext* context);
+    FrameTextureSource* CreateFrameTextureCacheMetal(id<MTLDevice> device);
+}
+
+#endif // _VUFORIA_MEDIA_FRAME_TEXTURE_CACHE_H_
@@ -14,6 +14,16 @@ countries.
 #import <OpenGLES/ES2/glext.h>
 #import <Metal/Metal.h>
 
+#include "AVSyncEngine.h"
+#include "FramePacer.h"
+#include "FrameQueue.h"
+#include "FrameSelector.h"
+#include "FrameTextureSource.h"
+#include "FrameUploader.h"
+#include "GpuMemoryBudget.h"
+#include "KeyframeIndex.h"
+#include "PlaybackStats.h"
+
 
 // Media types
 typedef enum tagMEDIA_TYPE { 
@@ -41,6 +51,24 @@ typedef enum tagMEDIA_STATE {
 static const float VIDEO_PLAYBACK_CURRENT_POSITION = -1.0f;
 
 
+// Decoded frames waiting for the renderer; when it falls behind, the oldest
+// frames are dropped rather than queued
+typedef VuforiaMedia::FrameQueue<CMSampleBufferRef, 3> VideoFrameQueue;
+
+// Decoded frames taken by the renderer, until their display time
+typedef VuforiaMedia::FrameSelector<CMSampleBufferRef, 4> VideoFrameSelector;
+
+
+// Master clock time at a host time, published by the frame pump so that the
+// renderer can tell the media time at which its frame is displayed
+struct VideoClockSample {
+    double mediaTime;
+    double hostTime;
+    uint32_t generation;    // changed whenever the queued frames are discarded (seek, stop)
+    uint32_t running;       // 0 while the clock is stopped
+};
+
+
 @interface VideoPlayerHelper : NSObject {
 @private
     BOOL useMetal;
@@ -57,8 +85,8 @@ static const float VIDEO_PLAYBACK_CURRENT_POSITION = -1.0f;
     // Timing
     CFTimeInterval mediaStartTime;
     CFTimeInterval playerCursorPosition;
-    NSTimer* frameTimer;
-    BOOL stopFrameTimer;
+    VuforiaMedia::FramePacer* framePacer;
+    VuforiaMedia::FramePumpThread* framePump;
     
     // Asset
     NSURL* mediaURL;
@@ -79,10 +107,19 @@ static const float VIDEO_PLAYBACK_CURRENT_POSITION = -1.0f;
     // Class data lock
     NSLock* dataLock;
     
-    // Sample and pixel buffers for video frames
-    CMSampleBufferRef latestSampleBuffer;
-    CMSampleBufferRef currentSampleBuffer;
-    NSLock* latestSampleBufferLock;
+    // Sample buffers of the video frames, from the frame pump to the renderer
+    VideoFrameQueue* frameQueue;
+    
+    // Frames picked by the renderer according to their display time, and the
+    // master clock it is read from (the generation of the frames the selector
+    // holds is only used on the rendering thread)
+    VideoFrameSelector* frameSelector;
+    VuforiaMedia::SeqLock<VideoClockSample>* clockSample;
+    uint32_t frameGeneration;
+    uint32_t frameSelectorGeneration;
+    
+    // Decoded, displayed and dropped frames
+    VuforiaMedia::PlaybackStatsCounters* playbackStats;
     
     // Video properties
     CGSize videoSize;
@@ -98,14 +135,25 @@ static const float VIDEO_PLAYBACK_CURRENT_POSITION = -1.0f;
     id<MTLTexture> videoTextureMetal;
     id<MTLDevice> metalDevice;
     Class MTLTextureDescriptorClass;
+    VuforiaMedia::FrameUploader* frameUploader;
+    
+    // Wraps the decoded frames as textures (NULL until the first frame, or
+    // if the texture cache is not available)
+    VuforiaMedia::FrameTextureSource* frameTextureSource;
+    BOOL frameTextureSourceFailed;
+    EAGLContext* frameTextureContext;   // context of the OpenGL ES texture cache (not retained)
+    
+    // Audio/video synchronisation (the master clock is fed on each tick of
+    // the frame pump)
+    VuforiaMedia::ExternalClock* syncClock;
+    VuforiaMedia::AVSyncEngine<CMSampleBufferRef>* syncEngine;
+    
+    // Keyframe index of the local video, for keyframe-aligned seeks (built
+    // in the background, empty until it is ready)
+    std::shared_ptr<VuforiaMedia::KeyframeIndex> keyframeIndex;
     
-    // Audio/video synchronisation state
-    enum tagSyncState {
-        SYNC_DEFAULT,
-        SYNC_READY,
-        SYNC_AHEAD,
-        SYNC_BEHIND
-    } syncStatus;
+    // Slot identifying the player in the GPU memory budget
+    int statusSlot;
     
     // Media player type
     enum tagPLAYER_TYPE {
@@ -128,10 +176,16 @@ static const float VIDEO_PLAYBACK_CURRENT_POSITION = -1.0f;
 - (BOOL)pause;
 - (BOOL)stop;
 - (MEDIA_STATE)updateVideoData;
+- (void*)getFrameTexturePtr;
 - (BOOL)seekTo:(float)position;
 - (float)getCurrentPosition;
 - (BOOL)setVolume:(float)volume;
 - (BOOL)setVideoTexturePtr:(void*)texturePtr;
 - (void)onPause;
+- (void)getSyncStats:(VuforiaMedia::SyncStats*)stats;
+- (void)getFrameQueueStats:(VuforiaMedia::FrameQueueStats*)stats;
+- (void)getJudderStats:(VuforiaMedia::JudderStats*)stats;
+- (void)getPlaybackStats:(VuforiaMedia::PlaybackStats*)stats;
+- (int)getStatusSlot;
 
 @end
@@ -30,11 +30,26 @@ extern "C"
     bool videoPlayerPauseIOS(void* dataSetPtr);
     bool videoPlayerStopIOS(void* dataSetPtr);
     int videoPlayerUpdateVideoDataIOS(void* dataSetPtr);
+    void* videoPlayerGetFrameTexturePtrIOS(void* dataSetPtr);
     bool videoPlayerSeekToIOS(void* dataSetPtr, float position);
     float videoPlayerGetCurrentPositionIOS(void* dataSetPtr);
     bool videoPlayerSetVolumeIOS(void* dataSetPtr, float value);
     int videoPlayerGetCurrentBufferingPercentageIOS(void* dataSetPtr);
     void videoPlayerOnPauseIOS(void* dataSetPtr);
+
+    // stats points to a VuforiaMedia::SyncStats structure
+    bool videoPlayerGetSyncStatsIOS(void* dataSetPtr, void* stats);
+
+    // stats points to a VuforiaMedia::FrameQueueStats structure
+    bool videoPlayerGetFrameQueueStatsIOS(void* dataSetPtr, void* stats);
+
+    // stats points to a VuforiaMedia::JudderStats structure
+    bool videoPlayerGetJudderStatsIOS(void* dataSetPtr, void* stats);
+
+    // stats points to a VuforiaMedia::PlaybackStats structure
+    bool videoPlayerGetPlaybackStatsIOS(void* dataSetPtr, void* stats);
+    
+    int videoPlayerGetSlotIOS(void* dataSetPtr);
     
 #ifdef __cplusplus
 }
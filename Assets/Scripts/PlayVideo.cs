@@ -188,7 +188,8 @@ public class PlayVideo : MonoBehaviour
         VideoPlaybackBehaviour[] videos = FindObjectsOfType<VideoPlaybackBehaviour>();
         foreach (VideoPlaybackBehaviour video in videos)
         {
-            if (video != currentVideo && 
+            if (video != currentVideo &&
+                video.VideoPlayer != currentVideo.VideoPlayer &&
                 video.CurrentState == VideoPlayerHelper.MediaState.PLAYING)
             {
                 video.VideoPlayer.Pause();
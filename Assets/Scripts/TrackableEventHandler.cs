@@ -9,6 +9,16 @@ using Vuforia;
 /// </summary>
 public class TrackableEventHandler : MonoBehaviour, ITrackableEventHandler
 {
+    #region PUBLIC_MEMBERS
+    /// <summary>
+    /// Seconds after tracking is lost before the video is hidden (paused),
+    /// then hibernated (player and video texture released)
+    /// </summary>
+    public float m_hideDelay = 2.0f;
+    public float m_hibernateDelay = 10.0f;
+    #endregion // PUBLIC_MEMBERS
+
+
     #region PRIVATE_MEMBERS
     private TrackableBehaviour mTrackableBehaviour;
     private bool mHasBeenFound = false;
@@ -31,19 +41,25 @@ public class TrackableEventHandler : MonoBehaviour, ITrackableEventHandler
 
     void Update()
     {
-        // Pause the video if tracking is lost for more than two seconds
+        // Hide the video if tracking is lost for more than m_hideDelay seconds,
+        // and release it if tracking is not found again within m_hibernateDelay seconds
         if (mHasBeenFound && mLostTracking)
         {
-            if (mSecondsSinceLost > 2.0f)
+            if (mSecondsSinceLost > m_hideDelay)
             {
+                bool hibernate = (mSecondsSinceLost > m_hibernateDelay);
+
                 VideoPlaybackBehaviour video = GetComponentInChildren<VideoPlaybackBehaviour>();
-                if (video != null &&
-                    video.CurrentState == VideoPlayerHelper.MediaState.PLAYING)
+                if (video != null)
                 {
-                    video.VideoPlayer.Pause();
+                    video.Suspend(hibernate ? VideoPlaybackBehaviour.SuspendLevel.HIBERNATED :
+                                              VideoPlaybackBehaviour.SuspendLevel.HIDDEN);
                 }
 
-                mLostTracking = false;
+                if (hibernate)
+                {
+                    mLostTracking = false;
+                }
             }
 
             mSecondsSinceLost += Time.deltaTime;
@@ -99,6 +115,15 @@ public class TrackableEventHandler : MonoBehaviour, ITrackableEventHandler
         // Optionally play the video automatically when the target is found
 
         VideoPlaybackBehaviour video = GetComponentInChildren<VideoPlaybackBehaviour>();
+
+        // Bring a suspended video back: a hidden video is played by the code below,
+        // a hibernated one is reloaded first and played once ready
+        if (video != null)
+        {
+            video.Resume(video.AutoPlay &&
+                video.CurrentSuspendLevel == VideoPlaybackBehaviour.SuspendLevel.HIBERNATED);
+        }
+
         if (video != null && video.AutoPlay)
         {
             if (video.VideoPlayer.IsPlayableOnTexture())
@@ -160,7 +185,8 @@ public class TrackableEventHandler : MonoBehaviour, ITrackableEventHandler
 
         foreach (VideoPlaybackBehaviour video in videos)
         {
-            if (video != currentVideo)
+            // Videos sharing the player of this one keep playing with it
+            if (video != currentVideo && video.VideoPlayer != currentVideo.VideoPlayer)
             {
                 if (video.CurrentState == VideoPlayerHelper.MediaState.PLAYING)
                 {
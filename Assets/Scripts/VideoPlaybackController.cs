@@ -25,6 +25,19 @@ using System.Collections;
 /// </summary>
 public class VideoPlaybackController : MonoBehaviour
 {
+    #region PUBLIC_MEMBER_VARIABLES
+
+    // Disk space for the remote videos, in megabytes; 0 disables the cache
+    public int m_videoCacheSizeMB = 256;
+
+    // Videos kept prepared ahead of their targets being found (WSA only);
+    // 0 disables prewarming
+    public int m_warmPoolSize = 2;
+
+    #endregion // PUBLIC_MEMBER_VARIABLES
+
+
+
     #region PRIVATE_MEMBER_VARIABLES
 
     private Vector2 mTouchStartPos;
@@ -42,6 +55,24 @@ public class VideoPlaybackController : MonoBehaviour
 
     #region UNITY_MONOBEHAVIOUR_METHODS
 
+    void Awake()
+    {
+        // Before the videos are loaded, in the Start() of their behaviours
+        if (m_videoCacheSizeMB > 0)
+        {
+            VideoCache.Enable(m_videoCacheSizeMB * 1024L * 1024L);
+        }
+
+        // Also before the behaviours prewarm their videos in their Start()
+        VideoPlayerHelper.SetWarmPoolSize(m_warmPoolSize);
+    }
+
+    void OnDestroy()
+    {
+        // The prepared videos that were not played are released with the scene
+        VideoPlayerHelper.ClearWarmPool();
+    }
+
     void Update()
     {
         // Determine the number of taps
@@ -234,7 +265,8 @@ public class VideoPlaybackController : MonoBehaviour
 
         foreach (VideoPlaybackBehaviour video in videos)
         {
-            if (video != currentVideo)
+            // (videos sharing the player of this one keep playing with it)
+            if (video != currentVideo && video.VideoPlayer != currentVideo.VideoPlayer)
             {
                 if (video.CurrentState == VideoPlayerHelper.MediaState.PLAYING)
                 {
@@ -0,0 +1,309 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+==============================================================================*/
+
+using UnityEngine;
+using System.Collections.Generic;
+
+/// <summary>
+/// A video player shared by all the VideoPlaybackBehaviours that show the same video.
+/// The video is decoded once, into one texture referenced by every behaviour,
+/// whatever the number of targets showing it. The decoder is released with the
+/// last behaviour using it.
+/// Each behaviour keeps its own volume and visibility: the decoder plays at the
+/// volume of the loudest visible behaviour.
+/// </summary>
+public class SharedVideoDecoder
+{
+    #region NESTED
+
+    public enum InitState
+    {
+        NOT_INITED,     // no behaviour has started initializing the player
+        INITIALIZING,   // one behaviour is initializing, loading and preparing the player
+        INITED,         // the player and the video texture are ready
+        ERROR
+    }
+
+    #endregion // NESTED
+
+
+
+    #region PRIVATE_MEMBER_VARIABLES
+
+    private static Dictionary<string, SharedVideoDecoder> sDecoders =
+            new Dictionary<string, SharedVideoDecoder>();
+
+    private string mPath;
+    private VideoPlayerHelper mVideoPlayer;
+    private List<VideoPlaybackBehaviour> mConsumers = new List<VideoPlaybackBehaviour>();
+
+    private InitState mInitState = InitState.NOT_INITED;
+    private VideoPlaybackBehaviour mInitializer = null;
+    private Texture2D mVideoTexture = null;
+    private float mSeekPosition = 0.0f;
+
+    private int mLastUpdateFrame = -1;
+    private VideoPlayerHelper.MediaState mLastState = VideoPlayerHelper.MediaState.NOT_READY;
+    private float mVolume = -1.0f;
+    private bool mAppPaused = false;
+
+    #endregion // PRIVATE_MEMBER_VARIABLES
+
+
+
+    #region PROPERTIES
+
+    public VideoPlayerHelper VideoPlayer
+    {
+        get { return mVideoPlayer; }
+    }
+
+    public InitState State
+    {
+        get { return mInitState; }
+    }
+
+    /// <summary>
+    /// Texture the video is decoded into, set by the behaviour that initialized the player
+    /// </summary>
+    public Texture2D VideoTexture
+    {
+        get { return mVideoTexture; }
+    }
+
+    /// <summary>
+    /// Playback position saved when the player was last deinitialized
+    /// </summary>
+    public float SeekPosition
+    {
+        get { return mSeekPosition; }
+    }
+
+    #endregion // PROPERTIES
+
+
+
+    #region PUBLIC_METHODS
+
+    /// <summary>
+    /// Returns the decoder of the video, creating it for its first behaviour
+    /// </summary>
+    public static SharedVideoDecoder Acquire(string path, VideoPlaybackBehaviour consumer)
+    {
+        SharedVideoDecoder decoder;
+        if (!sDecoders.TryGetValue(path, out decoder))
+        {
+            decoder = new SharedVideoDecoder(path);
+            sDecoders[path] = decoder;
+        }
+
+        decoder.mConsumers.Add(consumer);
+        return decoder;
+    }
+
+    /// <summary>
+    /// Releases the decoder for this behaviour; the player is deinitialized with the last one
+    /// </summary>
+    public void Release(VideoPlaybackBehaviour consumer)
+    {
+        mConsumers.Remove(consumer);
+
+        if (mConsumers.Count == 0)
+        {
+            mVideoPlayer.Deinit();
+            sDecoders.Remove(mPath);
+            return;
+        }
+
+        // A behaviour destroyed while initializing the player leaves it half loaded,
+        // the next behaviour rendering the video starts over
+        if (mInitializer == consumer && mInitState == InitState.INITIALIZING)
+        {
+            mVideoPlayer.Deinit();
+            mInitState = InitState.NOT_INITED;
+            mInitializer = null;
+        }
+    }
+
+    /// <summary>
+    /// Returns true if this behaviour has to initialize the player. Otherwise
+    /// it waits for the decoder to be INITED and uses its video texture.
+    /// </summary>
+    public bool BeginInit(VideoPlaybackBehaviour consumer)
+    {
+        if (mInitState != InitState.NOT_INITED)
+        {
+            return false;
+        }
+
+        mInitState = InitState.INITIALIZING;
+        mInitializer = consumer;
+        return true;
+    }
+
+    /// <summary>
+    /// Called by the initializing behaviour once the player is prepared, or has failed
+    /// </summary>
+    public void EndInit(bool succeeded, Texture2D videoTexture)
+    {
+        mInitState = succeeded ? InitState.INITED : InitState.ERROR;
+        mInitializer = null;
+        mVideoTexture = videoTexture;
+        mLastUpdateFrame = -1;
+        mVolume = -1.0f;
+    }
+
+    /// <summary>
+    /// Updates the video texture with the latest video frame, once per frame
+    /// however many behaviours render the video
+    /// </summary>
+    public VideoPlayerHelper.MediaState UpdateVideoData()
+    {
+        if (mLastUpdateFrame == Time.frameCount)
+        {
+            return mLastState;
+        }
+        mLastUpdateFrame = Time.frameCount;
+
+        UpdateVolume();
+
+        mLastState = mVideoPlayer.UpdateVideoData();
+        mVideoPlayer.UpdateFrameTexture(mVideoTexture);
+        if ((mLastState == VideoPlayerHelper.MediaState.PLAYING)
+            || (mLastState == VideoPlayerHelper.MediaState.PLAYING_FULLSCREEN))
+        {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+            // For Direct3D video texture update, we need to be on the rendering thread
+            GL.IssuePluginEvent(VideoPlayerHelper.GetNativeRenderEventFunc(), mVideoPlayer.GetRenderEventID());
+#else
+            GL.InvalidateState();
+#endif
+        }
+
+        return mLastState;
+    }
+
+    /// <summary>
+    /// Returns true if a behaviour other than this one shows the video
+    /// </summary>
+    public bool IsVisibleToOthers(VideoPlaybackBehaviour consumer)
+    {
+        foreach (VideoPlaybackBehaviour other in mConsumers)
+        {
+            if (other != consumer && other.IsVisible)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// Pauses the player when the application is paused, and hands it the video texture
+    /// again when the application resumes, as Unity may have recreated it with the
+    /// graphics context. The player itself is kept, to resume where it was.
+    /// Only the first of the behaviours notified does it.
+    /// </summary>
+    public void OnApplicationPause(bool pause)
+    {
+        if (mInitState != InitState.INITED || pause == mAppPaused)
+        {
+            return;
+        }
+        mAppPaused = pause;
+
+        if (pause)
+        {
+            mVideoPlayer.OnPause();
+            if (mVideoPlayer.GetStatus() == VideoPlayerHelper.MediaState.PLAYING)
+            {
+                mVideoPlayer.Pause();
+            }
+        }
+        else if (mVideoTexture != null && mVideoPlayer.IsPlayableOnTexture())
+        {
+            mVideoPlayer.SetVideoTexturePtr(mVideoTexture.GetNativeTexturePtr());
+        }
+    }
+
+    /// <summary>
+    /// Releases the player and the video texture once all the behaviours
+    /// using the decoder are hibernated
+    /// </summary>
+    public void Hibernate()
+    {
+        if (mInitState != InitState.INITED)
+        {
+            return;
+        }
+
+        foreach (VideoPlaybackBehaviour consumer in mConsumers)
+        {
+            if (consumer.CurrentSuspendLevel != VideoPlaybackBehaviour.SuspendLevel.HIBERNATED)
+            {
+                return;
+            }
+        }
+
+        Deinit();
+        Object.Destroy(mVideoTexture);
+        mVideoTexture = null;
+    }
+
+    #endregion // PUBLIC_METHODS
+
+
+
+    #region PRIVATE_METHODS
+
+    // Save the playback position and deinitialize the player
+    private void Deinit()
+    {
+        mSeekPosition = mVideoPlayer.GetCurrentPosition();
+        mVideoPlayer.Deinit();
+
+        mInitState = InitState.NOT_INITED;
+        mLastState = VideoPlayerHelper.MediaState.NOT_READY;
+        mAppPaused = false;
+    }
+
+    private SharedVideoDecoder(string path)
+    {
+        mPath = path;
+        mVideoPlayer = new VideoPlayerHelper();
+        mVideoPlayer.SetFilename(path);
+    }
+
+    // Play at the volume of the loudest visible behaviour, or of the loudest
+    // one while none is visible (the video is then paused shortly after)
+    private void UpdateVolume()
+    {
+        float visibleVolume = -1.0f;
+        float volume = 0.0f;
+        foreach (VideoPlaybackBehaviour consumer in mConsumers)
+        {
+            volume = Mathf.Max(volume, consumer.Volume);
+            if (consumer.IsVisible)
+            {
+                visibleVolume = Mathf.Max(visibleVolume, consumer.Volume);
+            }
+        }
+
+        if (visibleVolume >= 0.0f)
+        {
+            volume = visibleVolume;
+        }
+
+        if (volume != mVolume)
+        {
+            mVideoPlayer.SetVolume(volume);
+            mVolume = volume;
+        }
+    }
+
+    #endregion // PRIVATE_METHODS
+}
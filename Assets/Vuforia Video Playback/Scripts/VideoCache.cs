@@ -0,0 +1,174 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+==============================================================================*/
+
+using UnityEngine;
+using System.Runtime.InteropServices;
+using System.Text;
+
+/// <summary>
+/// Disk cache of the remote videos.
+/// Once enabled, http:// videos are played through a local server that stores
+/// the downloaded bytes in a bounded cache: a video plays from the disk after
+/// its first viewing, and the first bytes of the videos likely to be played
+/// next can be prefetched to start them without buffering.
+/// Other URLs, and https:// ones, are played directly.
+/// </summary>
+public static class VideoCache
+{
+    #region PUBLIC_MEMBER_VARIABLES
+
+    public const long DEFAULT_MAX_BYTES = 256L * 1024 * 1024;
+    public const long DEFAULT_PREFETCH_BYTES = 2L * 1024 * 1024;
+
+    #endregion // PUBLIC_MEMBER_VARIABLES
+
+
+
+    #region PRIVATE_MEMBER_VARIABLES
+
+    private const int MAX_URL_LENGTH = 4096;
+
+    private static bool sEnabled = false;
+
+    #endregion // PRIVATE_MEMBER_VARIABLES
+
+
+
+    #region PROPERTIES
+
+    public static bool IsEnabled
+    {
+        get { return sEnabled; }
+    }
+
+    /// <summary>
+    /// Size of the videos stored on the disk, in bytes
+    /// </summary>
+    public static long CachedBytes
+    {
+        get { return sEnabled ? cachingProxyGetCachedBytes() : 0; }
+    }
+
+    #endregion // PROPERTIES
+
+
+
+    #region PUBLIC_METHODS
+
+    /// <summary>
+    /// Enables the cache, or changes its size if it is already enabled.
+    /// The least recently played videos are removed beyond maxBytes.
+    /// Call it before the videos are loaded.
+    /// </summary>
+    public static bool Enable(long maxBytes = DEFAULT_MAX_BYTES)
+    {
+        sEnabled = cachingProxyStart(Application.temporaryCachePath + "/VideoCache", maxBytes);
+        return sEnabled;
+    }
+
+    /// <summary>
+    /// Stops serving the cached videos. The videos loaded through the cache cannot
+    /// be played anymore; the cached bytes are kept for the next time.
+    /// </summary>
+    public static void Disable()
+    {
+        cachingProxyStop();
+        sEnabled = false;
+    }
+
+    /// <summary>
+    /// Returns the URL to load the video from: the cache for remote http:// videos,
+    /// the filename itself otherwise
+    /// </summary>
+    public static string GetLocalUrl(string filename)
+    {
+        if (!sEnabled || !filename.StartsWith("http://"))
+        {
+            return filename;
+        }
+
+        StringBuilder localUrl = new StringBuilder(MAX_URL_LENGTH);
+        int length = cachingProxyGetLocalUrl(filename, localUrl, localUrl.Capacity);
+        return (length > 0 && length < localUrl.Capacity) ? localUrl.ToString() : filename;
+    }
+
+    /// <summary>
+    /// Downloads the first bytes of a remote video in the background,
+    /// unless they are already cached
+    /// </summary>
+    public static void Prefetch(string filename, long bytes = DEFAULT_PREFETCH_BYTES)
+    {
+        if (sEnabled && filename.StartsWith("http://"))
+        {
+            cachingProxyPrefetch(filename, bytes);
+        }
+    }
+
+    /// <summary>
+    /// Removes all the videos from the disk
+    /// </summary>
+    public static void Clear()
+    {
+        if (sEnabled)
+        {
+            cachingProxyClearCache();
+        }
+    }
+
+    #endregion // PUBLIC_METHODS
+
+
+
+    #region NATIVE_FUNCTIONS
+
+#if !UNITY_EDITOR
+
+#if UNITY_IPHONE || UNITY_IOS
+    private const string PLUGIN_NAME = "__Internal";
+#else
+    private const string PLUGIN_NAME = "VuforiaMedia";
+#endif
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern bool cachingProxyStart([MarshalAs(UnmanagedType.LPStr)] string cacheDirectory,
+                                                 long maxBytes);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern void cachingProxyStop();
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern int cachingProxyGetLocalUrl([MarshalAs(UnmanagedType.LPStr)] string url,
+                                                      StringBuilder localUrl, int capacity);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern void cachingProxyPrefetch([MarshalAs(UnmanagedType.LPStr)] string url, long bytes);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern long cachingProxyGetCachedBytes();
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern void cachingProxyClearCache();
+
+#else // !UNITY_EDITOR
+
+    // The Editor plays no video
+    static bool cachingProxyStart(string cacheDirectory, long maxBytes) { return false; }
+
+    static void cachingProxyStop() { }
+
+    static int cachingProxyGetLocalUrl(string url, StringBuilder localUrl, int capacity) { return 0; }
+
+    static void cachingProxyPrefetch(string url, long bytes) { }
+
+    static long cachingProxyGetCachedBytes() { return 0; }
+
+    static void cachingProxyClearCache() { }
+
+#endif // !UNITY_EDITOR
+
+    #endregion // NATIVE_FUNCTIONS
+}
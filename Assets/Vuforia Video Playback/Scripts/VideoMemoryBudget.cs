@@ -0,0 +1,170 @@
+/*===============================================================================
+Copyright (c) 2016 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+==============================================================================*/
+
+using UnityEngine;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Keeps the GPU memory of all the videos under a cap.
+/// The native players account the textures and buffers they allocate; once per
+/// frame the videos currently rendered are reported, and while the total exceeds
+/// the cap the videos least recently visible are hibernated, releasing their
+/// player and video texture. Visible videos are never hibernated.
+/// </summary>
+public static class VideoMemoryBudget
+{
+    #region PRIVATE_MEMBER_VARIABLES
+
+    // Number of slots of the native status block
+    private const int MAX_PLAYERS = 64;
+
+    private static List<VideoPlaybackBehaviour> sBehaviours = new List<VideoPlaybackBehaviour>();
+    private static int[] sVisiblePlayers = new int[MAX_PLAYERS];
+    private static int[] sPlayersToHibernate = new int[MAX_PLAYERS];
+    private static int sLastUpdateFrame = -1;
+
+    #endregion // PRIVATE_MEMBER_VARIABLES
+
+
+
+    #region PROPERTIES
+
+    /// <summary>
+    /// Maximum GPU memory of the videos, in bytes. 0 means no cap.
+    /// </summary>
+    public static long Cap
+    {
+        get { return gpuMemoryBudgetGetCap(); }
+        set { gpuMemoryBudgetSetCap(value); }
+    }
+
+    /// <summary>
+    /// GPU memory currently allocated by all the videos, in bytes
+    /// </summary>
+    public static long TotalBytes
+    {
+        get { return gpuMemoryBudgetGetTotalBytes(); }
+    }
+
+    #endregion // PROPERTIES
+
+
+
+    #region PUBLIC_METHODS
+
+    /// <summary>
+    /// Returns the GPU memory allocated by the player, in bytes
+    /// </summary>
+    public static long GetPlayerBytes(VideoPlayerHelper videoPlayer)
+    {
+        int slot = videoPlayer.GetStatusSlot();
+        return slot >= 0 ? gpuMemoryBudgetGetPlayerBytes(slot) : 0;
+    }
+
+    public static void Register(VideoPlaybackBehaviour behaviour)
+    {
+        if (!sBehaviours.Contains(behaviour))
+        {
+            sBehaviours.Add(behaviour);
+        }
+    }
+
+    public static void Unregister(VideoPlaybackBehaviour behaviour)
+    {
+        sBehaviours.Remove(behaviour);
+    }
+
+    /// <summary>
+    /// Reports the visible videos and hibernates the videos selected to get back
+    /// under the cap. Only the first call of a frame does it.
+    /// </summary>
+    public static void Update()
+    {
+        if (sLastUpdateFrame == Time.frameCount)
+        {
+            return;
+        }
+        sLastUpdateFrame = Time.frameCount;
+
+        int visibleCount = 0;
+        foreach (VideoPlaybackBehaviour behaviour in sBehaviours)
+        {
+            if (behaviour.IsVisible && behaviour.VideoPlayer != null && visibleCount < MAX_PLAYERS)
+            {
+                int slot = behaviour.VideoPlayer.GetStatusSlot();
+                if (slot >= 0)
+                {
+                    sVisiblePlayers[visibleCount++] = slot;
+                }
+            }
+        }
+
+        int count = gpuMemoryBudgetUpdate(sVisiblePlayers, visibleCount,
+                                          sPlayersToHibernate, sPlayersToHibernate.Length);
+
+        // A shared player is released once all the behaviours showing it are hibernated
+        for (int i = 0; i < count; ++i)
+        {
+            foreach (VideoPlaybackBehaviour behaviour in sBehaviours.ToArray())
+            {
+                if (behaviour.VideoPlayer != null &&
+                    behaviour.VideoPlayer.GetStatusSlot() == sPlayersToHibernate[i])
+                {
+                    behaviour.Suspend(VideoPlaybackBehaviour.SuspendLevel.HIBERNATED);
+                }
+            }
+        }
+    }
+
+    #endregion // PUBLIC_METHODS
+
+
+
+    #region NATIVE_FUNCTIONS
+
+#if !UNITY_EDITOR
+
+#if UNITY_IPHONE || UNITY_IOS
+    private const string PLUGIN_NAME = "__Internal";
+#else
+    private const string PLUGIN_NAME = "VuforiaMedia";
+#endif
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern void gpuMemoryBudgetSetCap(long bytes);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern long gpuMemoryBudgetGetCap();
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern long gpuMemoryBudgetGetTotalBytes();
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern long gpuMemoryBudgetGetPlayerBytes(int player);
+
+    [DllImport(PLUGIN_NAME)]
+    private static extern int gpuMemoryBudgetUpdate(int[] visiblePlayers, int visibleCount,
+                                                    [Out] int[] playersToHibernate, int maxCount);
+
+#else // !UNITY_EDITOR
+
+    static void gpuMemoryBudgetSetCap(long bytes) { }
+
+    static long gpuMemoryBudgetGetCap() { return 0; }
+
+    static long gpuMemoryBudgetGetTotalBytes() { return 0; }
+
+    static long gpuMemoryBudgetGetPlayerBytes(int player) { return 0; }
+
+    static int gpuMemoryBudgetUpdate(int[] visiblePlayers, int visibleCount,
+                                     int[] playersToHibernate, int maxCount) { return 0; }
+
+#endif // !UNITY_EDITOR
+
+    #endregion // NATIVE_FUNCTIONS
+}
@@ -17,6 +17,22 @@ using System.Collections;
 /// </summary>
 public class VideoPlaybackBehaviour : MonoBehaviour
 {
+    #region NESTED
+
+    /// <summary>
+    /// How much of the video is kept while its target is not visible
+    /// </summary>
+    public enum SuspendLevel
+    {
+        NONE,
+        HIDDEN,         // decoding stopped, player and video texture kept
+        HIBERNATED      // player and video texture released, position and a poster frame kept
+    }
+
+    #endregion // NESTED
+
+
+
     #region PUBLIC_MEMBER_VARIABLES
 
     /// <summary>
@@ -44,6 +60,44 @@ public class VideoPlaybackBehaviour : MonoBehaviour
     /// </summary>
     public bool m_autoPlay = false;
 
+    /// <summary>
+    /// Share the player with the other behaviours showing the same video: the video
+    /// is then decoded once, and its position and playback state are shared.
+    /// Only plain videos are shared: a looping, packed alpha, cropped or
+    /// playlist video has its own player.
+    /// </summary>
+    public bool m_shareDecoder = true;
+
+    /// <summary>
+    /// Volume of the video, from 0 to 1. A shared video plays at the volume
+    /// of the loudest target showing it.
+    /// </summary>
+    public float m_volume = 1.0f;
+
+    /// <summary>
+    /// Play the video, or the playlist, again from its start once it ends
+    /// </summary>
+    public bool m_loop = false;
+
+    /// <summary>
+    /// The video frames hold the colour in their left half and the alpha in
+    /// their right half, and are shown as a transparent video; the renderer
+    /// needs a transparent material. Only supported on Android.
+    /// </summary>
+    public bool m_packedAlpha = false;
+
+    /// <summary>
+    /// Region of the video shown, normalised from its top left corner; only
+    /// this region is copied, to a video texture of its size. Only supported
+    /// on Android and WSA.
+    /// </summary>
+    public Rect m_crop = new Rect(0, 0, 1, 1);
+
+    /// <summary>
+    /// Videos played after m_path, in order, without tearing down the decoder
+    /// </summary>
+    public string[] m_playlist = null;
+
     #endregion // PUBLIC_MEMBER_VARIABLES
 
 
@@ -53,11 +107,13 @@ public class VideoPlaybackBehaviour : MonoBehaviour
     private static bool sLoadingLocked = false;
 
     private VideoPlayerHelper mVideoPlayer = null;
+    private SharedVideoDecoder mDecoder = null;
     private bool mIsInited = false;
     private bool mInitInProgess = false;
     private bool mAppPaused = false;
 
     private Texture2D mVideoTexture = null;
+    private bool mPosterFrameShown = false;
 
     [SerializeField]
     [HideInInspector]
@@ -70,6 +126,14 @@ public class VideoPlaybackBehaviour : MonoBehaviour
             VideoPlayerHelper.MediaState.NOT_READY;
 
     private float mSeekPosition = 0.0f;
+    private int mPlaylistIndex = 0;
+
+    private SuspendLevel mSuspendLevel = SuspendLevel.NONE;
+    private bool mPlayOnResume = false;
+    private RenderTexture mHibernatePoster = null;
+
+    // The hibernation poster frame is a reduced copy of the last frame
+    private const int HIBERNATE_POSTER_DOWNSCALE = 4;
 
     private bool isPlayableOnTexture;
 
@@ -125,6 +189,46 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         get { return m_autoPlay; }
     }
 
+    /// <summary>
+    /// Volume of the video, from 0 to 1
+    /// </summary>
+    public float Volume
+    {
+        get { return m_volume; }
+        set
+        {
+            m_volume = Mathf.Clamp01(value);
+            if (mIsInited && mDecoder == null)
+            {
+                mVideoPlayer.SetVolume(m_volume);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Returns how much of the video is kept while its target is not visible
+    /// </summary>
+    public SuspendLevel CurrentSuspendLevel
+    {
+        get { return mSuspendLevel; }
+    }
+
+    /// <summary>
+    /// Returns whether the video is currently rendered on its target
+    /// </summary>
+    public bool IsVisible
+    {
+        get { return GetComponent<Renderer>().enabled; }
+    }
+
+    /// <summary>
+    /// Returns true if the player is shared with another behaviour whose target is visible
+    /// </summary>
+    public bool IsShownByOtherTargets
+    {
+        get { return mDecoder != null && mDecoder.IsVisibleToOthers(this); }
+    }
+
     #endregion // PROPERTIES
 
 
@@ -150,9 +254,29 @@ public class VideoPlaybackBehaviour : MonoBehaviour
             HandleStateChange(VideoPlayerHelper.MediaState.NOT_READY);
             mCurrentState = VideoPlayerHelper.MediaState.NOT_READY;
         }
-        // Create the video player and set the filename
-        mVideoPlayer = new VideoPlayerHelper();
-        mVideoPlayer.SetFilename(m_path);
+        // Create the video player and set the filename,
+        // or share the player of the other behaviours showing this video
+        if (m_shareDecoder && CanShareDecoder() && this.enabled)
+        {
+            mDecoder = SharedVideoDecoder.Acquire(m_path, this);
+            mVideoPlayer = mDecoder.VideoPlayer;
+        }
+        else
+        {
+            mVideoPlayer = new VideoPlayerHelper();
+            mVideoPlayer.SetFilename(m_path);
+        }
+
+        // Any target may be found next: have the start of remote videos ready,
+        // and the video prepared where the platform supports it
+        if (this.enabled)
+        {
+            VideoCache.Prefetch(m_path);
+            if (!IsCropped())
+            {
+                VideoPlayerHelper.Prewarm(m_path);
+            }
+        }
 
         // Flip the plane as the video texture is mirrored on the horizontal
         transform.localScale = new Vector3(-1 * Mathf.Abs(transform.localScale.x),
@@ -160,11 +284,19 @@ public class VideoPlaybackBehaviour : MonoBehaviour
 
         // Scale the icon
         ScaleIcon();
+
+        VideoMemoryBudget.Register(this);
+    }
+
+    void LateUpdate()
+    {
+        // Hibernate the hidden videos exceeding the GPU memory budget
+        VideoMemoryBudget.Update();
     }
 
     void OnRenderObject()
     {
-        if (mAppPaused) return;
+        if (mAppPaused || mSuspendLevel == SuspendLevel.HIBERNATED) return;
 
         CheckIconPlaneVisibility();
 
@@ -173,22 +305,52 @@ public class VideoPlaybackBehaviour : MonoBehaviour
             if (!mInitInProgess)
             {
                 mInitInProgess = true;
-                StartCoroutine(InitVideoPlayer());
+                if (mDecoder == null)
+                {
+                    StartCoroutine(InitVideoPlayer());
+                }
+                else if (mDecoder.BeginInit(this))
+                {
+                    // Resume the shared video where it was when it was deinitialized
+                    mSeekPosition = mDecoder.SeekPosition;
+                    StartCoroutine(InitVideoPlayer());
+                }
+                else
+                {
+                    StartCoroutine(WaitForSharedDecoder());
+                }
             }
 
             return;
         }
 
-        if (isPlayableOnTexture)
+        if (isPlayableOnTexture && mDecoder != null)
+        {
+            // The shared decoder updates the video texture once for all its behaviours
+            VideoPlayerHelper.MediaState state = mDecoder.UpdateVideoData();
+            CheckPlaylistItem();
+
+            // Check for playback state change
+            if (state != mCurrentState)
+            {
+                HandleStateChange(state);
+                mCurrentState = state;
+            }
+        }
+        else if (isPlayableOnTexture)
         {
             // Update the video texture with the latest video frame
             VideoPlayerHelper.MediaState state = mVideoPlayer.UpdateVideoData();
+            mVideoPlayer.UpdateFrameTexture(mVideoTexture);
+            CheckPlaylistItem();
             if ((state == VideoPlayerHelper.MediaState.PLAYING)
                 || (state == VideoPlayerHelper.MediaState.PLAYING_FULLSCREEN))
             {
 #if UNITY_WSA_10_0 && !UNITY_EDITOR
-                // For Direct3D video texture update, we need to be on the rendering thread
-                GL.IssuePluginEvent(VideoPlayerHelper.GetNativeRenderEventFunc(), 0);
+                // For Direct3D video texture update, we need to be on the rendering thread;
+                // only this video is updated, so that the copies of all videos in the
+                // scene are spread across the frame
+                GL.IssuePluginEvent(VideoPlayerHelper.GetNativeRenderEventFunc(), mVideoPlayer.GetRenderEventID());
 #else
                 GL.InvalidateState();
 #endif
@@ -241,6 +403,7 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         {
             Debug.Log("Could not initialize video player");
             HandleStateChange(VideoPlayerHelper.MediaState.ERROR);
+            EndSharedInit(false);
             this.enabled = false;
         }
     }
@@ -250,6 +413,16 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         // Lock file loading
         sLoadingLocked = true;
 
+        if (m_packedAlpha && !mVideoPlayer.SetPackedAlpha(true))
+        {
+            Debug.Log("Packed alpha is not supported on this platform, the video is shown as it is");
+        }
+
+        if (IsCropped() && !mVideoPlayer.SetCrop(m_crop))
+        {
+            Debug.Log("Cropping is not supported on this platform, the whole video is shown");
+        }
+
         // Load the video
         if (mVideoPlayer.Load(m_path, mMediaType, false, 0))
         {
@@ -257,8 +430,14 @@ public class VideoPlaybackBehaviour : MonoBehaviour
 
 #if UNITY_WSA_10_0 && !UNITY_EDITOR
             // On Windows 10 (WSA), we need to wait a little bit after loading a video,
-            // to avoid potential conflicts when loading multiple videos
-            yield return new WaitForSeconds(1.5f);
+            // to avoid potential conflicts when loading multiple videos;
+            // the cached poster frame can be shown meanwhile
+            float loadWaitEnd = Time.realtimeSinceStartup + 1.5f;
+            while (Time.realtimeSinceStartup < loadWaitEnd)
+            {
+                TryShowPosterFrame();
+                yield return new WaitForEndOfFrame();
+            }
 #endif
 
             // Unlock file loading
@@ -274,6 +453,7 @@ public class VideoPlaybackBehaviour : MonoBehaviour
 
             Debug.Log("Could not load video '" + m_path + "' for media type " + mMediaType);
             HandleStateChange(VideoPlayerHelper.MediaState.ERROR);
+            EndSharedInit(false);
             this.enabled = false;
         }
     } 
@@ -287,6 +467,7 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         {
             Debug.Log("Cannot prepare video, as the player is in error state.");
             HandleStateChange(VideoPlayerHelper.MediaState.ERROR);
+            EndSharedInit(false);
             this.enabled = false;
         }
         else
@@ -294,6 +475,8 @@ public class VideoPlaybackBehaviour : MonoBehaviour
             // Not in error state, we can move on...
             while (mVideoPlayer.GetStatus() == VideoPlayerHelper.MediaState.NOT_READY)
             {
+                TryShowPosterFrame();
+
                 // Wait one or few frames for video state to become ready
                 yield return new WaitForEndOfFrame();
             }
@@ -305,7 +488,11 @@ public class VideoPlaybackBehaviour : MonoBehaviour
             bool isOpenGLRendering = (
                 VuforiaRenderer.Instance.GetRendererAPI() == VuforiaRenderer.RendererAPI.GL_20
                 || VuforiaRenderer.Instance.GetRendererAPI() == VuforiaRenderer.RendererAPI.GL_30);
-            InitVideoTexture(isOpenGLRendering);
+            // (unless it was already created to show the poster frame)
+            if (!mPosterFrameShown)
+            {
+                InitVideoTexture(isOpenGLRendering);
+            }
 
             // Can we play this video on a texture?
             isPlayableOnTexture = mVideoPlayer.IsPlayableOnTexture();
@@ -315,24 +502,16 @@ public class VideoPlaybackBehaviour : MonoBehaviour
                 // Pass the video texture id to the video player
                 mVideoPlayer.SetVideoTexturePtr(mVideoTexture.GetNativeTexturePtr());
 
-                // Get the video width and height
-                int videoWidth = mVideoPlayer.GetVideoWidth();
-                int videoHeight = mVideoPlayer.GetVideoHeight();
-
-                if (videoWidth > 0 && videoHeight > 0)
-                {
-                    // Scale the video plane to match the video aspect ratio
-                    float aspect = videoHeight / (float)videoWidth;
-
-                    // Flip the plane as the video texture is mirrored on the horizontal
-                    transform.localScale = new Vector3(-0.1f, 0.1f, 0.1f * aspect);
-                }
+                ScaleToVideoAspect();
 
                 // Seek ahead if necessary
                 if (mSeekPosition > 0)
                 {
                     mVideoPlayer.SeekTo(mSeekPosition);
                 }
+
+                // Play again if the video was resumed from hibernation
+                ResumePlayback();
             }
             else
             {
@@ -342,10 +521,25 @@ public class VideoPlaybackBehaviour : MonoBehaviour
                 mCurrentState = state;
             }
 
+            if (mDecoder == null)
+            {
+                mVideoPlayer.SetVolume(m_volume);
+            }
+
+            if (m_playlist != null && m_playlist.Length > 0)
+            {
+                mVideoPlayer.SetPlaylist(m_playlist);
+            }
+            if (m_loop)
+            {
+                mVideoPlayer.SetLooping(true);
+            }
+
             // Scale the icon
             ScaleIcon();
             
             mIsInited = true;
+            EndSharedInit(true);
         }
 
         mInitInProgess = false;
@@ -359,32 +553,70 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         if (!mIsInited)
             return;
 
+        // The player is kept while the application is paused, so that it
+        // resumes where it was without reloading the video. If the graphics
+        // context is lost meanwhile, the plugin rebuilds the GPU resources of
+        // all the players on the first frame after resuming.
         if (pause)
         {
-            // Handle pause event natively
-            mVideoPlayer.OnPause();
-
-            // Store the playback position for later
-            mSeekPosition = mVideoPlayer.GetCurrentPosition();
+            if (mCurrentState == VideoPlayerHelper.MediaState.PLAYING)
+            {
+                mPlayOnResume = true;
+            }
 
-            // Deinit the video
-            mVideoPlayer.Deinit();
+            if (mDecoder != null)
+            {
+                // The first behaviour paused pauses the shared video
+                mDecoder.OnApplicationPause(true);
+            }
+            else
+            {
+                // Handle pause event natively
+                mVideoPlayer.OnPause();
 
-            // Reset initialization parameters
-            mIsInited = false;
-            mInitInProgess = false;
+                if (mVideoPlayer.GetStatus() == VideoPlayerHelper.MediaState.PLAYING)
+                {
+                    mVideoPlayer.Pause();
+                }
+            }
+        }
+        else
+        {
+            if (mDecoder != null)
+            {
+                mDecoder.OnApplicationPause(false);
+            }
+            else if (isPlayableOnTexture && mVideoTexture != null)
+            {
+                // Unity may have recreated the video texture with the context
+                mVideoPlayer.SetVideoTexturePtr(mVideoTexture.GetNativeTexturePtr());
+            }
 
-            // Set the current state to Not Ready
-            HandleStateChange(VideoPlayerHelper.MediaState.NOT_READY);
-            mCurrentState = VideoPlayerHelper.MediaState.NOT_READY;
+            if (isPlayableOnTexture && mSuspendLevel == SuspendLevel.NONE)
+            {
+                mSeekPosition = mVideoPlayer.GetCurrentPosition();
+                ResumePlayback();
+            }
         }
     }
 
 
     void OnDestroy()
     {
-        // Deinit the video
-        mVideoPlayer.Deinit();
+        VideoMemoryBudget.Unregister(this);
+
+        // Deinit the video, or release it if it is shared
+        if (mDecoder != null)
+        {
+            mDecoder.Release(this);
+            mDecoder = null;
+        }
+        else if (mVideoPlayer != null)
+        {
+            mVideoPlayer.Deinit();
+        }
+
+        ReleaseHibernatePoster();
     }
 
     #endregion // UNITY_MONOBEHAVIOUR_METHODS
@@ -409,12 +641,209 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         mIconPlane.GetComponent<Renderer>().material.mainTexture = m_playTexture;
     }
 
+    /// <summary>
+    /// Suspends the video while its target is not visible.
+    /// HIDDEN stops decoding but keeps the player and the video texture, to resume instantly.
+    /// HIBERNATED releases the player and the video texture, keeping only the playback
+    /// position and a reduced copy of the last frame, shown until the video is reloaded.
+    /// A shared video keeps playing while other targets show it, and is released
+    /// once all of them are hibernated.
+    /// </summary>
+    public void Suspend(SuspendLevel level)
+    {
+        if (level <= mSuspendLevel)
+        {
+            return;
+        }
+        mSuspendLevel = level;
+        mPlayOnResume = false;
+
+        if (!mIsInited)
+        {
+            // Still loading, the video can only be hidden
+            mSuspendLevel = SuspendLevel.HIDDEN;
+            return;
+        }
+
+        if (mCurrentState == VideoPlayerHelper.MediaState.PLAYING && !IsShownByOtherTargets)
+        {
+            mVideoPlayer.Pause();
+        }
+
+        if (level == SuspendLevel.HIBERNATED)
+        {
+            Hibernate();
+        }
+    }
+
+    /// <summary>
+    /// Resumes a suspended video, through the fastest path: a hidden video is shown
+    /// as it is, a hibernated one is reloaded at its position.
+    /// If play is true, playback restarts once the video is ready.
+    /// </summary>
+    public void Resume(bool play)
+    {
+        if (mSuspendLevel == SuspendLevel.NONE)
+        {
+            return;
+        }
+        mSuspendLevel = SuspendLevel.NONE;
+        mPlayOnResume = play;
+
+        if (mIsInited && isPlayableOnTexture)
+        {
+            mSeekPosition = mVideoPlayer.GetCurrentPosition();
+            ResumePlayback();
+        }
+        // Otherwise the next OnRenderObject reloads the video
+    }
+
     #endregion // PUBLIC_METHODS
 
 
 
     #region PRIVATE_METHODS
 
+    // Release the player and the video texture, showing a reduced copy of the last frame instead
+    private void Hibernate()
+    {
+        CaptureHibernatePoster();
+
+        if (mDecoder != null)
+        {
+            // The shared player is only released with its last visible behaviour
+            mDecoder.Hibernate();
+        }
+        else
+        {
+            mSeekPosition = mVideoPlayer.GetCurrentPosition();
+            mVideoPlayer.Deinit();
+            Destroy(mVideoTexture);
+        }
+        mVideoTexture = null;
+
+        // Reset initialization parameters
+        mIsInited = false;
+        mInitInProgess = false;
+        mPosterFrameShown = false;
+
+        HandleStateChange(VideoPlayerHelper.MediaState.NOT_READY);
+        mCurrentState = VideoPlayerHelper.MediaState.NOT_READY;
+    }
+
+    private void CaptureHibernatePoster()
+    {
+        bool hasFrame = mPosterFrameShown ||
+                mCurrentState == VideoPlayerHelper.MediaState.PLAYING ||
+                mCurrentState == VideoPlayerHelper.MediaState.PAUSED;
+        int w = mVideoPlayer.GetVideoWidth() / HIBERNATE_POSTER_DOWNSCALE;
+        int h = mVideoPlayer.GetVideoHeight() / HIBERNATE_POSTER_DOWNSCALE;
+        if (!hasFrame || mVideoTexture == null || w <= 0 || h <= 0)
+        {
+            return;
+        }
+
+        ReleaseHibernatePoster();
+        mHibernatePoster = new RenderTexture(w, h, 0);
+        Graphics.Blit(mVideoTexture, mHibernatePoster);
+    }
+
+    private void ReleaseHibernatePoster()
+    {
+        if (mHibernatePoster != null)
+        {
+            mHibernatePoster.Release();
+            Destroy(mHibernatePoster);
+            mHibernatePoster = null;
+        }
+    }
+
+    // Start playback if it was requested when the video was resumed
+    private void ResumePlayback()
+    {
+        if (!mPlayOnResume)
+        {
+            return;
+        }
+        mPlayOnResume = false;
+
+        VideoPlayerHelper.MediaState state = mVideoPlayer.GetStatus();
+        if (state == VideoPlayerHelper.MediaState.PAUSED ||
+            state == VideoPlayerHelper.MediaState.READY ||
+            state == VideoPlayerHelper.MediaState.STOPPED)
+        {
+            mVideoPlayer.Play(false, mSeekPosition);
+        }
+        else if (state == VideoPlayerHelper.MediaState.REACHED_END)
+        {
+            mVideoPlayer.Play(false, 0);
+        }
+        else if (state == VideoPlayerHelper.MediaState.PLAYING)
+        {
+            // Control calls are queued on Android and WSA: the pause of a
+            // suspend just before may not show in the status yet. Playing
+            // again undoes it, and does nothing if the video is playing.
+            mVideoPlayer.Play(false, VideoPlayerHelper.CURRENT_POSITION);
+        }
+    }
+
+    // Wait for the behaviour initializing the shared player, then show its video texture
+    private IEnumerator WaitForSharedDecoder()
+    {
+        while (mDecoder.State == SharedVideoDecoder.InitState.INITIALIZING)
+        {
+            yield return new WaitForEndOfFrame();
+        }
+
+        if (mDecoder.State == SharedVideoDecoder.InitState.NOT_INITED)
+        {
+            // The initializing behaviour was destroyed (or the application paused)
+            mInitInProgess = false;
+            yield break;
+        }
+
+        if (mDecoder.State == SharedVideoDecoder.InitState.ERROR)
+        {
+            Debug.Log("Cannot show video, as the shared player is in error state.");
+            HandleStateChange(VideoPlayerHelper.MediaState.ERROR);
+            mCurrentState = VideoPlayerHelper.MediaState.ERROR;
+            mInitInProgess = false;
+            this.enabled = false;
+            yield break;
+        }
+
+        mVideoTexture = mDecoder.VideoTexture;
+        isPlayableOnTexture = mVideoPlayer.IsPlayableOnTexture();
+        if (isPlayableOnTexture)
+        {
+            ScaleToVideoAspect();
+        }
+        ScaleIcon();
+
+        if (isPlayableOnTexture)
+        {
+            mSeekPosition = mVideoPlayer.GetCurrentPosition();
+            ResumePlayback();
+        }
+
+        // Show the texture (or icon) for the current state of the shared player
+        VideoPlayerHelper.MediaState state = mVideoPlayer.GetStatus();
+        HandleStateChange(state);
+        mCurrentState = state;
+
+        mIsInited = true;
+        mInitInProgess = false;
+    }
+
+    // Let the other behaviours sharing the player know that it is ready, or failed
+    private void EndSharedInit(bool succeeded)
+    {
+        if (mDecoder != null)
+        {
+            mDecoder.EndInit(succeeded, mVideoTexture);
+        }
+    }
+
     // Initialize the video texture
     private void InitVideoTexture(bool isOpenGLRendering)
     {
@@ -429,23 +858,118 @@ public class VideoPlaybackBehaviour : MonoBehaviour
         Debug.Log("InitVideoTexture with size: " + w + " x " + h);
 
         mVideoTexture = isOpenGLRendering ? 
-            new Texture2D(0, 0, TextureFormat.RGB565, false) :
+            new Texture2D(0, 0, m_packedAlpha ? TextureFormat.RGBA32 : TextureFormat.RGB565, false) :
             new Texture2D(w, h, TextureFormat.BGRA32, false);
         mVideoTexture.filterMode = FilterMode.Bilinear;
         mVideoTexture.wrapMode = TextureWrapMode.Clamp;
     }
 
+    // Show the cached poster frame of the video, if there is one,
+    // while the video is still being prepared
+    private void TryShowPosterFrame()
+    {
+        if (mPosterFrameShown || !mVideoPlayer.HasPosterFrame())
+        {
+            return;
+        }
+
+        // The poster frame has the size of the video, so the video texture
+        // can be created before the video is ready (poster frames are only
+        // supported with Direct3D)
+        InitVideoTexture(false);
+        mVideoPlayer.SetVideoTexturePtr(mVideoTexture.GetNativeTexturePtr());
+
+        // The poster frame is uploaded on the rendering thread
+        GL.IssuePluginEvent(VideoPlayerHelper.GetNativeRenderEventFunc(), mVideoPlayer.GetRenderEventID());
+
+        Material mat = GetComponent<Renderer>().material;
+        mat.mainTexture = mVideoTexture;
+        mat.mainTextureScale = new Vector2(1, 1);
+
+        ScaleToVideoAspect();
+        ScaleIcon();
+
+        mPosterFrameShown = true;
+    }
+
+    // Follow the player to the next playlist item, which may have another size
+    private void CheckPlaylistItem()
+    {
+        int index = mVideoPlayer.GetPlaylistIndex();
+        if (index == mPlaylistIndex)
+        {
+            return;
+        }
+        mPlaylistIndex = index;
+
+        // OpenGL textures are resized by the plugin, Direct3D and Metal ones
+        // are created with the size of the video
+        bool isOpenGLRendering = (
+            VuforiaRenderer.Instance.GetRendererAPI() == VuforiaRenderer.RendererAPI.GL_20
+            || VuforiaRenderer.Instance.GetRendererAPI() == VuforiaRenderer.RendererAPI.GL_30);
+        if (!isOpenGLRendering && mDecoder == null && mVideoTexture != null &&
+            (mVideoTexture.width != mVideoPlayer.GetVideoWidth() ||
+             mVideoTexture.height != mVideoPlayer.GetVideoHeight()))
+        {
+            Texture2D previousTexture = mVideoTexture;
+            InitVideoTexture(false);
+            mVideoPlayer.SetVideoTexturePtr(mVideoTexture.GetNativeTexturePtr());
+            GetComponent<Renderer>().material.mainTexture = mVideoTexture;
+            Destroy(previousTexture);
+        }
+
+        ScaleToVideoAspect();
+    }
+
+    private bool IsCropped()
+    {
+        return m_crop.xMin > 0 || m_crop.yMin > 0 || m_crop.xMax < 1 || m_crop.yMax < 1;
+    }
+
+    // The shared decoders are keyed on the path only: a video played with
+    // options of its own gets its own player
+    private bool CanShareDecoder()
+    {
+        bool hasPlaylist = m_playlist != null && m_playlist.Length > 0;
+        return !IsCropped() && !m_packedAlpha && !m_loop && !hasPlaylist;
+    }
+
+    // Scale the video plane to match the video aspect ratio
+    private void ScaleToVideoAspect()
+    {
+        int videoWidth = mVideoPlayer.GetVideoWidth();
+        int videoHeight = mVideoPlayer.GetVideoHeight();
+
+        if (videoWidth > 0 && videoHeight > 0)
+        {
+            float aspect = videoHeight / (float)videoWidth;
+
+            // Flip the plane as the video texture is mirrored on the horizontal
+            transform.localScale = new Vector3(-0.1f, 0.1f, 0.1f * aspect);
+        }
+    }
+
     // Handle video playback state changes
     private void HandleStateChange(VideoPlayerHelper.MediaState newState)
     {
         // If the movie is playing or paused render the video texture
-        // Otherwise render the keyframe
+        // (or if it shows the poster frame). Otherwise render the keyframe
         if (newState == VideoPlayerHelper.MediaState.PLAYING ||
-            newState == VideoPlayerHelper.MediaState.PAUSED)
+            newState == VideoPlayerHelper.MediaState.PAUSED ||
+            (mPosterFrameShown && newState != VideoPlayerHelper.MediaState.ERROR))
         {
             Material mat = GetComponent<Renderer>().material;
             mat.mainTexture = mVideoTexture;
             mat.mainTextureScale = new Vector2(1, 1);
+
+            ReleaseHibernatePoster();
+        }
+        else if (mHibernatePoster != null && newState != VideoPlayerHelper.MediaState.ERROR)
+        {
+            // Show the last frame while the video is reloaded after hibernation
+            Material mat = GetComponent<Renderer>().material;
+            mat.mainTexture = mHibernatePoster;
+            mat.mainTextureScale = new Vector2(1, 1);
         }
         else
         {
@@ -11,6 +11,7 @@ using UnityEngine;
 using System.Collections;
 using System.Runtime.InteropServices;
 using System.IO;
+using System.Threading;
 using System;
 using Vuforia;
 
@@ -46,15 +47,177 @@ public class VideoPlayerHelper
         ON_TEXTURE_FULLSCREEN
     }
 
+    /// <summary>
+    /// Status of a video, as retrieved in one batch for all videos.
+    /// The layout matches the native VideoPlayerSnapshot structure.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct PlayerSnapshot
+    {
+        public int Valid;
+        public MediaState State;
+        public float Position;
+        public float Duration;
+        public int BufferingPercentage;
+        public int Width;
+        public int Height;
+        public int NewFrame;
+    }
+
+    /// <summary>
+    /// Audio/video synchronisation counters of a video.
+    /// The layout matches the native SyncStats structure.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct SyncStats
+    {
+        public uint Presented;      // frames displayed
+        public uint Dropped;        // decoded frames never displayed
+        public uint Late;           // frames displayed later than the sync tolerance
+        public uint Duplicated;     // frame pump ticks on which a frame stayed past its duration
+        public uint Resyncs;        // decoder repositionings after falling far behind
+    }
+
+    /// <summary>
+    /// Counters of the queue of decoded frames waiting to be displayed.
+    /// The layout matches the native FrameQueueStats structure.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct FrameQueueStats
+    {
+        public uint Depth;          // frames queued now
+        public uint MaxDepth;       // most frames ever queued at once
+        public uint Pushed;         // frames queued by the decoder
+        public uint Popped;         // frames taken by the renderer
+        public uint Overwritten;    // frames dropped because the queue was full
+    }
+
+    /// <summary>
+    /// Display cadence of the frames of a video.
+    /// The layout matches the native JudderStats structure.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct JudderStats
+    {
+        public uint Refreshes;          // renders measured
+        public uint Frames;             // new frames displayed
+        public uint Repeated;           // renders that kept the previous frame on screen
+        public uint Skipped;            // decoded frames passed over without being displayed
+        public float Judder;            // mean difference between the time a frame stays on screen and its duration, in seconds
+        public float MaxJudder;         // largest such difference, in seconds
+        public float RefreshInterval;   // measured interval between renders, in seconds
+    }
+
+    /// <summary>
+    /// Playback quality of a video since it was loaded.
+    /// The layout matches the native PlaybackStats structure.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct PlaybackStats
+    {
+        public const int LateBucketCount = 8;
+
+        public uint Decoded;            // frames produced by the decoder
+        public uint Presented;          // frames displayed
+        public uint Dropped;            // decoded frames never displayed
+        public uint Stalls;             // times the video froze while playing
+
+        // Displayed frames by how late they reached the screen: up to 4, 8,
+        // 16, 33, 66, 133 and 266 ms, then later
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = LateBucketCount)]
+        public uint[] Late;
+
+        public float CopyTime;          // time spent copying frames to the video texture, in seconds
+        public float MaxCopyTime;       // longest copy of a frame, in seconds
+        public float StallTime;         // time the video stayed frozen, in seconds
+    }
+
+    /// <summary>
+    /// Status of a video, as published by the native side into the shared status block.
+    /// The layout matches the native PlayerStatus structure.
+    /// </summary>
+    private struct PlayerStatus
+    {
+        public MediaState State;
+        public float Position;
+        public float Duration;
+        public int BufferingPercentage;
+        public uint FrameCounter;
+        public int Width;
+        public int Height;
+        public int PlaylistIndex;
+    }
+
+    /// <summary>
+    /// Reinterprets a 32-bit word read from native memory as a float
+    /// </summary>
+    [StructLayout(LayoutKind.Explicit)]
+    private struct StatusWord
+    {
+        [FieldOffset(0)] public int Int;
+        [FieldOffset(0)] public float Float;
+    }
+
     #endregion // NESTED
 
 
 
+    #region PUBLIC_MEMBER_VARIABLES
+
+    /// <summary>
+    /// Render event ID that updates all playing videos at once
+    /// </summary>
+    public const int RENDER_EVENT_ALL_PLAYERS = 0;
+
+    /// <summary>
+    /// Maximum number of videos that can be alive at the same time
+    /// </summary>
+    public const int MAX_VIDEO_PLAYERS = 64;
+
+    /// <summary>
+    /// Seek position passed to Play to resume from the current position
+    /// </summary>
+    public const float CURRENT_POSITION = -1;
+
+    #endregion // PUBLIC_MEMBER_VARIABLES
+
+
+
     #region PRIVATE_MEMBER_VARIABLES
 
     private string mFilename = null;
     private string mFullScreenFilename = null;
 
+    // Video texture pointed at the decoded frames, and its own native texture
+    // to restore once the frames are released
+    private Texture2D mFrameTexture = null;
+    private IntPtr mFrameTextureOwnPtr = IntPtr.Zero;
+    private IntPtr mFrameTexturePtr = IntPtr.Zero;
+
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+    // Snapshots of all the videos, refreshed at most once per frame
+    private static PlayerSnapshot[] sSnapshots = new PlayerSnapshot[MAX_VIDEO_PLAYERS];
+    private static int sSnapshotFrame = -1;
+#endif
+
+    // Native status block shared by all the videos, mapped once and then read
+    // directly every frame (see PlayerStatusBlock.h in VuforiaMediaCommon)
+    private static IntPtr sStatusBlock = IntPtr.Zero;
+    private static int sStatusSlotStride = 0;
+    private static int sStatusSlotCount = 0;
+
+    // Byte offsets in a status block slot: sequence number, followed by PlayerStatus
+    private const int STATUS_OFFSET_SEQUENCE = 0;
+    private const int STATUS_OFFSET_STATE = 4;
+    private const int STATUS_OFFSET_POSITION = 8;
+    private const int STATUS_OFFSET_DURATION = 12;
+    private const int STATUS_OFFSET_BUFFERING = 16;
+    private const int STATUS_OFFSET_FRAME_COUNTER = 20;
+    private const int STATUS_OFFSET_WIDTH = 24;
+    private const int STATUS_OFFSET_HEIGHT = 28;
+    private const int STATUS_OFFSET_PLAYLIST_INDEX = 32;
+    private const int STATUS_READ_ATTEMPTS = 100;
+
     #endregion // PRIVATE_MEMBER_VARIABLES
 
 
@@ -73,11 +236,77 @@ public class VideoPlayerHelper
 #endif
     }
 
+    /// <summary>
+    /// Get the render event ID that updates only the texture of this video,
+    /// to be passed to GL.IssuePluginEvent together with GetNativeRenderEventFunc()
+    /// </summary>
+    public int GetRenderEventID()
+    {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+        return VideoPlayerGetRenderEventIDWSA(mVideoPlayerPtr);
+#else
+        return RENDER_EVENT_ALL_PLAYERS;
+#endif
+    }
+
+    /// <summary>
+    /// Get the render event ID that updates the textures of a group of videos
+    /// </summary>
+    public static int GetRenderGroupEventID(int group)
+    {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+        return VideoPlayerGetRenderGroupEventIDWSA(group);
+#else
+        return RENDER_EVENT_ALL_PLAYERS;
+#endif
+    }
+
+    /// <summary>
+    /// Prepares a video in the background (file opened, metadata parsed, first frame
+    /// decoded), so that a later Load() of the same file starts without delay.
+    /// Use it for the videos of the targets likely to be found next; the
+    /// VideoPlaybackBehaviours prewarm their video when they start. A player
+    /// given a crop does not use the prepared video.
+    /// Only supported on WSA, returns false on other platforms.
+    /// </summary>
+    public static bool Prewarm(string filename)
+    {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+        return VideoPlayerPrewarmWSA(GetPlaylistItemPath(filename));
+#else
+        return false;
+#endif
+    }
+
+    /// <summary>
+    /// Set how many prepared videos are kept by Prewarm(); the least recently
+    /// prewarmed ones are released first. 0 disables prewarming.
+    /// </summary>
+    public static void SetWarmPoolSize(int maxEntries)
+    {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+        VideoPlayerSetWarmPoolSizeWSA(maxEntries);
+#endif
+    }
+
+    /// <summary>
+    /// Release all the videos prepared by Prewarm()
+    /// </summary>
+    public static void ClearWarmPool()
+    {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+        VideoPlayerClearWarmPoolWSA();
+#endif
+    }
+
     /// <summary>
     /// Set the video filename
     /// </summary>
     public void SetFilename(string filename)
     {
+        // Remote videos are played through the disk cache, when it is enabled
+        filename = VideoCache.GetLocalUrl(filename);
+
 #if UNITY_ANDROID
 
         mFilename = filename;
@@ -107,14 +336,7 @@ public class VideoPlayerHelper
 		
 #elif UNITY_WSA_10_0
 
-        mFilename = filename;
-		
-        if (!filename.Contains("://"))
-        {
-            // Not a remote file, assume this file is located in the StreamingAssets folder
-            mFilename = "ms-appx:///Data/StreamingAssets/" + filename;
-        }
-		
+        mFilename = GetWSAFileUri(filename);
         mFullScreenFilename = mFilename;
 
 #endif
@@ -136,6 +358,7 @@ public class VideoPlayerHelper
     /// <returns></returns>
     public bool Deinit()
     {
+        RestoreFrameTexture();
         return videoPlayerDeinit();
     }
 
@@ -156,6 +379,7 @@ public class VideoPlayerHelper
     /// </summary>
     public bool Unload()
     {
+        RestoreFrameTexture();
         return videoPlayerUnload();
     }
 
@@ -273,6 +497,37 @@ public class VideoPlayerHelper
     }
 
 
+    /// <summary>
+    /// Points the video texture at the current decoded frame, where the plugin
+    /// wraps the frames as textures instead of copying them (iOS). Call it after
+    /// UpdateVideoData; the texture gets its own native texture back on Unload
+    /// and Deinit, or when the frames are copied again.
+    /// </summary>
+    public void UpdateFrameTexture(Texture2D texture)
+    {
+        IntPtr framePtr = videoPlayerGetFrameTexturePtr();
+        if (texture == null || (framePtr == IntPtr.Zero && mFrameTexture == null))
+        {
+            return;
+        }
+
+        if (texture != mFrameTexture)
+        {
+            RestoreFrameTexture();
+            mFrameTexture = texture;
+            mFrameTextureOwnPtr = texture.GetNativeTexturePtr();
+            mFrameTexturePtr = mFrameTextureOwnPtr;
+        }
+
+        IntPtr targetPtr = (framePtr != IntPtr.Zero) ? framePtr : mFrameTextureOwnPtr;
+        if (targetPtr != mFrameTexturePtr)
+        {
+            texture.UpdateExternalTexture(targetPtr);
+            mFrameTexturePtr = targetPtr;
+        }
+    }
+
+
     /// <summary>
     /// Moves the movie to the requested seek position
     /// </summary>
@@ -300,6 +555,178 @@ public class VideoPlayerHelper
     }
 
 
+    /// <summary>
+    /// Plays the movie, or the playlist, again from its start once it ends.
+    /// The decoder is kept: a single movie is looped by the platform player
+    /// and a playlist goes back to its first item without a visible gap.
+    /// Only supported on Android and WSA, returns false on other platforms.
+    /// </summary>
+    public bool SetLooping(bool looping)
+    {
+        return videoPlayerSetLooping(looping);
+    }
+
+
+    /// <summary>
+    /// Treats the movie as packed alpha: its frames hold the colour in their
+    /// left half and the alpha, as grey, in their right half. They are
+    /// recombined into a transparent video texture of the size of a half,
+    /// which is then the size reported for the movie. Call it before
+    /// SetVideoTexturePtr, and show the texture with a transparent material.
+    /// Only supported on Android, returns false on other platforms.
+    /// </summary>
+    public bool SetPackedAlpha(bool packedAlpha)
+    {
+#if UNITY_ANDROID && !UNITY_EDITOR
+        return GetJavaObject().Call<bool>("setPackedAlpha", packedAlpha);
+#else
+        return false;
+#endif
+    }
+
+
+    /// <summary>
+    /// Copies only a region of the movie, normalised from its top left corner,
+    /// to a video texture of its size, which is then the size reported for the
+    /// movie. Call it before SetVideoTexturePtr; a region of the same size in
+    /// pixels can then be moved while playing.
+    /// Only supported on Android and WSA, returns false on other platforms.
+    /// </summary>
+    public bool SetCrop(Rect crop)
+    {
+#if UNITY_ANDROID && !UNITY_EDITOR
+        return GetJavaObject().Call<bool>("setCrop", crop.x, crop.y, crop.width, crop.height);
+#elif UNITY_WSA_10_0 && !UNITY_EDITOR
+        mCropSet = VideoPlayerSetCropWSA(mVideoPlayerPtr, crop.x, crop.y, crop.width, crop.height);
+        return mCropSet;
+#else
+        return false;
+#endif
+    }
+
+
+    /// <summary>
+    /// Sets the movies played after the loaded one, in order. Each item is
+    /// prepared shortly before the previous one ends and takes over its video
+    /// texture, which is only recreated when the size changes.
+    /// Call it after Load; passing no movie clears the playlist.
+    /// Only supported on Android and WSA, returns false on other platforms.
+    /// </summary>
+    public bool SetPlaylist(params string[] nextFilenames)
+    {
+        if (mFilename == null)
+        {
+            return false;
+        }
+
+        string[] items = new string[1 + nextFilenames.Length];
+        items[0] = mFilename;
+        for (int i = 0; i < nextFilenames.Length; ++i)
+        {
+            items[i + 1] = GetPlaylistItemPath(nextFilenames[i]);
+        }
+        return videoPlayerSetPlaylist(items);
+    }
+
+
+    /// <summary>
+    /// Returns the playlist item being played, 0 for the loaded movie
+    /// </summary>
+    public int GetPlaylistIndex()
+    {
+        PlayerStatus status;
+        return ReadPlayerStatus(videoPlayerGetStatusSlot(), out status) ? status.PlaylistIndex : 0;
+    }
+
+
+    /// <summary>
+    /// Returns true once a cached frame of the loaded movie at its start position
+    /// was found. It is shown on the video texture by the next render event,
+    /// before the decoder has produced any frame.
+    /// Only supported on WSA, returns false on other platforms.
+    /// </summary>
+    public bool HasPosterFrame()
+    {
+#if UNITY_WSA_10_0 && !UNITY_EDITOR
+        return VideoPlayerHasPosterFrameWSA(mVideoPlayerPtr);
+#else
+        return false;
+#endif
+    }
+
+
+    /// <summary>
+    /// Returns the audio/video synchronisation counters of the on-texture playback.
+    /// Only supported on iOS, where the frames are paced by the plugin;
+    /// returns zeros on other platforms.
+    /// </summary>
+    public SyncStats GetSyncStats()
+    {
+        SyncStats stats = new SyncStats();
+#if (UNITY_IPHONE || UNITY_IOS) && !UNITY_EDITOR
+        videoPlayerGetSyncStatsIOS(mVideoPlayerPtr, out stats);
+#endif
+        return stats;
+    }
+
+
+    /// <summary>
+    /// Returns the counters of the queue between the decoder and the renderer.
+    /// Only supported on iOS; returns zeros on other platforms.
+    /// </summary>
+    public FrameQueueStats GetFrameQueueStats()
+    {
+        FrameQueueStats stats = new FrameQueueStats();
+#if (UNITY_IPHONE || UNITY_IOS) && !UNITY_EDITOR
+        videoPlayerGetFrameQueueStatsIOS(mVideoPlayerPtr, out stats);
+#endif
+        return stats;
+    }
+
+
+    /// <summary>
+    /// Returns how regularly the frames reach the screen: a frame that stays on
+    /// screen longer or shorter than its duration shows as judder (8 ms for
+    /// 24 fps on 60 Hz, a whole refresh for a frame displayed one render early
+    /// or late). On iOS the frames are chosen by their display time; on Android
+    /// and WSA the platform player latches them and only their cadence is measured.
+    /// </summary>
+    public JudderStats GetJudderStats()
+    {
+        JudderStats stats = new JudderStats();
+#if UNITY_ANDROID && !UNITY_EDITOR
+        videoPlayerGetJudderStatsAndroid(mVideoPlayerSlot, out stats);
+#elif (UNITY_IPHONE || UNITY_IOS) && !UNITY_EDITOR
+        videoPlayerGetJudderStatsIOS(mVideoPlayerPtr, out stats);
+#elif UNITY_WSA_10_0 && !UNITY_EDITOR
+        VideoPlayerGetJudderStatsWSA(mVideoPlayerPtr, out stats);
+#endif
+        return stats;
+    }
+
+
+    /// <summary>
+    /// Returns the frames decoded, displayed and dropped since the video was
+    /// loaded, how late the displayed frames were, the stalls, and the time
+    /// spent copying frames to the video texture. On Android the decoded frames
+    /// are the ones the platform player handed over, and their lateness is
+    /// measured from that moment.
+    /// </summary>
+    public PlaybackStats GetPlaybackStats()
+    {
+        PlaybackStats stats = new PlaybackStats();
+        stats.Late = new uint[PlaybackStats.LateBucketCount];
+#if UNITY_ANDROID && !UNITY_EDITOR
+        videoPlayerGetPlaybackStatsAndroid(mVideoPlayerSlot, out stats);
+#elif (UNITY_IPHONE || UNITY_IOS) && !UNITY_EDITOR
+        videoPlayerGetPlaybackStatsIOS(mVideoPlayerPtr, out stats);
+#elif UNITY_WSA_10_0 && !UNITY_EDITOR
+        VideoPlayerGetPlaybackStatsWSA(mVideoPlayerPtr, out stats);
+#endif
+        return stats;
+    }
+
+
     /// <summary>
     /// Gets the buffering percentage in case the movie is loaded from network
     /// Note this is not supported on iOS
@@ -310,6 +737,27 @@ public class VideoPlayerHelper
     }
 
 
+    /// <summary>
+    /// Returns the state, position, duration, buffering and size of the movie.
+    /// Where supported, the snapshots of all the movies are retrieved
+    /// with a single native call per frame.
+    /// </summary>
+    public PlayerSnapshot GetSnapshot()
+    {
+        return videoPlayerGetSnapshot();
+    }
+
+
+    /// <summary>
+    /// Returns the slot identifying the player in the native status block and
+    /// GPU memory budget, or -1 if the player is not initialized
+    /// </summary>
+    public int GetStatusSlot()
+    {
+        return videoPlayerGetStatusSlot();
+    }
+
+
     /// <summary>
     /// Allows native player to do appropriate on pause cleanup
     /// </summary>
@@ -322,13 +770,120 @@ public class VideoPlayerHelper
 
 
 
+#region PRIVATE_METHODS
+
+#if UNITY_WSA_10_0
+    private static string GetWSAFileUri(string filename)
+    {
+        if (!filename.Contains("://"))
+        {
+            // Not a remote file, assume this file is located in the StreamingAssets folder
+            return "ms-appx:///Data/StreamingAssets/" + filename;
+        }
+        return filename;
+    }
+#endif
+
+    /// <summary>
+    /// Returns the path a playlist item is opened from, resolved like SetFilename does
+    /// </summary>
+    private static string GetPlaylistItemPath(string filename)
+    {
+        filename = VideoCache.GetLocalUrl(filename);
+#if UNITY_WSA_10_0
+        filename = GetWSAFileUri(filename);
+#endif
+        return filename;
+    }
+
+    /// <summary>
+    /// Gives the video texture its own native texture back, before the frames
+    /// it points at are released
+    /// </summary>
+    private void RestoreFrameTexture()
+    {
+        if (mFrameTexture != null && mFrameTexturePtr != mFrameTextureOwnPtr)
+        {
+            mFrameTexture.UpdateExternalTexture(mFrameTextureOwnPtr);
+        }
+        mFrameTexture = null;
+        mFrameTextureOwnPtr = IntPtr.Zero;
+        mFrameTexturePtr = IntPtr.Zero;
+    }
+
+    /// <summary>
+    /// Reads the status of the video in the given slot straight from the native
+    /// status block, without calling into the plugin. Follows the seqlock protocol
+    /// of the native side: the copy is only kept if the sequence number was even
+    /// and did not change while reading.
+    /// </summary>
+    private static bool ReadPlayerStatus(int slot, out PlayerStatus status)
+    {
+        status = new PlayerStatus();
+
+        if (sStatusBlock == IntPtr.Zero || slot < 0 || slot >= sStatusSlotCount)
+        {
+            return false;
+        }
+
+        IntPtr slotPtr = new IntPtr(sStatusBlock.ToInt64() + (long)slot * sStatusSlotStride);
+        StatusWord word = new StatusWord();
+
+        for (int attempt = 0; attempt < STATUS_READ_ATTEMPTS; ++attempt)
+        {
+            int sequence = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_SEQUENCE);
+            if ((sequence & 1) != 0)
+            {
+                // A write is in progress
+                continue;
+            }
+            Thread.MemoryBarrier();
+
+            status.State = (MediaState) Marshal.ReadInt32(slotPtr, STATUS_OFFSET_STATE);
+            word.Int = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_POSITION);
+            status.Position = word.Float;
+            word.Int = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_DURATION);
+            status.Duration = word.Float;
+            status.BufferingPercentage = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_BUFFERING);
+            status.FrameCounter = (uint) Marshal.ReadInt32(slotPtr, STATUS_OFFSET_FRAME_COUNTER);
+            status.Width = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_WIDTH);
+            status.Height = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_HEIGHT);
+            status.PlaylistIndex = Marshal.ReadInt32(slotPtr, STATUS_OFFSET_PLAYLIST_INDEX);
+
+            Thread.MemoryBarrier();
+            if (Marshal.ReadInt32(slotPtr, STATUS_OFFSET_SEQUENCE) == sequence)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+#endregion // PRIVATE_METHODS
+
+
+
+
 #region NATIVE_FUNCTIONS
 
 #if !UNITY_EDITOR
 
 #if UNITY_ANDROID
 
+    [DllImport("VuforiaMedia")]
+    private static extern IntPtr videoPlayerGetStatusBlockAndroid(out int slotStride, out int slotCount);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool videoPlayerGetJudderStatsAndroid(int slot, out JudderStats stats);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool videoPlayerGetPlaybackStatsAndroid(int slot, out PlaybackStats stats);
+
+
     private AndroidJavaObject javaObj = null;
+    private int mVideoPlayerSlot = -1;
+    private uint mLastFrameCounter = 0;
 
     private AndroidJavaObject GetJavaObject()
     {
@@ -365,14 +920,28 @@ public class VideoPlayerHelper
             Debug.LogError("Incorrect Renderer API, setting it to OpenGL 2");
             openGLVersion = 2;
         }
-        return GetJavaObject().Call<bool>("init", openGLVersion);
+        bool result = GetJavaObject().Call<bool>("init", openGLVersion);
+
+        if (sStatusBlock == IntPtr.Zero)
+        {
+            sStatusBlock = videoPlayerGetStatusBlockAndroid(out sStatusSlotStride, out sStatusSlotCount);
+        }
+        mVideoPlayerSlot = GetJavaObject().Call<int>("getStatusSlot");
+
+        return result;
     }
 
     private bool videoPlayerDeinit()
     {
+        mVideoPlayerSlot = -1;
         return GetJavaObject().Call<bool>("deinit");
     }
 
+    private int videoPlayerGetStatusSlot()
+    {
+        return mVideoPlayerSlot;
+    }
+
     private bool videoPlayerLoad(string filename, int requestType, bool playOnTextureImmediately, float seekPosition)
     {
         return GetJavaObject().Call<bool>("load", filename, requestType, playOnTextureImmediately, seekPosition);
@@ -402,6 +971,11 @@ public class VideoPlayerHelper
 
     private int videoPlayerGetStatus()
     {
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            return (int)status.State;
+        }
         return GetJavaObject().Call<int>("getStatus");
     }
 
@@ -440,6 +1014,12 @@ public class VideoPlayerHelper
         return GetJavaObject().Call<int>("updateVideoData");
     }
 
+    private IntPtr videoPlayerGetFrameTexturePtr()
+    {
+        // the frames are rendered to the video texture
+        return IntPtr.Zero;
+    }
+
     private bool videoPlayerSeekTo(float position)
     {
         return GetJavaObject().Call<bool>("seekTo", position);
@@ -447,6 +1027,11 @@ public class VideoPlayerHelper
 
     private float videoPlayerGetCurrentPosition()
     {
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            return IsStatusReady(status.State) ? status.Position : -1;
+        }
         return GetJavaObject().Call<float>("getCurrentPosition");
     }
 
@@ -455,16 +1040,64 @@ public class VideoPlayerHelper
         return GetJavaObject().Call<bool>("setVolume", value);
     }
 
+    private bool videoPlayerSetLooping(bool looping)
+    {
+        return GetJavaObject().Call<bool>("setLooping", looping);
+    }
+
+    private bool videoPlayerSetPlaylist(string[] items)
+    {
+        return GetJavaObject().Call<bool>("setPlaylist", new object[] { items });
+    }
+
     private int videoPlayerGetCurrentBufferingPercentage()
     {
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            return status.BufferingPercentage;
+        }
         return GetJavaObject().Call<int>("getCurrentBufferingPercentage");
     }
 
+    private static bool IsStatusReady(MediaState state)
+    {
+        return state != MediaState.NOT_READY && state != MediaState.ERROR;
+    }
+
     private void videoPlayerOnPause()
     {
         // nothing to do for Android
     }
 
+    private PlayerSnapshot videoPlayerGetSnapshot()
+    {
+        PlayerSnapshot snapshot = new PlayerSnapshot();
+        snapshot.Valid = 1;
+
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            snapshot.State = status.State;
+            snapshot.Position = status.Position;
+            snapshot.Duration = status.Duration;
+            snapshot.BufferingPercentage = status.BufferingPercentage;
+            snapshot.Width = status.Width;
+            snapshot.Height = status.Height;
+            snapshot.NewFrame = (status.FrameCounter != mLastFrameCounter) ? 1 : 0;
+            mLastFrameCounter = status.FrameCounter;
+            return snapshot;
+        }
+
+        snapshot.State = (MediaState) videoPlayerGetStatus();
+        snapshot.Position = videoPlayerGetCurrentPosition();
+        snapshot.Duration = videoPlayerGetLength();
+        snapshot.BufferingPercentage = videoPlayerGetCurrentBufferingPercentage();
+        snapshot.Width = videoPlayerGetVideoWidth();
+        snapshot.Height = videoPlayerGetVideoHeight();
+        return snapshot;
+    }
+
 #elif (UNITY_IPHONE || UNITY_IOS)
 
     private IntPtr mVideoPlayerPtr = IntPtr.Zero;
@@ -472,6 +1105,21 @@ public class VideoPlayerHelper
     [DllImport("__Internal")]
     private static extern IntPtr videoPlayerInitIOS(bool isMetalRendering);
 
+    [DllImport("__Internal")]
+    private static extern bool videoPlayerGetSyncStatsIOS(IntPtr videoPlayerPtr, out SyncStats stats);
+
+    [DllImport("__Internal")]
+    private static extern bool videoPlayerGetFrameQueueStatsIOS(IntPtr videoPlayerPtr, out FrameQueueStats stats);
+
+    [DllImport("__Internal")]
+    private static extern bool videoPlayerGetJudderStatsIOS(IntPtr videoPlayerPtr, out JudderStats stats);
+
+    [DllImport("__Internal")]
+    private static extern bool videoPlayerGetPlaybackStatsIOS(IntPtr videoPlayerPtr, out PlaybackStats stats);
+
+    [DllImport("__Internal")]
+    private static extern int videoPlayerGetSlotIOS(IntPtr videoPlayerPtr);
+
     [DllImport("__Internal")]
     private static extern bool videoPlayerDeinitIOS(IntPtr videoPlayerPtr);
 
@@ -514,6 +1162,9 @@ public class VideoPlayerHelper
     [DllImport("__Internal")]
     private static extern int videoPlayerUpdateVideoDataIOS(IntPtr videoPlayerPtr);
 
+    [DllImport("__Internal")]
+    private static extern IntPtr videoPlayerGetFrameTexturePtrIOS(IntPtr videoPlayerPtr);
+
     [DllImport("__Internal")]
     private static extern bool videoPlayerSeekToIOS(IntPtr videoPlayerPtr, float position);
 
@@ -543,6 +1194,11 @@ public class VideoPlayerHelper
         return result;
     }
 
+    private int videoPlayerGetStatusSlot()
+    {
+        return mVideoPlayerPtr != IntPtr.Zero ? videoPlayerGetSlotIOS(mVideoPlayerPtr) : -1;
+    }
+
     private bool videoPlayerLoad(string filename, int requestType, bool playOnTextureImmediately, float seekPosition)
     {
         return videoPlayerLoadIOS(mVideoPlayerPtr, filename, requestType, playOnTextureImmediately, seekPosition);
@@ -608,6 +1264,11 @@ public class VideoPlayerHelper
         return videoPlayerUpdateVideoDataIOS(mVideoPlayerPtr);
     }
 
+    private IntPtr videoPlayerGetFrameTexturePtr()
+    {
+        return videoPlayerGetFrameTexturePtrIOS(mVideoPlayerPtr);
+    }
+
     private bool videoPlayerSeekTo(float position)
     {
         return videoPlayerSeekToIOS(mVideoPlayerPtr, position);
@@ -623,6 +1284,18 @@ public class VideoPlayerHelper
         return videoPlayerSetVolumeIOS(mVideoPlayerPtr, value);
     }
 
+    private bool videoPlayerSetLooping(bool looping)
+    {
+        // not supported by the iOS pipeline
+        return false;
+    }
+
+    private bool videoPlayerSetPlaylist(string[] items)
+    {
+        // not supported by the iOS pipeline
+        return false;
+    }
+
     private int videoPlayerGetCurrentBufferingPercentage()
     {
         return videoPlayerGetCurrentBufferingPercentageIOS(mVideoPlayerPtr);
@@ -633,13 +1306,66 @@ public class VideoPlayerHelper
         videoPlayerOnPauseIOS(mVideoPlayerPtr);
     }
 
+    private PlayerSnapshot videoPlayerGetSnapshot()
+    {
+        PlayerSnapshot snapshot = new PlayerSnapshot();
+        snapshot.Valid = 1;
+        snapshot.State = (MediaState) videoPlayerGetStatus();
+        snapshot.Position = videoPlayerGetCurrentPosition();
+        snapshot.Duration = videoPlayerGetLength();
+        snapshot.BufferingPercentage = videoPlayerGetCurrentBufferingPercentage();
+        snapshot.Width = videoPlayerGetVideoWidth();
+        snapshot.Height = videoPlayerGetVideoHeight();
+        return snapshot;
+    }
+
 #elif (UNITY_WSA_10_0)
 
     [DllImport("VuforiaMedia")]
     private static extern IntPtr GetRenderEventFunc();
 
+    [DllImport("VuforiaMedia")]
+    private static extern int VideoPlayerGetSlotWSA(IntPtr videoPlayerPtr);
+
+    [DllImport("VuforiaMedia")]
+    private static extern int VideoPlayerSnapshotAllWSA([In, Out] PlayerSnapshot[] snapshots, int count);
+
+    [DllImport("VuforiaMedia")]
+    private static extern int VideoPlayerGetRenderEventIDWSA(IntPtr videoPlayerPtr);
+
+    [DllImport("VuforiaMedia")]
+    private static extern int VideoPlayerGetRenderGroupEventIDWSA(int group);
+
+    [DllImport("VuforiaMedia")]
+    private static extern IntPtr VideoPlayerGetStatusBlockWSA(out int slotStride, out int slotCount);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerPrewarmWSA([MarshalAs(UnmanagedType.LPStr)] string filename);
+
+    [DllImport("VuforiaMedia")]
+    private static extern IntPtr VideoPlayerLoadFromWarmPoolWSA(IntPtr videoPlayerPtr, [MarshalAs(UnmanagedType.LPStr)] string filename, bool playOnTextureImmediately, float seekPosition);
+
+    [DllImport("VuforiaMedia")]
+    private static extern void VideoPlayerSetWarmPoolSizeWSA(int maxEntries);
+
+    [DllImport("VuforiaMedia")]
+    private static extern void VideoPlayerClearWarmPoolWSA();
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerHasPosterFrameWSA(IntPtr videoPlayerPtr);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerGetJudderStatsWSA(IntPtr videoPlayerPtr, out JudderStats stats);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerGetPlaybackStatsWSA(IntPtr videoPlayerPtr, out PlaybackStats stats);
+
 
     private IntPtr mVideoPlayerPtr = IntPtr.Zero;
+    private int mVideoPlayerSlot = -1;
+
+    // Prepared players are uncropped, so a cropped player always loads its own
+    private bool mCropSet = false;
     
     [DllImport("VuforiaMedia")]
     private static extern IntPtr VideoPlayerInitWSA();
@@ -695,6 +1421,16 @@ public class VideoPlayerHelper
     [DllImport("VuforiaMedia")]
     private static extern bool VideoPlayerSetVolumeWSA(IntPtr videoPlayerPtr, float value);
 
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerSetLoopingWSA(IntPtr videoPlayerPtr, bool looping);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerSetCropWSA(IntPtr videoPlayerPtr, float x, float y, float width, float height);
+
+    [DllImport("VuforiaMedia")]
+    private static extern bool VideoPlayerSetPlaylistWSA(IntPtr videoPlayerPtr,
+        [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPStr)] string[] items, int count);
+
     [DllImport("VuforiaMedia")]
     private static extern int VideoPlayerGetCurrentBufferingPercentageWSA(IntPtr videoPlayerPtr);
 
@@ -704,7 +1440,13 @@ public class VideoPlayerHelper
 
     private bool videoPlayerInit(VuforiaRenderer.RendererAPI unused_rendererAPI)
     {
+        if (sStatusBlock == IntPtr.Zero)
+        {
+            sStatusBlock = VideoPlayerGetStatusBlockWSA(out sStatusSlotStride, out sStatusSlotCount);
+        }
+
         mVideoPlayerPtr = VideoPlayerInitWSA();
+        mVideoPlayerSlot = VideoPlayerGetSlotWSA(mVideoPlayerPtr);
         return mVideoPlayerPtr != IntPtr.Zero;
     }
 
@@ -712,11 +1454,44 @@ public class VideoPlayerHelper
     {
         bool result = VideoPlayerDeinitWSA(mVideoPlayerPtr);
         mVideoPlayerPtr = IntPtr.Zero;
+        mVideoPlayerSlot = -1;
         return result;
     }
 
+    private int videoPlayerGetStatusSlot()
+    {
+        return mVideoPlayerSlot;
+    }
+
+    private PlayerSnapshot videoPlayerGetSnapshot()
+    {
+        if (mVideoPlayerSlot < 0)
+        {
+            return new PlayerSnapshot();
+        }
+
+        // One native call per frame refreshes the snapshots of all the videos
+        if (sSnapshotFrame != Time.frameCount)
+        {
+            VideoPlayerSnapshotAllWSA(sSnapshots, sSnapshots.Length);
+            sSnapshotFrame = Time.frameCount;
+        }
+
+        return sSnapshots[mVideoPlayerSlot];
+    }
+
     private bool videoPlayerLoad(string filename, int requestType, bool playOnTextureImmediately, float seekPosition)
     {
+        // A player prepared by Prewarm() replaces this one and keeps its slot;
+        // it was prepared from the start, and seeks and plays as requested once ready
+        IntPtr warmPlayerPtr = mCropSet ? IntPtr.Zero :
+            VideoPlayerLoadFromWarmPoolWSA(mVideoPlayerPtr, filename, playOnTextureImmediately, seekPosition);
+        if (warmPlayerPtr != IntPtr.Zero)
+        {
+            mVideoPlayerPtr = warmPlayerPtr;
+            return true;
+        }
+
         return VideoPlayerLoadWSA(mVideoPlayerPtr, filename, requestType, playOnTextureImmediately, seekPosition);
     }
 
@@ -742,7 +1517,12 @@ public class VideoPlayerHelper
 
     private int videoPlayerGetStatus()
     {
-        return VideoPlayerGetStatusWSA(mVideoPlayerPtr);
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            return (int)status.State;
+        }
+        return (int)videoPlayerGetSnapshot().State;
     }
 
     private int videoPlayerGetVideoWidth()
@@ -777,7 +1557,15 @@ public class VideoPlayerHelper
 
     private int videoPlayerUpdateVideoData()
     {
-        return VideoPlayerUpdateVideoDataWSA(mVideoPlayerPtr);
+        // The render event of this video requests its texture update itself,
+        // so only the status is needed here
+        return videoPlayerGetStatus();
+    }
+
+    private IntPtr videoPlayerGetFrameTexturePtr()
+    {
+        // the frames are copied to the video texture
+        return IntPtr.Zero;
     }
 
     private bool videoPlayerSeekTo(float position)
@@ -787,7 +1575,12 @@ public class VideoPlayerHelper
 
     private float videoPlayerGetCurrentPosition()
     {
-        return VideoPlayerGetCurrentPositionWSA(mVideoPlayerPtr);
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            return status.Position;
+        }
+        return videoPlayerGetSnapshot().Position;
     }
 
     private bool videoPlayerSetVolume(float value)
@@ -795,9 +1588,24 @@ public class VideoPlayerHelper
         return VideoPlayerSetVolumeWSA(mVideoPlayerPtr, value);
     }
 
+    private bool videoPlayerSetLooping(bool looping)
+    {
+        return VideoPlayerSetLoopingWSA(mVideoPlayerPtr, looping);
+    }
+
+    private bool videoPlayerSetPlaylist(string[] items)
+    {
+        return VideoPlayerSetPlaylistWSA(mVideoPlayerPtr, items, items.Length);
+    }
+
     private int videoPlayerGetCurrentBufferingPercentage()
     {
-        return VideoPlayerGetCurrentBufferingPercentageWSA(mVideoPlayerPtr);
+        PlayerStatus status;
+        if (ReadPlayerStatus(mVideoPlayerSlot, out status))
+        {
+            return status.BufferingPercentage;
+        }
+        return videoPlayerGetSnapshot().BufferingPercentage;
     }
 
     private void videoPlayerOnPause()
@@ -817,6 +1625,8 @@ public class VideoPlayerHelper
 
     bool videoPlayerDeinit() { return false; }
 
+    int videoPlayerGetStatusSlot() { return -1; }
+
     bool videoPlayerLoad(string filename, int requestType, bool playOnTextureImmediately, float seekPosition) { return false; }
 
     bool videoPlayerUnload() { return false; }
@@ -843,16 +1653,24 @@ public class VideoPlayerHelper
 
     int videoPlayerUpdateVideoData() { return 0; }
 
+    IntPtr videoPlayerGetFrameTexturePtr() { return IntPtr.Zero; }
+
     bool videoPlayerSeekTo(float position) { return false; }
 
     float videoPlayerGetCurrentPosition() { return 0; }
 
     bool videoPlayerSetVolume(float value) { return false; }
 
+    bool videoPlayerSetLooping(bool looping) { return false; }
+
+    bool videoPlayerSetPlaylist(string[] items) { return false; }
+
     int videoPlayerGetCurrentBufferingPercentage() { return 0; }
 
     void videoPlayerOnPause() { }
 
+    PlayerSnapshot videoPlayerGetSnapshot() { return new PlayerSnapshot(); }
+
 #endif // !UNITY_EDITOR
 
 #endregion // NATIVE_FUNCTIONS